@@ -138,6 +138,21 @@ namespace GnotePad
             spdlog::info("Headless smoke flag detected; quitting shortly after startup");
             QTimer::singleShot(kQuitAfterInitDelayMs, this, &QCoreApplication::quit);
         }
+
+        if (m_readStandardInput)
+        {
+            QTimer::singleShot(0, m_mainWindow.get(), &ui::MainWindow::openStandardInput);
+        }
+        if (!m_filesToOpen.isEmpty())
+        {
+            // With standard input in the main window, every file gets a window of its own.
+            QTimer::singleShot(0, m_mainWindow.get(), [this]() { m_mainWindow->openFiles(m_filesToOpen, false); });
+        }
+        else if (!m_readStandardInput && !m_quitAfterInit)
+        {
+            // Asked once the window is up, so the prompt has something to sit on.
+            QTimer::singleShot(0, m_mainWindow.get(), &ui::MainWindow::offerDocumentRecovery);
+        }
         return exec();
     }
 
@@ -186,10 +201,17 @@ namespace GnotePad
         const QCommandLineOption quitAfterInitOption({QStringLiteral("quit-after-init"), QStringLiteral("headless-smoke")},
                                                      QStringLiteral("Quit shortly after startup (useful for headless smoke tests)."));
 
+        const QCommandLineOption stdinOption(QStringLiteral("stdin"), QStringLiteral("Read the document from standard input."));
+
         parser.addOption(quitAfterInitOption);
+        parser.addOption(stdinOption);
+        parser.addPositionalArgument(
+            QStringLiteral("files"), QStringLiteral("Files to open; \"-\" reads standard input."), QStringLiteral("[files...]"));
         parser.process(arguments);
 
         m_quitAfterInit = parser.isSet(quitAfterInitOption);
+        m_filesToOpen = parser.positionalArguments();
+        m_readStandardInput = parser.isSet(stdinOption) || m_filesToOpen.removeAll(QStringLiteral("-")) > 0;
     }
 
     bool Application::isHeadlessSmokeMode()
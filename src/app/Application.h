@@ -41,6 +41,8 @@ namespace GnotePad
         std::unique_ptr<ui::MainWindow> m_mainWindow;
         QIcon m_applicationIcon;
         bool m_quitAfterInit{false};
+        bool m_readStandardInput{false};
+        QStringList m_filesToOpen;
     };
 
 } // namespace GnotePad
@@ -0,0 +1,143 @@
+#include "app/ReplaceCommand.h"
+
+#include "core/BatchReplace.h"
+
+#include <QtCore/qcommandlineoption.h>
+#include <QtCore/qcommandlineparser.h>
+#include <QtCore/qcoreapplication.h>
+#include <QtCore/qelapsedtimer.h>
+#include <QtCore/qstring.h>
+#include <QtCore/qstringliteral.h>
+#include <QtCore/qtextstream.h>
+
+#include <cstdio>
+#include <span>
+#include <string_view>
+
+#ifndef GNOTE_VERSION
+// Do not change to constexpr, this is set and passed in by the build system
+// NOLINTNEXTLINE(cppcoreguidelines-macro-usage)
+#define GNOTE_VERSION "0.0.0-dev"
+#endif
+
+namespace GnotePad
+{
+
+    namespace
+    {
+        constexpr int kExitFailed = 1;
+        constexpr int kExitUsage = 2;
+
+        QString errorText(core::BatchReplace::Error error)
+        {
+            switch (error)
+            {
+            case core::BatchReplace::Error::None:
+                break;
+            case core::BatchReplace::Error::Open:
+                return QStringLiteral("cannot open");
+            case core::BatchReplace::Error::Decode:
+                return QStringLiteral("unsupported encoding");
+            case core::BatchReplace::Error::Decompress:
+                return QStringLiteral("cannot decompress");
+            case core::BatchReplace::Error::Write:
+                return QStringLiteral("cannot write");
+            }
+            return {};
+        }
+
+        QString milliseconds(qint64 microseconds)
+        {
+            return QString::number(static_cast<double>(microseconds) / 1000.0, 'f', 2);
+        }
+    } // namespace
+
+    bool ReplaceCommand::requested(int argc, char** argv)
+    {
+        if (argc < 2)
+        {
+            return false;
+        }
+
+        // The editor parses with single-dash long options too, so "-replace" counts as well.
+        for (const char* argument : std::span(argv, static_cast<std::size_t>(argc)).subspan(1))
+        {
+            const std::string_view view(argument);
+            if (view == "--")
+            {
+                break;
+            }
+            if (view == "--replace" || view == "-replace" || view.starts_with("--replace=") || view.starts_with("-replace="))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    int ReplaceCommand::run(int& argc, char** argv)
+    {
+        const QCoreApplication app(argc, argv);
+        QCoreApplication::setApplicationName(QStringLiteral("GnotePad"));
+        QCoreApplication::setApplicationVersion(QString::fromLatin1(GNOTE_VERSION));
+
+        QCommandLineParser parser;
+        parser.setApplicationDescription(QStringLiteral("GnotePad batch replace - rewrite files without opening the editor"));
+        parser.addHelpOption();
+        parser.addVersionOption();
+        parser.setSingleDashWordOptionMode(QCommandLineParser::ParseAsLongOptions);
+        const QCommandLineOption replaceOption(QStringLiteral("replace"), QStringLiteral("Text to find."), QStringLiteral("term"));
+        const QCommandLineOption withOption(QStringLiteral("with"), QStringLiteral("Text to put in its place."), QStringLiteral("text"));
+        const QCommandLineOption matchCaseOption(QStringLiteral("match-case"), QStringLiteral("Match case exactly."));
+        const QCommandLineOption jobsOption(
+            QStringLiteral("jobs"), QStringLiteral("Files processed at once (default: one per core)."), QStringLiteral("count"));
+        parser.addOption(replaceOption);
+        parser.addOption(withOption);
+        parser.addOption(matchCaseOption);
+        parser.addOption(jobsOption);
+        parser.addPositionalArgument(QStringLiteral("files"), QStringLiteral("Files to rewrite."), QStringLiteral("files..."));
+        parser.process(app);
+
+        QTextStream out(stdout);
+        QTextStream err(stderr);
+        const QString term = parser.value(replaceOption);
+        const QStringList filePaths = parser.positionalArguments();
+        bool jobsValid = true;
+        const int jobs = parser.isSet(jobsOption) ? parser.value(jobsOption).toInt(&jobsValid) : 0;
+        if (term.isEmpty() || !parser.isSet(withOption) || filePaths.isEmpty() || !jobsValid)
+        {
+            err << "Usage: gnotepad --replace TERM --with TEXT [--match-case] [--jobs N] files...\n";
+            return kExitUsage;
+        }
+
+        const Qt::CaseSensitivity sensitivity = parser.isSet(matchCaseOption) ? Qt::CaseSensitive : Qt::CaseInsensitive;
+        const core::BatchReplace replace(term, parser.value(withOption), sensitivity);
+        QElapsedTimer timer;
+        timer.start();
+        qsizetype totalReplacements = 0;
+        qsizetype changedFiles = 0;
+        qsizetype failedFiles = 0;
+        replace.run(filePaths,
+                    jobs,
+                    [&](const core::BatchReplace::FileResult& result)
+                    {
+                        if (result.error != core::BatchReplace::Error::None)
+                        {
+                            ++failedFiles;
+                            err << result.filePath << ": " << errorText(result.error) << '\n';
+                            err.flush();
+                            return;
+                        }
+                        totalReplacements += result.replacements;
+                        changedFiles += result.replacements > 0 ? 1 : 0;
+                        out << result.filePath << ": " << result.replacements << " replacement(s) in " << milliseconds(result.elapsedUs)
+                            << " ms\n";
+                        out.flush();
+                    });
+
+        out << totalReplacements << " replacement(s) in " << changedFiles << " of " << filePaths.size() << " file(s), " << failedFiles
+            << " failed, " << milliseconds(timer.nsecsElapsed() / 1000) << " ms\n";
+        return failedFiles > 0 ? kExitFailed : 0;
+    }
+
+} // namespace GnotePad
@@ -0,0 +1,19 @@
+#pragma once
+
+namespace GnotePad
+{
+
+    // `gnotepad --replace TERM --with TEXT [--match-case] [--jobs N] files...` rewrites files without starting
+    // the GUI: only a QCoreApplication is created, so it runs on machines without a display.
+    class ReplaceCommand
+    {
+    public:
+        // True when the arguments ask for a batch replace rather than the editor.
+        [[nodiscard]] static bool requested(int argc, char** argv);
+
+        // Parses the arguments, processes the files and prints one line per file plus a summary. Returns 0 when
+        // every file was handled, 1 when any failed and 2 on a usage error.
+        static int run(int& argc, char** argv);
+    };
+
+} // namespace GnotePad
@@ -0,0 +1,107 @@
+#include "core/BatchReplace.h"
+
+#include "core/DocumentReader.h"
+#include "core/EncodedFileWriter.h"
+
+#include <QtCore/qelapsedtimer.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qthreadpool.h>
+
+namespace GnotePad::core
+{
+
+    namespace
+    {
+        // Same default as the editor: smaller files are read into a buffer, larger ones mapped.
+        constexpr qint64 kMapThresholdBytes = 4LL * 1024 * 1024;
+
+        BatchReplace::Error readError(DocumentReader::Error error)
+        {
+            switch (error)
+            {
+            case DocumentReader::Error::Open:
+                return BatchReplace::Error::Open;
+            case DocumentReader::Error::Decompress:
+                return BatchReplace::Error::Decompress;
+            case DocumentReader::Error::Decode:
+            case DocumentReader::Error::None:
+                break;
+            }
+            return BatchReplace::Error::Decode;
+        }
+    } // namespace
+
+    BatchReplace::BatchReplace(const QString& term, const QString& replacement, Qt::CaseSensitivity sensitivity)
+        : m_search(term, sensitivity), m_replacement(replacement)
+    {
+    }
+
+    BatchReplace::FileResult BatchReplace::replaceInFile(const QString& filePath) const
+    {
+        QElapsedTimer timer;
+        timer.start();
+        FileResult result;
+        result.filePath = filePath;
+        const auto finish = [&result, &timer]()
+        {
+            result.elapsedUs = timer.nsecsElapsed() / 1000;
+            return result;
+        };
+
+        DecodedDocument document;
+        const DocumentReader::Error error = DocumentReader::read(filePath, kMapThresholdBytes, document);
+        if (error != DocumentReader::Error::None)
+        {
+            result.error = readError(error);
+            return finish();
+        }
+
+        const QStringView text = document.text;
+        qsizetype match = m_search.indexIn(text);
+        if (match < 0)
+        {
+            return finish();
+        }
+
+        // One pass: the text between matches streams straight from the decoded buffer into the encoder.
+        EncodedFileWriter writer(filePath, document.encoding, document.hasBom, document.compression);
+        bool written = writer.open();
+        qsizetype copied = 0;
+        while (written && match >= 0)
+        {
+            written = writer.write(text.sliced(copied, match - copied)) && writer.write(m_replacement);
+            copied = match + m_search.termLength();
+            ++result.replacements;
+            match = m_search.indexIn(text, copied);
+        }
+        if (!written || !writer.write(text.sliced(copied)) || !writer.commit())
+        {
+            result.replacements = 0;
+            result.error = Error::Write;
+        }
+        return finish();
+    }
+
+    void BatchReplace::run(const QStringList& filePaths, int jobs, const std::function<void(const FileResult&)>& report) const
+    {
+        QThreadPool pool;
+        if (jobs > 0)
+        {
+            pool.setMaxThreadCount(jobs);
+        }
+
+        QMutex reportMutex;
+        for (const QString& filePath : filePaths)
+        {
+            pool.start(
+                [this, &report, &reportMutex, filePath]()
+                {
+                    const FileResult result = replaceInFile(filePath);
+                    const QMutexLocker locker(&reportMutex);
+                    report(result);
+                });
+        }
+        pool.waitForDone();
+    }
+
+} // namespace GnotePad::core
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "core/LiteralSearch.h"
+
+#include <QtCore/qnamespace.h>
+#include <QtCore/qstring.h>
+#include <QtCore/qstringlist.h>
+#include <QtCore/qtypes.h>
+
+#include <cstdint>
+#include <functional>
+
+namespace GnotePad::core
+{
+
+    // Replaces a literal term across many files without a window in sight. Every file is read and decoded the
+    // way the editor opens it (BOM sniffing, gzip/zstd), matched with the editor's LiteralSearch, and written
+    // back in its own encoding, BOM and compression through a QSaveFile, so a failure never leaves a file half
+    // written. Files without a match are not touched at all.
+    class BatchReplace
+    {
+    public:
+        enum class Error : std::uint8_t
+        {
+            None,
+            Open,
+            Decode,
+            Decompress,
+            Write
+        };
+
+        struct FileResult
+        {
+            QString filePath;
+            qsizetype replacements{0};
+            Error error{Error::None};
+            qint64 elapsedUs{0};
+        };
+
+        BatchReplace(const QString& term, const QString& replacement, Qt::CaseSensitivity sensitivity);
+
+        // Handles one file on the calling thread.
+        [[nodiscard]] FileResult replaceInFile(const QString& filePath) const;
+
+        // Spreads the files over up to jobs threads (all cores when jobs < 1) and returns once every file is
+        // done. report is called once per file as it finishes, never from two threads at the same time.
+        void run(const QStringList& filePaths, int jobs, const std::function<void(const FileResult&)>& report) const;
+
+    private:
+        LiteralSearch m_search;
+        QString m_replacement;
+    };
+
+} // namespace GnotePad::core
@@ -0,0 +1,220 @@
+#include "core/ByteLineIndex.h"
+
+#ifdef Q_PROCESSOR_X86_64
+#include <immintrin.h>
+#elifdef Q_PROCESSOR_ARM_64
+#include <arm_neon.h>
+#endif
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <iterator>
+
+namespace GnotePad::core
+{
+
+    namespace
+    {
+        constexpr bool isBreak(char byte)
+        {
+            return byte == '\n' || byte == '\r';
+        }
+
+        // Calls visit(index) for every LF or CR in data[from, to), in order; stops early when visit returns false.
+        template <typename Visitor> void forEachBreak(const char* data, qint64 from, qint64 to, Visitor&& visit)
+        {
+            qint64 index = from;
+#ifdef Q_PROCESSOR_X86_64
+            constexpr qint64 BlockBytes = 16;
+            const __m128i lineFeed = _mm_set1_epi8('\n');
+            const __m128i carriageReturn = _mm_set1_epi8('\r');
+            for (; index + BlockBytes <= to; index += BlockBytes)
+            {
+                const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + index));
+                auto hits = static_cast<unsigned>(
+                    _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(bytes, lineFeed), _mm_cmpeq_epi8(bytes, carriageReturn))));
+                while (hits != 0)
+                {
+                    if (!visit(index + std::countr_zero(hits)))
+                    {
+                        return;
+                    }
+                    hits &= hits - 1;
+                }
+            }
+#elifdef Q_PROCESSOR_ARM_64
+            constexpr qint64 BlockBytes = 16;
+            const auto* bytes8 = reinterpret_cast<const std::uint8_t*>(data);
+            for (; index + BlockBytes <= to; index += BlockBytes)
+            {
+                const uint8x16_t bytes = vld1q_u8(bytes8 + index);
+                const uint8x16_t hits = vorrq_u8(vceqq_u8(bytes, vdupq_n_u8('\n')), vceqq_u8(bytes, vdupq_n_u8('\r')));
+                if (vmaxvq_u8(hits) == 0)
+                {
+                    continue;
+                }
+                for (qint64 offset = index; offset < index + BlockBytes; ++offset)
+                {
+                    if (isBreak(data[offset]) && !visit(offset))
+                    {
+                        return;
+                    }
+                }
+            }
+#endif
+            for (; index < to; ++index)
+            {
+                if (isBreak(data[index]) && !visit(index))
+                {
+                    return;
+                }
+            }
+        }
+
+        qint64 findBreak(QByteArrayView data, qint64 from)
+        {
+            qint64 found = data.size();
+            forEachBreak(data.data(),
+                         from,
+                         data.size(),
+                         [&found](qint64 index)
+                         {
+                             found = index;
+                             return false;
+                         });
+            return found;
+        }
+    } // namespace
+
+    ByteLineIndex::Batch ByteLineIndex::scan(QByteArrayView data, qint64 from, qint64 to, qint64 firstLine)
+    {
+        Batch batch;
+        const char* bytes = data.data();
+        const qint64 size = data.size();
+        to = std::min(to, size);
+        forEachBreak(bytes,
+                     from,
+                     to,
+                     [&](qint64 index)
+                     {
+                         // The CR of a CRLF pair is not a break of its own; the LF after it ends the line.
+                         if (bytes[index] == '\r' && index + 1 < size && bytes[index + 1] == '\n')
+                         {
+                             return true;
+                         }
+                         ++batch.lineBreaks;
+                         if ((firstLine + batch.lineBreaks) % CheckpointInterval == 0)
+                         {
+                             batch.checkpoints.push_back(index + 1);
+                         }
+                         return true;
+                     });
+        batch.scannedTo = to;
+        return batch;
+    }
+
+    qint64 ByteLineIndex::nextLineStart(QByteArrayView data, qint64 position)
+    {
+        const qint64 index = findBreak(data, position);
+        if (index >= data.size())
+        {
+            return -1;
+        }
+        if (data[index] == '\r' && index + 1 < data.size() && data[index + 1] == '\n')
+        {
+            return index + 2;
+        }
+        return index + 1;
+    }
+
+    qint64 ByteLineIndex::lineEnd(QByteArrayView data, qint64 position)
+    {
+        return findBreak(data, position);
+    }
+
+    qint64 ByteLineIndex::previousLineStart(QByteArrayView data, qint64 dataStart, qint64 lineStart)
+    {
+        if (lineStart <= dataStart)
+        {
+            return dataStart;
+        }
+
+        // Step over the break that ends the previous line, then look for the one before it.
+        qint64 index = lineStart - 1;
+        if (data[index] == '\n' && index > dataStart && data[index - 1] == '\r')
+        {
+            --index;
+        }
+        while (index > dataStart)
+        {
+            --index;
+            if (isBreak(data[index]))
+            {
+                return index + 1;
+            }
+        }
+        return dataStart;
+    }
+
+    ByteLineIndex::ByteLineIndex(qint64 dataStart)
+    {
+        reset(dataStart);
+    }
+
+    void ByteLineIndex::reset(qint64 dataStart)
+    {
+        m_checkpoints.assign(1, dataStart);
+        m_lineCount = 1;
+        m_scannedTo = dataStart;
+    }
+
+    void ByteLineIndex::append(const Batch& batch)
+    {
+        m_checkpoints.insert(m_checkpoints.end(), batch.checkpoints.begin(), batch.checkpoints.end());
+        m_lineCount += batch.lineBreaks;
+        m_scannedTo = batch.scannedTo;
+    }
+
+    qint64 ByteLineIndex::lineStart(QByteArrayView data, qint64 line) const
+    {
+        // Every line below the count starts inside the scanned region, at most CheckpointInterval lines past a
+        // checkpoint.
+        line = std::clamp<qint64>(line, 0, m_lineCount - 1);
+        const auto checkpoint = std::min<std::size_t>(static_cast<std::size_t>(line / CheckpointInterval), m_checkpoints.size() - 1);
+        qint64 position = m_checkpoints[checkpoint];
+        for (qint64 current = static_cast<qint64>(checkpoint) * CheckpointInterval; current < line; ++current)
+        {
+            const qint64 next = nextLineStart(data, position);
+            if (next < 0)
+            {
+                break;
+            }
+            position = next;
+        }
+        return position;
+    }
+
+    qint64 ByteLineIndex::lineAt(QByteArrayView data, qint64 offset) const
+    {
+        if (offset >= m_scannedTo && m_scannedTo < data.size())
+        {
+            return -1;
+        }
+        const auto it = std::ranges::upper_bound(m_checkpoints, offset);
+        const auto checkpoint = static_cast<std::size_t>(std::max<std::ptrdiff_t>(0, std::distance(m_checkpoints.begin(), it) - 1));
+        qint64 line = static_cast<qint64>(checkpoint) * CheckpointInterval;
+        qint64 position = m_checkpoints[checkpoint];
+        while (true)
+        {
+            const qint64 next = nextLineStart(data, position);
+            if (next < 0 || next > offset)
+            {
+                return line;
+            }
+            ++line;
+            position = next;
+        }
+    }
+
+} // namespace GnotePad::core
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <QtCore/qbytearrayview.h>
+#include <QtCore/qtypes.h>
+
+#include <vector>
+
+namespace GnotePad::core
+{
+
+    // Sparse line index over the raw bytes of an ASCII-compatible file, for views that never decode the whole
+    // file. Only every CheckpointInterval-th line start is stored; any other line is reached by walking forward
+    // from the checkpoint before it, so a multi-gigabyte file costs a few megabytes of index. LF, CR and a CRLF
+    // pair each end a line. Scanning happens in batches (typically on a worker thread) that the owner appends in
+    // order. Lookups never walk past the scanned region; what lies beyond it has to wait for the next batch.
+    class ByteLineIndex
+    {
+    public:
+        static constexpr qint64 CheckpointInterval = 64;
+
+        // Result of scanning one range: the checkpointed line starts found in it and how many lines it ended.
+        struct Batch
+        {
+            std::vector<qint64> checkpoints;
+            qint64 lineBreaks{0};
+            qint64 scannedTo{0};
+        };
+
+        // Vectorized scan (SSE2 or NEON, scalar elsewhere) of data[from, to). firstLine is the number of the line
+        // that is current at from; data must be the whole file so a CR at the end of the range can see past it.
+        // Safe to call from any thread.
+        [[nodiscard]] static Batch scan(QByteArrayView data, qint64 from, qint64 to, qint64 firstLine);
+
+        // Offset just past the line break that ends the line containing position, or -1 on the last line.
+        [[nodiscard]] static qint64 nextLineStart(QByteArrayView data, qint64 position);
+
+        // Offset of the line break (or end of data) that ends the line containing position.
+        [[nodiscard]] static qint64 lineEnd(QByteArrayView data, qint64 position);
+
+        // Start of the line before the one starting at lineStart; lines never begin before dataStart.
+        [[nodiscard]] static qint64 previousLineStart(QByteArrayView data, qint64 dataStart, qint64 lineStart);
+
+        explicit ByteLineIndex(qint64 dataStart = 0);
+
+        void reset(qint64 dataStart);
+        void append(const Batch& batch);
+
+        // Lines known so far: one more than the breaks scanned, so a trailing newline adds an empty last line.
+        [[nodiscard]] qint64 lineCount() const
+        {
+            return m_lineCount;
+        }
+
+        [[nodiscard]] qint64 scannedTo() const
+        {
+            return m_scannedTo;
+        }
+
+        // Offset where the zero-based line starts; lines not indexed yet clamp to the last line known so far.
+        [[nodiscard]] qint64 lineStart(QByteArrayView data, qint64 line) const;
+
+        // Zero-based line containing offset, or -1 while offset lies beyond the scanned region of data.
+        [[nodiscard]] qint64 lineAt(QByteArrayView data, qint64 offset) const;
+
+    private:
+        std::vector<qint64> m_checkpoints;
+        qint64 m_lineCount{1};
+        qint64 m_scannedTo{0};
+    };
+
+} // namespace GnotePad::core
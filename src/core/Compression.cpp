@@ -0,0 +1,387 @@
+#include "core/Compression.h"
+
+#ifdef GNOTE_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef GNOTE_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#include <QtCore/qfile.h>
+#include <QtCore/qiodevice.h>
+#include <QtCore/qstringliteral.h>
+
+#include <algorithm>
+#include <limits>
+
+namespace GnotePad::core
+{
+
+    namespace
+    {
+        constexpr std::uint8_t kGzipMagic[] = {0x1f, 0x8b};
+        constexpr std::uint8_t kZstdMagic[] = {0x28, 0xb5, 0x2f, 0xfd};
+
+        // Output grows in steps of this size while compressing; about one encoded chunk of the file writer.
+        [[maybe_unused]] constexpr qsizetype kCompressStepBytes = 64 * 1024;
+
+        template<std::size_t N>
+        bool startsWith(QByteArrayView data, const std::uint8_t (&magic)[N])
+        {
+            return data.size() >= static_cast<qsizetype>(N) &&
+                   std::equal(magic, magic + N, data.begin(), [](std::uint8_t expected, char actual)
+                              { return expected == static_cast<std::uint8_t>(actual); });
+        }
+
+#ifdef GNOTE_HAVE_ZLIB
+        // zlib counts in unsigned int; longer spans are handed over in several rounds.
+        uInt zlibSpan(qsizetype size)
+        {
+            return static_cast<uInt>(std::min<qsizetype>(size, std::numeric_limits<uInt>::max()));
+        }
+#endif
+    } // namespace
+
+    Compression detectCompression(QByteArrayView head)
+    {
+        if (startsWith(head, kGzipMagic))
+        {
+            return Compression::Gzip;
+        }
+        if (startsWith(head, kZstdMagic))
+        {
+            return Compression::Zstd;
+        }
+        return Compression::None;
+    }
+
+    Compression detectFileCompression(const QString& filePath)
+    {
+        QFile file(filePath);
+        if (!file.open(QIODevice::ReadOnly))
+        {
+            return Compression::None;
+        }
+        return detectCompression(file.read(sizeof(kZstdMagic)));
+    }
+
+    Compression compressionForFileName(const QString& filePath)
+    {
+        Compression format = Compression::None;
+        if (filePath.endsWith(QStringLiteral(".gz"), Qt::CaseInsensitive))
+        {
+            format = Compression::Gzip;
+        }
+        else if (filePath.endsWith(QStringLiteral(".zst"), Qt::CaseInsensitive))
+        {
+            format = Compression::Zstd;
+        }
+        return compressionSupported(format) ? format : Compression::None;
+    }
+
+    bool compressionSupported(Compression format)
+    {
+        switch (format)
+        {
+        case Compression::None:
+            return true;
+        case Compression::Gzip:
+#ifdef GNOTE_HAVE_ZLIB
+            return true;
+#else
+            return false;
+#endif
+        case Compression::Zstd:
+#ifdef GNOTE_HAVE_ZSTD
+            return true;
+#else
+            return false;
+#endif
+        }
+        return false;
+    }
+
+    struct StreamDecompressor::State
+    {
+        Compression format{Compression::None};
+        bool ready{false};
+        bool ended{false};
+#ifdef GNOTE_HAVE_ZLIB
+        z_stream zlib{};
+#endif
+#ifdef GNOTE_HAVE_ZSTD
+        ZSTD_DCtx* zstd{nullptr};
+#endif
+    };
+
+    StreamDecompressor::StreamDecompressor(Compression format) : m_state(std::make_unique<State>())
+    {
+        m_state->format = format;
+#ifdef GNOTE_HAVE_ZLIB
+        if (format == Compression::Gzip)
+        {
+            // 16 + MAX_WBITS: expect a gzip header and trailer rather than a raw zlib stream.
+            m_state->ready = inflateInit2(&m_state->zlib, 16 + MAX_WBITS) == Z_OK;
+        }
+#endif
+#ifdef GNOTE_HAVE_ZSTD
+        if (format == Compression::Zstd)
+        {
+            m_state->zstd = ZSTD_createDCtx();
+            m_state->ready = m_state->zstd != nullptr;
+        }
+#endif
+    }
+
+    StreamDecompressor::~StreamDecompressor()
+    {
+#ifdef GNOTE_HAVE_ZLIB
+        if (m_state->format == Compression::Gzip && m_state->ready)
+        {
+            inflateEnd(&m_state->zlib);
+        }
+#endif
+#ifdef GNOTE_HAVE_ZSTD
+        ZSTD_freeDCtx(m_state->zstd);
+#endif
+    }
+
+    bool StreamDecompressor::decompress([[maybe_unused]] QByteArrayView& input, QByteArray& output, qsizetype capacity)
+    {
+        output.resize(capacity);
+        qsizetype produced = 0;
+        bool ok = false;
+
+#ifdef GNOTE_HAVE_ZLIB
+        if (m_state->format == Compression::Gzip && m_state->ready)
+        {
+            z_stream& stream = m_state->zlib;
+            ok = true;
+            while (produced < capacity)
+            {
+                if (m_state->ended)
+                {
+                    // Zero bytes after a complete member are padding, as tape and block devices leave it, and
+                    // gzip -d skips them; a member never starts with one.
+                    const auto padding = std::find_if(input.begin(), input.end(), [](char byte) { return byte != 0; });
+                    input = input.sliced(padding - input.begin());
+                    // Another member follows the one that just ended.
+                    if (input.isEmpty())
+                    {
+                        break;
+                    }
+                    if (inflateReset(&stream) != Z_OK)
+                    {
+                        ok = false;
+                        break;
+                    }
+                    m_state->ended = false;
+                }
+
+                const uInt inputSpan = zlibSpan(input.size());
+                const uInt outputSpan = zlibSpan(capacity - produced);
+                // zlib never writes through next_in; the cast only satisfies its non-const signature.
+                stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+                stream.avail_in = inputSpan;
+                stream.next_out = reinterpret_cast<Bytef*>(output.data() + produced);
+                stream.avail_out = outputSpan;
+                const int result = inflate(&stream, Z_NO_FLUSH);
+                const uInt consumed = inputSpan - stream.avail_in;
+                const uInt written = outputSpan - stream.avail_out;
+                input = input.sliced(consumed);
+                produced += written;
+
+                if (result == Z_STREAM_END)
+                {
+                    m_state->ended = true;
+                    continue;
+                }
+                if (result == Z_BUF_ERROR || (result == Z_OK && consumed == 0 && written == 0))
+                {
+                    // Needs more input than there is; not an error until the caller runs out for good.
+                    break;
+                }
+                if (result != Z_OK)
+                {
+                    ok = false;
+                    break;
+                }
+            }
+        }
+#endif
+#ifdef GNOTE_HAVE_ZSTD
+        if (m_state->format == Compression::Zstd && m_state->ready)
+        {
+            ZSTD_inBuffer source{input.data(), static_cast<std::size_t>(input.size()), 0};
+            ZSTD_outBuffer target{output.data(), static_cast<std::size_t>(capacity), 0};
+            ok = true;
+            while (target.pos < target.size)
+            {
+                const std::size_t consumedBefore = source.pos;
+                const std::size_t writtenBefore = target.pos;
+                const std::size_t result = ZSTD_decompressStream(m_state->zstd, &target, &source);
+                if (ZSTD_isError(result) != 0U)
+                {
+                    ok = false;
+                    break;
+                }
+                // Zero means a frame has been decoded and flushed completely.
+                m_state->ended = result == 0;
+                if (source.pos == consumedBefore && target.pos == writtenBefore)
+                {
+                    break;
+                }
+            }
+            input = input.sliced(static_cast<qsizetype>(source.pos));
+            produced = static_cast<qsizetype>(target.pos);
+        }
+#endif
+
+        output.resize(produced);
+        return ok;
+    }
+
+    bool StreamDecompressor::atEnd() const
+    {
+        return m_state->ended;
+    }
+
+    struct StreamCompressor::State
+    {
+        Compression format{Compression::None};
+        bool ready{false};
+#ifdef GNOTE_HAVE_ZLIB
+        z_stream zlib{};
+#endif
+#ifdef GNOTE_HAVE_ZSTD
+        ZSTD_CCtx* zstd{nullptr};
+#endif
+    };
+
+    StreamCompressor::StreamCompressor(Compression format) : m_state(std::make_unique<State>())
+    {
+        m_state->format = format;
+#ifdef GNOTE_HAVE_ZLIB
+        if (format == Compression::Gzip)
+        {
+            m_state->ready =
+                deflateInit2(&m_state->zlib, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 16 + MAX_WBITS, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+        }
+#endif
+#ifdef GNOTE_HAVE_ZSTD
+        if (format == Compression::Zstd)
+        {
+            m_state->zstd = ZSTD_createCCtx();
+            m_state->ready = m_state->zstd != nullptr;
+        }
+#endif
+    }
+
+    StreamCompressor::~StreamCompressor()
+    {
+#ifdef GNOTE_HAVE_ZLIB
+        if (m_state->format == Compression::Gzip && m_state->ready)
+        {
+            deflateEnd(&m_state->zlib);
+        }
+#endif
+#ifdef GNOTE_HAVE_ZSTD
+        ZSTD_freeCCtx(m_state->zstd);
+#endif
+    }
+
+    bool StreamCompressor::compress([[maybe_unused]] QByteArrayView input, [[maybe_unused]] QByteArray& output)
+    {
+        bool ok = false;
+#ifdef GNOTE_HAVE_ZLIB
+        if (m_state->format == Compression::Gzip && m_state->ready)
+        {
+            z_stream& stream = m_state->zlib;
+            ok = true;
+            while (ok && !input.isEmpty())
+            {
+                const uInt inputSpan = zlibSpan(input.size());
+                stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+                stream.avail_in = inputSpan;
+                // A full output step means deflate may hold more; go round until it leaves room to spare.
+                do
+                {
+                    const qsizetype used = output.size();
+                    output.resize(used + kCompressStepBytes);
+                    stream.next_out = reinterpret_cast<Bytef*>(output.data() + used);
+                    stream.avail_out = static_cast<uInt>(kCompressStepBytes);
+                    ok = deflate(&stream, Z_NO_FLUSH) != Z_STREAM_ERROR;
+                    output.resize(used + kCompressStepBytes - static_cast<qsizetype>(stream.avail_out));
+                } while (ok && stream.avail_out == 0);
+                input = input.sliced(inputSpan - stream.avail_in);
+            }
+        }
+#endif
+#ifdef GNOTE_HAVE_ZSTD
+        if (m_state->format == Compression::Zstd && m_state->ready)
+        {
+            ZSTD_inBuffer source{input.data(), static_cast<std::size_t>(input.size()), 0};
+            ok = true;
+            while (ok && source.pos < source.size)
+            {
+                const qsizetype used = output.size();
+                output.resize(used + kCompressStepBytes);
+                ZSTD_outBuffer target{output.data() + used, static_cast<std::size_t>(kCompressStepBytes), 0};
+                ok = ZSTD_isError(ZSTD_compressStream2(m_state->zstd, &target, &source, ZSTD_e_continue)) == 0U;
+                output.resize(used + static_cast<qsizetype>(target.pos));
+            }
+        }
+#endif
+        return ok;
+    }
+
+    bool StreamCompressor::finish([[maybe_unused]] QByteArray& output)
+    {
+        bool ok = false;
+#ifdef GNOTE_HAVE_ZLIB
+        if (m_state->format == Compression::Gzip && m_state->ready)
+        {
+            z_stream& stream = m_state->zlib;
+            stream.next_in = nullptr;
+            stream.avail_in = 0;
+            int result = Z_OK;
+            while (result == Z_OK || result == Z_BUF_ERROR)
+            {
+                const qsizetype used = output.size();
+                output.resize(used + kCompressStepBytes);
+                stream.next_out = reinterpret_cast<Bytef*>(output.data() + used);
+                stream.avail_out = static_cast<uInt>(kCompressStepBytes);
+                result = deflate(&stream, Z_FINISH);
+                output.resize(used + kCompressStepBytes - static_cast<qsizetype>(stream.avail_out));
+                if (result == Z_BUF_ERROR && stream.avail_out != 0)
+                {
+                    break;
+                }
+            }
+            ok = result == Z_STREAM_END;
+        }
+#endif
+#ifdef GNOTE_HAVE_ZSTD
+        if (m_state->format == Compression::Zstd && m_state->ready)
+        {
+            ZSTD_inBuffer source{nullptr, 0, 0};
+            std::size_t remaining = 1;
+            while (remaining != 0)
+            {
+                const qsizetype used = output.size();
+                output.resize(used + kCompressStepBytes);
+                ZSTD_outBuffer target{output.data() + used, static_cast<std::size_t>(kCompressStepBytes), 0};
+                remaining = ZSTD_compressStream2(m_state->zstd, &target, &source, ZSTD_e_end);
+                output.resize(used + static_cast<qsizetype>(target.pos));
+                if (ZSTD_isError(remaining) != 0U)
+                {
+                    break;
+                }
+            }
+            ok = remaining == 0;
+        }
+#endif
+        return ok;
+    }
+
+} // namespace GnotePad::core
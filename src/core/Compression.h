@@ -0,0 +1,83 @@
+#pragma once
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qbytearrayview.h>
+#include <QtCore/qstring.h>
+#include <QtCore/qtypes.h>
+
+#include <cstdint>
+#include <memory>
+
+namespace GnotePad::core
+{
+
+    enum class Compression : std::uint8_t
+    {
+        None,
+        Gzip,
+        Zstd
+    };
+
+    // Recognises a gzip or zstd container by its magic bytes.
+    [[nodiscard]] Compression detectCompression(QByteArrayView head);
+
+    // Peeks at the first bytes of filePath; None when the file cannot be read.
+    [[nodiscard]] Compression detectFileCompression(const QString& filePath);
+
+    // The container a file name asks for when saving (".gz" or ".zst"), if this build can write it.
+    [[nodiscard]] Compression compressionForFileName(const QString& filePath);
+
+    // Codecs are optional at build time; a format without one can be recognised but not read or written.
+    [[nodiscard]] bool compressionSupported(Compression format);
+
+    // Decompresses a gzip or zstd stream handed over in slices of any size. Each call produces at most the
+    // caller's capacity, so neither the compressed nor the decompressed stream has to be held whole.
+    // Concatenated gzip members and zstd frames read as one stream, the way zcat and zstdcat read them, and zero
+    // padding after a gzip member is skipped as gzip -d skips it.
+    class StreamDecompressor
+    {
+    public:
+        explicit StreamDecompressor(Compression format);
+        ~StreamDecompressor();
+
+        StreamDecompressor(const StreamDecompressor&) = delete;
+        StreamDecompressor& operator=(const StreamDecompressor&) = delete;
+        StreamDecompressor(StreamDecompressor&&) = delete;
+        StreamDecompressor& operator=(StreamDecompressor&&) = delete;
+
+        // Consumes bytes from the front of input and replaces output with up to capacity decompressed bytes.
+        // Call again while input is left or output came back full. Returns false for corrupt data or when
+        // the format has no codec in this build.
+        bool decompress(QByteArrayView& input, QByteArray& output, qsizetype capacity);
+
+        // True when the data seen so far ends on a complete member or frame; false for a truncated stream.
+        [[nodiscard]] bool atEnd() const;
+
+    private:
+        struct State;
+        std::unique_ptr<State> m_state;
+    };
+
+    // Compresses into a gzip member or a zstd frame, appending the output as the codec produces it.
+    class StreamCompressor
+    {
+    public:
+        explicit StreamCompressor(Compression format);
+        ~StreamCompressor();
+
+        StreamCompressor(const StreamCompressor&) = delete;
+        StreamCompressor& operator=(const StreamCompressor&) = delete;
+        StreamCompressor(StreamCompressor&&) = delete;
+        StreamCompressor& operator=(StreamCompressor&&) = delete;
+
+        bool compress(QByteArrayView input, QByteArray& output);
+
+        // Ends the stream, appending whatever the codec still holds and the trailer.
+        bool finish(QByteArray& output);
+
+    private:
+        struct State;
+        std::unique_ptr<State> m_state;
+    };
+
+} // namespace GnotePad::core
@@ -0,0 +1,339 @@
+#include "core/DocumentLoader.h"
+
+#include "core/Compression.h"
+#include "core/InputStreamReader.h"
+#include "core/MappedFile.h"
+#include "core/StreamDecoder.h"
+#include "core/TextEncoding.h"
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qbytearrayview.h>
+#include <QtCore/qsemaphore.h>
+#include <QtCore/qstringliteral.h>
+#include <QtCore/qthread.h>
+#include <QtCore/qtimer.h>
+
+#include <algorithm>
+#include <atomic>
+#include <optional>
+#include <utility>
+
+namespace GnotePad::core
+{
+
+    namespace
+    {
+        constexpr qint64 kFirstChunkBytes = 64LL * 1024;
+        constexpr qint64 kChunkBytes = 1024LL * 1024;
+        constexpr int kMaxChunksInFlight = 2;
+        constexpr int kCreditPollMs = 50;
+        // How long a read waits on a quiet stream before checking for cancellation.
+        constexpr int kStreamPollMs = 50;
+        // Longest byte order mark detectEncoding() knows (UTF-8; the UTF-16 ones are 2).
+        constexpr qsizetype kMaxBomBytes = 3;
+    } // namespace
+
+    struct DocumentLoader::RunState
+    {
+        std::atomic_bool cancelled{false};
+        QSemaphore credits{kMaxChunksInFlight};
+    };
+
+    DocumentLoader::DocumentLoader(QObject* parent) : QObject(parent)
+    {
+    }
+
+    DocumentLoader::~DocumentLoader()
+    {
+        cancel();
+    }
+
+    void DocumentLoader::start(const QString& filePath, qint64 mapThreshold)
+    {
+        cancel();
+
+        auto state = std::make_shared<RunState>();
+        m_activeRun = state;
+        m_thread.reset(QThread::create([this, state, filePath, mapThreshold]() { run(this, state, filePath, mapThreshold); }));
+        m_thread->setObjectName(QStringLiteral("DocumentLoader"));
+        m_thread->start();
+    }
+
+    void DocumentLoader::startStream(qintptr handle)
+    {
+        cancel();
+
+        auto state = std::make_shared<RunState>();
+        m_activeRun = state;
+        m_thread.reset(QThread::create([this, state, handle]() { runStream(this, state, handle); }));
+        m_thread->setObjectName(QStringLiteral("DocumentLoader"));
+        m_thread->start();
+    }
+
+    void DocumentLoader::cancel()
+    {
+        if (m_activeRun)
+        {
+            m_activeRun->cancelled = true;
+            // Wake a worker that is waiting for the GUI to acknowledge a chunk.
+            m_activeRun->credits.release(kMaxChunksInFlight);
+            m_activeRun.reset();
+        }
+        joinWorker();
+    }
+
+    void DocumentLoader::joinWorker()
+    {
+        if (m_thread)
+        {
+            m_thread->wait();
+            m_thread.reset();
+        }
+    }
+
+    void DocumentLoader::run(DocumentLoader* loader, const std::shared_ptr<RunState>& state, const QString& filePath, qint64 mapThreshold)
+    {
+        MappedFile file;
+        if (!file.open(filePath, mapThreshold))
+        {
+            postFinished(loader, state, Status::OpenFailed);
+            return;
+        }
+
+        const QByteArrayView data = file.data();
+        const Compression compression = detectCompression(data);
+        std::optional<StreamDecompressor> decompressor;
+        if (compression != Compression::None)
+        {
+            decompressor.emplace(compression);
+        }
+
+        // Raw bytes come either straight from the file or out of the decompressor, a chunk at a time; the
+        // encoding is sniffed from the first chunk, which is where a byte order mark sits.
+        std::optional<StreamDecoder> decoder;
+        const qint64 total = data.size();
+        QByteArrayView remaining = data;
+        QByteArray decompressed;
+        qint64 chunkBytes = kFirstChunkBytes;
+        while (true)
+        {
+            if (state->cancelled)
+            {
+                return;
+            }
+
+            QByteArrayView raw;
+            if (decompressor)
+            {
+                if (!decompressor->decompress(remaining, decompressed, chunkBytes))
+                {
+                    postFinished(loader, state, Status::DecompressFailed);
+                    return;
+                }
+                if (decompressed.isEmpty() && remaining.isEmpty())
+                {
+                    break;
+                }
+                raw = decompressed;
+            }
+            else
+            {
+                if (remaining.isEmpty())
+                {
+                    break;
+                }
+                raw = remaining.first(std::min(chunkBytes, static_cast<qint64>(remaining.size())));
+                remaining = remaining.sliced(raw.size());
+            }
+            const qint64 offset = total - remaining.size();
+            chunkBytes = kChunkBytes;
+
+            if (!decoder)
+            {
+                int bomLength = 0;
+                const auto encoding = detectEncoding(raw, bomLength);
+                postEncoding(loader, state, encoding, bomLength > 0);
+                decoder.emplace(encoding);
+                raw = raw.sliced(bomLength);
+            }
+
+            QString text = decoder->decode(raw);
+            if (decoder->hasError())
+            {
+                postFinished(loader, state, Status::DecodeFailed);
+                return;
+            }
+            if (!postChunk(loader, state, std::move(text), offset, total))
+            {
+                return;
+            }
+        }
+
+        // A stream cut off mid-member would otherwise pass for a shorter file.
+        if (decompressor && !decompressor->atEnd())
+        {
+            postFinished(loader, state, Status::DecompressFailed);
+            return;
+        }
+        if (!decoder)
+        {
+            postEncoding(loader, state, QStringConverter::Utf8, false);
+            decoder.emplace(QStringConverter::Utf8);
+        }
+
+        if (postChunk(loader, state, decoder->flush(), total, total))
+        {
+            postFinished(loader, state, Status::Completed);
+        }
+    }
+
+    void DocumentLoader::runStream(DocumentLoader* loader, const std::shared_ptr<RunState>& state, qintptr handle)
+    {
+        // One reused read buffer: whatever arrived is decoded and handed over before the next read, so memory
+        // grows with the text in the editor and not with the stream.
+        InputStreamReader reader(handle);
+        QByteArray raw;
+        raw.reserve(kChunkBytes);
+        std::optional<StreamDecoder> decoder;
+        qint64 bytesRead = 0;
+        bool ended = false;
+        while (!ended)
+        {
+            if (state->cancelled)
+            {
+                return;
+            }
+
+            // Only wait on a quiet stream while there is nothing to hand over yet; once bytes are in, gather what
+            // else is ready and deliver, so slow producers still show up promptly. A byte order mark can only be
+            // told apart once enough of the stream is in.
+            const bool needMore = raw.isEmpty() || (!decoder && raw.size() < kMaxBomBytes);
+            const qsizetype before = raw.size();
+            const auto result = reader.read(raw, kChunkBytes, needMore ? kStreamPollMs : 0);
+            bytesRead += raw.size() - before;
+            if (result == InputStreamReader::Result::Failed)
+            {
+                postFinished(loader, state, Status::ReadFailed);
+                return;
+            }
+            ended = result == InputStreamReader::Result::End;
+            if (result == InputStreamReader::Result::Data && raw.size() < kChunkBytes)
+            {
+                continue;
+            }
+            if (raw.isEmpty() || (!decoder && raw.size() < kMaxBomBytes && !ended))
+            {
+                continue;
+            }
+
+            if (!decoder)
+            {
+                int bomLength = 0;
+                const auto encoding = detectEncoding(raw, bomLength);
+                postEncoding(loader, state, encoding, bomLength > 0);
+                decoder.emplace(encoding);
+                raw.remove(0, bomLength);
+            }
+
+            QString text = decoder->decode(raw);
+            raw.resize(0);
+            if (decoder->hasError())
+            {
+                postFinished(loader, state, Status::DecodeFailed);
+                return;
+            }
+            if (!postChunk(loader, state, std::move(text), bytesRead, -1))
+            {
+                return;
+            }
+        }
+
+        if (!decoder)
+        {
+            postEncoding(loader, state, QStringConverter::Utf8, false);
+            decoder.emplace(QStringConverter::Utf8);
+        }
+        if (postChunk(loader, state, decoder->flush(), bytesRead, -1))
+        {
+            postFinished(loader, state, Status::Completed);
+        }
+    }
+
+    bool DocumentLoader::postChunk(
+        DocumentLoader* loader, const std::shared_ptr<RunState>& state, QString text, qint64 bytesProcessed, qint64 bytesTotal)
+    {
+        if (text.isEmpty())
+        {
+            return !state->cancelled;
+        }
+
+        LineIndex::Span lines = LineIndex::scan(text);
+        while (!state->credits.tryAcquire(1, kCreditPollMs))
+        {
+            if (state->cancelled)
+            {
+                return false;
+            }
+        }
+        if (state->cancelled)
+        {
+            return false;
+        }
+
+        QMetaObject::invokeMethod(
+            loader,
+            [loader, state, text = std::move(text), lines = std::move(lines), bytesProcessed, bytesTotal]()
+            { loader->deliverChunk(state, text, lines, bytesProcessed, bytesTotal); },
+            Qt::QueuedConnection);
+        return true;
+    }
+
+    void DocumentLoader::postEncoding(
+        DocumentLoader* loader, const std::shared_ptr<RunState>& state, QStringConverter::Encoding encoding, bool hasBom)
+    {
+        QMetaObject::invokeMethod(
+            loader, [loader, state, encoding, hasBom]() { loader->deliverEncoding(state, encoding, hasBom); }, Qt::QueuedConnection);
+    }
+
+    void DocumentLoader::postFinished(DocumentLoader* loader, const std::shared_ptr<RunState>& state, Status status)
+    {
+        QMetaObject::invokeMethod(loader, [loader, state, status]() { loader->deliverFinished(state, status); }, Qt::QueuedConnection);
+    }
+
+    void DocumentLoader::deliverEncoding(const std::shared_ptr<RunState>& state, QStringConverter::Encoding encoding, bool hasBom)
+    {
+        if (state != m_activeRun)
+        {
+            return;
+        }
+        emit encodingDetected(encoding, hasBom);
+    }
+
+    void DocumentLoader::deliverChunk(
+        const std::shared_ptr<RunState>& state, const QString& text, const LineIndex::Span& lines, qint64 bytesProcessed, qint64 bytesTotal)
+    {
+        if (state != m_activeRun)
+        {
+            return;
+        }
+
+        emit chunkReady(text, lines);
+        emit progressChanged(bytesProcessed, bytesTotal);
+
+        // Hand the credit back from a zero-delay timer so paint and input events get a turn before the next chunk.
+        QTimer::singleShot(0, this, [state]() { state->credits.release(); });
+    }
+
+    void DocumentLoader::deliverFinished(const std::shared_ptr<RunState>& state, Status status)
+    {
+        if (state != m_activeRun)
+        {
+            return;
+        }
+
+        m_activeRun.reset();
+        joinWorker();
+        emit finished(status);
+    }
+
+} // namespace GnotePad::core
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "core/LineIndex.h"
+
+#include <QtCore/qobject.h>
+#include <QtCore/qstring.h>
+#include <QtCore/qstringconverter.h>
+#include <QtCore/qtypes.h>
+
+#include <cstdint>
+#include <memory>
+
+class QThread;
+
+namespace GnotePad::core
+{
+
+    // Reads and decodes a file on a worker thread and hands the text to the GUI thread in chunks. The first
+    // chunk is small so the first screen appears immediately; later chunks are larger. At most a couple of
+    // chunks are in flight at a time and each one is acknowledged from a zero-delay timer, so appending the
+    // text yields to the event loop between batches instead of flooding the posted-event queue. Each chunk
+    // arrives with its line starts, scanned on the worker right after decoding. A gzip or zstd file is
+    // decompressed on the way, one bounded slice at a time, and progress counts the compressed bytes read.
+    // A pipe is read the same way as it fills, with no intermediate buffer beyond the chunk in hand.
+    class DocumentLoader : public QObject
+    {
+        Q_OBJECT
+
+    public:
+        enum class Status : std::uint8_t
+        {
+            Completed,
+            OpenFailed,
+            DecodeFailed,
+            DecompressFailed,
+            ReadFailed
+        };
+        Q_ENUM(Status)
+
+        explicit DocumentLoader(QObject* parent = nullptr);
+        ~DocumentLoader() override;
+
+        DocumentLoader(const DocumentLoader&) = delete;
+        DocumentLoader& operator=(const DocumentLoader&) = delete;
+        DocumentLoader(DocumentLoader&&) = delete;
+        DocumentLoader& operator=(DocumentLoader&&) = delete;
+
+        void start(const QString& filePath, qint64 mapThreshold);
+
+        // Reads a pipe or other stream until its writer closes it, delivering text as it arrives. Progress
+        // reports the bytes read so far against a total of -1.
+        void startStream(qintptr handle);
+
+        // Stops the current load, if any, and waits for the worker to exit. No further signals are emitted for it.
+        void cancel();
+
+        [[nodiscard]] bool isRunning() const
+        {
+            return m_activeRun != nullptr;
+        }
+
+    signals:
+        void encodingDetected(QStringConverter::Encoding encoding, bool hasBom);
+        void chunkReady(const QString& text, const GnotePad::core::LineIndex::Span& lines);
+        void progressChanged(qint64 bytesProcessed, qint64 bytesTotal);
+        void finished(GnotePad::core::DocumentLoader::Status status);
+
+    private:
+        struct RunState;
+
+        static void run(DocumentLoader* loader, const std::shared_ptr<RunState>& state, const QString& filePath, qint64 mapThreshold);
+        static void runStream(DocumentLoader* loader, const std::shared_ptr<RunState>& state, qintptr handle);
+        static void postEncoding(
+            DocumentLoader* loader, const std::shared_ptr<RunState>& state, QStringConverter::Encoding encoding, bool hasBom);
+        static bool postChunk(
+            DocumentLoader* loader, const std::shared_ptr<RunState>& state, QString text, qint64 bytesProcessed, qint64 bytesTotal);
+        static void postFinished(DocumentLoader* loader, const std::shared_ptr<RunState>& state, Status status);
+        void deliverEncoding(const std::shared_ptr<RunState>& state, QStringConverter::Encoding encoding, bool hasBom);
+        void deliverChunk(const std::shared_ptr<RunState>& state,
+                          const QString& text,
+                          const LineIndex::Span& lines,
+                          qint64 bytesProcessed,
+                          qint64 bytesTotal);
+        void deliverFinished(const std::shared_ptr<RunState>& state, Status status);
+        void joinWorker();
+
+        std::shared_ptr<RunState> m_activeRun;
+        std::unique_ptr<QThread> m_thread;
+    };
+
+} // namespace GnotePad::core
@@ -0,0 +1,169 @@
+#include "core/DocumentReader.h"
+
+#include "core/MappedFile.h"
+#include "core/StreamDecoder.h"
+#include "core/TextEncoding.h"
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qbytearrayview.h>
+#include <QtCore/qstringliteral.h>
+
+#include <atomic>
+#include <optional>
+#include <utility>
+
+namespace GnotePad::core
+{
+
+    namespace
+    {
+        constexpr qsizetype kDecompressChunkBytes = 1024LL * 1024;
+    } // namespace
+
+    struct DocumentReader::RunState
+    {
+        std::atomic_bool cancelled{false};
+    };
+
+    DocumentReader::DocumentReader(QObject* parent) : QObject(parent)
+    {
+        m_pool.setObjectName(QStringLiteral("DocumentReader"));
+    }
+
+    DocumentReader::~DocumentReader()
+    {
+        cancel();
+    }
+
+    void DocumentReader::start(const QStringList& filePaths, qint64 mapThreshold)
+    {
+        if (!m_activeRun)
+        {
+            m_activeRun = std::make_shared<RunState>();
+        }
+
+        const auto state = m_activeRun;
+        for (const QString& filePath : filePaths)
+        {
+            ++m_pending;
+            m_pool.start(
+                [this, state, filePath, mapThreshold]()
+                {
+                    if (state->cancelled)
+                    {
+                        return;
+                    }
+                    DecodedDocument document;
+                    const Error error = read(filePath, mapThreshold, document);
+                    QMetaObject::invokeMethod(
+                        this,
+                        [this, state, filePath, error, document = std::move(document)]() { deliver(state, filePath, error, document); },
+                        Qt::QueuedConnection);
+                });
+        }
+    }
+
+    void DocumentReader::cancel()
+    {
+        if (m_activeRun)
+        {
+            m_activeRun->cancelled = true;
+            m_activeRun.reset();
+        }
+        m_pending = 0;
+        m_pool.clear();
+        m_pool.waitForDone();
+    }
+
+    DocumentReader::Error DocumentReader::read(const QString& filePath, qint64 mapThreshold, DecodedDocument& document)
+    {
+        MappedFile file;
+        if (!file.open(filePath, mapThreshold))
+        {
+            return Error::Open;
+        }
+
+        // Decode straight out of the mapping (or read buffer); the raw bytes are never copied into a QByteArray.
+        QByteArrayView remaining = file.data();
+        document.diskBytes = remaining.size();
+        document.compression = detectCompression(remaining);
+        if (document.compression == Compression::None)
+        {
+            int bomLength = 0;
+            document.encoding = detectEncoding(remaining, bomLength);
+            document.hasBom = bomLength > 0;
+            StreamDecoder decoder(document.encoding);
+            document.text = decoder.decode(remaining.sliced(bomLength));
+            document.text.append(decoder.flush());
+            if (decoder.hasError())
+            {
+                return Error::Decode;
+            }
+        }
+        else
+        {
+            StreamDecompressor decompressor(document.compression);
+            std::optional<StreamDecoder> decoder;
+            QByteArray chunk;
+            while (true)
+            {
+                if (!decompressor.decompress(remaining, chunk, kDecompressChunkBytes))
+                {
+                    return Error::Decompress;
+                }
+                if (chunk.isEmpty() && remaining.isEmpty())
+                {
+                    break;
+                }
+
+                QByteArrayView raw = chunk;
+                if (!decoder)
+                {
+                    int bomLength = 0;
+                    document.encoding = detectEncoding(raw, bomLength);
+                    document.hasBom = bomLength > 0;
+                    decoder.emplace(document.encoding);
+                    raw = raw.sliced(bomLength);
+                }
+                document.text.append(decoder->decode(raw));
+            }
+            if (!decompressor.atEnd())
+            {
+                return Error::Decompress;
+            }
+            if (decoder)
+            {
+                document.text.append(decoder->flush());
+                if (decoder->hasError())
+                {
+                    return Error::Decode;
+                }
+            }
+        }
+
+        document.lines = LineIndex::scan(document.text);
+        return Error::None;
+    }
+
+    void DocumentReader::deliver(const std::shared_ptr<RunState>& state, const QString& filePath, Error error, const DecodedDocument& document)
+    {
+        if (state != m_activeRun)
+        {
+            return;
+        }
+
+        if (--m_pending == 0)
+        {
+            m_activeRun.reset();
+        }
+        if (error == Error::None)
+        {
+            emit documentReady(filePath, document);
+        }
+        else
+        {
+            emit documentFailed(filePath, error);
+        }
+    }
+
+} // namespace GnotePad::core
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "core/Compression.h"
+#include "core/LineIndex.h"
+
+#include <QtCore/qobject.h>
+#include <QtCore/qstring.h>
+#include <QtCore/qstringconverter.h>
+#include <QtCore/qstringlist.h>
+#include <QtCore/qthreadpool.h>
+#include <QtCore/qtypes.h>
+
+#include <cstdint>
+#include <memory>
+
+namespace GnotePad::core
+{
+
+    // A whole file decoded in one go, with its line starts already scanned.
+    struct DecodedDocument
+    {
+        QString text;
+        LineIndex::Span lines;
+        QStringConverter::Encoding encoding{QStringConverter::Utf8};
+        bool hasBom{false};
+        Compression compression{Compression::None};
+        qint64 diskBytes{0};
+    };
+
+    // Reads and decodes a batch of files on a thread pool, one task per file, and hands each document to the
+    // GUI thread as soon as it is ready, in whatever order they finish. Opening many files costs about as much
+    // as the largest of them. Meant for files small enough to show in one go; larger ones stream in through
+    // DocumentLoader instead.
+    class DocumentReader : public QObject
+    {
+        Q_OBJECT
+
+    public:
+        enum class Error : std::uint8_t
+        {
+            None,
+            Open,
+            Decode,
+            Decompress
+        };
+        Q_ENUM(Error)
+
+        explicit DocumentReader(QObject* parent = nullptr);
+        ~DocumentReader() override;
+
+        DocumentReader(const DocumentReader&) = delete;
+        DocumentReader& operator=(const DocumentReader&) = delete;
+        DocumentReader(DocumentReader&&) = delete;
+        DocumentReader& operator=(DocumentReader&&) = delete;
+
+        // Queues every file; batches started while another is still running join it.
+        void start(const QStringList& filePaths, qint64 mapThreshold);
+
+        // Drops whatever has not been delivered yet and waits for running tasks to exit.
+        void cancel();
+
+        [[nodiscard]] bool isRunning() const
+        {
+            return m_pending > 0;
+        }
+
+        // Reads, decompresses if need be, and decodes filePath on the calling thread.
+        static Error read(const QString& filePath, qint64 mapThreshold, DecodedDocument& document);
+
+    signals:
+        void documentReady(const QString& filePath, const GnotePad::core::DecodedDocument& document);
+        void documentFailed(const QString& filePath, GnotePad::core::DocumentReader::Error error);
+
+    private:
+        struct RunState;
+
+        void deliver(const std::shared_ptr<RunState>& state, const QString& filePath, Error error, const DecodedDocument& document);
+
+        std::shared_ptr<RunState> m_activeRun;
+        QThreadPool m_pool;
+        int m_pending{0};
+    };
+
+} // namespace GnotePad::core
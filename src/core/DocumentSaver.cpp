@@ -0,0 +1,90 @@
+#include "core/DocumentSaver.h"
+
+#include <QtCore/qstringliteral.h>
+#include <QtCore/qthread.h>
+
+#include <algorithm>
+#include <utility>
+
+namespace GnotePad::core
+{
+
+    struct DocumentSaver::RunState
+    {
+        QString filePath;
+        EncodedFileWriter::Error error{EncodedFileWriter::Error::None};
+    };
+
+    DocumentSaver::DocumentSaver(QObject* parent) : QObject(parent)
+    {
+    }
+
+    DocumentSaver::~DocumentSaver()
+    {
+        // A save is never abandoned half way; let the commit land before the window goes away.
+        m_activeRun.reset();
+        joinWorker();
+    }
+
+    void DocumentSaver::start(
+        const QString& filePath, PieceTable text, QStringConverter::Encoding encoding, bool writeBom, Compression compression)
+    {
+        waitForFinished();
+
+        auto state = std::make_shared<RunState>();
+        state->filePath = filePath;
+        m_activeRun = state;
+        m_thread.reset(QThread::create(
+            [this, state, text = std::move(text), encoding, writeBom, compression]()
+            {
+                EncodedFileWriter writer(state->filePath, encoding, writeBom, compression);
+                if (!writer.open() || !writeText(writer, text) || !writer.commit())
+                {
+                    state->error = writer.error();
+                }
+                QMetaObject::invokeMethod(this, [this, state]() { deliverFinished(state); }, Qt::QueuedConnection);
+            }));
+        m_thread->setObjectName(QStringLiteral("DocumentSaver"));
+        m_thread->start();
+    }
+
+    bool DocumentSaver::writeText(EncodedFileWriter& writer, const PieceTable& text)
+    {
+        // Unchanged spans are encoded straight out of the original buffers they were loaded into.
+        const auto pieces = text.pieces();
+        return std::ranges::all_of(pieces, [&writer](QStringView piece) { return writer.writePlainText(piece); });
+    }
+
+    void DocumentSaver::waitForFinished()
+    {
+        if (m_activeRun)
+        {
+            // The worker has written its result before exiting; the queued delivery it posted becomes stale.
+            const auto state = m_activeRun;
+            joinWorker();
+            deliverFinished(state);
+        }
+    }
+
+    void DocumentSaver::joinWorker()
+    {
+        if (m_thread)
+        {
+            m_thread->wait();
+            m_thread.reset();
+        }
+    }
+
+    void DocumentSaver::deliverFinished(const std::shared_ptr<RunState>& state)
+    {
+        if (state != m_activeRun)
+        {
+            return;
+        }
+
+        m_activeRun.reset();
+        joinWorker();
+        emit finished(state->filePath, state->error);
+    }
+
+} // namespace GnotePad::core
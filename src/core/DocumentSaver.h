@@ -0,0 +1,61 @@
+#pragma once
+
+#include "core/Compression.h"
+#include "core/EncodedFileWriter.h"
+#include "core/PieceTable.h"
+
+#include <QtCore/qobject.h>
+#include <QtCore/qstring.h>
+#include <QtCore/qstringconverter.h>
+
+#include <memory>
+
+class QThread;
+
+namespace GnotePad::core
+{
+
+    // Encodes and commits a snapshot of the document on a worker thread so the editor stays usable while
+    // QSaveFile::commit() waits on slow storage. The caller hands over a piece-table snapshot, which costs
+    // nothing to take and stays immutable while the editor goes on changing; the result comes back on the GUI
+    // thread through finished().
+    class DocumentSaver : public QObject
+    {
+        Q_OBJECT
+
+    public:
+        explicit DocumentSaver(QObject* parent = nullptr);
+        ~DocumentSaver() override;
+
+        DocumentSaver(const DocumentSaver&) = delete;
+        DocumentSaver& operator=(const DocumentSaver&) = delete;
+        DocumentSaver(DocumentSaver&&) = delete;
+        DocumentSaver& operator=(DocumentSaver&&) = delete;
+
+        void start(const QString& filePath, PieceTable text, QStringConverter::Encoding encoding, bool writeBom, Compression compression);
+
+        // Writes every piece of text in plain-text form; shared with synchronous saves.
+        static bool writeText(EncodedFileWriter& writer, const PieceTable& text);
+
+        // Blocks until the running save, if any, has committed, then emits finished() before returning.
+        void waitForFinished();
+
+        [[nodiscard]] bool isRunning() const
+        {
+            return m_activeRun != nullptr;
+        }
+
+    signals:
+        void finished(const QString& filePath, GnotePad::core::EncodedFileWriter::Error error);
+
+    private:
+        struct RunState;
+
+        void deliverFinished(const std::shared_ptr<RunState>& state);
+        void joinWorker();
+
+        std::shared_ptr<RunState> m_activeRun;
+        std::unique_ptr<QThread> m_thread;
+    };
+
+} // namespace GnotePad::core
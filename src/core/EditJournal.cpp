@@ -0,0 +1,430 @@
+#include "core/EditJournal.h"
+
+#include "core/FileSample.h"
+#include "core/StreamDecoder.h"
+#include "core/TextEncoding.h"
+
+#include <QtCore/qchar.h>
+#include <QtCore/qdatastream.h>
+#include <QtCore/qdir.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qfileinfo.h>
+#include <QtCore/qiodevice.h>
+#include <QtCore/qlockfile.h>
+#include <QtCore/qsavefile.h>
+#include <QtCore/qstandardpaths.h>
+#include <QtCore/qstringliteral.h>
+#include <QtCore/qsysinfo.h>
+#include <QtCore/quuid.h>
+
+#include <algorithm>
+#include <atomic>
+#include <utility>
+
+namespace GnotePad::core
+{
+
+    namespace
+    {
+        // Layout: magic, version, one snapshot or file base record, then edit records. Everything is in the host's byte order;
+        // a journal is only ever read back on the machine that wrote it.
+        constexpr quint32 kMagic = 0x474E4A31; // "GNJ1"
+        constexpr quint32 kVersion = 1;
+        constexpr quint8 kSnapshotRecord = 'S';
+        constexpr quint8 kFileBaseRecord = 'F';
+        constexpr quint8 kEditRecord = 'E';
+
+        // Records smaller than this never trigger a compaction, so short documents are not rewritten all the time.
+        constexpr qint64 kMinCompactionBytes = 1024LL * 1024;
+        // Text is streamed in slices so no single raw read or write has to cover a whole document.
+        constexpr qsizetype kRawSliceChars = 64 * 1024;
+
+        void configureStream(QDataStream& stream)
+        {
+            stream.setVersion(QDataStream::Qt_6_0);
+            stream.setByteOrder(QSysInfo::ByteOrder == QSysInfo::BigEndian ? QDataStream::BigEndian : QDataStream::LittleEndian);
+        }
+
+        void writeUtf16(QDataStream& stream, QStringView text)
+        {
+            for (qsizetype from = 0; from < text.size(); from += kRawSliceChars)
+            {
+                const QStringView slice = text.sliced(from, std::min(kRawSliceChars, text.size() - from));
+                stream.writeRawData(reinterpret_cast<const char*>(slice.utf16()), static_cast<int>(slice.size() * 2));
+            }
+        }
+
+        bool readUtf16(QDataStream& stream, QString& text, qint64 length)
+        {
+            text.resize(static_cast<qsizetype>(length));
+            for (qsizetype from = 0; from < text.size(); from += kRawSliceChars)
+            {
+                const auto bytes = static_cast<int>(std::min(kRawSliceChars, text.size() - from) * 2);
+                if (stream.readRawData(reinterpret_cast<char*>(text.data() + from), bytes) != bytes)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        bool writeSnapshot(const QString& filePath, const EditJournal::Metadata& metadata, const PieceTable& text)
+        {
+            QSaveFile file(filePath);
+            if (!file.open(QIODevice::WriteOnly))
+            {
+                return false;
+            }
+
+            QDataStream stream(&file);
+            configureStream(stream);
+            stream << kMagic << kVersion << kSnapshotRecord << static_cast<qint32>(metadata.encoding) << metadata.hasBom
+                   << metadata.documentPath << text.length();
+            for (const QStringView piece : text.pieces())
+            {
+                writeUtf16(stream, piece);
+            }
+            return stream.status() == QDataStream::Ok && file.commit();
+        }
+
+        bool appendRecords(const QString& filePath, const QByteArray& records)
+        {
+            QFile file(filePath);
+            return file.open(QIODevice::WriteOnly | QIODevice::Append) && file.write(records) == records.size();
+        }
+
+        bool replaceRecords(const QString& filePath, const QByteArray& records)
+        {
+            QSaveFile file(filePath);
+            return file.open(QIODevice::WriteOnly) && file.write(records) == records.size() && file.commit();
+        }
+
+        QByteArray fileBaseHeader(const EditJournal::Metadata& metadata, const EditJournal::FileBase& base)
+        {
+            QByteArray header;
+            QDataStream stream(&header, QIODevice::WriteOnly);
+            configureStream(stream);
+            stream << kMagic << kVersion << kFileBaseRecord << static_cast<qint32>(metadata.encoding) << metadata.hasBom
+                   << metadata.documentPath << base.filePath << base.bytes << static_cast<qint32>(base.encoding) << base.hasBom
+                   << base.sample;
+            return header;
+        }
+
+        // Decodes a file base the way a load does, or gives nothing when the file no longer holds those bytes.
+        std::optional<QString> readFileBase(const EditJournal::FileBase& base)
+        {
+            if (base.sample.isEmpty() || sampleFileHash(base.filePath, base.bytes) != base.sample)
+            {
+                return std::nullopt;
+            }
+            QFile file(base.filePath);
+            if (!file.open(QIODevice::ReadOnly))
+            {
+                return std::nullopt;
+            }
+            const QByteArray raw = file.read(base.bytes);
+            const qsizetype bomLength = base.hasBom ? byteOrderMark(base.encoding).size() : 0;
+            if (raw.size() != base.bytes || raw.size() < bomLength)
+            {
+                return std::nullopt;
+            }
+
+            StreamDecoder decoder(base.encoding);
+            QString text = decoder.decode(QByteArrayView(raw).sliced(bomLength));
+            text += decoder.flush();
+            if (decoder.hasError())
+            {
+                return std::nullopt;
+            }
+            // The editor holds a CRLF pair as a single break.
+            text.replace(QStringLiteral("\r\n"), QStringLiteral("\n"));
+            return text;
+        }
+    } // namespace
+
+    struct EditJournal::WriteRun
+    {
+        std::atomic<bool> done{false};
+        bool failed{false};
+    };
+
+    EditJournal::EditJournal()
+    {
+        m_writer.setObjectName(QStringLiteral("EditJournal"));
+        m_writer.setMaxThreadCount(1);
+        m_writer.setExpiryTimeout(-1);
+    }
+
+    EditJournal::~EditJournal()
+    {
+        // The journal itself stays behind: a session that ends without discard() is one to recover from.
+        joinWriter();
+    }
+
+    QString EditJournal::defaultDirectory()
+    {
+        return QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + QStringLiteral("/recovery");
+    }
+
+    bool EditJournal::open(const QString& directory, const Metadata& metadata, const PieceTable& text)
+    {
+        discard();
+        if (!QDir().mkpath(directory))
+        {
+            return false;
+        }
+
+        const QString filePath = QDir(directory).filePath(QUuid::createUuid().toString(QUuid::WithoutBraces) + QStringLiteral(".journal"));
+        auto lock = std::make_unique<QLockFile>(filePath + QStringLiteral(".lock"));
+        if (!lock->tryLock(0))
+        {
+            return false;
+        }
+
+        m_filePath = filePath;
+        m_metadata = metadata;
+        m_lock = std::move(lock);
+        // A file that could not be sampled cannot be checked at recovery, so it cannot stand in for the text.
+        if (!m_base || m_base->sample.isEmpty())
+        {
+            m_snapshotDue = true;
+            flush(text);
+            return true;
+        }
+
+        // The file stands in for the snapshot; the edits gathered against it follow straight away. Compaction
+        // weighs later records against the size of the file's text.
+        m_snapshotBytes = m_base->bytes;
+        m_recordBytes = m_pending.size();
+        startWrite(std::nullopt, fileBaseHeader(m_metadata, *m_base) + std::exchange(m_pending, {}), true);
+        return true;
+    }
+
+    void EditJournal::discard()
+    {
+        joinWriter();
+        m_writeRun.reset();
+        if (!m_filePath.isEmpty())
+        {
+            QFile::remove(m_filePath);
+        }
+        m_lock.reset();
+        m_filePath.clear();
+        m_pending.clear();
+        m_snapshotBytes = 0;
+        m_recordBytes = 0;
+        m_snapshotDue = false;
+        m_base.reset();
+    }
+
+    void EditJournal::rebase(FileBase base)
+    {
+        discard();
+        m_base = std::move(base);
+    }
+
+    void EditJournal::recordEdit(qint64 position, qint64 charsRemoved, QStringView inserted)
+    {
+        // Before a journal is open, edits are only worth keeping while a file base can replay them.
+        if (!isOpen() && !m_base)
+        {
+            return;
+        }
+
+        // Laid out the way QDataStream reads a QString back.
+        QDataStream stream(&m_pending, QIODevice::WriteOnly | QIODevice::Append);
+        configureStream(stream);
+        stream << kEditRecord << position << charsRemoved << static_cast<quint32>(inserted.size() * 2);
+        writeUtf16(stream, inserted);
+    }
+
+    void EditJournal::requestSnapshot()
+    {
+        // The text no longer follows from the file base by the records gathered; the snapshot takes its place.
+        m_snapshotDue = true;
+        m_base.reset();
+        if (!isOpen())
+        {
+            m_pending.clear();
+        }
+    }
+
+    void EditJournal::flush(const PieceTable& text)
+    {
+        if (!isOpen() || writerBusy())
+        {
+            return;
+        }
+
+        joinWriter();
+        // A failed write may have left a torn record behind; start over from a snapshot.
+        if (m_writeRun && m_writeRun->failed)
+        {
+            m_snapshotDue = true;
+        }
+        m_writeRun.reset();
+
+        const qint64 recordBytes = m_recordBytes + m_pending.size();
+        if (m_snapshotDue || recordBytes > std::max(m_snapshotBytes, kMinCompactionBytes))
+        {
+            // The snapshot already contains every gathered edit.
+            m_pending.clear();
+            m_recordBytes = 0;
+            m_snapshotBytes = text.length() * 2;
+            m_snapshotDue = false;
+            startWrite(text, {}, true);
+        }
+        else if (!m_pending.isEmpty())
+        {
+            m_recordBytes = recordBytes;
+            startWrite(std::nullopt, std::exchange(m_pending, {}), false);
+        }
+    }
+
+    void EditJournal::waitForWriter()
+    {
+        joinWriter();
+    }
+
+    QStringList EditJournal::orphanedJournals(const QString& directory)
+    {
+        QStringList orphans;
+        const auto entries = QDir(directory).entryInfoList({QStringLiteral("*.journal")}, QDir::Files, QDir::Time);
+        for (const QFileInfo& entry : entries)
+        {
+            // Only a dead owner makes a lock stale; a long-lived session must not look abandoned.
+            QLockFile lock(entry.absoluteFilePath() + QStringLiteral(".lock"));
+            lock.setStaleLockTime(0);
+            if (lock.tryLock(0))
+            {
+                lock.unlock();
+                orphans << entry.absoluteFilePath();
+            }
+        }
+        return orphans;
+    }
+
+    std::optional<EditJournal::Recovered> EditJournal::read(const QString& journalPath)
+    {
+        QFile file(journalPath);
+        if (!file.open(QIODevice::ReadOnly))
+        {
+            return std::nullopt;
+        }
+
+        QDataStream stream(&file);
+        configureStream(stream);
+        quint32 magic = 0;
+        quint32 version = 0;
+        quint8 type = 0;
+        qint32 encoding = 0;
+        Recovered recovered;
+        stream >> magic >> version >> type >> encoding >> recovered.metadata.hasBom >> recovered.metadata.documentPath;
+        if (stream.status() != QDataStream::Ok || magic != kMagic || version != kVersion)
+        {
+            return std::nullopt;
+        }
+        const auto toEncoding = [](qint32 value)
+        {
+            return value >= 0 && value <= QStringConverter::LastEncoding ? static_cast<QStringConverter::Encoding>(value)
+                                                                          : QStringConverter::Utf8;
+        };
+        recovered.metadata.encoding = toEncoding(encoding);
+
+        QString snapshot;
+        if (type == kSnapshotRecord)
+        {
+            qint64 length = 0;
+            stream >> length;
+            if (stream.status() != QDataStream::Ok || length < 0 || length > (file.size() - file.pos()) / 2 ||
+                !readUtf16(stream, snapshot, length))
+            {
+                return std::nullopt;
+            }
+        }
+        else if (type == kFileBaseRecord)
+        {
+            // A file changed since the journal started from it no longer holds the text the edits apply to.
+            FileBase base;
+            qint32 baseEncoding = 0;
+            stream >> base.filePath >> base.bytes >> baseEncoding >> base.hasBom >> base.sample;
+            base.encoding = toEncoding(baseEncoding);
+            if (stream.status() != QDataStream::Ok || base.bytes < 0)
+            {
+                return std::nullopt;
+            }
+            std::optional<QString> text = readFileBase(base);
+            if (!text)
+            {
+                return std::nullopt;
+            }
+            snapshot = std::move(*text);
+        }
+        else
+        {
+            return std::nullopt;
+        }
+
+        // Edits replay into a piece table, so a long journal over a large snapshot stays cheap to apply. A crash
+        // in the middle of an append leaves a torn last record, which ends the replay.
+        PieceTable text(snapshot);
+        while (true)
+        {
+            quint8 recordType = 0;
+            qint64 position = 0;
+            qint64 charsRemoved = 0;
+            QString inserted;
+            stream >> recordType >> position >> charsRemoved >> inserted;
+            if (stream.status() != QDataStream::Ok || recordType != kEditRecord || position < 0 || charsRemoved < 0 ||
+                position + charsRemoved > text.length())
+            {
+                break;
+            }
+            text.remove(position, charsRemoved);
+            if (!inserted.isEmpty())
+            {
+                text.insert(position, inserted);
+            }
+        }
+
+        // The piece table stores block separators the way the document reports them.
+        recovered.text = text.text();
+        recovered.text.replace(QChar::ParagraphSeparator, QLatin1Char('\n'));
+        return recovered;
+    }
+
+    void EditJournal::remove(const QString& journalPath)
+    {
+        QFile::remove(journalPath);
+    }
+
+    bool EditJournal::writerBusy() const
+    {
+        return m_writeRun && !m_writeRun->done.load(std::memory_order_acquire);
+    }
+
+    void EditJournal::startWrite(std::optional<PieceTable> snapshot, QByteArray records, bool replace)
+    {
+        auto run = std::make_shared<WriteRun>();
+        m_writeRun = run;
+        m_writer.start(
+            [run, filePath = m_filePath, metadata = m_metadata, snapshot = std::move(snapshot), records = std::move(records), replace]()
+            {
+                if (snapshot)
+                {
+                    run->failed = !writeSnapshot(filePath, metadata, *snapshot);
+                }
+                else
+                {
+                    run->failed = !(replace ? replaceRecords(filePath, records) : appendRecords(filePath, records));
+                }
+                run->done.store(true, std::memory_order_release);
+            });
+    }
+
+    void EditJournal::joinWriter()
+    {
+        m_writer.waitForDone();
+    }
+
+} // namespace GnotePad::core
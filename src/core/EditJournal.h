@@ -0,0 +1,134 @@
+#pragma once
+
+#include "core/PieceTable.h"
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qstring.h>
+#include <QtCore/qstringconverter.h>
+#include <QtCore/qstringlist.h>
+#include <QtCore/qstringview.h>
+#include <QtCore/qthreadpool.h>
+#include <QtCore/qtypes.h>
+
+#include <memory>
+#include <optional>
+
+class QLockFile;
+
+namespace GnotePad::core
+{
+
+    // Crash-recovery journal for the unsaved edits of one document. The file starts with the text the edits apply
+    // to and then grows by one record per edit, in piece-table coordinates. While the document is the text of a
+    // file on disk, the journal starts from that file: it notes where the file is and a sample of its bytes
+    // instead of copying the text, so the first edit of a large file costs a few hundred bytes. Otherwise it
+    // starts from a snapshot of the text. Records gather in memory and flush() hands them to a long-lived writer
+    // thread that appends them, so typing never waits on the disk. Once the records written since the start
+    // outgrow it, the next flush writes a fresh snapshot from a piece-table copy instead. A lock file beside the
+    // journal tells a live session's journal from one a crash left behind.
+    class EditJournal
+    {
+    public:
+        struct Metadata
+        {
+            QString documentPath;
+            QStringConverter::Encoding encoding{QStringConverter::Utf8};
+            bool hasBom{false};
+        };
+
+        // A file whose first bytes decode to exactly the text of the document.
+        struct FileBase
+        {
+            QString filePath;
+            qint64 bytes{0};
+            QStringConverter::Encoding encoding{QStringConverter::Utf8};
+            bool hasBom{false};
+            // sampleFileHash() of those bytes; recovery only replays onto a file that still matches it.
+            QByteArray sample;
+        };
+
+        struct Recovered
+        {
+            Metadata metadata;
+            QString text;
+        };
+
+        EditJournal();
+        ~EditJournal();
+
+        EditJournal(const EditJournal&) = delete;
+        EditJournal& operator=(const EditJournal&) = delete;
+        EditJournal(EditJournal&&) = delete;
+        EditJournal& operator=(EditJournal&&) = delete;
+
+        // Where journals live unless a caller picks another directory.
+        [[nodiscard]] static QString defaultDirectory();
+
+        // Starts a new journal in directory. It begins with the file base and the edits recorded since, when
+        // there is one, or else with a snapshot of text that already contains every edit.
+        bool open(const QString& directory, const Metadata& metadata, const PieceTable& text);
+
+        // Deletes the journal once its edits are saved or deliberately thrown away, and forgets the file base.
+        void discard();
+
+        // The document is the text of base again: an open journal is deleted, as there is nothing to recover, and
+        // edits from here on are gathered against base until a journal is opened.
+        void rebase(FileBase base);
+
+        [[nodiscard]] const std::optional<FileBase>& base() const
+        {
+            return m_base;
+        }
+
+        [[nodiscard]] bool isOpen() const
+        {
+            return m_lock != nullptr;
+        }
+
+        [[nodiscard]] const QString& filePath() const
+        {
+            return m_filePath;
+        }
+
+        // Mirrors one change of the document, already applied to the piece table flush() will be handed.
+        void recordEdit(qint64 position, qint64 charsRemoved, QStringView inserted);
+
+        // The document changed in a way the records do not describe, or its file base changed on disk; the file base
+        // is dropped and the next flush writes a snapshot.
+        void requestSnapshot();
+
+        // Hands the gathered records, or a snapshot of text when one is due, to the writer. Returns at once;
+        // while the writer is still busy with the previous batch the records keep gathering.
+        void flush(const PieceTable& text);
+
+        void waitForWriter();
+
+        // Journals in directory that no running session holds, newest first.
+        [[nodiscard]] static QStringList orphanedJournals(const QString& directory);
+
+        // Replays a journal up to its last complete record.
+        [[nodiscard]] static std::optional<Recovered> read(const QString& journalPath);
+
+        static void remove(const QString& journalPath);
+
+    private:
+        struct WriteRun;
+
+        [[nodiscard]] bool writerBusy() const;
+        void startWrite(std::optional<PieceTable> snapshot, QByteArray records, bool replace);
+        void joinWriter();
+
+        QString m_filePath;
+        Metadata m_metadata;
+        std::unique_ptr<QLockFile> m_lock;
+        QByteArray m_pending;
+        qint64 m_snapshotBytes{0};
+        qint64 m_recordBytes{0};
+        bool m_snapshotDue{false};
+        std::optional<FileBase> m_base;
+        std::shared_ptr<WriteRun> m_writeRun;
+        // One thread that stays up for the session; batches queue behind each other in the order flushed.
+        QThreadPool m_writer;
+    };
+
+} // namespace GnotePad::core
@@ -0,0 +1,181 @@
+#include "core/EncodedFileWriter.h"
+
+#include "core/TextEncoding.h"
+
+#include <QtCore/qchar.h>
+#include <QtCore/qiodevice.h>
+
+namespace GnotePad::core
+{
+
+    namespace
+    {
+        // UTF-16 units encoded per write; at most 3 bytes each for UTF-8, so the output buffer stays under 200 KiB.
+        constexpr qsizetype kChunkChars = 64 * 1024;
+    } // namespace
+
+    EncodedFileWriter::EncodedFileWriter(const QString& filePath, QStringConverter::Encoding encoding, bool writeBom, Compression compression)
+        : m_file(filePath), m_encoder(encoding), m_encoding(encoding), m_writeBom(writeBom)
+    {
+        if (compression != Compression::None)
+        {
+            m_compressor = std::make_unique<StreamCompressor>(compression);
+        }
+    }
+
+    bool EncodedFileWriter::open()
+    {
+        if (!m_file.open(QIODevice::WriteOnly))
+        {
+            m_error = Error::Open;
+            return false;
+        }
+
+        m_pending.reserve(kChunkChars);
+        if (m_writeBom)
+        {
+            if (!writeBytes(byteOrderMark(m_encoding)))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool EncodedFileWriter::write(QStringView text)
+    {
+        if (m_error != Error::None)
+        {
+            return false;
+        }
+
+        // Small pieces (a line, a separator) are gathered; anything that would overflow the chunk is encoded
+        // straight from the caller's storage once the gathered text has gone out.
+        if (m_pending.size() + text.size() <= kChunkChars)
+        {
+            m_pending.append(text);
+            return m_pending.size() < kChunkChars || flushPending();
+        }
+
+        if (!flushPending())
+        {
+            return false;
+        }
+        while (text.size() >= kChunkChars)
+        {
+            if (!encodeAndWrite(text.first(kChunkChars)))
+            {
+                return false;
+            }
+            text = text.sliced(kChunkChars);
+        }
+        m_pending.append(text);
+        return true;
+    }
+
+    bool EncodedFileWriter::writePlainText(QStringView text)
+    {
+        qsizetype runStart = 0;
+        for (qsizetype index = 0; index < text.size(); ++index)
+        {
+            char16_t replacement = 0;
+            switch (text[index].unicode())
+            {
+            case u'\r':
+            case 0xfdd0: // QTextBeginningOfFrame
+            case 0xfdd1: // QTextEndOfFrame
+            case QChar::ParagraphSeparator:
+            case QChar::LineSeparator:
+                replacement = u'\n';
+                break;
+            case QChar::Nbsp:
+                replacement = u' ';
+                break;
+            default:
+                continue;
+            }
+
+            if (!write(text.sliced(runStart, index - runStart)) || !write(QStringView(&replacement, 1)))
+            {
+                return false;
+            }
+            runStart = index + 1;
+        }
+        return write(text.sliced(runStart));
+    }
+
+    bool EncodedFileWriter::commit()
+    {
+        if (m_error != Error::None || !flushPending())
+        {
+            return false;
+        }
+        if (m_compressor)
+        {
+            m_compressed.resize(0);
+            if (!m_compressor->finish(m_compressed))
+            {
+                m_error = Error::Compress;
+                return false;
+            }
+            if (m_file.write(m_compressed) != m_compressed.size())
+            {
+                m_error = Error::Write;
+                return false;
+            }
+        }
+        if (!m_file.commit())
+        {
+            m_error = Error::Commit;
+            return false;
+        }
+        return true;
+    }
+
+    bool EncodedFileWriter::flushPending()
+    {
+        if (m_pending.isEmpty())
+        {
+            return true;
+        }
+        const bool written = encodeAndWrite(m_pending);
+        m_pending.resize(0);
+        return written;
+    }
+
+    bool EncodedFileWriter::encodeAndWrite(QStringView text)
+    {
+        m_encoded.resize(m_encoder.requiredSpace(text.size()));
+        char* const end = m_encoder.appendToBuffer(m_encoded.data(), text);
+        if (m_encoder.hasError())
+        {
+            m_error = Error::Encode;
+            return false;
+        }
+
+        return writeBytes(QByteArrayView(m_encoded.constData(), end - m_encoded.constData()));
+    }
+
+    bool EncodedFileWriter::writeBytes(QByteArrayView bytes)
+    {
+        if (m_compressor)
+        {
+            // The compressed buffer is reused; it holds what one encoded chunk compressed into.
+            m_compressed.resize(0);
+            if (!m_compressor->compress(bytes, m_compressed))
+            {
+                m_error = Error::Compress;
+                return false;
+            }
+            bytes = m_compressed;
+        }
+
+        if (m_file.write(bytes.data(), bytes.size()) != bytes.size())
+        {
+            m_error = Error::Write;
+            return false;
+        }
+        return true;
+    }
+
+} // namespace GnotePad::core
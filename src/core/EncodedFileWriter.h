@@ -0,0 +1,68 @@
+#pragma once
+
+#include "core/Compression.h"
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qbytearrayview.h>
+#include <QtCore/qsavefile.h>
+#include <QtCore/qstring.h>
+#include <QtCore/qstringconverter.h>
+#include <QtCore/qstringview.h>
+
+#include <cstdint>
+#include <memory>
+
+namespace GnotePad::core
+{
+
+    // Encodes text into a QSaveFile as it is handed over. Pieces of any size are gathered and encoded in
+    // fixed-size chunks through a reused output buffer, so memory stays bounded by the chunk size rather than
+    // the document size. The byte order mark, if requested, goes out first; the target file is only replaced
+    // when commit() succeeds, and abandoning the writer leaves it untouched. With a compression format the
+    // encoded chunks pass through a streaming compressor on their way to the file.
+    class EncodedFileWriter
+    {
+    public:
+        enum class Error : std::uint8_t
+        {
+            None,
+            Open,
+            Encode,
+            Write,
+            Compress,
+            Commit
+        };
+
+        EncodedFileWriter(const QString& filePath, QStringConverter::Encoding encoding, bool writeBom, Compression compression);
+
+        bool open();
+        bool write(QStringView text);
+
+        // Writes text in document form (one character per QTextDocument position) the way
+        // QTextDocument::toPlainText() renders it: block separators, frame markers and line separators become
+        // '\n' and non-breaking spaces plain spaces. Runs that need no mapping go out straight from the caller.
+        bool writePlainText(QStringView text);
+        bool commit();
+
+        [[nodiscard]] Error error() const
+        {
+            return m_error;
+        }
+
+    private:
+        bool encodeAndWrite(QStringView text);
+        bool flushPending();
+        bool writeBytes(QByteArrayView bytes);
+
+        QSaveFile m_file;
+        QStringEncoder m_encoder;
+        QStringConverter::Encoding m_encoding;
+        bool m_writeBom;
+        QString m_pending;
+        QByteArray m_encoded;
+        std::unique_ptr<StreamCompressor> m_compressor;
+        QByteArray m_compressed;
+        Error m_error{Error::None};
+    };
+
+} // namespace GnotePad::core
@@ -0,0 +1,164 @@
+#include "core/FileFollower.h"
+
+#ifdef Q_OS_UNIX
+#include <sys/stat.h>
+#endif
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qbytearrayview.h>
+#include <QtCore/qchar.h>
+#include <QtCore/qdatetime.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qfileinfo.h>
+#include <QtCore/qiodevice.h>
+#include <QtCore/qsysinfo.h>
+
+#include <algorithm>
+
+namespace GnotePad::core
+{
+
+    namespace
+    {
+        // Upper bound for one poll, so a burst of output is shown in slices instead of stalling the GUI thread.
+        constexpr qint64 kMaxBytesPerPoll = 4LL * 1024 * 1024;
+
+        // Length of the longest prefix of bytes that ends on a whole character and not on a CR.
+        qsizetype wholeCharacterLength(QByteArrayView bytes, QStringConverter::Encoding encoding)
+        {
+            bool bigEndian = QSysInfo::ByteOrder == QSysInfo::BigEndian;
+            qsizetype unitBytes = 1;
+            switch (encoding)
+            {
+            case QStringConverter::Utf16:
+            case QStringConverter::Utf16LE:
+            case QStringConverter::Utf16BE:
+                unitBytes = 2;
+                bigEndian = encoding == QStringConverter::Utf16 ? bigEndian : encoding == QStringConverter::Utf16BE;
+                break;
+            case QStringConverter::Utf32:
+            case QStringConverter::Utf32LE:
+            case QStringConverter::Utf32BE:
+                unitBytes = 4;
+                bigEndian = encoding == QStringConverter::Utf32 ? bigEndian : encoding == QStringConverter::Utf32BE;
+                break;
+            default:
+                break;
+            }
+            const auto unitAt = [&](qsizetype offset)
+            {
+                char32_t unit = 0;
+                for (qsizetype index = 0; index < unitBytes; ++index)
+                {
+                    const auto byte = static_cast<uchar>(bytes[offset + (bigEndian ? index : unitBytes - 1 - index)]);
+                    unit = (unit << 8) | byte;
+                }
+                return unit;
+            };
+
+            qsizetype length = bytes.size() - bytes.size() % unitBytes;
+            if (encoding == QStringConverter::Utf8)
+            {
+                // Back up to the lead byte of the last sequence and keep it only if all of it is here.
+                qsizetype lead = length;
+                while (lead > 0 && lead > length - 4 && (static_cast<uchar>(bytes[lead - 1]) & 0xC0) == 0x80)
+                {
+                    --lead;
+                }
+                if (lead > 0)
+                {
+                    const auto byte = static_cast<uchar>(bytes[lead - 1]);
+                    const qsizetype needed = byte >= 0xF0 ? 4 : byte >= 0xE0 ? 3 : byte >= 0xC0 ? 2 : 1;
+                    length = length - (lead - 1) < needed ? lead - 1 : length;
+                }
+            }
+            else if (unitBytes == 2 && length >= 2 && QChar::isHighSurrogate(unitAt(length - 2)))
+            {
+                length -= 2;
+            }
+            if (length >= unitBytes && unitAt(length - unitBytes) == u'\r')
+            {
+                length -= unitBytes;
+            }
+            return length;
+        }
+    } // namespace
+
+    void FileFollower::start(const QString& filePath, qint64 offset, QStringConverter::Encoding encoding)
+    {
+        m_filePath = filePath;
+        m_offset = offset;
+        m_encoding = encoding;
+        m_identity = identify(filePath).value_or(Identity{});
+        m_decoder.emplace(encoding);
+    }
+
+    void FileFollower::stop()
+    {
+        m_filePath.clear();
+        m_offset = 0;
+        m_identity = {};
+        m_decoder.reset();
+    }
+
+    FileFollower::Status FileFollower::poll(QString& appended)
+    {
+        appended.clear();
+        if (!m_decoder)
+        {
+            return Status::Unchanged;
+        }
+
+        const auto identity = identify(m_filePath);
+        if (!identity)
+        {
+            return Status::Missing;
+        }
+        if (*identity != m_identity)
+        {
+            return Status::Replaced;
+        }
+
+        QFile file(m_filePath);
+        if (!file.open(QIODevice::ReadOnly))
+        {
+            return Status::Missing;
+        }
+        const qint64 size = file.size();
+        if (size < m_offset)
+        {
+            return Status::Truncated;
+        }
+        if (size == m_offset || !file.seek(m_offset))
+        {
+            return Status::Unchanged;
+        }
+
+        const QByteArray bytes = file.read(std::min(size - m_offset, kMaxBytesPerPoll));
+        const qsizetype whole = wholeCharacterLength(bytes, m_encoding);
+        m_offset += whole;
+        appended = m_decoder->decode(QByteArrayView(bytes).first(whole));
+        return appended.isEmpty() ? Status::Unchanged : Status::Appended;
+    }
+
+    std::optional<FileFollower::Identity> FileFollower::identify(const QString& filePath)
+    {
+#ifdef Q_OS_UNIX
+        struct stat info = {};
+        if (::stat(QFile::encodeName(filePath).constData(), &info) != 0)
+        {
+            return std::nullopt;
+        }
+        return Identity{static_cast<quint64>(info.st_dev), static_cast<quint64>(info.st_ino)};
+#else
+        // Without inodes, a file recreated under the same name is recognised by its new creation time.
+        const QFileInfo info(filePath);
+        if (!info.exists())
+        {
+            return std::nullopt;
+        }
+        return Identity{0, static_cast<quint64>(info.birthTime().toMSecsSinceEpoch())};
+#endif
+    }
+
+} // namespace GnotePad::core
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "core/StreamDecoder.h"
+
+#include <QtCore/qstring.h>
+#include <QtCore/qstringconverter.h>
+#include <QtCore/qtypes.h>
+
+#include <cstdint>
+#include <optional>
+
+namespace GnotePad::core
+{
+
+    // Follows a file that grows by appending, the way `tail -f` does. Each poll reads only the bytes past the
+    // last offset and decodes them with a stream decoder, so characters and CRLF pairs split across writes
+    // come out whole. A file that shrank below the offset was truncated in place; one whose identity (device
+    // and inode, or creation time where there are no inodes) changed was replaced, as log rotation does.
+    // The offset only moves past whole characters: an unfinished one, or a trailing CR whose LF may be yet to
+    // come, is read again by the next poll, so following can restart from offset() with a fresh decoder.
+    class FileFollower
+    {
+    public:
+        enum class Status : std::uint8_t
+        {
+            Unchanged,
+            Appended,
+            Truncated,
+            Replaced,
+            Missing
+        };
+
+        // Starts following filePath with the first offset bytes already shown.
+        void start(const QString& filePath, qint64 offset, QStringConverter::Encoding encoding);
+        void stop();
+
+        [[nodiscard]] bool isActive() const
+        {
+            return m_decoder.has_value();
+        }
+
+        // Bytes of the file decoded and handed out so far.
+        [[nodiscard]] qint64 offset() const
+        {
+            return m_offset;
+        }
+
+        // Reads what was appended since the last poll into appended; it stays empty for any other status.
+        [[nodiscard]] Status poll(QString& appended);
+
+    private:
+        struct Identity
+        {
+            quint64 device{0};
+            quint64 file{0};
+
+            bool operator==(const Identity&) const = default;
+        };
+
+        [[nodiscard]] static std::optional<Identity> identify(const QString& filePath);
+
+        QString m_filePath;
+        qint64 m_offset{0};
+        QStringConverter::Encoding m_encoding{QStringConverter::Utf8};
+        Identity m_identity;
+        std::optional<StreamDecoder> m_decoder;
+    };
+
+} // namespace GnotePad::core
@@ -0,0 +1,51 @@
+#include "core/FileSample.h"
+
+#include <QtCore/qcryptographichash.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qiodevice.h>
+
+namespace GnotePad::core
+{
+
+    namespace
+    {
+        constexpr qint64 kSampleBlocks = 8;
+        constexpr qint64 kSampleBlockBytes = 4096;
+    } // namespace
+
+    QByteArray sampleFileHash(const QString& filePath, qint64 length)
+    {
+        QFile file(filePath);
+        if (!file.open(QIODevice::ReadOnly))
+        {
+            return {};
+        }
+        const qint64 size = length >= 0 ? length : file.size();
+        if (size > file.size())
+        {
+            return {};
+        }
+
+        QCryptographicHash hash(QCryptographicHash::Sha256);
+        hash.addData(QByteArrayView(reinterpret_cast<const char*>(&size), sizeof(size)));
+        // A small file is read whole; a larger one in blocks at its start, its end and evenly in between.
+        const qint64 blocks = size <= kSampleBlocks * kSampleBlockBytes ? 1 : kSampleBlocks;
+        const qint64 blockBytes = blocks == 1 ? size : kSampleBlockBytes;
+        for (qint64 index = 0; index < blocks; ++index)
+        {
+            const qint64 offset = blocks == 1 ? 0 : (size - blockBytes) * index / (blocks - 1);
+            if (!file.seek(offset))
+            {
+                return {};
+            }
+            const QByteArray block = file.read(blockBytes);
+            if (block.size() != blockBytes)
+            {
+                return {};
+            }
+            hash.addData(block);
+        }
+        return hash.result();
+    }
+
+} // namespace GnotePad::core
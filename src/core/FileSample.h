@@ -0,0 +1,18 @@
+#pragma once
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qstring.h>
+#include <QtCore/qtypes.h>
+
+namespace GnotePad::core
+{
+
+    // A cheap stand-in for hashing a whole file: the size and a few small blocks spread evenly from its start to
+    // its end are hashed together, so a check costs a handful of reads however large the file is. It catches the
+    // rewrites that keep the size and land within the file system's timestamp resolution, such as a tool that
+    // saves twice a second or restores the old modification time; an edit that misses every block goes unseen.
+    // A length of 0 or more samples only the file's first length bytes. The digest is the same from one run to
+    // the next, so it can be stored; it is empty when the file cannot be read or is shorter than length.
+    [[nodiscard]] QByteArray sampleFileHash(const QString& filePath, qint64 length = -1);
+
+} // namespace GnotePad::core
@@ -0,0 +1,321 @@
+#include "core/FileSearch.h"
+
+#include "core/Compression.h"
+#include "core/MappedFile.h"
+#include "core/StreamDecoder.h"
+#include "core/TextEncoding.h"
+
+#include <QtCore/qdir.h>
+#include <QtCore/qdiriterator.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qstringliteral.h>
+#include <QtCore/qthread.h>
+#include <QtCore/qwaitcondition.h>
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <utility>
+
+namespace GnotePad::core
+{
+
+    namespace
+    {
+        // Small files are cheaper to read than to map; everything else is searched out of the page cache.
+        constexpr qint64 kMapThresholdBytes = 64LL * 1024;
+        constexpr qsizetype kSniffBytes = 8 * 1024;
+        // Bytes decoded between checks for cancellation.
+        constexpr qsizetype kDecodeChunkBytes = 1024LL * 1024;
+        // Characters of one unfinished line held at most; a longer line is searched in pieces as it arrives.
+        constexpr qsizetype kMaxPendingChars = 4 * kDecodeChunkBytes;
+        constexpr qsizetype kMaxPreviewChars = 240;
+        constexpr qsizetype kPreviewContextChars = 40;
+
+        // The same breaks the editor's LineIndex and PieceTable split lines at.
+        constexpr bool isBreak(char16_t unit)
+        {
+            return unit == u'\n' || unit == u'\r' || unit == 0x2029 || unit == 0xFDD0 || unit == 0xFDD1;
+        }
+
+        // Lines ended in [from, until) of text; the LF of a CRLF pair ends nothing.
+        qint64 countBreaks(QStringView text, qsizetype from, qsizetype until)
+        {
+            qint64 count = 0;
+            for (qsizetype index = from; index < until; ++index)
+            {
+                const char16_t unit = text[index].unicode();
+                if (isBreak(unit) && !(unit == u'\n' && index > 0 && text[index - 1] == u'\r'))
+                {
+                    ++count;
+                }
+            }
+            return count;
+        }
+
+        qsizetype nextBreak(QStringView text, qsizetype from)
+        {
+            const auto found = std::find_if(text.begin() + from, text.end(), [](QChar unit) { return isBreak(unit.unicode()); });
+            return found == text.end() ? -1 : found - text.begin();
+        }
+
+        qsizetype previousBreak(QStringView text, qsizetype before)
+        {
+            for (qsizetype index = before - 1; index >= 0; --index)
+            {
+                if (isBreak(text[index].unicode()))
+                {
+                    return index;
+                }
+            }
+            return -1;
+        }
+
+        FileSearch::Hit makeHit(qint64 line, QStringView text, qsizetype column)
+        {
+            const qsizetype from = text.size() > kMaxPreviewChars ? std::max<qsizetype>(0, column - kPreviewContextChars) : 0;
+            return FileSearch::Hit{line, column, text.sliced(from).left(kMaxPreviewChars).trimmed().toString()};
+        }
+    } // namespace
+
+    struct FileSearch::RunState
+    {
+        explicit RunState(const LiteralSearch& literal) : search(literal)
+        {
+        }
+
+        std::atomic_bool cancelled{false};
+        const LiteralSearch search;
+        QMutex mutex;
+        QWaitCondition ready;
+        std::deque<QString> queue;
+        bool walking{true};
+        std::atomic<qint64> searched{0};
+        std::atomic<qint64> matched{0};
+        std::atomic_int workersLeft{0};
+    };
+
+    FileSearch::FileSearch(QObject* parent) : QObject(parent)
+    {
+        m_pool.setObjectName(QStringLiteral("FileSearch"));
+    }
+
+    FileSearch::~FileSearch()
+    {
+        cancel();
+        m_pool.waitForDone();
+    }
+
+    void FileSearch::start(const QString& directory, const QStringList& nameFilters, const LiteralSearch& search, int jobs)
+    {
+        cancel();
+
+        const int workers = jobs > 0 ? jobs : std::max(1, QThread::idealThreadCount());
+        auto state = std::make_shared<RunState>(search);
+        state->workersLeft = workers;
+        m_activeRun = state;
+        // Workers of a cancelled run may still be finishing a chunk; the new run's tasks queue up behind them.
+        m_pool.setMaxThreadCount(workers + 1);
+
+        m_pool.start(
+            [state, directory, nameFilters]()
+            {
+                QDirIterator entries(directory, nameFilters, QDir::Files | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+                while (!state->cancelled && entries.hasNext())
+                {
+                    QString filePath = entries.next();
+                    {
+                        const QMutexLocker locker(&state->mutex);
+                        state->queue.push_back(std::move(filePath));
+                    }
+                    state->ready.wakeOne();
+                }
+                {
+                    const QMutexLocker locker(&state->mutex);
+                    state->walking = false;
+                }
+                state->ready.wakeAll();
+            });
+
+        for (int worker = 0; worker < workers; ++worker)
+        {
+            m_pool.start(
+                [this, state]()
+                {
+                    while (true)
+                    {
+                        QString filePath;
+                        {
+                            QMutexLocker locker(&state->mutex);
+                            while (state->queue.empty() && state->walking && !state->cancelled)
+                            {
+                                state->ready.wait(&state->mutex);
+                            }
+                            if (state->queue.empty() || state->cancelled)
+                            {
+                                break;
+                            }
+                            filePath = std::move(state->queue.front());
+                            state->queue.pop_front();
+                        }
+
+                        QList<Hit> hits = searchFile(filePath, state->search, state->cancelled);
+                        ++state->searched;
+                        if (!hits.isEmpty())
+                        {
+                            ++state->matched;
+                            QMetaObject::invokeMethod(
+                                this,
+                                [this, state, filePath, hits = std::move(hits)]() { deliverHits(state, filePath, hits); },
+                                Qt::QueuedConnection);
+                        }
+                    }
+                    if (--state->workersLeft == 0)
+                    {
+                        QMetaObject::invokeMethod(this, [this, state]() { deliverFinished(state); }, Qt::QueuedConnection);
+                    }
+                });
+        }
+    }
+
+    void FileSearch::cancel()
+    {
+        if (m_activeRun)
+        {
+            const auto state = std::exchange(m_activeRun, nullptr);
+            {
+                const QMutexLocker locker(&state->mutex);
+                state->cancelled = true;
+            }
+            state->ready.wakeAll();
+        }
+        // Tasks that never started are dropped; running ones notice the flag within a chunk.
+        m_pool.clear();
+    }
+
+    QList<FileSearch::Hit> FileSearch::searchFile(const QString& filePath, const LiteralSearch& search, const std::atomic_bool& cancelled)
+    {
+        MappedFile file;
+        if (!file.open(filePath, kMapThresholdBytes))
+        {
+            return {};
+        }
+
+        QByteArrayView bytes = file.data();
+        if (detectCompression(bytes) != Compression::None)
+        {
+            return {};
+        }
+        int bomLength = 0;
+        const QStringConverter::Encoding encoding = detectEncoding(bytes, bomLength);
+        if (bomLength == 0 && looksBinary(bytes.first(std::min(bytes.size(), kSniffBytes))))
+        {
+            return {};
+        }
+        bytes = bytes.sliced(bomLength);
+
+        // Decoded text is searched a chunk at a time, whole lines only; a partial last line waits for the next
+        // chunk. The term cannot contain a line break, so no match is lost at a chunk edge. The decoder holds back
+        // a trailing CR, so a CRLF pair always arrives whole. A line that outgrows kMaxPendingChars without a
+        // break is searched as far as it has come, keeping just enough of its tail for a match that straddles the
+        // cut and for the whole-word check on either side of one.
+        QList<Hit> hits;
+        StreamDecoder decoder(encoding);
+        QString pending;
+        qint64 line = 0;
+        // Characters of the current line searched and dropped from pending, and whether that part had a match.
+        qsizetype lineOffset = 0;
+        bool lineMatched = false;
+        const auto searchLines = [&](bool atEnd)
+        {
+            const qsizetype lastBreak = atEnd ? -1 : previousBreak(pending, pending.size());
+            if (!atEnd && lastBreak < 0)
+            {
+                if (pending.size() <= kMaxPendingChars)
+                {
+                    return;
+                }
+                // A match starting at or before cut has its whole term and the unit after it in pending; later ones wait.
+                const qsizetype cut = pending.size() - search.termLength() - 1;
+                const bool wanted = !lineMatched && hits.size() < MaxHitsPerFile;
+                const qsizetype match = wanted ? search.indexIn(pending, lineOffset > 0 ? 1 : 0) : -1;
+                if (match >= 0 && match <= cut)
+                {
+                    Hit hit = makeHit(line, pending, match);
+                    hit.column += lineOffset;
+                    hits.append(std::move(hit));
+                    lineMatched = true;
+                }
+                pending.remove(0, cut);
+                lineOffset += cut;
+                return;
+            }
+
+            const qsizetype complete = atEnd ? pending.size() : lastBreak + 1;
+            const QStringView text = QStringView(pending).first(complete);
+            // The unit at 0 of a line already cut was searched before and is only kept as context.
+            qsizetype from = lineOffset > 0 ? 1 : 0;
+            if (lineMatched)
+            {
+                const qsizetype end = nextBreak(text, 0);
+                from = end < 0 ? text.size() : end + 1;
+            }
+            qsizetype counted = 0;
+            for (qsizetype match = from < text.size() ? search.indexIn(text, from) : -1; match >= 0 && hits.size() < MaxHitsPerFile;)
+            {
+                line += countBreaks(text, counted, match);
+                const qsizetype lineStart = previousBreak(text, match) + 1;
+                qsizetype lineEnd = nextBreak(text, match);
+                lineEnd = lineEnd < 0 ? text.size() : lineEnd;
+                Hit hit = makeHit(line, text.sliced(lineStart, lineEnd - lineStart), match - lineStart);
+                hit.column += lineStart == 0 ? lineOffset : 0;
+                hits.append(std::move(hit));
+                counted = match;
+                match = lineEnd < text.size() ? search.indexIn(text, lineEnd + 1) : -1;
+            }
+            line += countBreaks(text, counted, text.size());
+            pending.remove(0, complete);
+            lineOffset = 0;
+            lineMatched = false;
+        };
+
+        while (!bytes.isEmpty() && hits.size() < MaxHitsPerFile)
+        {
+            if (cancelled)
+            {
+                return {};
+            }
+            const qsizetype take = std::min(bytes.size(), kDecodeChunkBytes);
+            pending.append(decoder.decode(bytes.first(take)));
+            bytes = bytes.sliced(take);
+            searchLines(false);
+        }
+        pending.append(decoder.flush());
+        searchLines(true);
+        return hits;
+    }
+
+    bool FileSearch::looksBinary(QByteArrayView head)
+    {
+        return !head.isEmpty() && std::memchr(head.data(), 0, static_cast<std::size_t>(head.size())) != nullptr;
+    }
+
+    void FileSearch::deliverHits(const std::shared_ptr<RunState>& state, const QString& filePath, const QList<Hit>& hits)
+    {
+        if (state == m_activeRun)
+        {
+            emit fileMatched(filePath, hits);
+        }
+    }
+
+    void FileSearch::deliverFinished(const std::shared_ptr<RunState>& state)
+    {
+        if (state != m_activeRun)
+        {
+            return;
+        }
+        m_activeRun.reset();
+        emit finished(state->searched, state->matched);
+    }
+
+} // namespace GnotePad::core
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "core/LiteralSearch.h"
+
+#include <QtCore/qbytearrayview.h>
+#include <QtCore/qlist.h>
+#include <QtCore/qobject.h>
+#include <QtCore/qstring.h>
+#include <QtCore/qstringlist.h>
+#include <QtCore/qthreadpool.h>
+#include <QtCore/qtypes.h>
+
+#include <atomic>
+#include <memory>
+
+namespace GnotePad::core
+{
+
+    // Finds the files under a directory that contain a term, for Find in Files. One task walks the tree while
+    // the others take files off a shared queue as they become free, so a few huge logs do not hold up thousands
+    // of small files behind them. Each file is mapped, sniffed for binary content, decoded with the encoding
+    // its byte order mark names, and searched a chunk at a time. Files with hits come back on the GUI thread
+    // through fileMatched() as soon as each one is done.
+    class FileSearch : public QObject
+    {
+        Q_OBJECT
+
+    public:
+        // The first match on a line; line is zero-based and text is the line, shortened around the match if long.
+        struct Hit
+        {
+            qint64 line{0};
+            qsizetype column{0};
+            QString text;
+        };
+
+        explicit FileSearch(QObject* parent = nullptr);
+        ~FileSearch() override;
+
+        FileSearch(const FileSearch&) = delete;
+        FileSearch& operator=(const FileSearch&) = delete;
+        FileSearch(FileSearch&&) = delete;
+        FileSearch& operator=(FileSearch&&) = delete;
+
+        // Searches every file below directory whose name matches one of nameFilters; jobs <= 0 means one per core.
+        void start(const QString& directory, const QStringList& nameFilters, const LiteralSearch& search, int jobs = 0);
+
+        // Returns at once; nothing more from the run is delivered, and its workers stop within one chunk.
+        void cancel();
+
+        [[nodiscard]] bool isRunning() const
+        {
+            return m_activeRun != nullptr;
+        }
+
+        // Hits in filePath, one per matching line and at most MaxHitsPerFile; none for binary or unreadable
+        // files. Safe to call on any thread.
+        [[nodiscard]] static QList<Hit> searchFile(const QString& filePath, const LiteralSearch& search, const std::atomic_bool& cancelled);
+
+        // Whether the first bytes of a file without a byte order mark look like binary data: any NUL byte counts.
+        [[nodiscard]] static bool looksBinary(QByteArrayView head);
+
+        static constexpr qsizetype MaxHitsPerFile = 1000;
+
+    signals:
+        void fileMatched(const QString& filePath, const QList<GnotePad::core::FileSearch::Hit>& hits);
+        void finished(qint64 filesSearched, qint64 filesMatched);
+
+    private:
+        struct RunState;
+
+        void deliverHits(const std::shared_ptr<RunState>& state, const QString& filePath, const QList<Hit>& hits);
+        void deliverFinished(const std::shared_ptr<RunState>& state);
+
+        std::shared_ptr<RunState> m_activeRun;
+        QThreadPool m_pool;
+    };
+
+} // namespace GnotePad::core
@@ -0,0 +1,101 @@
+#include "core/IncrementalSearch.h"
+
+#include <QtCore/qstringliteral.h>
+
+#include <algorithm>
+#include <atomic>
+#include <utility>
+
+namespace GnotePad::core
+{
+
+    struct IncrementalSearch::RunState
+    {
+        std::atomic_bool cancelled{false};
+    };
+
+    IncrementalSearch::IncrementalSearch(QObject* parent) : QObject(parent)
+    {
+        // One run at a time; a superseded one gives way within a slice.
+        m_pool.setMaxThreadCount(1);
+        m_pool.setObjectName(QStringLiteral("IncrementalSearch"));
+    }
+
+    IncrementalSearch::~IncrementalSearch()
+    {
+        cancel();
+        m_pool.waitForDone();
+    }
+
+    void IncrementalSearch::start(SliceSearch search, qint64 begin, qint64 from, qint64 end, bool backward)
+    {
+        cancel();
+
+        auto state = std::make_shared<RunState>();
+        m_activeRun = state;
+        m_pool.start(
+            [this, state, search = std::move(search), begin, from, end, backward]()
+            {
+                const auto scan = [&](qint64 first, qint64 last) -> qint64
+                {
+                    if (backward)
+                    {
+                        for (qint64 slice = last; slice > first && !state->cancelled; slice -= SliceUnits)
+                        {
+                            const qint64 match = search(std::max(first, slice - SliceUnits), slice);
+                            if (match >= 0)
+                            {
+                                return match;
+                            }
+                        }
+                        return -1;
+                    }
+                    for (qint64 slice = first; slice < last && !state->cancelled; slice += SliceUnits)
+                    {
+                        const qint64 match = search(slice, std::min(last, slice + SliceUnits));
+                        if (match >= 0)
+                        {
+                            return match;
+                        }
+                    }
+                    return -1;
+                };
+
+                qint64 match = backward ? scan(begin, from) : scan(from, end);
+                if (match < 0)
+                {
+                    match = backward ? scan(from, end) : scan(begin, from);
+                }
+                if (!state->cancelled)
+                {
+                    QMetaObject::invokeMethod(this, [this, state, match]() { deliver(state, match); }, Qt::QueuedConnection);
+                }
+            });
+    }
+
+    void IncrementalSearch::cancel()
+    {
+        if (m_activeRun)
+        {
+            std::exchange(m_activeRun, nullptr)->cancelled = true;
+        }
+        // A run still waiting for the thread never starts.
+        m_pool.clear();
+    }
+
+    void IncrementalSearch::waitForDone()
+    {
+        m_pool.waitForDone();
+    }
+
+    void IncrementalSearch::deliver(const std::shared_ptr<RunState>& state, qint64 position)
+    {
+        if (state != m_activeRun)
+        {
+            return;
+        }
+        m_activeRun.reset();
+        emit finished(position);
+    }
+
+} // namespace GnotePad::core
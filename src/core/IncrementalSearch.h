@@ -0,0 +1,66 @@
+#pragma once
+
+#include <QtCore/qobject.h>
+#include <QtCore/qthreadpool.h>
+#include <QtCore/qtypes.h>
+
+#include <functional>
+#include <memory>
+
+namespace GnotePad::core
+{
+
+    // Runs the search behind find-as-you-type off the GUI thread. Each start() supersedes the run before it:
+    // the old run is flagged and stops at its next slice, and whatever it finds is never delivered, so a burst
+    // of keystrokes costs one slice per stale term rather than one whole-document pass each. The text is
+    // searched in slices of SliceUnits so a cancelled run lets go quickly even in a document of hundreds of
+    // megabytes. The outcome comes back on the GUI thread through a queued call.
+    class IncrementalSearch : public QObject
+    {
+        Q_OBJECT
+
+    public:
+        // First match starting in [from, until), or the last one when the run goes backward, or -1; called on the
+        // worker thread. A match may run past until.
+        using SliceSearch = std::function<qint64(qint64 from, qint64 until)>;
+
+        explicit IncrementalSearch(QObject* parent = nullptr);
+        ~IncrementalSearch() override;
+
+        IncrementalSearch(const IncrementalSearch&) = delete;
+        IncrementalSearch& operator=(const IncrementalSearch&) = delete;
+        IncrementalSearch(IncrementalSearch&&) = delete;
+        IncrementalSearch& operator=(IncrementalSearch&&) = delete;
+
+        // Looks for the first match in [from, end), then wraps round to [begin, from). Backward it looks for the
+        // last match in [begin, from) first, slices taken from the back, then wraps round to [from, end). Whatever
+        // search reads must stay alive and unchanged until the run is finished or waitForDone() returns.
+        void start(SliceSearch search, qint64 begin, qint64 from, qint64 end, bool backward = false);
+
+        // Returns at once; nothing more from the current run is delivered.
+        void cancel();
+
+        // Blocks until no run is left reading its text, for owners about to free it.
+        void waitForDone();
+
+        [[nodiscard]] bool isRunning() const
+        {
+            return m_activeRun != nullptr;
+        }
+
+        static constexpr qint64 SliceUnits = 4LL * 1024 * 1024;
+
+    signals:
+        // position is -1 when nothing matched anywhere.
+        void finished(qint64 position);
+
+    private:
+        struct RunState;
+
+        void deliver(const std::shared_ptr<RunState>& state, qint64 position);
+
+        std::shared_ptr<RunState> m_activeRun;
+        QThreadPool m_pool;
+    };
+
+} // namespace GnotePad::core
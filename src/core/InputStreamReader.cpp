@@ -0,0 +1,101 @@
+#include "core/InputStreamReader.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <poll.h>
+#include <unistd.h>
+
+#include <cerrno>
+#endif
+
+#include <algorithm>
+
+namespace GnotePad::core
+{
+
+    InputStreamReader::InputStreamReader(qintptr handle) : m_handle(handle)
+    {
+    }
+
+    qintptr InputStreamReader::standardInputHandle()
+    {
+#ifdef _WIN32
+        return reinterpret_cast<qintptr>(GetStdHandle(STD_INPUT_HANDLE));
+#else
+        return STDIN_FILENO;
+#endif
+    }
+
+    InputStreamReader::Result InputStreamReader::read(QByteArray& buffer, qsizetype capacity, int timeoutMs)
+    {
+        const qsizetype used = buffer.size();
+        const qsizetype room = capacity - used;
+        if (room <= 0)
+        {
+            return Result::Data;
+        }
+
+#ifdef _WIN32
+        const auto handle = reinterpret_cast<HANDLE>(m_handle);
+        if (handle == nullptr || handle == INVALID_HANDLE_VALUE)
+        {
+            return Result::Failed;
+        }
+
+        // Only pipes can be asked how much is waiting; files and consoles are read directly.
+        DWORD toRead = static_cast<DWORD>(std::min<qsizetype>(room, MAXDWORD));
+        if (GetFileType(handle) == FILE_TYPE_PIPE)
+        {
+            DWORD available = 0;
+            if (PeekNamedPipe(handle, nullptr, 0, nullptr, &available, nullptr) == 0)
+            {
+                return GetLastError() == ERROR_BROKEN_PIPE ? Result::End : Result::Failed;
+            }
+            if (available == 0)
+            {
+                Sleep(static_cast<DWORD>(std::max(timeoutMs, 0)));
+                return Result::Idle;
+            }
+            toRead = std::min(toRead, available);
+        }
+
+        buffer.resize(used + toRead);
+        DWORD bytesRead = 0;
+        const BOOL ok = ReadFile(handle, buffer.data() + used, toRead, &bytesRead, nullptr);
+        buffer.resize(used + static_cast<qsizetype>(bytesRead));
+        if (ok == 0)
+        {
+            return GetLastError() == ERROR_BROKEN_PIPE ? Result::End : Result::Failed;
+        }
+        return bytesRead == 0 ? Result::End : Result::Data;
+#else
+        const auto descriptor = static_cast<int>(m_handle);
+        pollfd request{descriptor, POLLIN, 0};
+        const int ready = ::poll(&request, 1, timeoutMs);
+        if (ready == 0 || (ready < 0 && errno == EINTR))
+        {
+            return Result::Idle;
+        }
+        if (ready < 0)
+        {
+            return Result::Failed;
+        }
+
+        buffer.resize(capacity);
+        const ssize_t bytesRead = ::read(descriptor, buffer.data() + used, static_cast<std::size_t>(room));
+        const int readError = errno;
+        buffer.resize(used + std::max<qsizetype>(bytesRead, 0));
+        if (bytesRead > 0)
+        {
+            return Result::Data;
+        }
+        if (bytesRead == 0)
+        {
+            return Result::End;
+        }
+        return readError == EINTR || readError == EAGAIN ? Result::Idle : Result::Failed;
+#endif
+    }
+
+} // namespace GnotePad::core
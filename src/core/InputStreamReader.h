@@ -0,0 +1,37 @@
+#pragma once
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qtypes.h>
+
+#include <cstdint>
+
+namespace GnotePad::core
+{
+
+    // Reads an inherited pipe, terminal or redirected file as it fills, without ever blocking for longer than
+    // the caller allows, so a worker reading a stream that goes quiet can still notice it has been cancelled.
+    // The handle is a file descriptor on Unix and a HANDLE on Windows; it is borrowed, never closed.
+    class InputStreamReader
+    {
+    public:
+        enum class Result : std::uint8_t
+        {
+            Data,
+            Idle,
+            End,
+            Failed
+        };
+
+        explicit InputStreamReader(qintptr handle);
+
+        [[nodiscard]] static qintptr standardInputHandle();
+
+        // Waits up to timeoutMs for input, then appends whatever is ready to buffer without letting it grow
+        // past capacity bytes. Idle means nothing arrived in time; End means the writer closed its side.
+        Result read(QByteArray& buffer, qsizetype capacity, int timeoutMs);
+
+    private:
+        qintptr m_handle;
+    };
+
+} // namespace GnotePad::core
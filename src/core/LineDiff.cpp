@@ -0,0 +1,164 @@
+#include "core/LineDiff.h"
+
+#include "core/LineIndex.h"
+
+#include <QtCore/qhashfunctions.h>
+
+#include <algorithm>
+#include <iterator>
+#include <optional>
+#include <utility>
+
+namespace GnotePad::core
+{
+
+    namespace
+    {
+        // A run of lines equal on both sides, starting at oldStart and oldStart - diagonal.
+        struct Snake
+        {
+            qint64 oldStart{0};
+            qint64 newStart{0};
+            qint64 length{0};
+        };
+
+        // Greedy forward Myers search over a[0, n) and b[0, m). Each round d keeps the furthest x reached on
+        // every diagonal k = x - y; the rounds are kept so the path can be walked back into its snakes.
+        std::optional<std::vector<Snake>> shortestEditPath(const std::size_t* a, qint64 n, const std::size_t* b, qint64 m, qint64 maxEdits)
+        {
+            const qint64 maxD = std::min(n + m, maxEdits);
+            const qint64 offset = maxD + 1;
+            std::vector<qint64> furthest(static_cast<std::size_t>((2 * maxD) + 3), 0);
+            std::vector<std::vector<qint64>> rounds;
+
+            for (qint64 d = 0; d <= maxD; ++d)
+            {
+                // Round d reads diagonals -d - 1 through d + 1 of the previous round.
+                const auto first = furthest.begin() + static_cast<std::ptrdiff_t>(offset - d - 1);
+                rounds.emplace_back(first, first + static_cast<std::ptrdiff_t>((2 * d) + 3));
+
+                for (qint64 k = -d; k <= d; k += 2)
+                {
+                    const qint64 below = furthest[static_cast<std::size_t>(offset + k - 1)];
+                    const qint64 above = furthest[static_cast<std::size_t>(offset + k + 1)];
+                    qint64 x = (k == -d || (k != d && below < above)) ? above : below + 1;
+                    qint64 y = x - k;
+                    while (x < n && y < m && a[x] == b[y])
+                    {
+                        ++x;
+                        ++y;
+                    }
+                    furthest[static_cast<std::size_t>(offset + k)] = x;
+
+                    if (x < n || y < m)
+                    {
+                        continue;
+                    }
+
+                    std::vector<Snake> snakes;
+                    for (qint64 round = d; round >= 0; --round)
+                    {
+                        const auto& previous = rounds[static_cast<std::size_t>(round)];
+                        const auto at = [&previous, round](qint64 diagonal)
+                        { return previous[static_cast<std::size_t>(diagonal + round + 1)]; };
+
+                        const qint64 diagonal = x - y;
+                        const bool down = diagonal == -round || (diagonal != round && at(diagonal - 1) < at(diagonal + 1));
+                        const qint64 previousDiagonal = down ? diagonal + 1 : diagonal - 1;
+                        const qint64 previousX = at(previousDiagonal);
+                        const qint64 snakeStart = round == 0 ? 0 : (down ? previousX : previousX + 1);
+                        if (x > snakeStart)
+                        {
+                            snakes.push_back({snakeStart, snakeStart - diagonal, x - snakeStart});
+                        }
+                        x = previousX;
+                        y = previousX - previousDiagonal;
+                    }
+                    std::ranges::reverse(snakes);
+                    return snakes;
+                }
+            }
+            return std::nullopt;
+        }
+    } // namespace
+
+    void LineDiff::Hasher::add(QStringView text)
+    {
+        const LineIndex::Span span = LineIndex::scan(text);
+        qsizetype from = 0;
+        for (const qint64 lineStart : span.lineStarts)
+        {
+            const QStringView line = text.sliced(from, static_cast<qsizetype>(lineStart) - from);
+            if (m_carry.isEmpty())
+            {
+                m_hashes.push_back(qHash(line));
+            }
+            else
+            {
+                m_carry.append(line);
+                m_hashes.push_back(qHash(QStringView(m_carry)));
+                m_carry.clear();
+            }
+            from = static_cast<qsizetype>(lineStart);
+        }
+        m_carry.append(text.sliced(from));
+    }
+
+    std::vector<std::size_t> LineDiff::Hasher::finish()
+    {
+        m_hashes.push_back(qHash(QStringView(m_carry)));
+        m_carry.clear();
+        return std::exchange(m_hashes, {});
+    }
+
+    std::vector<LineDiff::Hunk> LineDiff::compute(const std::vector<std::size_t>& oldLines, const std::vector<std::size_t>& newLines,
+                                                  qint64 maxEdits)
+    {
+        const auto oldCount = static_cast<qint64>(oldLines.size());
+        const auto newCount = static_cast<qint64>(newLines.size());
+
+        const auto [oldMismatch, newMismatch] = std::ranges::mismatch(oldLines, newLines);
+        const auto prefix = static_cast<qint64>(std::distance(oldLines.begin(), oldMismatch));
+        qint64 suffix = 0;
+        while (suffix < oldCount - prefix && suffix < newCount - prefix &&
+               oldLines[static_cast<std::size_t>(oldCount - 1 - suffix)] == newLines[static_cast<std::size_t>(newCount - 1 - suffix)])
+        {
+            ++suffix;
+        }
+
+        const qint64 oldMiddle = oldCount - prefix - suffix;
+        const qint64 newMiddle = newCount - prefix - suffix;
+        if (oldMiddle == 0 && newMiddle == 0)
+        {
+            return {};
+        }
+
+        const auto snakes = oldMiddle == 0 || newMiddle == 0
+                                ? std::optional<std::vector<Snake>>{std::vector<Snake>{}}
+                                : shortestEditPath(oldLines.data() + prefix, oldMiddle, newLines.data() + prefix, newMiddle, maxEdits);
+        if (!snakes)
+        {
+            return {Hunk{prefix, oldMiddle, prefix, newMiddle}};
+        }
+
+        std::vector<Hunk> hunks;
+        qint64 oldNext = 0;
+        qint64 newNext = 0;
+        const auto emitGap = [&](qint64 oldEnd, qint64 newEnd)
+        {
+            if (oldEnd > oldNext || newEnd > newNext)
+            {
+                hunks.push_back({prefix + oldNext, oldEnd - oldNext, prefix + newNext, newEnd - newNext});
+            }
+        };
+        for (const Snake& snake : *snakes)
+        {
+            emitGap(snake.oldStart, snake.newStart);
+            oldNext = snake.oldStart + snake.length;
+            newNext = snake.newStart + snake.length;
+        }
+        emitGap(oldMiddle, newMiddle);
+        return hunks;
+    }
+
+} // namespace GnotePad::core
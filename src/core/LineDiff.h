@@ -0,0 +1,51 @@
+#pragma once
+
+#include <QtCore/qstring.h>
+#include <QtCore/qstringview.h>
+#include <QtCore/qtypes.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace GnotePad::core
+{
+
+    // Line-level diff between two texts, computed over one hash per line. Lines carry their terminator, so two
+    // texts whose lines all hash equal are equal character for character (up to hash collisions), and every
+    // hunk maps to one contiguous character range on either side. Common leading and trailing lines are
+    // trimmed before Myers' O(ND) search runs on what is left, so a few changed lines in a huge file cost a
+    // pass over the hashes plus work proportional to the change.
+    class LineDiff
+    {
+    public:
+        // Old lines [oldStart, oldStart + oldCount) become new lines [newStart, newStart + newCount).
+        struct Hunk
+        {
+            qint64 oldStart{0};
+            qint64 oldCount{0};
+            qint64 newStart{0};
+            qint64 newCount{0};
+        };
+
+        // Hashes the lines of a text handed over in pieces; a line may span any number of pieces. Breaks are the
+        // ones LineIndex::scan() recognises, so the hashes line up with a LineIndex of the same text. The text
+        // must hold one character per document position (CRLF pairs already collapsed). The last line (possibly
+        // empty) has no terminator, so there is always at least one hash.
+        class Hasher
+        {
+        public:
+            void add(QStringView text);
+            [[nodiscard]] std::vector<std::size_t> finish();
+
+        private:
+            std::vector<std::size_t> m_hashes;
+            QString m_carry;
+        };
+
+        // Hunks in ascending order. When more than maxEdits lines would have to be inserted or removed the search
+        // gives up and returns a single hunk covering everything between the common leading and trailing lines.
+        [[nodiscard]] static std::vector<Hunk> compute(const std::vector<std::size_t>& oldLines, const std::vector<std::size_t>& newLines,
+                                                       qint64 maxEdits);
+    };
+
+} // namespace GnotePad::core
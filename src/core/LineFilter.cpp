@@ -0,0 +1,186 @@
+#include "core/LineFilter.h"
+
+#include "core/LiteralSearch.h"
+#include "core/RegexSearch.h"
+
+#include <QtCore/qstring.h>
+#include <QtCore/qstringliteral.h>
+#include <QtCore/qthread.h>
+
+#include <algorithm>
+#include <atomic>
+#include <utility>
+
+namespace GnotePad::core
+{
+
+    namespace
+    {
+        // Lines tested between checks for a newer filter.
+        constexpr qint64 kCancelCheckLines = 4096;
+
+        constexpr bool isBreak(char16_t unit)
+        {
+            return unit == u'\n' || unit == u'\r' || unit == 0x2029 || unit == 0xFDD0 || unit == 0xFDD1;
+        }
+    } // namespace
+
+    struct LineFilter::RunState
+    {
+        RunState(PieceTable snapshot, int taskCount)
+            : text(std::move(snapshot)), parts(static_cast<std::size_t>(taskCount)), tasksLeft(taskCount)
+        {
+        }
+
+        std::atomic_bool cancelled{false};
+        const PieceTable text;
+        // Each task's hidden lines, in order; joined when the last task is done.
+        std::vector<std::vector<qint64>> parts;
+        std::atomic_int tasksLeft;
+    };
+
+    LineFilter::Predicate LineFilter::literalPredicate(const LiteralSearch& search)
+    {
+        return [search](QStringView line) { return search.indexIn(line) >= 0; };
+    }
+
+    LineFilter::Predicate LineFilter::regexPredicate(const QRegularExpression& expression)
+    {
+        return [expression](QStringView line) { return RegexSearch::globalMatch(expression, line).hasNext(); };
+    }
+
+    LineFilter::LineFilter(QObject* parent) : QObject(parent)
+    {
+        m_pool.setObjectName(QStringLiteral("LineFilter"));
+    }
+
+    LineFilter::~LineFilter()
+    {
+        cancel();
+        m_pool.waitForDone();
+    }
+
+    void LineFilter::start(Predicate predicate, PieceTable text, bool invert, int jobs)
+    {
+        cancel();
+
+        const qint64 lineCount = text.lineCount();
+        const int tasks = static_cast<int>(std::clamp<qint64>(jobs > 0 ? jobs : QThread::idealThreadCount(), 1, lineCount));
+        auto state = std::make_shared<RunState>(std::move(text), tasks);
+        m_activeRun = state;
+        // Tasks of a cancelled filter may still be finishing a stretch; the new filter's tasks queue up behind them.
+        m_pool.setMaxThreadCount(tasks);
+
+        for (int task = 0; task < tasks; ++task)
+        {
+            m_pool.start(
+                [this, state, predicate, invert, task, tasks, lineCount]()
+                {
+                    // Each task takes an equal share of the lines and reads them where they lie in the pieces; only
+                    // a line that straddles two pieces is copied.
+                    const qint64 firstLine = lineCount * task / tasks;
+                    const qint64 endLine = lineCount * (task + 1) / tasks;
+                    const qint64 from = state->text.lineStart(firstLine);
+                    const qint64 until = endLine < lineCount ? state->text.lineStart(endLine) : state->text.length();
+                    std::vector<qint64>& hidden = state->parts[static_cast<std::size_t>(task)];
+
+                    qint64 line = firstLine;
+                    const auto test = [&](QStringView content)
+                    {
+                        if (predicate(content) == invert)
+                        {
+                            hidden.push_back(line);
+                        }
+                        ++line;
+                    };
+
+                    QString carried;
+                    qint64 pieceStart = 0;
+                    for (const QStringView piece : state->text.pieces())
+                    {
+                        const qint64 pieceEnd = pieceStart + piece.size();
+                        if (pieceEnd <= from)
+                        {
+                            pieceStart = pieceEnd;
+                            continue;
+                        }
+                        if (pieceStart >= until)
+                        {
+                            break;
+                        }
+                        const auto begin = static_cast<qsizetype>(std::max(from, pieceStart) - pieceStart);
+                        const auto end = static_cast<qsizetype>(std::min(until, pieceEnd) - pieceStart);
+                        qsizetype segmentBegin = begin;
+                        for (qsizetype index = begin; index < end; ++index)
+                        {
+                            if (!isBreak(piece[index].unicode()))
+                            {
+                                continue;
+                            }
+                            const QStringView segment = piece.sliced(segmentBegin, index - segmentBegin);
+                            if (carried.isEmpty())
+                            {
+                                test(segment);
+                            }
+                            else
+                            {
+                                carried.append(segment);
+                                test(carried);
+                                carried.clear();
+                            }
+                            segmentBegin = index + 1;
+                            if ((line - firstLine) % kCancelCheckLines == 0 && state->cancelled)
+                            {
+                                return;
+                            }
+                        }
+                        carried.append(piece.sliced(segmentBegin, end - segmentBegin));
+                        pieceStart = pieceEnd;
+                    }
+                    // Only the document's last line runs to the end of a share without a break.
+                    if (line < endLine)
+                    {
+                        test(carried);
+                    }
+
+                    if (--state->tasksLeft == 0 && !state->cancelled)
+                    {
+                        QMetaObject::invokeMethod(this, [this, state]() { deliver(state); }, Qt::QueuedConnection);
+                    }
+                });
+        }
+    }
+
+    void LineFilter::cancel()
+    {
+        if (m_activeRun)
+        {
+            std::exchange(m_activeRun, nullptr)->cancelled = true;
+        }
+        // Tasks that never started are dropped; running ones notice the flag within a few thousand lines.
+        m_pool.clear();
+    }
+
+    void LineFilter::deliver(const std::shared_ptr<RunState>& state)
+    {
+        if (state != m_activeRun)
+        {
+            return;
+        }
+        m_activeRun.reset();
+
+        std::size_t total = 0;
+        for (const std::vector<qint64>& part : state->parts)
+        {
+            total += part.size();
+        }
+        m_hiddenLines.clear();
+        m_hiddenLines.reserve(total);
+        for (const std::vector<qint64>& part : state->parts)
+        {
+            m_hiddenLines.insert(m_hiddenLines.end(), part.begin(), part.end());
+        }
+        emit finished(state->text.lineCount(), static_cast<qint64>(m_hiddenLines.size()));
+    }
+
+} // namespace GnotePad::core
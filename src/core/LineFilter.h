@@ -0,0 +1,73 @@
+#pragma once
+
+#include "core/PieceTable.h"
+
+#include <QtCore/qobject.h>
+#include <QtCore/qregularexpression.h>
+#include <QtCore/qstringview.h>
+#include <QtCore/qthreadpool.h>
+#include <QtCore/qtypes.h>
+
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace GnotePad::core
+{
+
+    class LiteralSearch;
+
+    // Decides which lines of a document a filtered view leaves out. The lines are cut into one equal share per
+    // task and tested in parallel over a piece-table snapshot; the result is the sorted list of lines to hide,
+    // so a view can hide exactly those and later show exactly those again without testing anything.
+    class LineFilter : public QObject
+    {
+        Q_OBJECT
+
+    public:
+        // Whether a line matches. Lines never include their break; predicates run on several threads at once.
+        using Predicate = std::function<bool(QStringView line)>;
+
+        [[nodiscard]] static Predicate literalPredicate(const LiteralSearch& search);
+        [[nodiscard]] static Predicate regexPredicate(const QRegularExpression& expression);
+
+        explicit LineFilter(QObject* parent = nullptr);
+        ~LineFilter() override;
+
+        LineFilter(const LineFilter&) = delete;
+        LineFilter& operator=(const LineFilter&) = delete;
+        LineFilter(LineFilter&&) = delete;
+        LineFilter& operator=(LineFilter&&) = delete;
+
+        // Drops any filter still running and tests every line of text in the background. Matching lines are kept,
+        // or hidden when invert is set. jobs <= 0 means one task per core.
+        void start(Predicate predicate, PieceTable text, bool invert, int jobs = 0);
+
+        void cancel();
+
+        [[nodiscard]] bool isRunning() const
+        {
+            return m_activeRun != nullptr;
+        }
+
+        // Zero-based lines the last finished run hides, in ascending order; they are handed over, not copied.
+        [[nodiscard]] std::vector<qint64> takeHiddenLines()
+        {
+            return std::exchange(m_hiddenLines, {});
+        }
+
+    signals:
+        void finished(qint64 lineCount, qint64 hiddenCount);
+
+    private:
+        struct RunState;
+
+        void deliver(const std::shared_ptr<RunState>& state);
+
+        std::vector<qint64> m_hiddenLines;
+        std::shared_ptr<RunState> m_activeRun;
+        QThreadPool m_pool;
+    };
+
+} // namespace GnotePad::core
@@ -0,0 +1,276 @@
+#include "core/LineIndex.h"
+
+#ifdef Q_PROCESSOR_X86_64
+#include <immintrin.h>
+#elifdef Q_PROCESSOR_ARM_64
+#include <arm_neon.h>
+#endif
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <iterator>
+
+namespace GnotePad::core
+{
+
+    namespace
+    {
+        // Lines per bucket: large enough that the bucket list stays short for multi-million-line files, small
+        // enough that rewriting one bucket per keystroke is cheap.
+        constexpr std::size_t kBucketLines = 4096;
+        constexpr std::size_t kMinMergedBucketLines = kBucketLines / 4;
+
+        constexpr char16_t kParagraphSeparator = 0x2029;
+        constexpr char16_t kBeginningOfFrame = 0xFDD0;
+        constexpr char16_t kEndOfFrame = 0xFDD1;
+
+        constexpr bool isBreak(char16_t unit)
+        {
+            return unit == u'\n' || unit == u'\r' || unit == kParagraphSeparator || unit == kBeginningOfFrame || unit == kEndOfFrame;
+        }
+
+        template <typename Visitor> void forEachBreakScalar(const char16_t* data, qsizetype from, qsizetype size, Visitor& visit)
+        {
+            for (qsizetype index = from; index < size; ++index)
+            {
+                if (isBreak(data[index]))
+                {
+                    visit(index);
+                }
+            }
+        }
+
+        // Calls visit(index) for every break unit, in order.
+        template <typename Visitor> void forEachBreak(const char16_t* data, qsizetype size, Visitor&& visit)
+        {
+            qsizetype index = 0;
+#ifdef Q_PROCESSOR_X86_64
+            constexpr qsizetype BlockUnits = 8;
+            const __m128i lineFeed = _mm_set1_epi16(u'\n');
+            const __m128i carriageReturn = _mm_set1_epi16(u'\r');
+            const __m128i paragraphSeparator = _mm_set1_epi16(static_cast<short>(kParagraphSeparator));
+            // The two frame markers differ only in the lowest bit.
+            const __m128i frameMarker = _mm_set1_epi16(static_cast<short>(kBeginningOfFrame));
+            const __m128i frameMask = _mm_set1_epi16(static_cast<short>(0xFFFE));
+            for (; index + BlockUnits <= size; index += BlockUnits)
+            {
+                const __m128i units = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + index));
+                const __m128i newlines = _mm_or_si128(_mm_cmpeq_epi16(units, lineFeed), _mm_cmpeq_epi16(units, carriageReturn));
+                const __m128i separators =
+                    _mm_or_si128(_mm_cmpeq_epi16(units, paragraphSeparator), _mm_cmpeq_epi16(_mm_and_si128(units, frameMask), frameMarker));
+                // Two mask bits per matching unit.
+                auto hits = static_cast<unsigned>(_mm_movemask_epi8(_mm_or_si128(newlines, separators)));
+                while (hits != 0)
+                {
+                    const int bit = std::countr_zero(hits);
+                    visit(index + (bit / 2));
+                    hits &= ~(3U << bit);
+                }
+            }
+#elifdef Q_PROCESSOR_ARM_64
+            constexpr qsizetype BlockUnits = 8;
+            const auto* units16 = reinterpret_cast<const std::uint16_t*>(data);
+            for (; index + BlockUnits <= size; index += BlockUnits)
+            {
+                const uint16x8_t units = vld1q_u16(units16 + index);
+                const uint16x8_t newlines = vorrq_u16(vceqq_u16(units, vdupq_n_u16(u'\n')), vceqq_u16(units, vdupq_n_u16(u'\r')));
+                const uint16x8_t separators = vorrq_u16(vceqq_u16(units, vdupq_n_u16(kParagraphSeparator)),
+                                                        vceqq_u16(vandq_u16(units, vdupq_n_u16(0xFFFE)), vdupq_n_u16(kBeginningOfFrame)));
+                if (vmaxvq_u16(vorrq_u16(newlines, separators)) != 0)
+                {
+                    forEachBreakScalar(data, index, index + BlockUnits, visit);
+                }
+            }
+#endif
+            forEachBreakScalar(data, index, size, visit);
+        }
+    } // namespace
+
+    LineIndex::Span LineIndex::scan(QStringView text)
+    {
+        Span span;
+        const auto* data = text.utf16();
+        const qsizetype size = text.size();
+        // A CRLF pair inside one piece becomes a single block separator, so its LF takes no position.
+        qsizetype absorbed = 0;
+        forEachBreak(data,
+                     size,
+                     [&](qsizetype index)
+                     {
+                         if (data[index] == u'\n' && index > 0 && data[index - 1] == u'\r')
+                         {
+                             ++absorbed;
+                             return;
+                         }
+                         span.lineStarts.push_back(index - absorbed + 1);
+                     });
+        span.length = size - absorbed;
+        return span;
+    }
+
+    LineIndex::LineIndex()
+    {
+        clear();
+    }
+
+    void LineIndex::clear()
+    {
+        m_buckets.assign(1, Bucket{.starts = {0}});
+        m_lineCount = 1;
+        m_length = 0;
+    }
+
+    void LineIndex::append(const Span& span)
+    {
+        const qint64 origin = m_length;
+        for (const qint64 start : span.lineStarts)
+        {
+            Bucket* bucket = &m_buckets.back();
+            const qint64 absolute = origin + start;
+            if (bucket->starts.size() >= kBucketLines)
+            {
+                bucket->length = absolute - bucket->base;
+                m_buckets.push_back(Bucket{.base = absolute, .firstLine = m_lineCount, .starts = {0}});
+            }
+            else
+            {
+                bucket->starts.push_back(absolute - bucket->base);
+            }
+            ++m_lineCount;
+        }
+        m_length = origin + span.length;
+        m_buckets.back().length = m_length - m_buckets.back().base;
+    }
+
+    bool LineIndex::applyEdit(qint64 position, qint64 charsRemoved, qint64 charsAdded, const std::vector<qint64>& insertedLineStarts)
+    {
+        if (position < 0 || charsRemoved < 0 || charsAdded < 0 || position + charsRemoved > m_length)
+        {
+            return false;
+        }
+
+        const std::size_t first = bucketForPosition(position);
+        // Includes a bucket that begins exactly at position + charsRemoved: its first line start goes away.
+        std::size_t last = bucketForPosition(position + charsRemoved);
+
+        const qint64 origin = m_buckets[first].base;
+        const qint64 editStart = position - origin;
+        const qint64 editEnd = editStart + charsRemoved;
+        const qint64 delta = charsAdded - charsRemoved;
+
+        // Flatten the affected buckets into offsets from origin and apply the edit there.
+        std::vector<qint64> starts;
+        qint64 length = 0;
+        for (std::size_t index = first; index <= last; ++index)
+        {
+            const Bucket& bucket = m_buckets[index];
+            const qint64 offset = bucket.base - origin;
+            for (const qint64 start : bucket.starts)
+            {
+                const qint64 relative = offset + start;
+                if (relative <= editStart)
+                {
+                    starts.push_back(relative);
+                }
+                else if (relative > editEnd)
+                {
+                    starts.push_back(relative + delta);
+                }
+            }
+            length += bucket.length;
+        }
+        length += delta;
+
+        std::vector<qint64> inserted;
+        inserted.reserve(insertedLineStarts.size());
+        for (const qint64 start : insertedLineStarts)
+        {
+            if (start <= position || start > position + charsAdded)
+            {
+                return false;
+            }
+            inserted.push_back(start - origin);
+        }
+        const auto split = std::ranges::upper_bound(starts, editStart);
+        starts.insert(split, inserted.begin(), inserted.end());
+
+        // Fold a small remainder into the following bucket so deletions do not leave a trail of tiny ones.
+        if (starts.size() < kMinMergedBucketLines && last + 1 < m_buckets.size())
+        {
+            ++last;
+            const Bucket& next = m_buckets[last];
+            for (const qint64 start : next.starts)
+            {
+                starts.push_back(next.base + delta - origin + start);
+            }
+            length += next.length;
+        }
+
+        std::vector<Bucket> rebuilt;
+        for (std::size_t begin = 0; begin < starts.size(); begin += kBucketLines)
+        {
+            const std::size_t end = std::min(starts.size(), begin + kBucketLines);
+            Bucket bucket;
+            bucket.base = origin + starts[begin];
+            bucket.length = (end < starts.size() ? starts[end] : length) - starts[begin];
+            bucket.starts.reserve(end - begin);
+            std::transform(starts.begin() + static_cast<std::ptrdiff_t>(begin),
+                           starts.begin() + static_cast<std::ptrdiff_t>(end),
+                           std::back_inserter(bucket.starts),
+                           [&](qint64 start) { return start - starts[begin]; });
+            rebuilt.push_back(std::move(bucket));
+        }
+
+        const auto firstIt = m_buckets.begin() + static_cast<std::ptrdiff_t>(first);
+        const auto tail = m_buckets.erase(firstIt, m_buckets.begin() + static_cast<std::ptrdiff_t>(last + 1));
+        const auto nextIt = m_buckets.insert(tail, std::make_move_iterator(rebuilt.begin()), std::make_move_iterator(rebuilt.end()));
+        for (auto it = nextIt + static_cast<std::ptrdiff_t>(rebuilt.size()); it != m_buckets.end(); ++it)
+        {
+            it->base += delta;
+        }
+
+        m_length += delta;
+        refreshBuckets(first);
+        return true;
+    }
+
+    qint64 LineIndex::lineStart(qint64 line) const
+    {
+        line = std::clamp<qint64>(line, 0, m_lineCount - 1);
+        const Bucket& bucket = m_buckets[bucketForLine(line)];
+        return bucket.base + bucket.starts[static_cast<std::size_t>(line - bucket.firstLine)];
+    }
+
+    qint64 LineIndex::lineAt(qint64 position) const
+    {
+        position = std::clamp<qint64>(position, 0, m_length);
+        const Bucket& bucket = m_buckets[bucketForPosition(position)];
+        const auto it = std::ranges::upper_bound(bucket.starts, position - bucket.base);
+        return bucket.firstLine + (std::distance(bucket.starts.begin(), it) - 1);
+    }
+
+    std::size_t LineIndex::bucketForLine(qint64 line) const
+    {
+        const auto it = std::ranges::upper_bound(m_buckets, line, {}, &Bucket::firstLine);
+        return static_cast<std::size_t>(std::distance(m_buckets.begin(), it) - 1);
+    }
+
+    std::size_t LineIndex::bucketForPosition(qint64 position) const
+    {
+        const auto it = std::ranges::upper_bound(m_buckets, position, {}, &Bucket::base);
+        return static_cast<std::size_t>(std::max<std::ptrdiff_t>(0, std::distance(m_buckets.begin(), it) - 1));
+    }
+
+    void LineIndex::refreshBuckets(std::size_t from)
+    {
+        qint64 line = from == 0 ? 0 : m_buckets[from - 1].firstLine + static_cast<qint64>(m_buckets[from - 1].starts.size());
+        for (std::size_t index = from; index < m_buckets.size(); ++index)
+        {
+            m_buckets[index].firstLine = line;
+            line += static_cast<qint64>(m_buckets[index].starts.size());
+        }
+        m_lineCount = line;
+    }
+
+} // namespace GnotePad::core
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <QtCore/qstringview.h>
+#include <QtCore/qtypes.h>
+
+#include <vector>
+
+namespace GnotePad::core
+{
+
+    // Line-start positions of a document, kept in QTextDocument coordinates: every line break (LF, CR, a CRLF
+    // pair inserted in one piece, U+2029 and the frame markers QTextCursor::insertText() treats as breaks)
+    // occupies a single position. Lines are stored in buckets of relative offsets, so an edit only rewrites the
+    // bucket it lands in and shifts the bucket bases after it; lookups by line or position are a binary search
+    // over the buckets followed by an indexed or binary lookup inside one.
+    class LineIndex
+    {
+    public:
+        // Breaks found in one piece of text: where each following line starts, relative to the start of the
+        // piece, and how many document positions the piece occupies once inserted.
+        struct Span
+        {
+            std::vector<qint64> lineStarts;
+            qint64 length{0};
+        };
+
+        // Vectorized newline scan (SSE2 or NEON, scalar elsewhere). Safe to call from any thread.
+        [[nodiscard]] static Span scan(QStringView text);
+
+        LineIndex();
+
+        void clear();
+
+        // Records text inserted at the end of the document.
+        void append(const Span& span);
+
+        // Mirrors QTextDocument::contentsChange(): line starts in (position, position + charsRemoved] go away,
+        // those after the change move, and insertedLineStarts (absolute, within (position, position + charsAdded])
+        // come in. Returns false when the change does not fit the index, which then needs rebuilding.
+        bool applyEdit(qint64 position, qint64 charsRemoved, qint64 charsAdded, const std::vector<qint64>& insertedLineStarts);
+
+        [[nodiscard]] qint64 lineCount() const
+        {
+            return m_lineCount;
+        }
+
+        [[nodiscard]] qint64 length() const
+        {
+            return m_length;
+        }
+
+        // Position where the zero-based line starts; out-of-range lines are clamped.
+        [[nodiscard]] qint64 lineStart(qint64 line) const;
+
+        // Zero-based line containing position; out-of-range positions are clamped.
+        [[nodiscard]] qint64 lineAt(qint64 position) const;
+
+    private:
+        struct Bucket
+        {
+            qint64 base{0};
+            qint64 firstLine{0};
+            qint64 length{0};
+            // Relative to base; the first entry is always 0 because every bucket begins at a line start.
+            std::vector<qint64> starts;
+        };
+
+        [[nodiscard]] std::size_t bucketForLine(qint64 line) const;
+        [[nodiscard]] std::size_t bucketForPosition(qint64 position) const;
+        void refreshBuckets(std::size_t from);
+
+        std::vector<Bucket> m_buckets;
+        qint64 m_lineCount{1};
+        qint64 m_length{0};
+    };
+
+} // namespace GnotePad::core
@@ -0,0 +1,434 @@
+#include "core/LiteralSearch.h"
+
+#ifdef Q_PROCESSOR_X86_64
+#include <immintrin.h>
+#elifdef Q_PROCESSOR_ARM_64
+#include <arm_neon.h>
+#endif
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+
+namespace GnotePad::core
+{
+
+    namespace
+    {
+        // Matches fewer than this many characters apart are folded into one edit; copying the gap is cheaper
+        // than another trip through QTextDocument's insert machinery.
+        constexpr qsizetype kMergeGapChars = 4096;
+
+        constexpr std::uint32_t kNoUnit = 0x10000;
+
+        // For every BMP unit, the next unit in its case-folding class; the classes form cycles, so walking from
+        // a unit until it comes round again visits every unit that folds the same way. Built on first use.
+        const std::vector<char16_t>& foldCycles()
+        {
+            static const std::vector<char16_t> cycles = []()
+            {
+                std::vector<char16_t> next(0x10000);
+                std::vector<std::uint32_t> classHead(0x10000, kNoUnit);
+                for (std::uint32_t unit = 0; unit < 0x10000; ++unit)
+                {
+                    next[unit] = static_cast<char16_t>(unit);
+                    const char32_t folded = QChar::toCaseFolded(static_cast<char32_t>(unit));
+                    if (QChar::isSurrogate(unit) || folded > 0xFFFF)
+                    {
+                        continue;
+                    }
+                    std::uint32_t& head = classHead[folded];
+                    if (head == kNoUnit)
+                    {
+                        head = unit;
+                        continue;
+                    }
+                    next[unit] = next[head];
+                    next[head] = static_cast<char16_t>(unit);
+                }
+                return next;
+            }();
+            return cycles;
+        }
+
+#ifdef Q_PROCESSOR_X86_64
+        constexpr qsizetype kBlockUnits = 8;
+        constexpr int kMaskBitsPerUnit = 2;
+
+        // Marks the block positions whose first unit is one of first's and whose last unit is one of last's.
+        template <std::size_t N> class Prefilter
+        {
+        public:
+            Prefilter(const std::array<char16_t, N>& first, int firstCount, const std::array<char16_t, N>& last, int lastCount)
+                : m_firstCount(firstCount), m_lastCount(lastCount)
+            {
+                for (std::size_t index = 0; index < N; ++index)
+                {
+                    m_first[index] = _mm_set1_epi16(static_cast<short>(first[index]));
+                    m_last[index] = _mm_set1_epi16(static_cast<short>(last[index]));
+                }
+            }
+
+            // Two mask bits per candidate unit.
+            [[nodiscard]] unsigned candidates(const char16_t* firstUnits, const char16_t* lastUnits) const
+            {
+                const __m128i firstBlock = _mm_loadu_si128(reinterpret_cast<const __m128i*>(firstUnits));
+                const __m128i lastBlock = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lastUnits));
+                __m128i firstHits = _mm_cmpeq_epi16(firstBlock, m_first[0]);
+                for (int index = 1; index < m_firstCount; ++index)
+                {
+                    firstHits = _mm_or_si128(firstHits, _mm_cmpeq_epi16(firstBlock, m_first[index]));
+                }
+                __m128i lastHits = _mm_cmpeq_epi16(lastBlock, m_last[0]);
+                for (int index = 1; index < m_lastCount; ++index)
+                {
+                    lastHits = _mm_or_si128(lastHits, _mm_cmpeq_epi16(lastBlock, m_last[index]));
+                }
+                return static_cast<unsigned>(_mm_movemask_epi8(_mm_and_si128(firstHits, lastHits)));
+            }
+
+        private:
+            // Plain arrays: std::array would drop the vector type's alignment attribute.
+            // NOLINTBEGIN(cppcoreguidelines-avoid-c-arrays,modernize-avoid-c-arrays)
+            __m128i m_first[N]{};
+            __m128i m_last[N]{};
+            // NOLINTEND(cppcoreguidelines-avoid-c-arrays,modernize-avoid-c-arrays)
+            int m_firstCount;
+            int m_lastCount;
+        };
+#elifdef Q_PROCESSOR_ARM_64
+        constexpr qsizetype kBlockUnits = 8;
+        constexpr int kMaskBitsPerUnit = 8;
+
+        template <std::size_t N> class Prefilter
+        {
+        public:
+            Prefilter(const std::array<char16_t, N>& first, int firstCount, const std::array<char16_t, N>& last, int lastCount)
+                : m_firstCount(firstCount), m_lastCount(lastCount)
+            {
+                for (std::size_t index = 0; index < N; ++index)
+                {
+                    m_first[index] = vdupq_n_u16(first[index]);
+                    m_last[index] = vdupq_n_u16(last[index]);
+                }
+            }
+
+            // Eight mask bits per candidate unit: the comparison narrowed to one byte per lane.
+            [[nodiscard]] std::uint64_t candidates(const char16_t* firstUnits, const char16_t* lastUnits) const
+            {
+                const uint16x8_t firstBlock = vld1q_u16(reinterpret_cast<const std::uint16_t*>(firstUnits));
+                const uint16x8_t lastBlock = vld1q_u16(reinterpret_cast<const std::uint16_t*>(lastUnits));
+                uint16x8_t firstHits = vceqq_u16(firstBlock, m_first[0]);
+                for (int index = 1; index < m_firstCount; ++index)
+                {
+                    firstHits = vorrq_u16(firstHits, vceqq_u16(firstBlock, m_first[index]));
+                }
+                uint16x8_t lastHits = vceqq_u16(lastBlock, m_last[0]);
+                for (int index = 1; index < m_lastCount; ++index)
+                {
+                    lastHits = vorrq_u16(lastHits, vceqq_u16(lastBlock, m_last[index]));
+                }
+                return vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vandq_u16(firstHits, lastHits), 4)), 0);
+            }
+
+        private:
+            // NOLINTBEGIN(cppcoreguidelines-avoid-c-arrays,modernize-avoid-c-arrays)
+            uint16x8_t m_first[N]{};
+            uint16x8_t m_last[N]{};
+            // NOLINTEND(cppcoreguidelines-avoid-c-arrays,modernize-avoid-c-arrays)
+            int m_firstCount;
+            int m_lastCount;
+        };
+#endif
+    } // namespace
+
+    bool LiteralSearch::Variants::contains(char16_t unit) const
+    {
+        return std::find(units.begin(), units.begin() + count, unit) != units.begin() + count;
+    }
+
+    LiteralSearch::LiteralSearch(const QString& term, Qt::CaseSensitivity sensitivity, bool wholeWords)
+        : m_term(term), m_sensitivity(sensitivity), m_wholeWords(wholeWords)
+    {
+        if (m_term.isEmpty())
+        {
+            return;
+        }
+
+        const auto variantsOf = [this](char16_t unit, Variants& variants)
+        {
+            variants.units.fill(unit);
+            variants.count = 1;
+            if (m_sensitivity == Qt::CaseSensitive)
+            {
+                return true;
+            }
+            if (QChar::isSurrogate(unit))
+            {
+                return false;
+            }
+            const std::vector<char16_t>& cycles = foldCycles();
+            for (char16_t other = cycles[unit]; other != unit; other = cycles[other])
+            {
+                if (variants.count == MaxVariants)
+                {
+                    return false;
+                }
+                variants.units[static_cast<std::size_t>(variants.count++)] = other;
+            }
+            return true;
+        };
+        m_prefilter = variantsOf(m_term.front().unicode(), m_first) && variantsOf(m_term.back().unicode(), m_last);
+    }
+
+    qsizetype LiteralSearch::indexIn(QStringView text, qsizetype from) const
+    {
+        const qsizetype length = m_term.size();
+        for (qsizetype position = scanForward(text, from, text.size()); position >= 0;
+             position = scanForward(text, position + 1, text.size()))
+        {
+            const QChar before = position > 0 ? text[position - 1] : QChar();
+            const QChar after = position + length < text.size() ? text[position + length] : QChar();
+            if (isWholeWord(before, after))
+            {
+                return position;
+            }
+        }
+        return -1;
+    }
+
+    qsizetype LiteralSearch::count(QStringView text) const
+    {
+        qsizetype matches = 0;
+        for (qsizetype position = indexIn(text); position >= 0; position = indexIn(text, position + m_term.size()))
+        {
+            ++matches;
+        }
+        return matches;
+    }
+
+    qint64 LiteralSearch::find(const std::vector<QStringView>& pieces, qint64 from, qint64 until, bool backward) const
+    {
+        const qsizetype length = m_term.size();
+        std::vector<qint64> starts;
+        starts.reserve(pieces.size() + 1);
+        qint64 total = 0;
+        for (const QStringView piece : pieces)
+        {
+            starts.push_back(total);
+            total += piece.size();
+        }
+        starts.push_back(total);
+
+        from = std::max<qint64>(from, 0);
+        until = std::min(until, total - length + 1);
+        if (length == 0 || from >= until)
+        {
+            return -1;
+        }
+
+        const auto pieceAt = [&starts](qint64 position)
+        { return static_cast<std::size_t>(std::upper_bound(starts.begin(), starts.end(), position) - starts.begin() - 1); };
+        const auto unitAt = [&](qint64 position)
+        {
+            if (position < 0 || position >= total)
+            {
+                return QChar();
+            }
+            const std::size_t index = pieceAt(position);
+            return pieces[index][position - starts[index]];
+        };
+        const auto accepted = [&](qint64 position) { return isWholeWord(unitAt(position - 1), unitAt(position + length)); };
+
+        // Matches starting in a piece either lie inside it, found straight in its storage, or run on into the
+        // pieces after it, found in a copy of the seam no longer than twice the term.
+        QString seam;
+        const auto searchPiece = [&](std::size_t index) -> qint64
+        {
+            const QStringView piece = pieces[index];
+            const qint64 pieceStart = starts[index];
+            const auto localFrom = static_cast<qsizetype>(std::max(from - pieceStart, qint64{0}));
+            const auto localUntil = static_cast<qsizetype>(std::min(until - pieceStart, static_cast<qint64>(piece.size())));
+            if (localFrom >= localUntil)
+            {
+                return -1;
+            }
+
+            const auto inside = [&]() -> qint64
+            {
+                qsizetype position = backward ? scanBackward(piece, localFrom, localUntil) : scanForward(piece, localFrom, localUntil);
+                while (position >= 0 && !accepted(pieceStart + position))
+                {
+                    position = backward ? scanBackward(piece, localFrom, position) : scanForward(piece, position + 1, localUntil);
+                }
+                return position < 0 ? -1 : pieceStart + position;
+            };
+            const auto across = [&]() -> qint64
+            {
+                const qsizetype seamStart = std::max(localFrom, piece.size() - (length - 1));
+                if (length < 2 || seamStart >= localUntil)
+                {
+                    return -1;
+                }
+                seam = piece.sliced(seamStart).toString();
+                for (std::size_t next = index + 1; next < pieces.size() && seam.size() < 2 * (length - 1); ++next)
+                {
+                    seam.append(pieces[next].first(std::min(pieces[next].size(), 2 * (length - 1) - seam.size())));
+                }
+                const qsizetype seamUntil = localUntil - seamStart;
+                qsizetype position = backward ? scanBackward(seam, 0, seamUntil) : scanForward(seam, 0, seamUntil);
+                while (position >= 0 && !accepted(pieceStart + seamStart + position))
+                {
+                    position = backward ? scanBackward(seam, 0, position) : scanForward(seam, position + 1, seamUntil);
+                }
+                return position < 0 ? -1 : pieceStart + seamStart + position;
+            };
+
+            // Matches inside a piece all start before the ones running past its end.
+            const qint64 first = backward ? across() : inside();
+            return first >= 0 ? first : (backward ? inside() : across());
+        };
+
+        const std::size_t firstPiece = pieceAt(from);
+        const std::size_t lastPiece = pieceAt(until - 1);
+        for (std::size_t step = 0; step <= lastPiece - firstPiece; ++step)
+        {
+            const qint64 match = searchPiece(backward ? lastPiece - step : firstPiece + step);
+            if (match >= 0)
+            {
+                return match;
+            }
+        }
+        return -1;
+    }
+
+    qsizetype LiteralSearch::scanForward(QStringView text, qsizetype from, qsizetype until) const
+    {
+        const qsizetype length = m_term.size();
+        until = std::min(until, text.size() - length + 1);
+        qsizetype start = std::max<qsizetype>(from, 0);
+        if (length == 0 || start >= until)
+        {
+            return -1;
+        }
+
+        const char16_t* data = text.utf16();
+#if defined(Q_PROCESSOR_X86_64) || defined(Q_PROCESSOR_ARM_64)
+        if (m_prefilter)
+        {
+            const Prefilter<MaxVariants> prefilter(m_first.units, m_first.count, m_last.units, m_last.count);
+            for (; start + kBlockUnits <= until; start += kBlockUnits)
+            {
+                auto hits = prefilter.candidates(data + start, data + start + length - 1);
+                while (hits != 0)
+                {
+                    const int unit = std::countr_zero(hits) / kMaskBitsPerUnit;
+                    if (matchesAt(data + start + unit))
+                    {
+                        return start + unit;
+                    }
+                    // Drop every mask bit of this unit.
+                    hits &= ~(((decltype(hits){1} << kMaskBitsPerUnit) - 1) << (unit * kMaskBitsPerUnit));
+                }
+            }
+        }
+#endif
+        for (; start < until; ++start)
+        {
+            if ((!m_prefilter || (m_first.contains(data[start]) && m_last.contains(data[start + length - 1]))) && matchesAt(data + start))
+            {
+                return start;
+            }
+        }
+        return -1;
+    }
+
+    qsizetype LiteralSearch::scanBackward(QStringView text, qsizetype from, qsizetype until) const
+    {
+        const qsizetype length = m_term.size();
+        qsizetype end = std::min(until, text.size() - length + 1);
+        from = std::max<qsizetype>(from, 0);
+        if (length == 0 || from >= end)
+        {
+            return -1;
+        }
+
+        const char16_t* data = text.utf16();
+#if defined(Q_PROCESSOR_X86_64) || defined(Q_PROCESSOR_ARM_64)
+        if (m_prefilter)
+        {
+            const Prefilter<MaxVariants> prefilter(m_first.units, m_first.count, m_last.units, m_last.count);
+            for (; end - kBlockUnits >= from; end -= kBlockUnits)
+            {
+                const qsizetype start = end - kBlockUnits;
+                auto hits = prefilter.candidates(data + start, data + start + length - 1);
+                while (hits != 0)
+                {
+                    const int bit = static_cast<int>(sizeof(hits) * 8) - 1 - std::countl_zero(hits);
+                    const int unit = bit / kMaskBitsPerUnit;
+                    if (matchesAt(data + start + unit))
+                    {
+                        return start + unit;
+                    }
+                    // Drop every mask bit of this unit and above.
+                    hits &= (decltype(hits){1} << (unit * kMaskBitsPerUnit)) - 1;
+                }
+            }
+        }
+#endif
+        for (; end > from; --end)
+        {
+            const qsizetype start = end - 1;
+            if ((!m_prefilter || (m_first.contains(data[start]) && m_last.contains(data[start + length - 1]))) && matchesAt(data + start))
+            {
+                return start;
+            }
+        }
+        return -1;
+    }
+
+    bool LiteralSearch::matchesAt(const char16_t* data) const
+    {
+        const QStringView candidate(data, m_term.size());
+        if (m_sensitivity == Qt::CaseSensitive)
+        {
+            return std::equal(candidate.utf16(), candidate.utf16() + candidate.size(), m_term.utf16());
+        }
+        return candidate.compare(m_term, Qt::CaseInsensitive) == 0;
+    }
+
+    bool LiteralSearch::isWholeWord(QChar before, QChar after) const
+    {
+        return !m_wholeWords || (!before.isLetterOrNumber() && !after.isLetterOrNumber());
+    }
+
+    void addReplacement(QList<TextReplacement>& edits, QStringView text, qsizetype position, qsizetype length, QStringView replacement)
+    {
+        if (!edits.isEmpty())
+        {
+            TextReplacement& previous = edits.last();
+            const qsizetype previousEnd = previous.position + previous.length;
+            if (position - previousEnd < kMergeGapChars)
+            {
+                previous.text.append(text.sliced(previousEnd, position - previousEnd));
+                previous.text.append(replacement);
+                previous.length = position + length - previous.position;
+                return;
+            }
+        }
+        edits.append(TextReplacement{position, length, replacement.toString()});
+    }
+
+    QList<TextReplacement> planReplaceAll(QStringView text, const LiteralSearch& search, QStringView replacement, qsizetype& matches)
+    {
+        QList<TextReplacement> edits;
+        matches = 0;
+        for (qsizetype position = search.indexIn(text); position >= 0; position = search.indexIn(text, position + search.termLength()))
+        {
+            ++matches;
+            addReplacement(edits, text, position, search.termLength(), replacement);
+        }
+        return edits;
+    }
+
+} // namespace GnotePad::core
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <QtCore/qchar.h>
+#include <QtCore/qlist.h>
+#include <QtCore/qnamespace.h>
+#include <QtCore/qstring.h>
+#include <QtCore/qstringview.h>
+#include <QtCore/qtypes.h>
+
+#include <array>
+#include <vector>
+
+namespace GnotePad::core
+{
+
+    // Finds a fixed term in plain UTF-16 text, the way Find and Replace match it in the editor: matches never
+    // overlap, Qt::CaseInsensitive compares case-folded characters, and whole-word matches may not touch a
+    // letter or digit on either side. The headless batch replace was built on it first; Replace All, Find
+    // Next, Find in Files and the match highlights adopted it later, so all of them agree on what counts as an
+    // occurrence.
+    //
+    // Candidates are found eight units at a time by comparing the term's first and last unit against the
+    // text with SSE2 or NEON; only positions where both agree are compared in full. Ignoring case, each of
+    // the two units is compared against every unit in its case-folding class, worked out once per term.
+    class LiteralSearch
+    {
+    public:
+        LiteralSearch(const QString& term, Qt::CaseSensitivity sensitivity, bool wholeWords = false);
+
+        [[nodiscard]] qsizetype termLength() const
+        {
+            return m_term.size();
+        }
+
+        // Position of the first match starting at or after from, or -1.
+        [[nodiscard]] qsizetype indexIn(QStringView text, qsizetype from = 0) const;
+
+        // Number of non-overlapping matches in text.
+        [[nodiscard]] qsizetype count(QStringView text) const;
+
+        // Searches text stored in pieces (a PieceTable's) as if it were one string, without flattening it. Returns
+        // the first match starting in [from, until), or the last one when backward, or -1.
+        [[nodiscard]] qint64 find(const std::vector<QStringView>& pieces, qint64 from, qint64 until, bool backward) const;
+
+    private:
+        static constexpr int MaxVariants = 4;
+
+        struct Variants
+        {
+            std::array<char16_t, MaxVariants> units{};
+            int count{0};
+
+            [[nodiscard]] bool contains(char16_t unit) const;
+        };
+
+        // Lowest or highest match start in [from, until) lying wholly inside text; no whole-word check.
+        [[nodiscard]] qsizetype scanForward(QStringView text, qsizetype from, qsizetype until) const;
+        [[nodiscard]] qsizetype scanBackward(QStringView text, qsizetype from, qsizetype until) const;
+        [[nodiscard]] bool matchesAt(const char16_t* data) const;
+        [[nodiscard]] bool isWholeWord(QChar before, QChar after) const;
+
+        QString m_term;
+        Qt::CaseSensitivity m_sensitivity;
+        bool m_wholeWords;
+        // The prefilter is skipped when either end of the term is a surrogate and case is ignored.
+        bool m_prefilter{false};
+        Variants m_first;
+        Variants m_last;
+    };
+
+    // One edit of a Replace All: length characters at position become text.
+    struct TextReplacement
+    {
+        qsizetype position{0};
+        qsizetype length{0};
+        QString text;
+    };
+
+    // Adds replacing length characters of text at position to edits, which are in document order and end before
+    // position. A match close behind the previous edit joins it, along with the text in between.
+    void addReplacement(QList<TextReplacement>& edits, QStringView text, qsizetype position, qsizetype length, QStringView replacement);
+
+    // Plans replacing every match of search in text with replacement, in one scan. Matches that sit close
+    // together share one edit spanning them and the text in between, so a dense document is rewritten in a
+    // few large edits rather than one per match. Edits come back in document order; matches gets the count.
+    [[nodiscard]] QList<TextReplacement> planReplaceAll(QStringView text,
+                                                        const LiteralSearch& search,
+                                                        QStringView replacement,
+                                                        qsizetype& matches);
+
+} // namespace GnotePad::core
@@ -0,0 +1,109 @@
+#include "core/MappedFile.h"
+
+#ifdef Q_OS_UNIX
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <spdlog/spdlog.h>
+
+#include <QtCore/qiodevice.h>
+
+#include <cstdint>
+
+namespace GnotePad::core
+{
+
+    MappedFile::~MappedFile()
+    {
+        close();
+    }
+
+    bool MappedFile::open(const QString& filePath, qint64 mapThreshold, Fallback fallback)
+    {
+        close();
+        m_mapError.clear();
+
+        m_file.setFileName(filePath);
+        if (!m_file.open(QIODevice::ReadOnly))
+        {
+            return false;
+        }
+
+        m_size = m_file.size();
+        if (m_size <= 0)
+        {
+            m_size = 0;
+            return true;
+        }
+
+        if (mapThreshold >= 0 && m_size >= mapThreshold)
+        {
+            m_mapped = m_file.map(0, m_size);
+            if (m_mapped)
+            {
+                adviseSequential(m_mapped, m_size);
+                return true;
+            }
+            if (fallback == Fallback::Fail)
+            {
+                m_mapError = m_file.errorString();
+                close();
+                return false;
+            }
+            spdlog::warn("Memory-mapping {} failed ({}); falling back to a buffered read",
+                         filePath.toStdString(),
+                         m_file.errorString().toStdString());
+        }
+
+        m_buffer = m_file.readAll();
+        m_size = m_buffer.size();
+        return true;
+    }
+
+    void MappedFile::close()
+    {
+        if (m_mapped)
+        {
+            m_file.unmap(m_mapped);
+            m_mapped = nullptr;
+        }
+        m_buffer.clear();
+        m_size = 0;
+        if (m_file.isOpen())
+        {
+            m_file.close();
+        }
+    }
+
+    QByteArrayView MappedFile::data() const
+    {
+        if (m_mapped)
+        {
+            return {m_mapped, m_size};
+        }
+        return m_buffer;
+    }
+
+    void MappedFile::adviseSequential(uchar* address, qint64 length)
+    {
+#ifdef Q_OS_UNIX
+        // posix_madvise needs a page-aligned start; QFile::map only guarantees that for offset 0.
+        const auto pageSize = static_cast<std::uintptr_t>(sysconf(_SC_PAGESIZE));
+        const auto start = reinterpret_cast<std::uintptr_t>(address);
+        const auto alignedStart = start & ~(pageSize - 1);
+        const auto alignedLength = static_cast<std::size_t>(length) + (start - alignedStart);
+        // NOLINTNEXTLINE(performance-no-int-to-ptr)
+        if (posix_madvise(reinterpret_cast<void*>(alignedStart), alignedLength, POSIX_MADV_SEQUENTIAL) != 0)
+        {
+            spdlog::debug("posix_madvise(SEQUENTIAL) was rejected; continuing without readahead hint");
+        }
+#else
+        // Windows maps through CreateFileMapping, which has no per-view sequential hint; the cache manager's
+        // own readahead applies.
+        static_cast<void>(address);
+        static_cast<void>(length);
+#endif
+    }
+
+} // namespace GnotePad::core
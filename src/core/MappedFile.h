@@ -0,0 +1,67 @@
+#pragma once
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qbytearrayview.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qstring.h>
+#include <QtCore/qtypes.h>
+
+#include <cstdint>
+
+namespace GnotePad::core
+{
+
+    // Read-only view over a file's bytes. Files at or above the map threshold are memory-mapped with a
+    // sequential readahead hint so decoders can read straight out of the page cache; smaller files (or
+    // files that cannot be mapped) are read into a heap buffer instead.
+    class MappedFile
+    {
+    public:
+        // What open() does when a file at or above the threshold cannot be mapped.
+        enum class Fallback : std::uint8_t
+        {
+            ReadIntoBuffer,
+            Fail
+        };
+
+        MappedFile() = default;
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        MappedFile(MappedFile&&) = delete;
+        MappedFile& operator=(MappedFile&&) = delete;
+
+        // With Fallback::Fail a mapping failure closes the file and returns false; errorString() keeps the reason.
+        bool open(const QString& filePath, qint64 mapThreshold, Fallback fallback = Fallback::ReadIntoBuffer);
+        void close();
+
+        [[nodiscard]] QByteArrayView data() const;
+
+        [[nodiscard]] qint64 size() const
+        {
+            return m_size;
+        }
+
+        [[nodiscard]] bool isMapped() const
+        {
+            return m_mapped != nullptr;
+        }
+
+        [[nodiscard]] QString errorString() const
+        {
+            return m_mapError.isEmpty() ? m_file.errorString() : m_mapError;
+        }
+
+    private:
+        static void adviseSequential(uchar* address, qint64 length);
+
+        QFile m_file;
+        uchar* m_mapped{nullptr};
+        QByteArray m_buffer;
+        qint64 m_size{0};
+        // Closing the file clears its own error, so a failed mapping's reason is kept here.
+        QString m_mapError;
+    };
+
+} // namespace GnotePad::core
@@ -0,0 +1,247 @@
+#include "core/MatchIndex.h"
+
+#include "core/LiteralSearch.h"
+#include "core/RegexSearch.h"
+
+#include <QtCore/qstringliteral.h>
+
+#include <algorithm>
+#include <atomic>
+#include <utility>
+
+namespace GnotePad::core
+{
+
+    namespace
+    {
+        // Lines scanned between checks for a newer search.
+        constexpr qint64 kCancelCheckLines = 4096;
+
+        constexpr bool isBreak(char16_t unit)
+        {
+            return unit == u'\n' || unit == u'\r' || unit == 0x2029 || unit == 0xFDD0 || unit == 0xFDD1;
+        }
+
+        // Runs matcher over each line of text, which starts at document position start.
+        void matchLines(const MatchIndex::LineMatcher& matcher, QStringView text, qint64 start, std::vector<MatchIndex::Match>& matches)
+        {
+            qsizetype lineBegin = 0;
+            for (qsizetype index = 0; index < text.size(); ++index)
+            {
+                if (isBreak(text[index].unicode()))
+                {
+                    matcher(text.sliced(lineBegin, index - lineBegin), start + lineBegin, matches);
+                    lineBegin = index + 1;
+                }
+            }
+            matcher(text.sliced(lineBegin), start + lineBegin, matches);
+        }
+    } // namespace
+
+    struct MatchIndex::RunState
+    {
+        std::atomic_bool cancelled{false};
+        std::vector<Match> matches;
+    };
+
+    MatchIndex::LineMatcher MatchIndex::literalMatcher(const LiteralSearch& search)
+    {
+        return [search](QStringView line, qint64 lineStart, std::vector<Match>& matches)
+        {
+            for (qsizetype position = search.indexIn(line); position >= 0; position = search.indexIn(line, position + search.termLength()))
+            {
+                matches.push_back(Match{lineStart + position, search.termLength()});
+            }
+        };
+    }
+
+    MatchIndex::LineMatcher MatchIndex::regexMatcher(const QRegularExpression& expression)
+    {
+        return [expression](QStringView line, qint64 lineStart, std::vector<Match>& matches)
+        {
+            auto found = RegexSearch::globalMatch(expression, line);
+            while (found.hasNext())
+            {
+                const QRegularExpressionMatch match = found.next();
+                if (match.capturedLength() > 0)
+                {
+                    matches.push_back(Match{lineStart + match.capturedStart(), match.capturedLength()});
+                }
+            }
+        };
+    }
+
+    MatchIndex::MatchIndex(QObject* parent) : QObject(parent)
+    {
+        // One scan at a time; a superseded one notices its flag within a few thousand lines and makes way.
+        m_pool.setMaxThreadCount(1);
+        m_pool.setObjectName(QStringLiteral("MatchIndex"));
+    }
+
+    MatchIndex::~MatchIndex()
+    {
+        cancelRun();
+        m_pool.waitForDone();
+    }
+
+    void MatchIndex::start(LineMatcher matcher, PieceTable text)
+    {
+        m_matcher = std::move(matcher);
+        rescan(std::move(text));
+    }
+
+    void MatchIndex::adopt(LineMatcher matcher, std::vector<Match> matches)
+    {
+        cancelRun();
+        m_matcher = std::move(matcher);
+        m_matches = std::move(matches);
+        emit matchesChanged();
+    }
+
+    void MatchIndex::rescan(PieceTable text)
+    {
+        cancelRun();
+        m_matches.clear();
+        if (!m_matcher)
+        {
+            emit matchesChanged();
+            return;
+        }
+
+        auto state = std::make_shared<RunState>();
+        m_activeRun = state;
+        m_pool.start(
+            [this, state, matcher = m_matcher, text = std::move(text)]()
+            {
+                // Lines are matched where they lie in the pieces; only one that straddles two pieces is copied.
+                QString carried;
+                qint64 lineStart = 0;
+                qint64 position = 0;
+                qint64 lines = 0;
+                for (const QStringView piece : text.pieces())
+                {
+                    qsizetype segmentBegin = 0;
+                    for (qsizetype index = 0; index < piece.size(); ++index)
+                    {
+                        if (!isBreak(piece[index].unicode()))
+                        {
+                            continue;
+                        }
+                        const QStringView segment = piece.sliced(segmentBegin, index - segmentBegin);
+                        if (carried.isEmpty())
+                        {
+                            matcher(segment, lineStart, state->matches);
+                        }
+                        else
+                        {
+                            carried.append(segment);
+                            matcher(carried, lineStart, state->matches);
+                            carried.clear();
+                        }
+                        lineStart = position + index + 1;
+                        segmentBegin = index + 1;
+                        if (++lines % kCancelCheckLines == 0 && state->cancelled)
+                        {
+                            return;
+                        }
+                    }
+                    carried.append(piece.sliced(segmentBegin));
+                    position += piece.size();
+                }
+                matcher(carried, lineStart, state->matches);
+                if (!state->cancelled)
+                {
+                    QMetaObject::invokeMethod(this, [this, state]() { deliver(state); }, Qt::QueuedConnection);
+                }
+            });
+        emit matchesChanged();
+    }
+
+    void MatchIndex::clear()
+    {
+        cancelRun();
+        m_matcher = nullptr;
+        m_matches.clear();
+        emit matchesChanged();
+    }
+
+    void MatchIndex::applyEdit(qint64 position, qint64 charsRemoved, qint64 charsAdded, qint64 linesStart, QStringView lines)
+    {
+        if (!m_matcher)
+        {
+            return;
+        }
+        if (m_activeRun)
+        {
+            // The scan is over the text as it was before this edit; the edit is replayed on its result.
+            m_pendingEdits.push_back(PendingEdit{position, charsRemoved, charsAdded, linesStart, lines.toString()});
+            return;
+        }
+        replaceLines(charsRemoved, charsAdded, linesStart, lines);
+        emit matchesChanged();
+    }
+
+    qsizetype MatchIndex::indexOf(qint64 position, qint64 length) const
+    {
+        const auto match =
+            std::ranges::lower_bound(m_matches, position, std::less<>(), [](const Match& candidate) { return candidate.position; });
+        if (match == m_matches.end() || match->position != position || match->length != length)
+        {
+            return -1;
+        }
+        return static_cast<qsizetype>(match - m_matches.begin());
+    }
+
+    std::span<const Match> MatchIndex::matchesIn(qint64 from, qint64 until) const
+    {
+        const auto byPosition = [](const Match& match) { return match.position; };
+        const auto first = std::ranges::lower_bound(m_matches, from, std::less<>(), byPosition);
+        const auto last = std::ranges::lower_bound(first, m_matches.end(), until, std::less<>(), byPosition);
+        return {first, last};
+    }
+
+    void MatchIndex::deliver(const std::shared_ptr<RunState>& state)
+    {
+        if (state != m_activeRun)
+        {
+            return;
+        }
+        m_activeRun.reset();
+        m_matches = std::move(state->matches);
+        for (const PendingEdit& edit : m_pendingEdits)
+        {
+            replaceLines(edit.charsRemoved, edit.charsAdded, edit.linesStart, edit.lines);
+        }
+        m_pendingEdits.clear();
+        emit matchesChanged();
+    }
+
+    void MatchIndex::cancelRun()
+    {
+        if (m_activeRun)
+        {
+            m_activeRun->cancelled = true;
+            m_activeRun.reset();
+        }
+        m_pendingEdits.clear();
+    }
+
+    void MatchIndex::replaceLines(qint64 charsRemoved, qint64 charsAdded, qint64 linesStart, QStringView lines)
+    {
+        // Matches never cross a line break, so text before the touched lines keeps its matches as they are and
+        // text after them keeps its matches shifted. The touched lines ended at oldLinesEnd before the edit; a
+        // match may start right at a line's end, hence the inclusive bound.
+        const qint64 delta = charsAdded - charsRemoved;
+        const qint64 oldLinesEnd = linesStart + lines.size() - delta;
+        const auto byPosition = [](const Match& match) { return match.position; };
+        const auto first = std::ranges::lower_bound(m_matches, linesStart, std::less<>(), byPosition);
+        const auto last = std::ranges::upper_bound(first, m_matches.end(), oldLinesEnd, std::less<>(), byPosition);
+        std::for_each(last, m_matches.end(), [delta](Match& match) { match.position += delta; });
+
+        std::vector<Match> rescanned;
+        matchLines(m_matcher, lines, linesStart, rescanned);
+        const auto erasedAt = m_matches.erase(first, last);
+        m_matches.insert(erasedAt, rescanned.begin(), rescanned.end());
+    }
+
+} // namespace GnotePad::core
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "core/PieceTable.h"
+
+#include <QtCore/qobject.h>
+#include <QtCore/qregularexpression.h>
+#include <QtCore/qstring.h>
+#include <QtCore/qstringview.h>
+#include <QtCore/qthreadpool.h>
+#include <QtCore/qtypes.h>
+
+#include <functional>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace GnotePad::core
+{
+
+    class LiteralSearch;
+
+    // Every match of the current search in the document, for highlighting them all and for the "N of M" count.
+    // The first scan runs on a worker thread over a piece-table snapshot. After that each edit rescans only the
+    // lines it touched, from their new text as the editor hands it in; edits that land while the first scan is
+    // still running are queued and replayed on its result.
+    class MatchIndex : public QObject
+    {
+        Q_OBJECT
+
+    public:
+        struct Match
+        {
+            qint64 position{0};
+            qint64 length{0};
+        };
+
+        // Appends the matches in one line, which starts at document position lineStart, to matches in order.
+        // Lines never include their break. Matchers run on the worker thread as well as the GUI thread.
+        using LineMatcher = std::function<void(QStringView line, qint64 lineStart, std::vector<Match>& matches)>;
+
+        [[nodiscard]] static LineMatcher literalMatcher(const LiteralSearch& search);
+        // Empty matches are left out, as Find skips them.
+        [[nodiscard]] static LineMatcher regexMatcher(const QRegularExpression& expression);
+
+        explicit MatchIndex(QObject* parent = nullptr);
+        ~MatchIndex() override;
+
+        MatchIndex(const MatchIndex&) = delete;
+        MatchIndex& operator=(const MatchIndex&) = delete;
+        MatchIndex(MatchIndex&&) = delete;
+        MatchIndex& operator=(MatchIndex&&) = delete;
+
+        // Drops the current matches and scans text with matcher in the background.
+        void start(LineMatcher matcher, PieceTable text);
+
+        // Takes matches found elsewhere, such as from the word index, instead of scanning for them; matcher keeps
+        // them current through later edits.
+        void adopt(LineMatcher matcher, std::vector<Match> matches);
+
+        // Scans text again with the current matcher, for a document that was replaced wholesale.
+        void rescan(PieceTable text);
+
+        void clear();
+
+        // Mirrors an edit of the document. linesStart is where the first line the edit touched starts, and lines
+        // holds the text of every touched line as it reads after the edit, the breaks between them included.
+        void applyEdit(qint64 position, qint64 charsRemoved, qint64 charsAdded, qint64 linesStart, QStringView lines);
+
+        [[nodiscard]] bool isActive() const
+        {
+            return static_cast<bool>(m_matcher);
+        }
+
+        [[nodiscard]] bool isScanning() const
+        {
+            return m_activeRun != nullptr;
+        }
+
+        [[nodiscard]] qsizetype count() const
+        {
+            return static_cast<qsizetype>(m_matches.size());
+        }
+
+        // Zero-based index of the match covering exactly [position, position + length), or -1.
+        [[nodiscard]] qsizetype indexOf(qint64 position, qint64 length) const;
+
+        // The matches starting in [from, until), in document order.
+        [[nodiscard]] std::span<const Match> matchesIn(qint64 from, qint64 until) const;
+
+    signals:
+        void matchesChanged();
+
+    private:
+        struct RunState;
+
+        struct PendingEdit
+        {
+            qint64 position{0};
+            qint64 charsRemoved{0};
+            qint64 charsAdded{0};
+            qint64 linesStart{0};
+            QString lines;
+        };
+
+        void deliver(const std::shared_ptr<RunState>& state);
+        void cancelRun();
+        void replaceLines(qint64 charsRemoved, qint64 charsAdded, qint64 linesStart, QStringView lines);
+
+        LineMatcher m_matcher;
+        std::vector<Match> m_matches;
+        std::vector<PendingEdit> m_pendingEdits;
+        std::shared_ptr<RunState> m_activeRun;
+        QThreadPool m_pool;
+    };
+
+} // namespace GnotePad::core
@@ -0,0 +1,177 @@
+#include "core/MultiTermSearch.h"
+
+#include <QtCore/qchar.h>
+
+#include <algorithm>
+#include <deque>
+#include <limits>
+#include <map>
+
+namespace GnotePad::core
+{
+
+    namespace
+    {
+        constexpr int kRootUnits = 0x10000;
+        // States with more edges than this are searched by bisection rather than one by one.
+        constexpr int kLinearEdges = 8;
+        // Units scanned between checks for cancellation.
+        constexpr qint64 kCancelCheckUnits = 1LL << 20;
+    } // namespace
+
+    MultiTermSearch::MultiTermSearch(const QStringList& terms, Qt::CaseSensitivity sensitivity) : m_sensitivity(sensitivity)
+    {
+        // The trie is grown with a map per state, then frozen into the flat edge array.
+        std::vector<std::map<char16_t, int>> children(1);
+        m_states.resize(1);
+        for (const QString& term : terms)
+        {
+            if (term.isEmpty())
+            {
+                continue;
+            }
+            int state = 0;
+            for (const QChar unit : term)
+            {
+                const char16_t key = fold(unit.unicode());
+                const auto [edge, added] = children[state].try_emplace(key, static_cast<int>(m_states.size()));
+                if (added)
+                {
+                    children.emplace_back();
+                    m_states.emplace_back();
+                }
+                state = edge->second;
+            }
+            if (m_states[state].term < 0)
+            {
+                m_states[state].term = static_cast<int>(m_terms.size());
+                m_terms << term;
+            }
+        }
+
+        for (std::size_t state = 0; state < children.size(); ++state)
+        {
+            m_states[state].firstEdge = static_cast<int>(m_edges.size());
+            m_states[state].edgeCount = static_cast<int>(children[state].size());
+            for (const auto& [unit, target] : children[state])
+            {
+                m_edges.push_back(Edge{unit, target});
+            }
+        }
+        m_rootNext.assign(kRootUnits, 0);
+        for (const auto& [unit, target] : children[0])
+        {
+            m_rootNext[unit] = target;
+        }
+
+        // Failure links breadth first: a state's link is the longest proper suffix of its path that is also a
+        // path from the root, found by following the parent's links.
+        std::deque<int> pending;
+        for (const auto& [unit, target] : children[0])
+        {
+            pending.push_back(target);
+        }
+        while (!pending.empty())
+        {
+            const int state = pending.front();
+            pending.pop_front();
+            for (const auto& [unit, target] : children[state])
+            {
+                const int fail = step(m_states[state].fail, unit);
+                m_states[target].fail = fail;
+                m_states[target].output = m_states[fail].term >= 0 ? fail : m_states[fail].output;
+                pending.push_back(target);
+            }
+        }
+    }
+
+    std::vector<MultiTermSearch::Hit> MultiTermSearch::findAll(const std::vector<QStringView>& pieces) const
+    {
+        std::vector<qint64> counts;
+        const std::atomic_bool cancelled{false};
+        return findAll(pieces, std::numeric_limits<qsizetype>::max(), counts, cancelled);
+    }
+
+    std::vector<MultiTermSearch::Hit> MultiTermSearch::findAll(const std::vector<QStringView>& pieces,
+                                                               qsizetype maxHitsPerTerm,
+                                                               std::vector<qint64>& counts,
+                                                               const std::atomic_bool& cancelled) const
+    {
+        std::vector<Hit> hits;
+        counts.assign(static_cast<std::size_t>(m_terms.size()), 0);
+        if (m_terms.isEmpty())
+        {
+            return hits;
+        }
+
+        // The automaton's state carries across piece boundaries, so terms split between pieces are found
+        // without copying anything.
+        int state = 0;
+        qint64 position = 0;
+        for (const QStringView piece : pieces)
+        {
+            for (const QChar unit : piece)
+            {
+                if (position % kCancelCheckUnits == 0 && cancelled)
+                {
+                    return hits;
+                }
+                state = step(state, fold(unit.unicode()));
+                for (int found = m_states[state].term >= 0 ? state : m_states[state].output; found >= 0;
+                     found = m_states[found].output)
+                {
+                    const int term = m_states[found].term;
+                    if (++counts[static_cast<std::size_t>(term)] <= maxHitsPerTerm)
+                    {
+                        hits.push_back(Hit{position - termLength(term) + 1, term});
+                    }
+                }
+                ++position;
+            }
+        }
+
+        // Found in order of where they end; callers step through them by where they start.
+        std::ranges::sort(hits, [](const Hit& lhs, const Hit& rhs)
+                          { return lhs.position != rhs.position ? lhs.position < rhs.position : lhs.term < rhs.term; });
+        return hits;
+    }
+
+    char16_t MultiTermSearch::fold(char16_t unit) const
+    {
+        if (m_sensitivity == Qt::CaseSensitive || QChar::isSurrogate(unit))
+        {
+            return unit;
+        }
+        const char32_t folded = QChar::toCaseFolded(static_cast<char32_t>(unit));
+        return folded > 0xFFFF ? unit : static_cast<char16_t>(folded);
+    }
+
+    int MultiTermSearch::child(int state, char16_t unit) const
+    {
+        const State& node = m_states[state];
+        const auto first = m_edges.begin() + node.firstEdge;
+        const auto last = first + node.edgeCount;
+        if (node.edgeCount <= kLinearEdges)
+        {
+            const auto edge = std::find_if(first, last, [unit](const Edge& candidate) { return candidate.unit == unit; });
+            return edge == last ? -1 : edge->target;
+        }
+        const auto edge = std::lower_bound(first, last, unit, [](const Edge& candidate, char16_t key) { return candidate.unit < key; });
+        return edge == last || edge->unit != unit ? -1 : edge->target;
+    }
+
+    int MultiTermSearch::step(int state, char16_t unit) const
+    {
+        while (state != 0)
+        {
+            const int next = child(state, unit);
+            if (next >= 0)
+            {
+                return next;
+            }
+            state = m_states[state].fail;
+        }
+        return m_rootNext[unit];
+    }
+
+} // namespace GnotePad::core
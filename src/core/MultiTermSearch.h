@@ -0,0 +1,89 @@
+#pragma once
+
+#include <QtCore/qnamespace.h>
+#include <QtCore/qstring.h>
+#include <QtCore/qstringlist.h>
+#include <QtCore/qstringview.h>
+#include <QtCore/qtypes.h>
+
+#include <atomic>
+#include <vector>
+
+namespace GnotePad::core
+{
+
+    // Finds every occurrence of every term of a list in one pass over the text, for watch-lists of error
+    // signatures: an Aho-Corasick automaton over UTF-16 units, so the cost of a scan does not grow with the
+    // number of terms. Occurrences may overlap, of the same term or of different ones. Ignoring case, each
+    // unit is compared by its simple case folding; terms that fold the same are counted as one.
+    //
+    // States keep their edges sorted in one flat array; the root, where a scan spends most of its time on
+    // text that matches nothing, has a direct table over all 65536 units instead.
+    class MultiTermSearch
+    {
+    public:
+        struct Hit
+        {
+            qint64 position{0};
+            int term{0};
+        };
+
+        // Empty and repeated terms are dropped; terms() lists those that remain, in their original order.
+        MultiTermSearch(const QStringList& terms, Qt::CaseSensitivity sensitivity);
+
+        [[nodiscard]] const QStringList& terms() const
+        {
+            return m_terms;
+        }
+
+        [[nodiscard]] qsizetype termLength(int term) const
+        {
+            return m_terms.at(term).size();
+        }
+
+        // Every occurrence in text stored in pieces (a PieceTable's), read as one string; sorted by position,
+        // then by term.
+        [[nodiscard]] std::vector<Hit> findAll(const std::vector<QStringView>& pieces) const;
+
+        // Like findAll(), but keeps only the first maxHitsPerTerm hits of each term while counts, one per term,
+        // still get every occurrence. Stops early, with hits and counts incomplete, once cancelled is set.
+        [[nodiscard]] std::vector<Hit> findAll(const std::vector<QStringView>& pieces,
+                                               qsizetype maxHitsPerTerm,
+                                               std::vector<qint64>& counts,
+                                               const std::atomic_bool& cancelled) const;
+
+        [[nodiscard]] std::vector<Hit> findAll(QStringView text) const
+        {
+            return findAll(std::vector<QStringView>{text});
+        }
+
+    private:
+        struct Edge
+        {
+            char16_t unit{0};
+            int target{0};
+        };
+
+        struct State
+        {
+            int fail{0};
+            // Nearest state down the failure chain where a term ends, or -1.
+            int output{-1};
+            // Term that ends here, or -1.
+            int term{-1};
+            int firstEdge{0};
+            int edgeCount{0};
+        };
+
+        [[nodiscard]] char16_t fold(char16_t unit) const;
+        [[nodiscard]] int child(int state, char16_t unit) const;
+        [[nodiscard]] int step(int state, char16_t unit) const;
+
+        QStringList m_terms;
+        Qt::CaseSensitivity m_sensitivity;
+        std::vector<State> m_states;
+        std::vector<Edge> m_edges;
+        std::vector<int> m_rootNext;
+    };
+
+} // namespace GnotePad::core
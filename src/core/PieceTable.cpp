@@ -0,0 +1,309 @@
+#include "core/PieceTable.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace GnotePad::core
+{
+
+    namespace
+    {
+        // Original buffers are cut into pieces of this size, so splitting one to edit inside it only ever
+        // recounts the line breaks of a bounded span.
+        constexpr qsizetype kOriginalPieceChars = 1024LL * 1024;
+        constexpr qsizetype kAddBlockChars = 64LL * 1024;
+
+        constexpr bool isBreak(char16_t unit)
+        {
+            return unit == u'\n' || unit == u'\r' || unit == 0x2029 || unit == 0xFDD0 || unit == 0xFDD1;
+        }
+
+        qint64 countLineBreaks(const char16_t* data, qsizetype length)
+        {
+            return std::count_if(data, data + length, isBreak);
+        }
+
+        template <typename Pointer> qint64 subtreeLength(const Pointer& node)
+        {
+            return node ? node->length : 0;
+        }
+
+        template <typename Pointer> qint64 subtreeLineBreaks(const Pointer& node)
+        {
+            return node ? node->lineBreaks : 0;
+        }
+    } // namespace
+
+    struct PieceTable::Node
+    {
+        Piece piece;
+        NodePtr left;
+        NodePtr right;
+        std::uint32_t priority{0};
+        qint64 length{0};
+        qint64 lineBreaks{0};
+    };
+
+    PieceTable::PieceTable() = default;
+
+    PieceTable::PieceTable(const QString& original)
+    {
+        appendOriginal(original);
+    }
+
+    // A copy is a snapshot: it shares every node and buffer but not the writable end of the add buffer, so
+    // edits to either table never touch text the other can see.
+    PieceTable::PieceTable(const PieceTable& other) : m_root(other.m_root), m_priorityState(other.m_priorityState)
+    {
+    }
+
+    PieceTable& PieceTable::operator=(const PieceTable& other)
+    {
+        if (this != &other)
+        {
+            m_root = other.m_root;
+            m_addBlock.reset();
+            m_addBlockSize = 0;
+            m_addBlockCapacity = 0;
+            m_priorityState = other.m_priorityState;
+        }
+        return *this;
+    }
+
+    void PieceTable::appendOriginal(const QString& text)
+    {
+        if (!text.isEmpty())
+        {
+            appendPieces(std::make_shared<const QString>(text));
+        }
+    }
+
+    void PieceTable::insert(qint64 position, QStringView text)
+    {
+        if (text.isEmpty())
+        {
+            return;
+        }
+        position = std::clamp<qint64>(position, 0, length());
+
+        // Text never moves once it is in the add buffer; a new block is started when the current one is full.
+        if (!m_addBlock || m_addBlockCapacity - m_addBlockSize < text.size())
+        {
+            m_addBlockCapacity = std::max(kAddBlockChars, text.size());
+            m_addBlock = std::make_shared_for_overwrite<char16_t[]>(static_cast<std::size_t>(m_addBlockCapacity));
+            m_addBlockSize = 0;
+        }
+        char16_t* const destination = m_addBlock.get() + m_addBlockSize;
+        std::copy_n(text.utf16(), text.size(), destination);
+        m_addBlockSize += text.size();
+        const qint64 lineBreaks = countLineBreaks(destination, text.size());
+
+        auto [left, right] = split(m_root, position);
+        // Consecutive keystrokes extend the piece before the caret instead of adding one piece each.
+        const Piece* previous = lastPiece(left);
+        if (previous && previous->storage.get() == m_addBlock.get() && previous->data + previous->length == destination)
+        {
+            left = extendLastPiece(left, text.size(), lineBreaks);
+        }
+        else
+        {
+            left = merge(left, makeNode(Piece{m_addBlock, destination, text.size(), lineBreaks}, nullptr, nullptr, nextPriority()));
+        }
+        m_root = merge(left, right);
+    }
+
+    void PieceTable::remove(qint64 position, qint64 length)
+    {
+        const qint64 total = this->length();
+        position = std::clamp<qint64>(position, 0, total);
+        length = std::clamp<qint64>(length, 0, total - position);
+        if (length == 0)
+        {
+            return;
+        }
+
+        auto [left, rest] = split(m_root, position);
+        m_root = merge(left, split(rest, length).second);
+    }
+
+    qint64 PieceTable::length() const
+    {
+        return subtreeLength(m_root);
+    }
+
+    qint64 PieceTable::lineCount() const
+    {
+        return subtreeLineBreaks(m_root) + 1;
+    }
+
+    qint64 PieceTable::lineStart(qint64 line) const
+    {
+        qint64 remaining = std::clamp<qint64>(line, 0, lineCount() - 1);
+        if (remaining == 0)
+        {
+            return 0;
+        }
+
+        // Find the remaining-th break; the line starts right after it.
+        qint64 base = 0;
+        const Node* node = m_root.get();
+        while (node)
+        {
+            const qint64 leftBreaks = subtreeLineBreaks(node->left);
+            if (remaining <= leftBreaks)
+            {
+                node = node->left.get();
+                continue;
+            }
+            remaining -= leftBreaks;
+            base += subtreeLength(node->left);
+
+            const Piece& piece = node->piece;
+            if (remaining <= piece.lineBreaks)
+            {
+                for (qsizetype index = 0; index < piece.length; ++index)
+                {
+                    if (isBreak(piece.data[index]) && --remaining == 0)
+                    {
+                        return base + index + 1;
+                    }
+                }
+            }
+            remaining -= piece.lineBreaks;
+            base += piece.length;
+            node = node->right.get();
+        }
+        return length();
+    }
+
+    std::vector<QStringView> PieceTable::pieces() const
+    {
+        std::vector<QStringView> result;
+        std::vector<const Node*> stack;
+        const Node* node = m_root.get();
+        while (node || !stack.empty())
+        {
+            while (node)
+            {
+                stack.push_back(node);
+                node = node->left.get();
+            }
+            node = stack.back();
+            stack.pop_back();
+            result.emplace_back(node->piece.data, node->piece.length);
+            node = node->right.get();
+        }
+        return result;
+    }
+
+    QString PieceTable::text() const
+    {
+        QString result;
+        result.reserve(length());
+        for (const QStringView piece : pieces())
+        {
+            result.append(piece);
+        }
+        return result;
+    }
+
+    PieceTable::NodePtr PieceTable::makeNode(Piece piece, NodePtr left, NodePtr right, std::uint32_t priority)
+    {
+        const qint64 length = piece.length + subtreeLength(left) + subtreeLength(right);
+        const qint64 lineBreaks = piece.lineBreaks + subtreeLineBreaks(left) + subtreeLineBreaks(right);
+        return std::make_shared<const Node>(Node{std::move(piece), std::move(left), std::move(right), priority, length, lineBreaks});
+    }
+
+    std::pair<PieceTable::NodePtr, PieceTable::NodePtr> PieceTable::split(const NodePtr& node, qint64 position)
+    {
+        if (!node)
+        {
+            return {};
+        }
+
+        const qint64 leftLength = subtreeLength(node->left);
+        if (position <= leftLength)
+        {
+            auto [left, right] = split(node->left, position);
+            return {std::move(left), makeNode(node->piece, std::move(right), node->right, node->priority)};
+        }
+
+        const qint64 offset = position - leftLength;
+        if (offset >= node->piece.length)
+        {
+            auto [left, right] = split(node->right, offset - node->piece.length);
+            return {makeNode(node->piece, node->left, std::move(left), node->priority), std::move(right)};
+        }
+
+        // The split lands inside this piece; both halves keep its priority, which still dominates their subtrees.
+        Piece head = node->piece;
+        Piece tail = node->piece;
+        head.length = offset;
+        head.lineBreaks = countLineBreaks(head.data, head.length);
+        tail.data += offset;
+        tail.length -= offset;
+        tail.lineBreaks -= head.lineBreaks;
+        return {makeNode(std::move(head), node->left, nullptr, node->priority), makeNode(std::move(tail), nullptr, node->right, node->priority)};
+    }
+
+    PieceTable::NodePtr PieceTable::merge(const NodePtr& left, const NodePtr& right)
+    {
+        if (!left)
+        {
+            return right;
+        }
+        if (!right)
+        {
+            return left;
+        }
+        if (left->priority > right->priority)
+        {
+            return makeNode(left->piece, left->left, merge(left->right, right), left->priority);
+        }
+        return makeNode(right->piece, merge(left, right->left), right->right, right->priority);
+    }
+
+    PieceTable::NodePtr PieceTable::extendLastPiece(const NodePtr& node, qsizetype length, qint64 lineBreaks)
+    {
+        if (node->right)
+        {
+            return makeNode(node->piece, node->left, extendLastPiece(node->right, length, lineBreaks), node->priority);
+        }
+        Piece piece = node->piece;
+        piece.length += length;
+        piece.lineBreaks += lineBreaks;
+        return makeNode(std::move(piece), node->left, nullptr, node->priority);
+    }
+
+    const PieceTable::Piece* PieceTable::lastPiece(const NodePtr& node)
+    {
+        const Node* current = node.get();
+        while (current && current->right)
+        {
+            current = current->right.get();
+        }
+        return current ? &current->piece : nullptr;
+    }
+
+    void PieceTable::appendPieces(const std::shared_ptr<const QString>& storage)
+    {
+        const auto* data = reinterpret_cast<const char16_t*>(storage->constData());
+        const qsizetype size = storage->size();
+        for (qsizetype offset = 0; offset < size; offset += kOriginalPieceChars)
+        {
+            const qsizetype length = std::min(kOriginalPieceChars, size - offset);
+            Piece piece{storage, data + offset, length, countLineBreaks(data + offset, length)};
+            m_root = merge(m_root, makeNode(std::move(piece), nullptr, nullptr, nextPriority()));
+        }
+    }
+
+    std::uint32_t PieceTable::nextPriority()
+    {
+        // xorshift32; the treap only needs priorities that are cheap and well spread, not unpredictable.
+        m_priorityState ^= m_priorityState << 13;
+        m_priorityState ^= m_priorityState >> 17;
+        m_priorityState ^= m_priorityState << 5;
+        return m_priorityState;
+    }
+
+} // namespace GnotePad::core
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <QtCore/qstring.h>
+#include <QtCore/qstringview.h>
+#include <QtCore/qtypes.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace GnotePad::core
+{
+
+    // Piece-table text buffer in QTextDocument coordinates: one character per document position, with every
+    // block separator stored as a single break character. Loaded text lives in immutable original buffers and
+    // typed or pasted text in an append-only add buffer; the pieces referring to them sit in a persistent treap
+    // whose nodes carry subtree length and line-break counts, so edits and lookups by offset or line are
+    // logarithmic. Copying a PieceTable is O(1) and yields an immutable snapshot that may be read on another
+    // thread while the original keeps being edited. The editor keeps one beside its QTextDocument as a mirror,
+    // not as the document's storage, so it costs a second copy of the text.
+    class PieceTable
+    {
+    public:
+        PieceTable();
+        explicit PieceTable(const QString& original);
+
+        PieceTable(const PieceTable& other);
+        PieceTable& operator=(const PieceTable& other);
+        PieceTable(PieceTable&&) noexcept = default;
+        PieceTable& operator=(PieceTable&&) noexcept = default;
+        ~PieceTable() = default;
+
+        // Adds another original buffer at the end, as a background load does chunk by chunk.
+        void appendOriginal(const QString& text);
+
+        void insert(qint64 position, QStringView text);
+        void remove(qint64 position, qint64 length);
+
+        [[nodiscard]] qint64 length() const;
+        [[nodiscard]] qint64 lineCount() const;
+
+        // Position where the zero-based line starts; out-of-range lines are clamped.
+        [[nodiscard]] qint64 lineStart(qint64 line) const;
+
+        // The pieces in document order. The views stay valid as long as this table (or a copy of it) is alive.
+        [[nodiscard]] std::vector<QStringView> pieces() const;
+
+        [[nodiscard]] QString text() const;
+
+    private:
+        struct Piece
+        {
+            std::shared_ptr<const void> storage;
+            const char16_t* data{nullptr};
+            qsizetype length{0};
+            qint64 lineBreaks{0};
+        };
+
+        struct Node;
+        using NodePtr = std::shared_ptr<const Node>;
+
+        static NodePtr makeNode(Piece piece, NodePtr left, NodePtr right, std::uint32_t priority);
+        static std::pair<NodePtr, NodePtr> split(const NodePtr& node, qint64 position);
+        static NodePtr merge(const NodePtr& left, const NodePtr& right);
+        static NodePtr extendLastPiece(const NodePtr& node, qsizetype length, qint64 lineBreaks);
+        [[nodiscard]] static const Piece* lastPiece(const NodePtr& node);
+
+        void appendPieces(const std::shared_ptr<const QString>& storage);
+        std::uint32_t nextPriority();
+
+        NodePtr m_root;
+        std::shared_ptr<char16_t[]> m_addBlock;
+        qsizetype m_addBlockSize{0};
+        qsizetype m_addBlockCapacity{0};
+        std::uint32_t m_priorityState{0x9E3779B9U};
+    };
+
+} // namespace GnotePad::core
@@ -0,0 +1,373 @@
+#include "core/RegexSearch.h"
+
+#include <QtCore/qchar.h>
+#include <QtCore/qglobal.h>
+
+#include <algorithm>
+
+namespace GnotePad::core
+{
+
+    namespace
+    {
+        // Per start position; PCRE2's default of ten million lets a single nested quantifier spin for seconds.
+        constexpr auto kMatchLimitPrefix = "(*LIMIT_MATCH=1000000)";
+
+        QRegularExpressionMatch matchIn(const QRegularExpression& expression,
+                                        QStringView text,
+                                        qsizetype offset,
+                                        QRegularExpression::MatchType type = QRegularExpression::NormalMatch,
+                                        QRegularExpression::MatchOptions options = QRegularExpression::NoMatchOption)
+        {
+#if QT_VERSION >= QT_VERSION_CHECK(6, 5, 0)
+            return expression.matchView(text, offset, type, options);
+#else
+            return expression.match(text, offset, type, options);
+#endif
+        }
+    } // namespace
+
+    const QRegularExpression& RegexCache::get(const QString& pattern, QRegularExpression::PatternOptions options)
+    {
+        const auto cached = std::find_if(m_entries.begin(),
+                                         m_entries.end(),
+                                         [&](const Entry& entry) { return entry.options == options && entry.pattern == pattern; });
+        if (cached != m_entries.end())
+        {
+            // Most recently used first.
+            std::rotate(m_entries.begin(), cached, cached + 1);
+            return m_entries.front().expression;
+        }
+
+        QRegularExpression expression(QString::fromLatin1(kMatchLimitPrefix) + pattern, options);
+        if (expression.isValid())
+        {
+            expression.optimize();
+        }
+        if (m_entries.size() == Capacity)
+        {
+            m_entries.removeLast();
+        }
+        m_entries.prepend(Entry{pattern, options, std::move(expression)});
+        return m_entries.front().expression;
+    }
+
+    ReplacementTemplate::ReplacementTemplate(const QString& replacement)
+    {
+        QString literal;
+        const auto flushLiteral = [this, &literal]()
+        {
+            if (!literal.isEmpty())
+            {
+                m_parts.push_back(Part{literal, -1, {}});
+                literal.clear();
+            }
+        };
+
+        for (qsizetype index = 0; index < replacement.size(); ++index)
+        {
+            const QChar unit = replacement[index];
+            const QChar next = index + 1 < replacement.size() ? replacement[index + 1] : QChar();
+            if (unit == u'\\' && next.isDigit())
+            {
+                flushLiteral();
+                m_parts.push_back(Part{{}, next.digitValue(), {}});
+                ++index;
+            }
+            else if (unit == u'\\' && (next == u'n' || next == u't' || next == u'\\'))
+            {
+                literal.append(next == u'n' ? QChar(u'\n') : next == u't' ? QChar(u'\t') : next);
+                ++index;
+            }
+            else if (unit == u'$' && next.isDigit())
+            {
+                // "$12" is group 12; anything past two digits is plain text.
+                flushLiteral();
+                int group = next.digitValue();
+                index += 1;
+                if (index + 1 < replacement.size() && replacement[index + 1].isDigit())
+                {
+                    group = group * 10 + replacement[index + 1].digitValue();
+                    ++index;
+                }
+                m_parts.push_back(Part{{}, group, {}});
+            }
+            else if (unit == u'$' && next == u'{' && replacement.indexOf(u'}', index + 2) > index + 2)
+            {
+                flushLiteral();
+                const qsizetype close = replacement.indexOf(u'}', index + 2);
+                m_parts.push_back(Part{{}, -1, replacement.sliced(index + 2, close - index - 2)});
+                index = close;
+            }
+            else if (unit == u'$' && next == u'$')
+            {
+                literal.append(unit);
+                ++index;
+            }
+            else
+            {
+                literal.append(unit);
+            }
+        }
+        flushLiteral();
+    }
+
+    void ReplacementTemplate::appendTo(QString& out, const QRegularExpressionMatch& match) const
+    {
+        for (const Part& part : m_parts)
+        {
+            if (!part.name.isEmpty())
+            {
+                out.append(match.capturedView(part.name));
+            }
+            else if (part.group >= 0)
+            {
+                // Groups the pattern does not have expand to nothing.
+                out.append(match.capturedView(part.group));
+            }
+            else
+            {
+                out.append(part.literal);
+            }
+        }
+    }
+
+    QRegularExpressionMatchIterator RegexSearch::globalMatch(const QRegularExpression& expression, QStringView text, qsizetype offset)
+    {
+#if QT_VERSION >= QT_VERSION_CHECK(6, 5, 0)
+        return expression.globalMatchView(text, offset);
+#else
+        return expression.globalMatch(text, offset);
+#endif
+    }
+
+    RegexSearch::RegexSearch(const QRegularExpression& expression,
+                             const std::vector<QStringView>& pieces,
+                             const LineIndex& lines,
+                             int budgetMs)
+        : m_expression(expression), m_pieces(pieces), m_lines(lines), m_budgetMs(budgetMs)
+    {
+        m_pieceStarts.reserve(pieces.size() + 1);
+        qint64 total = 0;
+        for (const QStringView piece : pieces)
+        {
+            m_pieceStarts.push_back(total);
+            total += piece.size();
+        }
+        m_pieceStarts.push_back(total);
+    }
+
+    QStringView RegexSearch::line(qint64 index, qint64& lineStart)
+    {
+        lineStart = m_lines.lineStart(index);
+        const qint64 total = m_pieceStarts.back();
+        qint64 lineEnd = index + 1 < m_lines.lineCount() ? m_lines.lineStart(index + 1) - 1 : total;
+        lineEnd = std::max(std::min(lineEnd, total), lineStart);
+        if (m_pieces.empty() || lineStart >= lineEnd)
+        {
+            return {};
+        }
+
+        // The last piece starting at or before the line.
+        const auto after = std::upper_bound(m_pieceStarts.begin(), m_pieceStarts.end() - 1, lineStart);
+        auto piece = static_cast<std::size_t>(after - m_pieceStarts.begin() - 1);
+        const qint64 offset = lineStart - m_pieceStarts[piece];
+        if (lineEnd <= m_pieceStarts[piece + 1])
+        {
+            return m_pieces[piece].sliced(offset, lineEnd - lineStart);
+        }
+
+        m_scratch.resize(0);
+        for (qint64 position = lineStart; position < lineEnd; ++piece)
+        {
+            const qint64 from = position - m_pieceStarts[piece];
+            const qint64 count = std::min(lineEnd, m_pieceStarts[piece + 1]) - position;
+            m_scratch.append(m_pieces[piece].sliced(from, count));
+            position += count;
+        }
+        return m_scratch;
+    }
+
+    bool RegexSearch::nextMatch(QStringView text, qsizetype from, QRegularExpressionMatch& match)
+    {
+        // Each window is the line cut short, matched with hard partial matching: a start position that needs to look
+        // past the cut comes back as a partial match at once, and only that start is tried again, anchored, against
+        // the whole line. Every start before it is settled by the window alone.
+        while (from <= text.size())
+        {
+            if (m_timer.hasExpired(m_budgetMs))
+            {
+                return false;
+            }
+            qsizetype windowEnd = std::min(text.size(), from + WindowChars);
+            // A cut through a surrogate pair would make the window invalid UTF-16.
+            windowEnd -= windowEnd < text.size() && text[windowEnd - 1].isHighSurrogate() ? 1 : 0;
+            if (windowEnd == text.size())
+            {
+                match = matchIn(m_expression, text, from);
+                return true;
+            }
+            QRegularExpressionMatch found = matchIn(m_expression, text.first(windowEnd), from, QRegularExpression::PartialPreferFirstMatch);
+            if (found.hasMatch() && found.capturedEnd() < windowEnd)
+            {
+                match = found;
+                return true;
+            }
+            if (!found.hasMatch() && !found.hasPartialMatch())
+            {
+                from = windowEnd;
+                continue;
+            }
+            // A complete match that reaches the cut may have been cut short too.
+            const qsizetype start = found.capturedStart();
+            found = matchIn(m_expression, text, start, QRegularExpression::NormalMatch, QRegularExpression::AnchorAtOffsetMatchOption);
+            if (found.hasMatch())
+            {
+                match = found;
+                return true;
+            }
+            from = start + (start + 1 < text.size() && text[start].isHighSurrogate() ? 2 : 1);
+        }
+        match = {};
+        return true;
+    }
+
+    template <typename Visit>
+    bool RegexSearch::forEachMatch(QStringView text, qsizetype from, Visit visit)
+    {
+        if (text.size() <= WindowChars)
+        {
+            auto matches = globalMatch(m_expression, text, from);
+            while (matches.hasNext())
+            {
+                if (!visit(matches.next()))
+                {
+                    return true;
+                }
+                if (m_timer.hasExpired(m_budgetMs))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        QRegularExpressionMatch match;
+        while (from <= text.size())
+        {
+            if (!nextMatch(text, from, match))
+            {
+                return false;
+            }
+            if (!match.hasMatch() || !visit(match))
+            {
+                return true;
+            }
+            from = match.capturedEnd();
+            if (match.capturedLength() == 0)
+            {
+                from += from < text.size() && text[from].isHighSurrogate() ? 2 : 1;
+            }
+        }
+        return true;
+    }
+
+    RegexSearch::Result RegexSearch::find(qint64 from, qint64 until, bool backward, Match& match, const ReplacementTemplate* replacement)
+    {
+        until = std::min(until, m_pieceStarts.back());
+        from = std::max<qint64>(from, 0);
+        if (from >= until)
+        {
+            return Result::NotFound;
+        }
+
+        m_timer.start();
+        const qint64 firstLine = m_lines.lineAt(from);
+        const qint64 lastLine = m_lines.lineAt(until - 1);
+        for (qint64 step = 0; step <= lastLine - firstLine; ++step)
+        {
+            if (m_timer.hasExpired(m_budgetMs))
+            {
+                return Result::TimedOut;
+            }
+
+            qint64 lineStart = 0;
+            const QStringView text = line(backward ? lastLine - step : firstLine + step, lineStart);
+            const qsizetype localFrom = std::max<qint64>(from - lineStart, 0);
+            const qsizetype localUntil = std::min<qint64>(until - lineStart, text.size() + 1);
+            QRegularExpressionMatch found;
+            const bool inBudget = forEachMatch(text,
+                                               localFrom,
+                                               [&](const QRegularExpressionMatch& next)
+                                               {
+                                                   if (next.capturedStart() >= localUntil)
+                                                   {
+                                                       return false;
+                                                   }
+                                                   if (next.capturedLength() > 0)
+                                                   {
+                                                       found = next;
+                                                   }
+                                                   return backward || !found.hasMatch();
+                                               });
+            if (!inBudget)
+            {
+                return Result::TimedOut;
+            }
+            if (found.hasMatch())
+            {
+                match.position = lineStart + found.capturedStart();
+                match.length = found.capturedLength();
+                match.replacement.clear();
+                if (replacement)
+                {
+                    replacement->appendTo(match.replacement, found);
+                }
+                return Result::Found;
+            }
+        }
+        return Result::NotFound;
+    }
+
+    RegexSearch::Result
+    RegexSearch::planReplaceAll(QStringView text, const ReplacementTemplate& replacement, QList<TextReplacement>& edits, qsizetype& matches)
+    {
+        m_timer.start();
+        edits.clear();
+        matches = 0;
+        QString expanded;
+        for (qint64 index = 0; index < m_lines.lineCount(); ++index)
+        {
+            if (m_timer.hasExpired(m_budgetMs))
+            {
+                edits.clear();
+                matches = 0;
+                return Result::TimedOut;
+            }
+
+            const qint64 lineStart = m_lines.lineStart(index);
+            qint64 lineEnd = index + 1 < m_lines.lineCount() ? m_lines.lineStart(index + 1) - 1 : text.size();
+            lineEnd = std::clamp<qint64>(lineEnd, lineStart, text.size());
+            const QStringView lineText = text.sliced(lineStart, lineEnd - lineStart);
+            const bool inBudget = forEachMatch(lineText,
+                                               0,
+                                               [&](const QRegularExpressionMatch& match)
+                                               {
+                                                   expanded.resize(0);
+                                                   replacement.appendTo(expanded, match);
+                                                   const qint64 position = lineStart + match.capturedStart();
+                                                   addReplacement(edits, text, position, match.capturedLength(), expanded);
+                                                   ++matches;
+                                                   return true;
+                                               });
+            if (!inBudget)
+            {
+                edits.clear();
+                matches = 0;
+                return Result::TimedOut;
+            }
+        }
+        return matches > 0 ? Result::Found : Result::NotFound;
+    }
+
+} // namespace GnotePad::core
@@ -0,0 +1,123 @@
+#pragma once
+
+#include "core/LineIndex.h"
+#include "core/LiteralSearch.h"
+
+#include <QtCore/qelapsedtimer.h>
+#include <QtCore/qlist.h>
+#include <QtCore/qregularexpression.h>
+#include <QtCore/qstring.h>
+#include <QtCore/qstringview.h>
+#include <QtCore/qtypes.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace GnotePad::core
+{
+
+    // Compiled regular expressions by pattern text and options, most recently used first. Pressing F3 again, or
+    // Replace after Find, reuses the JIT-compiled code instead of compiling the pattern anew.
+    class RegexCache
+    {
+    public:
+        // The pattern is JIT-compiled up front, with a PCRE2 match limit prepended so a pattern that backtracks
+        // catastrophically gives up on a start position instead of running on. Check isValid() before use; the
+        // reference stays valid until the next call.
+        const QRegularExpression& get(const QString& pattern, QRegularExpression::PatternOptions options);
+
+    private:
+        static constexpr qsizetype Capacity = 8;
+
+        struct Entry
+        {
+            QString pattern;
+            QRegularExpression::PatternOptions options;
+            QRegularExpression expression;
+        };
+
+        QList<Entry> m_entries;
+    };
+
+    // A Replace With text for regular expressions, parsed once and expanded per match. "\1" or "$1" stands for
+    // capture group 1 ("\0" or "$0" for the whole match, "${name}" for a named group), "\n" and "\t" for a
+    // newline and a tab, and "\\" or "$$" for the character itself.
+    class ReplacementTemplate
+    {
+    public:
+        explicit ReplacementTemplate(const QString& replacement);
+
+        void appendTo(QString& out, const QRegularExpressionMatch& match) const;
+
+    private:
+        struct Part
+        {
+            QString literal;
+            int group{-1};
+            QString name;
+        };
+
+        std::vector<Part> m_parts;
+    };
+
+    // Runs a regular expression over a document line by line, the way QTextDocument::find does, so a match
+    // never spans a line break. The document is read from its pieces (a PieceTable's) with positions from its
+    // LineIndex; only lines that straddle two pieces are copied. Every call gives up once budgetMs is spent,
+    // so a pathological pattern on a huge document is reported instead of freezing the caller. The budget is
+    // checked after every match, and a line longer than WindowChars is tried a window of start positions at a
+    // time, so even one enormous line without a match cannot run far past it. On such a line the search
+    // resumes one character on after an empty match.
+    class RegexSearch
+    {
+    public:
+        enum class Result : std::uint8_t
+        {
+            Found,
+            NotFound,
+            TimedOut
+        };
+
+        struct Match
+        {
+            qint64 position{-1};
+            qint64 length{0};
+            // The expanded replacement, when find() was given a template.
+            QString replacement;
+        };
+
+        RegexSearch(const QRegularExpression& expression, const std::vector<QStringView>& pieces, const LineIndex& lines, int budgetMs);
+
+        // Every match in text from offset on, without copying text, whichever Qt version the build uses.
+        static QRegularExpressionMatchIterator globalMatch(const QRegularExpression& expression, QStringView text, qsizetype offset = 0);
+
+        // First non-empty match starting in [from, until), or the last one when backward.
+        Result find(qint64 from, qint64 until, bool backward, Match& match, const ReplacementTemplate* replacement = nullptr);
+
+        // Plans replacing every match, empty ones included, with replacement expanded for it. text is the whole
+        // document flattened (toPlainText()); the edits slice it for the text they keep between matches.
+        Result planReplaceAll(QStringView text, const ReplacementTemplate& replacement, QList<TextReplacement>& edits, qsizetype& matches);
+
+        static constexpr qsizetype WindowChars = 64 * 1024;
+
+    private:
+        QStringView line(qint64 index, qint64& lineStart);
+
+        // The first match in text starting at or after from, found one window at a time. False once the budget
+        // is spent; match is left without a match when there is none.
+        bool nextMatch(QStringView text, qsizetype from, QRegularExpressionMatch& match);
+
+        // Hands visit each match in text from from on, in order, until it returns false. False once the budget
+        // is spent.
+        template <typename Visit>
+        bool forEachMatch(QStringView text, qsizetype from, Visit visit);
+
+        const QRegularExpression& m_expression;
+        const std::vector<QStringView>& m_pieces;
+        const LineIndex& m_lines;
+        std::vector<qint64> m_pieceStarts;
+        QString m_scratch;
+        int m_budgetMs;
+        QElapsedTimer m_timer;
+    };
+
+} // namespace GnotePad::core
@@ -0,0 +1,39 @@
+#include "core/StreamDecoder.h"
+
+#include <QtCore/qchar.h>
+#include <QtCore/qstringliteral.h>
+
+namespace GnotePad::core
+{
+
+    StreamDecoder::StreamDecoder(QStringConverter::Encoding encoding) : m_encoding(encoding), m_decoder(encoding)
+    {
+    }
+
+    QString StreamDecoder::decode(QByteArrayView chunk)
+    {
+        QString text = m_encoding == QStringConverter::Utf8 ? m_utf8Decoder.decode(chunk) : m_decoder(chunk);
+        if (m_pendingCarriageReturn)
+        {
+            text.prepend(QLatin1Char('\r'));
+            m_pendingCarriageReturn = false;
+        }
+        if (text.endsWith(QLatin1Char('\r')))
+        {
+            text.chop(1);
+            m_pendingCarriageReturn = true;
+        }
+        return text;
+    }
+
+    QString StreamDecoder::flush()
+    {
+        if (!m_pendingCarriageReturn)
+        {
+            return {};
+        }
+        m_pendingCarriageReturn = false;
+        return QStringLiteral("\r");
+    }
+
+} // namespace GnotePad::core
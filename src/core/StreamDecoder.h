@@ -0,0 +1,41 @@
+#pragma once
+
+#include "core/Utf8Decoder.h"
+
+#include <QtCore/qbytearrayview.h>
+#include <QtCore/qstring.h>
+#include <QtCore/qstringconverter.h>
+
+namespace GnotePad::core
+{
+
+    // Stateful decoder for text that arrives in chunks. Multi-byte sequences split across chunks are carried
+    // over, and a trailing carriage return is held back until the next chunk so a CRLF pair is never split:
+    // every returned piece can be appended to a QTextDocument on its own without creating a spurious block.
+    // UTF-8 goes through the vectorized Utf8Decoder; other encodings use QStringDecoder.
+    class StreamDecoder
+    {
+    public:
+        explicit StreamDecoder(QStringConverter::Encoding encoding);
+
+        [[nodiscard]] QString decode(QByteArrayView chunk);
+        [[nodiscard]] QString flush();
+
+        [[nodiscard]] bool hasError() const
+        {
+            return m_encoding == QStringConverter::Utf8 ? m_utf8Decoder.hasError() : m_decoder.hasError();
+        }
+
+        [[nodiscard]] QStringConverter::Encoding encoding() const
+        {
+            return m_encoding;
+        }
+
+    private:
+        QStringConverter::Encoding m_encoding;
+        QStringDecoder m_decoder;
+        Utf8Decoder m_utf8Decoder;
+        bool m_pendingCarriageReturn{false};
+    };
+
+} // namespace GnotePad::core
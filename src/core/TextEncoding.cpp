@@ -0,0 +1,43 @@
+#include "core/TextEncoding.h"
+
+namespace GnotePad::core
+{
+
+    QStringConverter::Encoding detectEncoding(QByteArrayView data, int& bomLength)
+    {
+        bomLength = 0;
+        if (data.startsWith(QByteArray::fromHex("efbbbf")))
+        {
+            bomLength = 3;
+            return QStringConverter::Utf8;
+        }
+        if (data.startsWith(QByteArray::fromHex("fffe")))
+        {
+            bomLength = 2;
+            return QStringConverter::Utf16LE;
+        }
+        if (data.startsWith(QByteArray::fromHex("feff")))
+        {
+            bomLength = 2;
+            return QStringConverter::Utf16BE;
+        }
+
+        return QStringConverter::Utf8;
+    }
+
+    QByteArray byteOrderMark(QStringConverter::Encoding encoding)
+    {
+        switch (encoding)
+        {
+        case QStringConverter::Utf8:
+            return QByteArray::fromHex("efbbbf");
+        case QStringConverter::Utf16LE:
+            return QByteArray::fromHex("fffe");
+        case QStringConverter::Utf16BE:
+            return QByteArray::fromHex("feff");
+        default:
+            return {};
+        }
+    }
+
+} // namespace GnotePad::core
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qbytearrayview.h>
+#include <QtCore/qstringconverter.h>
+
+namespace GnotePad::core
+{
+
+    // Sniffs a leading byte order mark. Returns UTF-8 when none is present and reports the BOM size via bomLength.
+    [[nodiscard]] QStringConverter::Encoding detectEncoding(QByteArrayView data, int& bomLength);
+
+    // Byte order mark written ahead of the payload when saving with a BOM; empty for encodings without one.
+    [[nodiscard]] QByteArray byteOrderMark(QStringConverter::Encoding encoding);
+
+} // namespace GnotePad::core
@@ -0,0 +1,348 @@
+#include "core/Utf8Decoder.h"
+
+#ifdef Q_PROCESSOR_X86_64
+#include <immintrin.h>
+#if defined(__GNUC__) && !defined(Q_OS_WIN)
+#define GNOTE_UTF8_AVX2_DISPATCH
+#endif
+#elifdef Q_PROCESSOR_ARM_64
+#include <arm_neon.h>
+#endif
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qchar.h>
+#include <QtCore/qnamespace.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+
+namespace GnotePad::core
+{
+
+    namespace
+    {
+        // Widens the leading run of ASCII bytes in src into dst and returns its length. The vector kernels may
+        // also write the widened bytes of the block that ends the run; the caller overwrites those.
+        using WidenKernel = qsizetype (*)(const uchar* src, qsizetype length, char16_t* dst);
+
+        qsizetype widenAsciiScalar(const uchar* src, qsizetype length, char16_t* dst)
+        {
+            qsizetype index = 0;
+            while (index < length && src[index] < 0x80)
+            {
+                dst[index] = src[index];
+                ++index;
+            }
+            return index;
+        }
+
+#ifdef Q_PROCESSOR_X86_64
+        qsizetype widenAsciiSse2(const uchar* src, qsizetype length, char16_t* dst)
+        {
+            constexpr qsizetype BlockBytes = 16;
+            const __m128i zero = _mm_setzero_si128();
+            qsizetype index = 0;
+            for (; index + BlockBytes <= length; index += BlockBytes)
+            {
+                const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + index));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + index), _mm_unpacklo_epi8(bytes, zero));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + index + (BlockBytes / 2)), _mm_unpackhi_epi8(bytes, zero));
+                const auto highBits = static_cast<unsigned>(_mm_movemask_epi8(bytes));
+                if (highBits != 0)
+                {
+                    return index + std::countr_zero(highBits);
+                }
+            }
+            return index + widenAsciiScalar(src + index, length - index, dst + index);
+        }
+#endif
+
+#ifdef GNOTE_UTF8_AVX2_DISPATCH
+        __attribute__((target("avx2"))) qsizetype widenAsciiAvx2(const uchar* src, qsizetype length, char16_t* dst)
+        {
+            constexpr qsizetype BlockBytes = 32;
+            qsizetype index = 0;
+            for (; index + BlockBytes <= length; index += BlockBytes)
+            {
+                const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + index));
+                const __m256i low = _mm256_cvtepu8_epi16(_mm256_castsi256_si128(bytes));
+                const __m256i high = _mm256_cvtepu8_epi16(_mm256_extracti128_si256(bytes, 1));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + index), low);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + index + (BlockBytes / 2)), high);
+                const auto highBits = static_cast<unsigned>(_mm256_movemask_epi8(bytes));
+                if (highBits != 0)
+                {
+                    return index + std::countr_zero(highBits);
+                }
+            }
+            return index + widenAsciiSse2(src + index, length - index, dst + index);
+        }
+#endif
+
+#ifdef Q_PROCESSOR_ARM_64
+        qsizetype widenAsciiNeon(const uchar* src, qsizetype length, char16_t* dst)
+        {
+            constexpr qsizetype BlockBytes = 16;
+            auto* out = reinterpret_cast<std::uint16_t*>(dst);
+            qsizetype index = 0;
+            for (; index + BlockBytes <= length; index += BlockBytes)
+            {
+                const uint8x16_t bytes = vld1q_u8(src + index);
+                if (vmaxvq_u8(bytes) >= 0x80)
+                {
+                    break;
+                }
+                vst1q_u16(out + index, vmovl_u8(vget_low_u8(bytes)));
+                vst1q_u16(out + index + (BlockBytes / 2), vmovl_high_u8(bytes));
+            }
+            return index + widenAsciiScalar(src + index, length - index, dst + index);
+        }
+#endif
+
+        WidenKernel widenKernel()
+        {
+            static const WidenKernel kernel = []() -> WidenKernel
+            {
+#ifdef GNOTE_UTF8_AVX2_DISPATCH
+                __builtin_cpu_init();
+                if (__builtin_cpu_supports("avx2"))
+                {
+                    return widenAsciiAvx2;
+                }
+#endif
+#ifdef Q_PROCESSOR_X86_64
+                return widenAsciiSse2;
+#elifdef Q_PROCESSOR_ARM_64
+                return widenAsciiNeon;
+#else
+                return widenAsciiScalar;
+#endif
+            }();
+            return kernel;
+        }
+
+        enum class Step : std::uint8_t
+        {
+            Complete,
+            Incomplete,
+            Invalid
+        };
+
+        struct Progress
+        {
+            qsizetype consumed{0};
+            qsizetype written{0};
+            Step step{Step::Complete};
+        };
+
+        constexpr bool isContinuation(uchar byte)
+        {
+            return (byte & 0xC0) == 0x80;
+        }
+
+        // Length of the sequence introduced by a non-ASCII lead byte, or 0 when the byte cannot start one
+        // (continuation bytes, the always-overlong C0/C1 and anything past F4).
+        constexpr qsizetype sequenceLength(uchar lead)
+        {
+            if (lead < 0xC2)
+            {
+                return 0;
+            }
+            if (lead < 0xE0)
+            {
+                return 2;
+            }
+            if (lead < 0xF0)
+            {
+                return 3;
+            }
+            if (lead < 0xF5)
+            {
+                return 4;
+            }
+            return 0;
+        }
+
+        // Decodes one multi-byte sequence. Like QStringDecoder, a sequence cut short by the end of the input is
+        // only an error if one of the bytes that did arrive is not a continuation byte.
+        Step decodeSequence(const uchar* src, qsizetype available, char16_t* dst, qsizetype& bytes, qsizetype& units)
+        {
+            const uchar lead = src[0];
+            const qsizetype needed = sequenceLength(lead);
+            if (needed == 0)
+            {
+                return Step::Invalid;
+            }
+            const qsizetype present = std::min(needed, available);
+            for (qsizetype index = 1; index < present; ++index)
+            {
+                if (!isContinuation(src[index]))
+                {
+                    return Step::Invalid;
+                }
+            }
+            if (available < needed)
+            {
+                return Step::Incomplete;
+            }
+
+            char32_t codePoint = 0;
+            switch (needed)
+            {
+            case 2:
+                codePoint = (static_cast<char32_t>(lead & 0x1F) << 6) | (src[1] & 0x3FU);
+                break;
+            case 3:
+                codePoint = (static_cast<char32_t>(lead & 0x0F) << 12) | (static_cast<char32_t>(src[1] & 0x3F) << 6) | (src[2] & 0x3FU);
+                if (codePoint < 0x800 || QChar::isSurrogate(codePoint))
+                {
+                    return Step::Invalid;
+                }
+                break;
+            default:
+                codePoint = (static_cast<char32_t>(lead & 0x07) << 18) | (static_cast<char32_t>(src[1] & 0x3F) << 12) |
+                            (static_cast<char32_t>(src[2] & 0x3F) << 6) | (src[3] & 0x3FU);
+                if (codePoint < 0x10000 || codePoint > QChar::LastValidCodePoint)
+                {
+                    return Step::Invalid;
+                }
+                break;
+            }
+
+            bytes = needed;
+            if (QChar::requiresSurrogates(codePoint))
+            {
+                dst[0] = QChar::highSurrogate(codePoint);
+                dst[1] = QChar::lowSurrogate(codePoint);
+                units = 2;
+            }
+            else
+            {
+                dst[0] = static_cast<char16_t>(codePoint);
+                units = 1;
+            }
+            return Step::Complete;
+        }
+
+        // Transcodes until the input runs out, a malformed sequence is found or the input ends mid-sequence.
+        Progress transcode(const uchar* src, qsizetype length, char16_t* dst)
+        {
+            const WidenKernel widen = widenKernel();
+            Progress progress;
+            while (progress.consumed < length)
+            {
+                const qsizetype ascii = widen(src + progress.consumed, length - progress.consumed, dst + progress.written);
+                progress.consumed += ascii;
+                progress.written += ascii;
+                if (progress.consumed == length)
+                {
+                    break;
+                }
+
+                qsizetype bytes = 0;
+                qsizetype units = 0;
+                progress.step = decodeSequence(src + progress.consumed, length - progress.consumed, dst + progress.written, bytes, units);
+                if (progress.step != Step::Complete)
+                {
+                    break;
+                }
+                progress.consumed += bytes;
+                progress.written += units;
+            }
+            return progress;
+        }
+    } // namespace
+
+    QString Utf8Decoder::decode(QByteArrayView chunk)
+    {
+        if (m_fallback)
+        {
+            return (*m_fallback)(chunk);
+        }
+
+        const auto* src = reinterpret_cast<const uchar*>(chunk.data());
+        const qsizetype length = chunk.size();
+        // Every byte yields at most one UTF-16 unit; only a carried-over sequence can yield more units than the
+        // chunk contributes bytes, and never more than it carried.
+        QString text(length + m_pendingLength, Qt::Uninitialized);
+        auto* dst = reinterpret_cast<char16_t*>(text.data());
+        qsizetype consumed = 0;
+        qsizetype written = 0;
+
+        if (m_pendingLength > 0)
+        {
+            std::array<uchar, 4> sequence{};
+            std::copy_n(m_pending.cbegin(), m_pendingLength, sequence.begin());
+            const qsizetype take = std::min<qsizetype>(static_cast<qsizetype>(sequence.size()) - m_pendingLength, length);
+            std::copy_n(src, take, sequence.begin() + m_pendingLength);
+
+            qsizetype bytes = 0;
+            qsizetype units = 0;
+            const auto step = decodeSequence(sequence.data(), m_pendingLength + take, dst, bytes, units);
+            if (step == Step::Invalid)
+            {
+                QByteArray remainder(m_pending.data(), m_pendingLength);
+                remainder.append(chunk);
+                return switchToFallback(text, 0, remainder);
+            }
+            if (step == Step::Incomplete)
+            {
+                std::copy_n(chunk.data(), length, m_pending.begin() + m_pendingLength);
+                m_pendingLength += length;
+                return {};
+            }
+
+            consumed = bytes - m_pendingLength;
+            written = units;
+            m_pendingLength = 0;
+            if (!m_headerDone)
+            {
+                m_headerDone = true;
+                if (dst[0] == QChar::ByteOrderMark)
+                {
+                    written = 0;
+                }
+            }
+        }
+        else if (!m_headerDone && chunk.startsWith("\xEF\xBB\xBF"))
+        {
+            // QStringDecoder drops a byte order mark at the very start of the stream.
+            consumed = 3;
+            m_headerDone = true;
+        }
+
+        const auto progress = transcode(src + consumed, length - consumed, dst + written);
+        consumed += progress.consumed;
+        written += progress.written;
+        if (written > 0)
+        {
+            m_headerDone = true;
+        }
+
+        if (progress.step == Step::Invalid)
+        {
+            return switchToFallback(text, written, chunk.sliced(consumed));
+        }
+        if (progress.step == Step::Incomplete)
+        {
+            m_pendingLength = length - consumed;
+            std::copy_n(chunk.data() + consumed, m_pendingLength, m_pending.begin());
+        }
+
+        text.truncate(written);
+        return text;
+    }
+
+    QString Utf8Decoder::switchToFallback(QString& text, qsizetype written, QByteArrayView remainder)
+    {
+        // The bytes before the malformed sequence were valid and end on a character boundary, so a fresh decoder
+        // fed the remainder is in the same state the original decoder would have been in at that point.
+        m_fallback.emplace(QStringConverter::Utf8, m_headerDone ? QStringConverter::Flag::ConvertInitialBom : QStringConverter::Flag::Default);
+        m_pendingLength = 0;
+        text.truncate(written);
+        text.append((*m_fallback)(remainder));
+        return text;
+    }
+
+} // namespace GnotePad::core
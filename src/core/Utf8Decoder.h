@@ -0,0 +1,38 @@
+#pragma once
+
+#include <QtCore/qbytearrayview.h>
+#include <QtCore/qstring.h>
+#include <QtCore/qstringconverter.h>
+
+#include <array>
+#include <optional>
+
+namespace GnotePad::core
+{
+
+    // Stateful UTF-8 to UTF-16 decoder that validates and transcodes in a single pass. Runs of ASCII are
+    // widened a vector register at a time (AVX2 when the CPU has it, SSE2 or NEON otherwise, scalar
+    // elsewhere); multi-byte sequences go through a scalar validator that applies the same rules as
+    // QStringDecoder. Output is identical to QStringDecoder(QStringConverter::Utf8): an initial BOM is
+    // skipped and incomplete trailing sequences are carried into the next call. On the first malformed
+    // sequence the rest of the stream is handed to a QStringDecoder so replacement characters match too.
+    class Utf8Decoder
+    {
+    public:
+        [[nodiscard]] QString decode(QByteArrayView chunk);
+
+        [[nodiscard]] bool hasError() const
+        {
+            return m_fallback && m_fallback->hasError();
+        }
+
+    private:
+        QString switchToFallback(QString& text, qsizetype written, QByteArrayView remainder);
+
+        std::array<char, 4> m_pending{};
+        qsizetype m_pendingLength{0};
+        bool m_headerDone{false};
+        std::optional<QStringDecoder> m_fallback;
+    };
+
+} // namespace GnotePad::core
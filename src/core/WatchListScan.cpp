@@ -0,0 +1,75 @@
+#include "core/WatchListScan.h"
+
+#include <QtCore/qstringliteral.h>
+
+#include <atomic>
+
+namespace GnotePad::core
+{
+
+    struct WatchListScan::RunState
+    {
+        RunState(const MultiTermSearch& terms, PieceTable snapshot) : search(terms), text(std::move(snapshot))
+        {
+        }
+
+        std::atomic_bool cancelled{false};
+        const MultiTermSearch search;
+        const PieceTable text;
+        std::vector<MultiTermSearch::Hit> hits;
+        std::vector<qint64> counts;
+    };
+
+    WatchListScan::WatchListScan(QObject* parent) : QObject(parent)
+    {
+        // One scan at a time; a superseded one gives way within a megabyte.
+        m_pool.setMaxThreadCount(1);
+        m_pool.setObjectName(QStringLiteral("WatchListScan"));
+    }
+
+    WatchListScan::~WatchListScan()
+    {
+        cancel();
+        m_pool.waitForDone();
+    }
+
+    void WatchListScan::start(const MultiTermSearch& search, PieceTable text)
+    {
+        cancel();
+
+        auto state = std::make_shared<RunState>(search, std::move(text));
+        m_activeRun = state;
+        m_pool.start(
+            [this, state]()
+            {
+                state->hits = state->search.findAll(state->text.pieces(), MaxHitsPerTerm, state->counts, state->cancelled);
+                if (!state->cancelled)
+                {
+                    QMetaObject::invokeMethod(this, [this, state]() { deliver(state); }, Qt::QueuedConnection);
+                }
+            });
+    }
+
+    void WatchListScan::cancel()
+    {
+        if (m_activeRun)
+        {
+            std::exchange(m_activeRun, nullptr)->cancelled = true;
+        }
+        // A scan still waiting for the thread never starts.
+        m_pool.clear();
+    }
+
+    void WatchListScan::deliver(const std::shared_ptr<RunState>& state)
+    {
+        if (state != m_activeRun)
+        {
+            return;
+        }
+        m_activeRun.reset();
+        m_hits = std::move(state->hits);
+        m_counts = std::move(state->counts);
+        emit finished();
+    }
+
+} // namespace GnotePad::core
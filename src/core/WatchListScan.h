@@ -0,0 +1,72 @@
+#pragma once
+
+#include "core/MultiTermSearch.h"
+#include "core/PieceTable.h"
+
+#include <QtCore/qobject.h>
+#include <QtCore/qthreadpool.h>
+#include <QtCore/qtypes.h>
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace GnotePad::core
+{
+
+    // Runs a watch-list search off the GUI thread over a piece-table snapshot. Every occurrence of every term is
+    // counted, but only the first MaxHitsPerTerm hits of each term are kept for stepping, so a term that occurs
+    // millions of times in a log costs a count, not millions of stored positions. Each start() supersedes the
+    // scan before it; a superseded scan stops within a megabyte of text and is never delivered.
+    class WatchListScan : public QObject
+    {
+        Q_OBJECT
+
+    public:
+        explicit WatchListScan(QObject* parent = nullptr);
+        ~WatchListScan() override;
+
+        WatchListScan(const WatchListScan&) = delete;
+        WatchListScan& operator=(const WatchListScan&) = delete;
+        WatchListScan(WatchListScan&&) = delete;
+        WatchListScan& operator=(WatchListScan&&) = delete;
+
+        void start(const MultiTermSearch& search, PieceTable text);
+
+        // Returns at once; nothing more from the current scan is delivered.
+        void cancel();
+
+        [[nodiscard]] bool isRunning() const
+        {
+            return m_activeRun != nullptr;
+        }
+
+        // Hits of the last finished scan, sorted like MultiTermSearch::findAll(); they are handed over, not copied.
+        [[nodiscard]] std::vector<MultiTermSearch::Hit> takeHits()
+        {
+            return std::exchange(m_hits, {});
+        }
+
+        // Occurrences of each term in the last finished scan, exact whatever was kept of its hits.
+        [[nodiscard]] const std::vector<qint64>& counts() const
+        {
+            return m_counts;
+        }
+
+        static constexpr qsizetype MaxHitsPerTerm = 10000;
+
+    signals:
+        void finished();
+
+    private:
+        struct RunState;
+
+        void deliver(const std::shared_ptr<RunState>& state);
+
+        std::vector<MultiTermSearch::Hit> m_hits;
+        std::vector<qint64> m_counts;
+        std::shared_ptr<RunState> m_activeRun;
+        QThreadPool m_pool;
+    };
+
+} // namespace GnotePad::core
@@ -0,0 +1,612 @@
+#include "core/WordIndex.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qstringliteral.h>
+#include <QtCore/qthread.h>
+#include <QtCore/qtimer.h>
+
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <optional>
+#include <ranges>
+#include <utility>
+
+namespace GnotePad::core
+{
+
+    namespace
+    {
+        // Rough heap cost of one dictionary entry beyond its characters: the hash node and the string header.
+        constexpr qint64 kWordOverheadBytes = 64;
+
+        qint64 wordBytes(qsizetype chars)
+        {
+            return kWordOverheadBytes + chars * qint64{sizeof(char16_t)};
+        }
+
+        qint64 blockBytes(const WordIndex::Block& block)
+        {
+            return qint64{sizeof(WordIndex::Block)} + static_cast<qint64>(block.postings.capacity() * sizeof(WordIndex::Posting));
+        }
+
+        // Case-folds word unit by unit into key, reusing key's storage so a dictionary hit costs no allocation.
+        void foldInto(QStringView word, QString& key)
+        {
+            key.resize(word.size());
+            for (qsizetype index = 0; index < word.size(); ++index)
+            {
+                key[index] = word[index].toCaseFolded();
+            }
+        }
+
+        // Random access to text held in a piece table's pieces, which must outlive it.
+        class PieceText
+        {
+        public:
+            explicit PieceText(const PieceTable& text) : m_pieces(text.pieces())
+            {
+                m_starts.reserve(m_pieces.size());
+                for (const QStringView piece : m_pieces)
+                {
+                    m_starts.push_back(m_length);
+                    m_length += piece.size();
+                }
+            }
+
+            [[nodiscard]] qint64 length() const
+            {
+                return m_length;
+            }
+
+            [[nodiscard]] QChar at(qint64 position) const
+            {
+                const std::size_t index = pieceAt(position);
+                return m_pieces[index][static_cast<qsizetype>(position - m_starts[index])];
+            }
+
+            // Appends [from, until) to out.
+            void append(qint64 from, qint64 until, QString& out) const
+            {
+                for (std::size_t index = pieceAt(from); from < until && index < m_pieces.size(); ++index)
+                {
+                    const QStringView piece = m_pieces[index];
+                    const qint64 offset = from - m_starts[index];
+                    const qint64 take = std::min(until - from, piece.size() - offset);
+                    out.append(piece.sliced(static_cast<qsizetype>(offset), static_cast<qsizetype>(take)));
+                    from += take;
+                }
+            }
+
+            [[nodiscard]] bool equals(qint64 position, QStringView word) const
+            {
+                for (qsizetype index = 0; index < word.size(); ++index)
+                {
+                    if (position + index >= m_length || at(position + index) != word[index])
+                    {
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+            // Whether no word runs across position: it is an end of the text or follows a non-word unit.
+            [[nodiscard]] bool isCut(qint64 position) const
+            {
+                return position <= 0 || position >= m_length || !at(position - 1).isLetterOrNumber();
+            }
+
+            // The first cut at or after position.
+            [[nodiscard]] qint64 nextCut(qint64 position) const
+            {
+                while (!isCut(position))
+                {
+                    ++position;
+                }
+                return position;
+            }
+
+        private:
+            [[nodiscard]] std::size_t pieceAt(qint64 position) const
+            {
+                const auto after = std::ranges::upper_bound(m_starts, position);
+                return static_cast<std::size_t>(std::max<std::ptrdiff_t>(std::distance(m_starts.begin(), after) - 1, 0));
+            }
+
+            std::vector<QStringView> m_pieces;
+            std::vector<qint64> m_starts;
+            qint64 m_length{0};
+        };
+
+        template <typename Intern> WordIndex::Block indexBlock(QStringView text, Intern& intern)
+        {
+            WordIndex::Block block;
+            block.length = text.size();
+            qsizetype index = 0;
+            while (index < text.size())
+            {
+                if (!text[index].isLetterOrNumber())
+                {
+                    ++index;
+                    continue;
+                }
+                const qsizetype begin = index;
+                while (index < text.size() && text[index].isLetterOrNumber())
+                {
+                    ++index;
+                }
+                block.postings.push_back(WordIndex::Posting{intern(text.sliced(begin, index - begin)), static_cast<quint32>(begin)});
+            }
+            // Stable, so each word's offsets stay in document order.
+            std::ranges::stable_sort(block.postings, std::less<>(), &WordIndex::Posting::word);
+            block.postings.shrink_to_fit();
+            return block;
+        }
+
+        // Indexes [from, until) of text into blocks of about BlockChars that end at cuts; until must be a cut.
+        // keepGoing sees each block as it is added and may stop the work by returning false.
+        template <typename Intern, typename KeepGoing>
+        void indexRange(const PieceText& text,
+                        qint64 from,
+                        qint64 until,
+                        Intern& intern,
+                        std::vector<WordIndex::Block>& blocks,
+                        KeepGoing keepGoing)
+        {
+            QString chunk;
+            while (from < until)
+            {
+                const qint64 end = std::min(text.nextCut(std::min(until, from + WordIndex::BlockChars)), until);
+                chunk.clear();
+                text.append(from, end, chunk);
+                blocks.push_back(indexBlock(chunk, intern));
+                if (!keepGoing(blocks.back()))
+                {
+                    return;
+                }
+                from = end;
+            }
+        }
+    } // namespace
+
+    struct WordIndex::RunState
+    {
+        RunState(PieceTable snapshot, int taskCount, qint64 limit)
+            : text(std::move(snapshot)),
+              reader(text),
+              parts(static_cast<std::size_t>(taskCount)),
+              tasksLeft(taskCount),
+              memoryLimit(limit)
+        {
+        }
+
+        std::atomic_bool cancelled{false};
+        std::atomic_bool overLimit{false};
+        const PieceTable text;
+        const PieceText reader;
+        QMutex mutex;
+        // Shared by every task; each keeps its own cache in front of it, so the lock is taken once per new word.
+        QHash<QString, quint32> words;
+        std::atomic<qint64> dictionaryBytes{0};
+        std::atomic<qint64> postingBytes{0};
+        std::vector<std::vector<Block>> parts;
+        std::atomic_int tasksLeft;
+        const qint64 memoryLimit;
+    };
+
+    WordIndex::WordIndex(QObject* parent) : QObject(parent), m_rebuildTimer(new QTimer(this)), m_memoryTimer(new QTimer(this))
+    {
+        m_pool.setObjectName(QStringLiteral("WordIndex"));
+        m_rebuildTimer->setSingleShot(true);
+        m_rebuildTimer->setInterval(RebuildDelayMs);
+        m_memoryTimer->setInterval(MemoryCheckIntervalMs);
+        connect(m_rebuildTimer, &QTimer::timeout, this, [this]() { build(std::exchange(m_rebuildText, PieceTable())); });
+        connect(m_memoryTimer, &QTimer::timeout, this, &WordIndex::checkMemory);
+    }
+
+    WordIndex::~WordIndex()
+    {
+        cancelRun();
+        m_pool.waitForDone();
+    }
+
+    void WordIndex::build(PieceTable text, int jobs)
+    {
+        cancelRun();
+        reset();
+        const qint64 available = availableMemoryBytes();
+        if (available >= 0 && available < MinFreeMemoryBytes)
+        {
+            drop(DropReason::LowMemory);
+            return;
+        }
+
+        const int tasks = jobs > 0 ? jobs : std::max(1, QThread::idealThreadCount());
+        auto state = std::make_shared<RunState>(std::move(text), tasks, m_memoryLimit);
+        m_activeRun = state;
+        m_state = State::Building;
+        m_memoryTimer->start();
+        // Tasks of a cancelled build may still be finishing a block; the new build's tasks queue up behind them.
+        m_pool.setMaxThreadCount(tasks);
+
+        for (int task = 0; task < tasks; ++task)
+        {
+            m_pool.start(
+                [this, state, task, tasks]()
+                {
+                    // Each task takes an equal share, its ends moved forward to cuts so no word is split between
+                    // two tasks; neighbouring tasks move their shared end the same way.
+                    const qint64 length = state->reader.length();
+                    const qint64 from = state->reader.nextCut(length * task / tasks);
+                    const qint64 until = state->reader.nextCut(length * (task + 1) / tasks);
+
+                    QHash<QString, quint32> cache;
+                    QString key;
+                    const auto intern = [&](QStringView word)
+                    {
+                        foldInto(word, key);
+                        if (const auto cached = cache.constFind(key); cached != cache.cend())
+                        {
+                            return *cached;
+                        }
+                        quint32 id = 0;
+                        {
+                            const QMutexLocker locker(&state->mutex);
+                            const auto known = state->words.constFind(key);
+                            if (known == state->words.cend())
+                            {
+                                id = static_cast<quint32>(state->words.size());
+                                state->words.insert(key, id);
+                                state->dictionaryBytes += wordBytes(key.size());
+                            }
+                            else
+                            {
+                                id = *known;
+                            }
+                        }
+                        cache.insert(key, id);
+                        return id;
+                    };
+                    const auto keepGoing = [&state](const Block& block)
+                    {
+                        state->postingBytes += blockBytes(block);
+                        if (state->dictionaryBytes + state->postingBytes > state->memoryLimit)
+                        {
+                            state->overLimit = true;
+                        }
+                        return !state->cancelled && !state->overLimit;
+                    };
+                    indexRange(state->reader, from, until, intern, state->parts[static_cast<std::size_t>(task)], keepGoing);
+
+                    if (--state->tasksLeft == 0 && !state->cancelled)
+                    {
+                        QMetaObject::invokeMethod(this, [this, state]() { deliver(state); }, Qt::QueuedConnection);
+                    }
+                });
+        }
+    }
+
+    void WordIndex::clear()
+    {
+        cancelRun();
+        reset();
+        m_memoryTimer->stop();
+        m_state = State::Off;
+    }
+
+    void WordIndex::applyEdit(qint64 position, qint64 charsRemoved, qint64 charsAdded, const PieceTable& text)
+    {
+        if (m_state == State::Off)
+        {
+            return;
+        }
+        if (m_state == State::Building)
+        {
+            scheduleRebuild(text);
+            return;
+        }
+
+        const qsizetype first = blockAt(position);
+        const qsizetype last = blockAt(position + charsRemoved);
+        if (last - first >= MaxEditBlocks)
+        {
+            scheduleRebuild(text);
+            return;
+        }
+
+        // The touched blocks are read again from the new text. If the edit left a word running up to their end,
+        // it may have joined the first word of the next block, which is read again as well.
+        const PieceText reader(text);
+        const qint64 from = m_blockStarts[static_cast<std::size_t>(first)];
+        auto end = static_cast<std::size_t>(last) + 1;
+        qint64 until = m_blockStarts[end - 1] + m_blocks[end - 1].length + charsAdded - charsRemoved;
+        while (end < m_blocks.size() && !reader.isCut(until))
+        {
+            until += m_blocks[end].length;
+            ++end;
+        }
+
+        QString key;
+        const auto intern = [this, &key](QStringView word)
+        {
+            foldInto(word, key);
+            const auto known = m_words.constFind(key);
+            if (known != m_words.cend())
+            {
+                return *known;
+            }
+            const auto id = static_cast<quint32>(m_words.size());
+            m_words.insert(key, id);
+            m_dictionaryBytes += wordBytes(key.size());
+            return id;
+        };
+        std::vector<Block> replacement;
+        indexRange(reader, from, until, intern, replacement, [](const Block&) { return true; });
+
+        const auto firstBlock = m_blocks.begin() + first;
+        const auto lastBlock = m_blocks.begin() + static_cast<std::ptrdiff_t>(end);
+        std::for_each(firstBlock, lastBlock, [this](const Block& block) { m_postingBytes -= blockBytes(block); });
+        std::ranges::for_each(replacement, [this](const Block& block) { m_postingBytes += blockBytes(block); });
+        const auto insertAt = m_blocks.erase(firstBlock, lastBlock);
+        m_blocks.insert(insertAt, std::make_move_iterator(replacement.begin()), std::make_move_iterator(replacement.end()));
+        if (m_blocks.empty())
+        {
+            m_blocks.emplace_back();
+        }
+        recomputeStarts();
+
+        if (memoryBytes() > m_memoryLimit)
+        {
+            drop(DropReason::MemoryLimit);
+        }
+    }
+
+    void WordIndex::setMemoryLimit(qint64 bytes)
+    {
+        m_memoryLimit = bytes;
+        if (m_state == State::Ready && memoryBytes() > m_memoryLimit)
+        {
+            drop(DropReason::MemoryLimit);
+        }
+    }
+
+    std::vector<qint64> WordIndex::occurrences(QStringView word, Qt::CaseSensitivity sensitivity, const PieceTable& text) const
+    {
+        std::vector<qint64> positions;
+        QString key;
+        foldInto(word, key);
+        const auto id = m_words.constFind(key);
+        if (!isReady() || !isWord(word) || id == m_words.cend())
+        {
+            return positions;
+        }
+        std::optional<PieceText> reader;
+        if (sensitivity == Qt::CaseSensitive)
+        {
+            reader.emplace(text);
+        }
+        visitOccurrences(*id,
+                         0,
+                         m_blockStarts.back() + m_blocks.back().length,
+                         false,
+                         [&](qint64 position)
+                         {
+                             if (!reader || reader->equals(position, word))
+                             {
+                                 positions.push_back(position);
+                             }
+                             return false;
+                         });
+        return positions;
+    }
+
+    qsizetype WordIndex::count(QStringView word) const
+    {
+        QString key;
+        foldInto(word, key);
+        const auto id = m_words.constFind(key);
+        if (!isReady() || !isWord(word) || id == m_words.cend())
+        {
+            return 0;
+        }
+        qsizetype total = 0;
+        for (const Block& block : m_blocks)
+        {
+            total += std::ranges::equal_range(block.postings, *id, std::less<>(), &Posting::word).size();
+        }
+        return total;
+    }
+
+    qint64 WordIndex::find(QStringView word,
+                           Qt::CaseSensitivity sensitivity,
+                           const PieceTable& text,
+                           qint64 from,
+                           qint64 until,
+                           bool backward) const
+    {
+        QString key;
+        foldInto(word, key);
+        const auto id = m_words.constFind(key);
+        if (!isReady() || !isWord(word) || id == m_words.cend() || from >= until)
+        {
+            return -1;
+        }
+        std::optional<PieceText> reader;
+        if (sensitivity == Qt::CaseSensitive)
+        {
+            reader.emplace(text);
+        }
+        qint64 found = -1;
+        visitOccurrences(*id,
+                         from,
+                         until,
+                         backward,
+                         [&](qint64 position)
+                         {
+                             if (reader && !reader->equals(position, word))
+                             {
+                                 return false;
+                             }
+                             found = position;
+                             return true;
+                         });
+        return found;
+    }
+
+    bool WordIndex::isWord(QStringView term)
+    {
+        return !term.isEmpty() && std::ranges::all_of(term, [](QChar unit) { return unit.isLetterOrNumber(); });
+    }
+
+    qint64 WordIndex::availableMemoryBytes()
+    {
+#ifdef Q_OS_LINUX
+        // procfs files report no size, so the whole file is read rather than tested for its end.
+        QFile meminfo(QStringLiteral("/proc/meminfo"));
+        if (!meminfo.open(QIODevice::ReadOnly))
+        {
+            return -1;
+        }
+        const QByteArray contents = meminfo.readAll();
+        for (const QByteArray& line : contents.split('\n'))
+        {
+            // "MemAvailable:   123456 kB"
+            if (line.startsWith("MemAvailable:"))
+            {
+                bool valid = false;
+                const qint64 kibibytes = line.simplified().split(' ').value(1).toLongLong(&valid);
+                return valid ? kibibytes * 1024 : -1;
+            }
+        }
+        return -1;
+#elifdef _WIN32
+        MEMORYSTATUSEX status{};
+        status.dwLength = sizeof(status);
+        return GlobalMemoryStatusEx(&status) ? static_cast<qint64>(status.ullAvailPhys) : -1;
+#else
+        return -1;
+#endif
+    }
+
+    void WordIndex::deliver(const std::shared_ptr<RunState>& state)
+    {
+        if (state != m_activeRun)
+        {
+            return;
+        }
+        m_activeRun.reset();
+        if (state->overLimit)
+        {
+            drop(DropReason::MemoryLimit);
+            return;
+        }
+
+        m_words = std::move(state->words);
+        m_dictionaryBytes = state->dictionaryBytes;
+        m_postingBytes = state->postingBytes;
+        for (std::vector<Block>& part : state->parts)
+        {
+            m_blocks.insert(m_blocks.end(), std::make_move_iterator(part.begin()), std::make_move_iterator(part.end()));
+        }
+        if (m_blocks.empty())
+        {
+            m_blocks.emplace_back();
+        }
+        recomputeStarts();
+        m_state = State::Ready;
+        emit ready();
+    }
+
+    void WordIndex::cancelRun()
+    {
+        m_rebuildTimer->stop();
+        m_rebuildText = PieceTable();
+        if (m_activeRun)
+        {
+            m_activeRun->cancelled = true;
+            m_activeRun.reset();
+        }
+        // Tasks that never started are dropped; running ones notice the flag within a block.
+        m_pool.clear();
+    }
+
+    void WordIndex::reset()
+    {
+        m_words.clear();
+        m_blocks.clear();
+        m_blockStarts.clear();
+        m_dictionaryBytes = 0;
+        m_postingBytes = 0;
+    }
+
+    void WordIndex::drop(DropReason reason)
+    {
+        clear();
+        emit dropped(reason);
+    }
+
+    void WordIndex::checkMemory()
+    {
+        const qint64 available = availableMemoryBytes();
+        if (m_state != State::Off && available >= 0 && available < MinFreeMemoryBytes)
+        {
+            drop(DropReason::LowMemory);
+        }
+    }
+
+    void WordIndex::scheduleRebuild(const PieceTable& text)
+    {
+        cancelRun();
+        reset();
+        m_state = State::Building;
+        m_rebuildText = text;
+        m_rebuildTimer->start();
+    }
+
+    qsizetype WordIndex::blockAt(qint64 position) const
+    {
+        const auto after = std::ranges::upper_bound(m_blockStarts, position);
+        return std::max<qsizetype>(std::distance(m_blockStarts.begin(), after) - 1, 0);
+    }
+
+    void WordIndex::recomputeStarts()
+    {
+        m_blockStarts.resize(m_blocks.size());
+        qint64 start = 0;
+        for (std::size_t index = 0; index < m_blocks.size(); ++index)
+        {
+            m_blockStarts[index] = start;
+            start += m_blocks[index].length;
+        }
+    }
+
+    // Visits the occurrences starting in [from, until) in document order, or in reverse when backward, until visit
+    // returns true.
+    template <typename Visit> void WordIndex::visitOccurrences(quint32 word, qint64 from, qint64 until, bool backward, Visit&& visit) const
+    {
+        const qsizetype first = blockAt(from);
+        const qsizetype last = blockAt(until - 1);
+        for (qsizetype step = 0; step <= last - first; ++step)
+        {
+            const auto index = static_cast<std::size_t>(backward ? last - step : first + step);
+            const qint64 blockStart = m_blockStarts[index];
+            const auto postings = std::ranges::equal_range(m_blocks[index].postings, word, std::less<>(), &Posting::word);
+            const auto visitPosting = [&](const Posting& posting)
+            {
+                const qint64 position = blockStart + posting.offset;
+                return position >= from && position < until && visit(position);
+            };
+            if (backward ? std::ranges::any_of(postings | std::views::reverse, visitPosting) : std::ranges::any_of(postings, visitPosting))
+            {
+                return;
+            }
+        }
+    }
+
+} // namespace GnotePad::core
@@ -0,0 +1,168 @@
+#pragma once
+
+#include "core/PieceTable.h"
+
+#include <QtCore/qhash.h>
+#include <QtCore/qnamespace.h>
+#include <QtCore/qobject.h>
+#include <QtCore/qstring.h>
+#include <QtCore/qstringview.h>
+#include <QtCore/qthreadpool.h>
+#include <QtCore/qtypes.h>
+
+#include <memory>
+#include <vector>
+
+class QTimer;
+
+namespace GnotePad::core
+{
+
+    // Where every word of the document occurs, so whole-word searches and occurrence counts answer from a
+    // lookup instead of a scan. A word is a maximal run of letters and digits, exactly what a whole-word
+    // search accepts, and words are indexed case-folded; case-sensitive queries check each candidate against
+    // the text. The document is cut into blocks of about BlockChars, each holding its words' offsets sorted by
+    // word, so an edit re-reads only the blocks it touched. The first build runs in parallel over a piece-table
+    // snapshot. The index gives itself up rather than grow past its memory limit or eat the last of the
+    // machine's free memory.
+    class WordIndex : public QObject
+    {
+        Q_OBJECT
+
+    public:
+        enum class State
+        {
+            Off,
+            Building,
+            Ready
+        };
+
+        enum class DropReason
+        {
+            MemoryLimit,
+            LowMemory
+        };
+
+        explicit WordIndex(QObject* parent = nullptr);
+        ~WordIndex() override;
+
+        WordIndex(const WordIndex&) = delete;
+        WordIndex& operator=(const WordIndex&) = delete;
+        WordIndex(WordIndex&&) = delete;
+        WordIndex& operator=(WordIndex&&) = delete;
+
+        // Drops the current index and indexes text in the background; jobs <= 0 means one task per core.
+        void build(PieceTable text, int jobs = 0);
+
+        void clear();
+
+        // Mirrors an edit of the document; text is the document after it. An edit that lands mid-build, or one
+        // too large to re-read on the spot, starts the build over once edits pause.
+        void applyEdit(qint64 position, qint64 charsRemoved, qint64 charsAdded, const PieceTable& text);
+
+        [[nodiscard]] State state() const
+        {
+            return m_state;
+        }
+
+        [[nodiscard]] bool isReady() const
+        {
+            return m_state == State::Ready;
+        }
+
+        // Estimated heap use of the index.
+        [[nodiscard]] qint64 memoryBytes() const
+        {
+            return m_dictionaryBytes + m_postingBytes;
+        }
+
+        [[nodiscard]] qsizetype wordCount() const
+        {
+            return m_words.size();
+        }
+
+        [[nodiscard]] qint64 memoryLimit() const
+        {
+            return m_memoryLimit;
+        }
+
+        // Drops the index at once if it is already larger.
+        void setMemoryLimit(qint64 bytes);
+
+        // Start of every occurrence of word in text, in document order. text must be the indexed document.
+        [[nodiscard]] std::vector<qint64> occurrences(QStringView word, Qt::CaseSensitivity sensitivity, const PieceTable& text) const;
+
+        // Occurrences of word, ignoring case; no text is read.
+        [[nodiscard]] qsizetype count(QStringView word) const;
+
+        // Like LiteralSearch::find with whole words: the first occurrence starting in [from, until), or the last
+        // one when backward, or -1.
+        [[nodiscard]] qint64 find(QStringView word,
+                                  Qt::CaseSensitivity sensitivity,
+                                  const PieceTable& text,
+                                  qint64 from,
+                                  qint64 until,
+                                  bool backward) const;
+
+        // Whether term is a single word the index can answer for.
+        [[nodiscard]] static bool isWord(QStringView term);
+
+        // Bytes of memory the system could still hand out, or -1 where that cannot be told.
+        [[nodiscard]] static qint64 availableMemoryBytes();
+
+        static constexpr qint64 BlockChars = 64LL * 1024;
+        static constexpr qint64 DefaultMemoryLimitBytes = 512LL * 1024 * 1024;
+        // Below this much free memory the index is dropped, and not built.
+        static constexpr qint64 MinFreeMemoryBytes = 256LL * 1024 * 1024;
+        static constexpr int MemoryCheckIntervalMs = 5000;
+        // Quiet time after an edit before an interrupted build starts over.
+        static constexpr int RebuildDelayMs = 500;
+        // Edits spanning more blocks than this are not re-read on the GUI thread.
+        static constexpr qint64 MaxEditBlocks = 16;
+
+        // One occurrence: the word's id and its offset from the start of its block.
+        struct Posting
+        {
+            quint32 word{0};
+            quint32 offset{0};
+        };
+
+        struct Block
+        {
+            qint64 length{0};
+            // Sorted by word, then offset.
+            std::vector<Posting> postings;
+        };
+
+    signals:
+        void ready();
+        void dropped(GnotePad::core::WordIndex::DropReason reason);
+
+    private:
+        struct RunState;
+
+        void deliver(const std::shared_ptr<RunState>& state);
+        void cancelRun();
+        void reset();
+        void drop(DropReason reason);
+        void checkMemory();
+        void scheduleRebuild(const PieceTable& text);
+        [[nodiscard]] qsizetype blockAt(qint64 position) const;
+        void recomputeStarts();
+        template <typename Visit> void visitOccurrences(quint32 word, qint64 from, qint64 until, bool backward, Visit&& visit) const;
+
+        State m_state{State::Off};
+        QHash<QString, quint32> m_words;
+        std::vector<Block> m_blocks;
+        std::vector<qint64> m_blockStarts;
+        qint64 m_dictionaryBytes{0};
+        qint64 m_postingBytes{0};
+        qint64 m_memoryLimit{DefaultMemoryLimitBytes};
+        PieceTable m_rebuildText;
+        QTimer* const m_rebuildTimer;
+        QTimer* const m_memoryTimer;
+        std::shared_ptr<RunState> m_activeRun;
+        QThreadPool m_pool;
+    };
+
+} // namespace GnotePad::core
@@ -1,7 +1,14 @@
 #include "app/Application.h"
+#include "app/ReplaceCommand.h"
 
 int main(int argc, char* argv[])
 {
+    // Batch replace never touches a widget, so it runs before QApplication would need a display.
+    if (GnotePad::ReplaceCommand::requested(argc, argv))
+    {
+        return GnotePad::ReplaceCommand::run(argc, argv);
+    }
+
     GnotePad::Application app(argc, argv);
     return app.run();
 }
@@ -0,0 +1,125 @@
+#include "ui/FindBar.h"
+
+#include <QtGui/qevent.h>
+#include <QtGui/qguiapplication.h>
+#include <QtWidgets/qboxlayout.h>
+#include <QtWidgets/qcheckbox.h>
+#include <QtWidgets/qlabel.h>
+#include <QtWidgets/qlineedit.h>
+#include <QtWidgets/qtoolbutton.h>
+
+#include <QSignalBlocker>
+
+// NOTE: Qt parent-child ownership deletes child QObjects automatically, so raw pointers
+// assigned from new within this file are intentional and safe.
+
+namespace GnotePad::ui
+{
+
+    FindBar::FindBar(QWidget* parent) : QWidget(parent)
+    {
+        // NOLINTBEGIN(cppcoreguidelines-owning-memory)
+        auto* const layout = new QHBoxLayout(this);
+        auto* const label = new QLabel(tr("Find:"), this);
+        m_field = new QLineEdit(this);
+        m_matchCase = new QCheckBox(tr("Match case"), this);
+        m_previousButton = new QToolButton(this);
+        m_nextButton = new QToolButton(this);
+        m_status = new QLabel(this);
+        m_closeButton = new QToolButton(this);
+        // NOLINTEND(cppcoreguidelines-owning-memory)
+
+        layout->setContentsMargins(4, 2, 4, 2);
+        layout->addWidget(label);
+        layout->addWidget(m_field, 1);
+        layout->addWidget(m_previousButton);
+        layout->addWidget(m_nextButton);
+        layout->addWidget(m_matchCase);
+        layout->addWidget(m_status);
+        layout->addWidget(m_closeButton);
+
+        label->setBuddy(m_field);
+        m_field->setClearButtonEnabled(true);
+        m_previousButton->setText(tr("Previous"));
+        m_nextButton->setText(tr("Next"));
+        m_closeButton->setText(tr("Close"));
+
+        const auto reportTerm = [this]() { emit termEdited(term(), caseSensitivity()); };
+        connect(m_field, &QLineEdit::textEdited, this, reportTerm);
+        connect(m_matchCase, &QCheckBox::toggled, this, reportTerm);
+        connect(m_field,
+                &QLineEdit::returnPressed,
+                this,
+                [this]()
+                {
+                    if (QGuiApplication::keyboardModifiers().testFlag(Qt::ShiftModifier))
+                    {
+                        emit findPreviousRequested();
+                    }
+                    else
+                    {
+                        emit findNextRequested();
+                    }
+                });
+        connect(m_previousButton, &QToolButton::clicked, this, &FindBar::findPreviousRequested);
+        connect(m_nextButton, &QToolButton::clicked, this, &FindBar::findNextRequested);
+        connect(m_closeButton, &QToolButton::clicked, this, &FindBar::closeRequested);
+    }
+
+    QString FindBar::term() const
+    {
+        return m_field->text();
+    }
+
+    Qt::CaseSensitivity FindBar::caseSensitivity() const
+    {
+        return m_matchCase->isChecked() ? Qt::CaseSensitive : Qt::CaseInsensitive;
+    }
+
+    void FindBar::setTerm(const QString& term)
+    {
+        m_field->setText(term);
+    }
+
+    void FindBar::setCaseSensitivity(Qt::CaseSensitivity sensitivity)
+    {
+        const QSignalBlocker blocker(m_matchCase);
+        m_matchCase->setChecked(sensitivity == Qt::CaseSensitive);
+    }
+
+    void FindBar::activate()
+    {
+        show();
+        m_field->setFocus(Qt::ShortcutFocusReason);
+        m_field->selectAll();
+    }
+
+    void FindBar::setStatus(const QString& status)
+    {
+        m_status->setText(status);
+    }
+
+    bool FindBar::event(QEvent* event)
+    {
+        // The shortcut override reaches the term field first and, unclaimed, bubbles up here; accepting it turns
+        // Escape back into a plain key press for keyPressEvent instead of firing the window's Cancel shortcut.
+        if (event->type() == QEvent::ShortcutOverride && static_cast<QKeyEvent*>(event)->key() == Qt::Key_Escape)
+        {
+            event->accept();
+            return true;
+        }
+        return QWidget::event(event);
+    }
+
+    void FindBar::keyPressEvent(QKeyEvent* event)
+    {
+        if (event->key() == Qt::Key_Escape)
+        {
+            emit closeRequested();
+            event->accept();
+            return;
+        }
+        QWidget::keyPressEvent(event);
+    }
+
+} // namespace GnotePad::ui
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <QtCore/qnamespace.h>
+#include <QtCore/qobject.h>
+#include <QtCore/qstring.h>
+#include <QtWidgets/qwidget.h>
+
+class QCheckBox;
+class QEvent;
+class QKeyEvent;
+class QLabel;
+class QLineEdit;
+class QToolButton;
+
+namespace GnotePad::ui
+{
+
+    // Non-modal find bar below the editor. Every edit of the term is reported straight away so the owner can
+    // search as the user types; Enter and Shift+Enter step to the next and previous match and Escape closes.
+    class FindBar : public QWidget
+    {
+        Q_OBJECT
+
+    public:
+        explicit FindBar(QWidget* parent = nullptr);
+
+        [[nodiscard]] QString term() const;
+        [[nodiscard]] Qt::CaseSensitivity caseSensitivity() const;
+
+        // Neither emits termEdited().
+        void setTerm(const QString& term);
+        void setCaseSensitivity(Qt::CaseSensitivity sensitivity);
+
+        // Shows the bar and puts the caret in the term field with the term selected.
+        void activate();
+        void setStatus(const QString& status);
+
+    signals:
+        void termEdited(const QString& term, Qt::CaseSensitivity sensitivity);
+        void findNextRequested();
+        void findPreviousRequested();
+        void closeRequested();
+
+    protected:
+        // Claims Escape before window shortcuts see it, so Escape closes the bar even while Cancel Loading is armed.
+        bool event(QEvent* event) override;
+        void keyPressEvent(QKeyEvent* event) override;
+
+    private:
+        QLineEdit* m_field{nullptr};
+        QCheckBox* m_matchCase{nullptr};
+        QToolButton* m_previousButton{nullptr};
+        QToolButton* m_nextButton{nullptr};
+        QLabel* m_status{nullptr};
+        QToolButton* m_closeButton{nullptr};
+    };
+
+} // namespace GnotePad::ui
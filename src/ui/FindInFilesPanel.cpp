@@ -0,0 +1,109 @@
+#include "ui/FindInFilesPanel.h"
+
+#include "core/LiteralSearch.h"
+
+#include <QtCore/qdir.h>
+#include <QtCore/qvariant.h>
+#include <QtWidgets/qboxlayout.h>
+#include <QtWidgets/qlabel.h>
+#include <QtWidgets/qtoolbutton.h>
+#include <QtWidgets/qtreewidget.h>
+
+// NOTE: Qt parent-child ownership deletes child QObjects automatically, so raw pointers
+// assigned from new within this file are intentional and safe.
+
+namespace GnotePad::ui
+{
+
+    namespace
+    {
+        constexpr int kFilePathRole = Qt::UserRole;
+        constexpr int kLineNumberRole = Qt::UserRole + 1;
+    } // namespace
+
+    FindInFilesPanel::FindInFilesPanel(QWidget* parent) : QWidget(parent), m_search(new core::FileSearch(this))
+    {
+        // NOLINTBEGIN(cppcoreguidelines-owning-memory)
+        auto* const layout = new QVBoxLayout(this);
+        auto* const header = new QHBoxLayout();
+        m_status = new QLabel(this);
+        m_cancelButton = new QToolButton(this);
+        m_results = new QTreeWidget(this);
+        // NOLINTEND(cppcoreguidelines-owning-memory)
+
+        layout->setContentsMargins(0, 0, 0, 0);
+        layout->addLayout(header);
+        layout->addWidget(m_results);
+        header->addWidget(m_status, 1);
+        header->addWidget(m_cancelButton);
+
+        m_cancelButton->setText(tr("Cancel"));
+        m_cancelButton->setEnabled(false);
+        m_results->setHeaderHidden(true);
+        m_results->setUniformRowHeights(true);
+        m_results->setRootIsDecorated(true);
+
+        connect(m_cancelButton, &QToolButton::clicked, this, &FindInFilesPanel::cancel);
+        connect(m_results, &QTreeWidget::itemActivated, this, [this](QTreeWidgetItem* item, int) { activateItem(item); });
+        connect(m_search, &core::FileSearch::fileMatched, this, &FindInFilesPanel::addFileHits);
+        connect(m_search, &core::FileSearch::finished, this, &FindInFilesPanel::finishSearch);
+    }
+
+    void FindInFilesPanel::start(const QString& directory,
+                                 const QStringList& nameFilters,
+                                 const QString& term,
+                                 Qt::CaseSensitivity sensitivity)
+    {
+        m_results->clear();
+        m_hitCount = 0;
+        m_directory = directory;
+        m_status->setText(tr("Searching for \"%1\" in %2...").arg(term, QDir::toNativeSeparators(directory)));
+        m_cancelButton->setEnabled(true);
+        m_search->start(directory, nameFilters, core::LiteralSearch(term, sensitivity));
+    }
+
+    void FindInFilesPanel::cancel()
+    {
+        if (!m_search->isRunning())
+        {
+            return;
+        }
+        m_search->cancel();
+        m_cancelButton->setEnabled(false);
+        m_status->setText(tr("Search cancelled: %1 hit(s) in %2 file(s)").arg(m_hitCount).arg(m_results->topLevelItemCount()));
+    }
+
+    void FindInFilesPanel::addFileHits(const QString& filePath, const QList<core::FileSearch::Hit>& hits)
+    {
+        const QDir directory(m_directory);
+        // NOLINTBEGIN(cppcoreguidelines-owning-memory)
+        auto* const fileItem = new QTreeWidgetItem(m_results);
+        fileItem->setText(0, tr("%1 (%2)").arg(QDir::toNativeSeparators(directory.relativeFilePath(filePath))).arg(hits.size()));
+        fileItem->setData(0, kFilePathRole, filePath);
+        fileItem->setData(0, kLineNumberRole, 1);
+        for (const core::FileSearch::Hit& hit : hits)
+        {
+            auto* const hitItem = new QTreeWidgetItem(fileItem);
+            hitItem->setText(0, tr("Ln %1: %2").arg(hit.line + 1).arg(hit.text));
+            hitItem->setData(0, kFilePathRole, filePath);
+            hitItem->setData(0, kLineNumberRole, hit.line + 1);
+        }
+        // NOLINTEND(cppcoreguidelines-owning-memory)
+        m_hitCount += hits.size();
+    }
+
+    void FindInFilesPanel::finishSearch(qint64 filesSearched, qint64 filesMatched)
+    {
+        m_cancelButton->setEnabled(false);
+        m_status->setText(tr("%1 hit(s) in %2 of %3 file(s)").arg(m_hitCount).arg(filesMatched).arg(filesSearched));
+    }
+
+    void FindInFilesPanel::activateItem(QTreeWidgetItem* item)
+    {
+        if (item)
+        {
+            emit hitActivated(item->data(0, kFilePathRole).toString(), item->data(0, kLineNumberRole).toLongLong());
+        }
+    }
+
+} // namespace GnotePad::ui
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "core/FileSearch.h"
+
+#include <QtCore/qlist.h>
+#include <QtCore/qobject.h>
+#include <QtCore/qstring.h>
+#include <QtCore/qstringlist.h>
+#include <QtCore/qtypes.h>
+#include <QtWidgets/qwidget.h>
+
+class QLabel;
+class QToolButton;
+class QTreeWidget;
+class QTreeWidgetItem;
+
+namespace GnotePad::ui
+{
+
+    // Results of Find in Files: one entry per matching file with its hits beneath, filled in as the search
+    // finds them. Activating a hit asks for the file to be opened at that line.
+    class FindInFilesPanel : public QWidget
+    {
+        Q_OBJECT
+
+    public:
+        explicit FindInFilesPanel(QWidget* parent = nullptr);
+
+        void start(const QString& directory, const QStringList& nameFilters, const QString& term, Qt::CaseSensitivity sensitivity);
+        void cancel();
+
+        [[nodiscard]] bool isSearching() const
+        {
+            return m_search->isRunning();
+        }
+
+        [[nodiscard]] QTreeWidget* results() const
+        {
+            return m_results;
+        }
+
+    signals:
+        // lineNumber is one-based, as Go To Line takes it.
+        void hitActivated(const QString& filePath, qint64 lineNumber);
+
+    private:
+        void addFileHits(const QString& filePath, const QList<core::FileSearch::Hit>& hits);
+        void finishSearch(qint64 filesSearched, qint64 filesMatched);
+        void activateItem(QTreeWidgetItem* item);
+
+        core::FileSearch* const m_search;
+        QLabel* m_status{nullptr};
+        QToolButton* m_cancelButton{nullptr};
+        QTreeWidget* m_results{nullptr};
+        QString m_directory;
+        qint64 m_hitCount{0};
+    };
+
+} // namespace GnotePad::ui
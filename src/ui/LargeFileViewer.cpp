@@ -0,0 +1,793 @@
+#include "ui/LargeFileViewer.h"
+
+#include "core/TextEncoding.h"
+
+#include <spdlog/spdlog.h>
+
+#include <QtCore/qchar.h>
+#include <QtCore/qnamespace.h>
+#include <QtCore/qrect.h>
+#include <QtCore/qstringconverter.h>
+#include <QtCore/qstringliteral.h>
+#include <QtCore/qstringview.h>
+#include <QtCore/qthread.h>
+#include <QtGui/qcolor.h>
+#include <QtGui/qevent.h>
+#include <QtGui/qfontmetrics.h>
+#include <QtGui/qpainter.h>
+#include <QtGui/qpalette.h>
+#include <QtWidgets/qscrollbar.h>
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <utility>
+
+// NOTE: Qt parent-child ownership deletes child QObjects automatically, so raw pointers
+// assigned from new within this file are intentional and safe.
+
+namespace GnotePad::ui
+{
+
+    namespace
+    {
+        // Bytes the indexer scans between progress reports to the GUI thread.
+        constexpr qint64 kIndexBatchBytes = 32LL * 1024 * 1024;
+        // Longer lines are cut off on screen; the rest stays reachable through Find.
+        constexpr qint64 kMaxDisplayedLineBytes = 16LL * 1024;
+        // Scrolling by up to this many lines walks from the current top instead of going through the index.
+        constexpr qint64 kMaxLinesWalked = 256;
+        constexpr int kTextMargin = 4;
+
+        // Bytes the longest character takes, and the most any one UTF-16 unit of a term can take.
+        constexpr qint64 kMaxCharacterBytes = 4;
+        constexpr qint64 kMaxBytesPerUnit = 3;
+
+        // Position in decoded text: a byte offset and the UTF-16 units decoded before it.
+        struct Utf8Cursor
+        {
+            qint64 byte{0};
+            qint64 unit{0};
+        };
+
+        // Moves cursor one character at a time until its byte reaches byteLimit or its unit reaches unitLimit,
+        // counting units the way QString::fromUtf8() decodes them: a byte that does not start a well-formed
+        // sequence becomes one replacement character on its own.
+        void advanceUtf8(QByteArrayView bytes, Utf8Cursor& cursor, qint64 byteLimit, qint64 unitLimit)
+        {
+            while (cursor.byte < byteLimit && cursor.byte < bytes.size() && cursor.unit < unitLimit)
+            {
+                const auto byteAt = [&](qint64 index) { return static_cast<unsigned char>(bytes[cursor.byte + index]); };
+                const unsigned char lead = byteAt(0);
+                qint64 length = 1;
+                if (lead >= 0xC2 && lead <= 0xF4)
+                {
+                    length = lead < 0xE0 ? 2 : (lead < 0xF0 ? 3 : 4);
+                    // The second byte's range also rules out overlong forms, surrogates and code points past U+10FFFF.
+                    const unsigned char low = lead == 0xE0 ? 0xA0 : (lead == 0xF0 ? 0x90 : 0x80);
+                    const unsigned char high = lead == 0xED ? 0x9F : (lead == 0xF4 ? 0x8F : 0xBF);
+                    bool wellFormed = cursor.byte + length <= bytes.size() && byteAt(1) >= low && byteAt(1) <= high;
+                    for (qint64 index = 2; wellFormed && index < length; ++index)
+                    {
+                        wellFormed = (byteAt(index) & 0xC0) == 0x80;
+                    }
+                    length = wellFormed ? length : 1;
+                }
+                cursor.byte += length;
+                cursor.unit += length == 4 ? 2 : 1;
+            }
+        }
+
+        int clampToInt(qint64 value)
+        {
+            return static_cast<int>(std::clamp<qint64>(value, 0, std::numeric_limits<int>::max()));
+        }
+    } // namespace
+
+    struct LargeFileViewer::IndexRun
+    {
+        std::atomic_bool cancelled{false};
+    };
+
+    LargeFileViewer::LineNumberArea::LineNumberArea(LargeFileViewer* viewer) : QWidget(viewer), m_viewer(viewer)
+    {
+        setCursor(Qt::ArrowCursor);
+    }
+
+    QSize LargeFileViewer::LineNumberArea::sizeHint() const
+    {
+        if (!m_viewer)
+        {
+            return {0, 0};
+        }
+        return {m_viewer->lineNumberAreaWidth(), 0};
+    }
+
+    void LargeFileViewer::LineNumberArea::paintEvent(QPaintEvent* event)
+    {
+        if (m_viewer)
+        {
+            m_viewer->lineNumberAreaPaintEvent(event);
+        }
+    }
+
+    LargeFileViewer::LargeFileViewer(QWidget* parent)
+        : QAbstractScrollArea(parent),
+          m_lineNumberArea(new LineNumberArea(this)),
+          m_search(new core::IncrementalSearch(this))
+    {
+        setFocusPolicy(Qt::StrongFocus);
+        connect(m_search, &core::IncrementalSearch::finished, this, &LargeFileViewer::showFoundMatch);
+        viewport()->setCursor(Qt::IBeamCursor);
+        m_lineNumberArea->setVisible(m_lineNumbersVisible);
+        updateGeometries();
+        updateScrollRange();
+    }
+
+    LargeFileViewer::~LargeFileViewer()
+    {
+        // The indexer and the search read straight out of the mapping; both have to be gone before the file is
+        // unmapped.
+        stopIndexing();
+        stopFind();
+    }
+
+    bool LargeFileViewer::openFile(const QString& filePath)
+    {
+        m_errorString.clear();
+
+        // Reading the whole file into memory is what the viewer is there to avoid, so a file that cannot be mapped
+        // is not shown at all. The file shown now is only closed once the new one is mapped and checked.
+        auto file = std::make_unique<core::MappedFile>();
+        if (!file->open(filePath, 0, core::MappedFile::Fallback::Fail))
+        {
+            m_errorString = file->errorString();
+            spdlog::warn("Large file viewer could not map {}: {}", filePath.toStdString(), m_errorString.toStdString());
+            return false;
+        }
+
+        int bomLength = 0;
+        if (core::detectEncoding(file->data(), bomLength) != QStringConverter::Utf8)
+        {
+            return false;
+        }
+
+        closeFile();
+        m_file = std::move(file);
+        m_data = m_file->data();
+        m_dataStart = bomLength;
+        m_index.reset(m_dataStart);
+        m_topOffset = m_dataStart;
+        m_open = true;
+
+        if (!indexingComplete())
+        {
+            startIndexing();
+        }
+        updateGeometries();
+        updateScrollRange();
+        viewport()->update();
+        emit lineCountChanged(lineCount());
+        emit cursorPositionChanged();
+        return true;
+    }
+
+    void LargeFileViewer::closeFile()
+    {
+        stopIndexing();
+        stopFind();
+        m_file.reset();
+        m_data = {};
+        m_dataStart = 0;
+        m_index.reset(0);
+        m_open = false;
+        m_topLine = 0;
+        m_topOffset = 0;
+        m_currentLine = 0;
+        m_match = {};
+        m_pendingMatch = {};
+        m_rowStarts.clear();
+        m_contentWidth = 0;
+        horizontalScrollBar()->setRange(0, 0);
+        updateGeometries();
+        updateScrollRange();
+        viewport()->update();
+    }
+
+    qint64 LargeFileViewer::currentColumn() const
+    {
+        if (!m_open || m_match.offset < 0)
+        {
+            return 0;
+        }
+        const qint64 lineStart = m_index.lineStart(m_data, m_currentLine);
+        return QString::fromUtf8(m_data.sliced(lineStart, m_match.offset - lineStart)).size();
+    }
+
+    void LargeFileViewer::goToLine(qint64 line)
+    {
+        if (!m_open)
+        {
+            return;
+        }
+        m_match = {};
+        setCurrentLine(std::clamp<qint64>(line, 0, m_index.lineCount() - 1), true);
+    }
+
+    bool LargeFileViewer::find(const QString& term, QTextDocument::FindFlags flags)
+    {
+        if (!m_open || term.isEmpty())
+        {
+            return false;
+        }
+
+        // Like the editor's Find: forward starts after the current match, backward before it.
+        qint64 from = findAnchor();
+        if (!flags.testFlag(QTextDocument::FindBackward) && m_match.offset >= 0)
+        {
+            from += m_match.length;
+        }
+        startFind(term, flags, from);
+        return true;
+    }
+
+    qint64 LargeFileViewer::findAnchor() const
+    {
+        if (!m_open)
+        {
+            return 0;
+        }
+        return m_match.offset >= 0 ? m_match.offset : m_index.lineStart(m_data, m_currentLine);
+    }
+
+    void LargeFileViewer::findIncrementally(const QString& term, QTextDocument::FindFlags flags, qint64 anchor)
+    {
+        if (!m_open || term.isEmpty())
+        {
+            cancelFind();
+            return;
+        }
+        flags &= ~QTextDocument::FindBackward;
+        startFind(term, flags, anchor);
+    }
+
+    void LargeFileViewer::cancelFind()
+    {
+        m_search->cancel();
+        m_pendingMatch = {};
+    }
+
+    void LargeFileViewer::startFind(const QString& term, QTextDocument::FindFlags flags, qint64 from)
+    {
+        const core::LiteralSearch search(term,
+                                         flags.testFlag(QTextDocument::FindCaseSensitively) ? Qt::CaseSensitive : Qt::CaseInsensitive,
+                                         flags.testFlag(QTextDocument::FindWholeWords));
+        const bool backward = flags.testFlag(QTextDocument::FindBackward);
+        m_pendingMatch = {};
+        m_findUnits = search.termLength();
+        m_search->start([this, search, backward](qint64 sliceFrom, qint64 until) { return searchFrom(search, sliceFrom, until, backward); },
+                        m_dataStart,
+                        std::clamp<qint64>(from, m_dataStart, m_data.size()),
+                        m_data.size(),
+                        backward);
+    }
+
+    void LargeFileViewer::showFoundMatch(qint64 offset)
+    {
+        if (offset < 0)
+        {
+            emit findFinished(false);
+            return;
+        }
+        // Case folding can match characters of another encoded length than the term's, so the match's bytes are
+        // counted from its units.
+        Utf8Cursor end{offset, 0};
+        advanceUtf8(m_data, end, m_data.size(), m_findUnits);
+        m_pendingMatch = {offset, end.byte - offset};
+        showPendingMatch();
+    }
+
+    void LargeFileViewer::showPendingMatch()
+    {
+        // Counting lines up to a match the indexer has not reached would walk the mapping on the GUI thread; the
+        // match waits for the batch that covers it instead.
+        const qint64 line = m_index.lineAt(m_data, m_pendingMatch.offset);
+        if (line < 0)
+        {
+            return;
+        }
+        m_match = std::exchange(m_pendingMatch, {});
+        setCurrentLine(line, true);
+        ensureMatchVisible();
+        emit findFinished(true);
+    }
+
+    void LargeFileViewer::stopFind()
+    {
+        cancelFind();
+        m_search->waitForDone();
+    }
+
+    qint64 LargeFileViewer::searchFrom(const core::LiteralSearch& search, qint64 from, qint64 until, bool backward) const
+    {
+        // The slice is decoded with one character of context on either side for the whole-word check, and enough
+        // bytes past until for a match that starts before it.
+        const qint64 windowStart = std::max(m_dataStart, from - kMaxCharacterBytes);
+        const qint64 windowEnd =
+            std::min<qint64>(m_data.size(), until + (search.termLength() * kMaxBytesPerUnit) + kMaxCharacterBytes);
+        const QByteArrayView bytes = m_data.sliced(windowStart, windowEnd - windowStart);
+        const QString text = QString::fromUtf8(bytes);
+
+        Utf8Cursor first;
+        advanceUtf8(bytes, first, from - windowStart, std::numeric_limits<qint64>::max());
+        Utf8Cursor last = first;
+        advanceUtf8(bytes, last, until - windowStart, std::numeric_limits<qint64>::max());
+
+        const qint64 match = search.find({QStringView(text)}, first.unit, last.unit, backward);
+        if (match < 0)
+        {
+            return -1;
+        }
+        Utf8Cursor found = first;
+        advanceUtf8(bytes, found, bytes.size(), match);
+        return windowStart + found.byte;
+    }
+
+    void LargeFileViewer::setDisplayFont(const QFont& font)
+    {
+        setFont(font);
+        m_rowStarts.clear();
+        m_contentWidth = 0;
+        updateGeometries();
+        updateScrollRange();
+        viewport()->update();
+    }
+
+    void LargeFileViewer::setTabSizeSpaces(int spaces)
+    {
+        m_tabSizeSpaces = std::max(1, spaces);
+        m_contentWidth = 0;
+        viewport()->update();
+    }
+
+    void LargeFileViewer::setLineNumbersVisible(bool visible)
+    {
+        if (m_lineNumbersVisible == visible)
+        {
+            return;
+        }
+
+        m_lineNumbersVisible = visible;
+        m_lineNumberArea->setVisible(m_lineNumbersVisible);
+        updateGeometries();
+    }
+
+    int LargeFileViewer::lineNumberAreaWidth() const
+    {
+        if (!m_lineNumbersVisible)
+        {
+            return 0;
+        }
+
+        int digits = 1;
+        qint64 max = std::max<qint64>(1, m_index.lineCount());
+        while (max >= 10)
+        {
+            max /= 10;
+            ++digits;
+        }
+
+        return 8 + (fontMetrics().horizontalAdvance(QLatin1Char('9')) * digits);
+    }
+
+    void LargeFileViewer::lineNumberAreaPaintEvent(QPaintEvent* event)
+    {
+        if (!m_lineNumbersVisible)
+        {
+            return;
+        }
+
+        QPainter painter(m_lineNumberArea);
+        painter.fillRect(event->rect(), palette().alternateBase());
+        painter.setRenderHint(QPainter::TextAntialiasing, true);
+
+        const QColor inactiveColor = palette().color(QPalette::Disabled, QPalette::Text);
+        const QColor activeColor = palette().color(QPalette::Text);
+        const int height = lineHeight();
+        const auto& rows = visibleRowStarts();
+        for (std::size_t row = 0; row < rows.size(); ++row)
+        {
+            const qint64 line = m_topLine + static_cast<qint64>(row);
+            painter.setPen(line == m_currentLine ? activeColor : inactiveColor);
+            painter.drawText(0,
+                             static_cast<int>(row) * height,
+                             m_lineNumberArea->width() - 6,
+                             fontMetrics().height(),
+                             Qt::AlignRight,
+                             QString::number(line + 1));
+        }
+    }
+
+    void LargeFileViewer::paintEvent(QPaintEvent* event)
+    {
+        QPainter painter(viewport());
+        painter.fillRect(event->rect(), palette().base());
+        if (!m_open)
+        {
+            return;
+        }
+
+        const QFontMetrics metrics(font());
+        const int height = lineHeight();
+        const int left = kTextMargin - horizontalScrollBar()->value();
+        const auto& rows = visibleRowStarts();
+        int widest = m_contentWidth;
+        for (std::size_t row = 0; row < rows.size(); ++row)
+        {
+            const qint64 line = m_topLine + static_cast<qint64>(row);
+            const qint64 start = rows[row];
+            const int top = static_cast<int>(row) * height;
+            const int baseline = top + metrics.ascent();
+            const QByteArrayView bytes = displayedBytes(start);
+            const QString text = displayText(bytes);
+
+            if (line == m_currentLine)
+            {
+                painter.fillRect(QRect(0, top, viewport()->width(), height), palette().alternateBase());
+            }
+            painter.setPen(palette().color(QPalette::Text));
+            painter.drawText(left, baseline, text);
+            widest = std::max(widest, metrics.horizontalAdvance(text));
+
+            if (m_match.offset >= start && m_match.offset + m_match.length <= start + bytes.size())
+            {
+                const qint64 matchStart = m_match.offset - start;
+                const QString before = displayText(bytes.first(matchStart));
+                const QString matched = displayText(bytes.first(matchStart + m_match.length)).sliced(before.size());
+                const int x = left + metrics.horizontalAdvance(before);
+                painter.fillRect(QRect(x, top, metrics.horizontalAdvance(matched), height), palette().highlight());
+                painter.setPen(palette().color(QPalette::HighlightedText));
+                painter.drawText(x, baseline, matched);
+            }
+        }
+
+        // The widest line seen so far sets the horizontal range; it only grows while the file stays open.
+        if (widest != m_contentWidth)
+        {
+            m_contentWidth = widest;
+            horizontalScrollBar()->setRange(0, std::max(0, m_contentWidth + (2 * kTextMargin) - viewport()->width()));
+        }
+    }
+
+    void LargeFileViewer::resizeEvent(QResizeEvent* event)
+    {
+        QAbstractScrollArea::resizeEvent(event);
+        m_rowStarts.clear();
+        updateGeometries();
+        updateScrollRange();
+        horizontalScrollBar()->setPageStep(viewport()->width());
+        horizontalScrollBar()->setRange(0, std::max(0, m_contentWidth + (2 * kTextMargin) - viewport()->width()));
+    }
+
+    void LargeFileViewer::keyPressEvent(QKeyEvent* event)
+    {
+        const bool control = event->modifiers().testFlag(Qt::ControlModifier);
+        switch (event->key())
+        {
+        case Qt::Key_Up:
+            moveCurrentLine(-1);
+            break;
+        case Qt::Key_Down:
+            moveCurrentLine(1);
+            break;
+        case Qt::Key_PageUp:
+            moveCurrentLine(-fullyVisibleRows());
+            break;
+        case Qt::Key_PageDown:
+            moveCurrentLine(fullyVisibleRows());
+            break;
+        case Qt::Key_Home:
+            if (control)
+            {
+                moveCurrentLine(-m_currentLine);
+            }
+            else
+            {
+                horizontalScrollBar()->setValue(0);
+            }
+            break;
+        case Qt::Key_End:
+            if (!control)
+            {
+                QAbstractScrollArea::keyPressEvent(event);
+                return;
+            }
+            moveCurrentLine(m_index.lineCount() - 1 - m_currentLine);
+            break;
+        default:
+            QAbstractScrollArea::keyPressEvent(event);
+            return;
+        }
+        event->accept();
+    }
+
+    void LargeFileViewer::mousePressEvent(QMouseEvent* event)
+    {
+        if (!m_open || event->button() != Qt::LeftButton)
+        {
+            QAbstractScrollArea::mousePressEvent(event);
+            return;
+        }
+
+        const auto row = static_cast<std::size_t>(std::max(0, static_cast<int>(event->position().y()) / lineHeight()));
+        if (row < visibleRowStarts().size())
+        {
+            m_match = {};
+            setCurrentLine(m_topLine + static_cast<qint64>(row), false);
+        }
+        event->accept();
+    }
+
+    void LargeFileViewer::wheelEvent(QWheelEvent* event)
+    {
+        if (event->modifiers().testFlag(Qt::ControlModifier))
+        {
+            event->accept();
+            if (event->angleDelta().y() > 0)
+            {
+                emit zoomRequested(1);
+            }
+            else if (event->angleDelta().y() < 0)
+            {
+                emit zoomRequested(-1);
+            }
+            return;
+        }
+
+        QAbstractScrollArea::wheelEvent(event);
+    }
+
+    void LargeFileViewer::scrollContentsBy([[maybe_unused]] int dx, int dy)
+    {
+        if (dy != 0)
+        {
+            moveTopLine(verticalScrollBar()->value());
+            m_lineNumberArea->update();
+        }
+        viewport()->update();
+    }
+
+    void LargeFileViewer::startIndexing()
+    {
+        auto run = std::make_shared<IndexRun>();
+        m_indexRun = run;
+        m_indexThread.reset(QThread::create(
+            [this, run, data = m_data, start = m_dataStart]()
+            {
+                qint64 line = 0;
+                for (qint64 offset = start; offset < data.size() && !run->cancelled;)
+                {
+                    const qint64 to = std::min<qint64>(data.size(), offset + kIndexBatchBytes);
+                    core::ByteLineIndex::Batch batch = core::ByteLineIndex::scan(data, offset, to, line);
+                    line += batch.lineBreaks;
+                    offset = to;
+                    QMetaObject::invokeMethod(
+                        this, [this, run, batch = std::move(batch)]() { deliverIndexBatch(run, batch); }, Qt::QueuedConnection);
+                }
+            }));
+        m_indexThread->setObjectName(QStringLiteral("LargeFileIndexer"));
+        m_indexThread->start();
+    }
+
+    void LargeFileViewer::stopIndexing()
+    {
+        if (m_indexRun)
+        {
+            m_indexRun->cancelled = true;
+            m_indexRun.reset();
+        }
+        if (m_indexThread)
+        {
+            m_indexThread->wait();
+            m_indexThread.reset();
+        }
+    }
+
+    void LargeFileViewer::deliverIndexBatch(const std::shared_ptr<IndexRun>& run, const core::ByteLineIndex::Batch& batch)
+    {
+        if (run != m_indexRun)
+        {
+            return;
+        }
+
+        m_index.append(batch);
+        if (indexingComplete())
+        {
+            stopIndexing();
+        }
+        updateGeometries();
+        updateScrollRange();
+        if (m_pendingMatch.offset >= 0)
+        {
+            showPendingMatch();
+        }
+        emit lineCountChanged(lineCount());
+    }
+
+    void LargeFileViewer::moveTopLine(qint64 line)
+    {
+        line = std::max<qint64>(0, line);
+        const qint64 delta = line - m_topLine;
+        if (delta > 0 && delta <= kMaxLinesWalked)
+        {
+            while (m_topLine < line)
+            {
+                const qint64 next = core::ByteLineIndex::nextLineStart(m_data, m_topOffset);
+                if (next < 0)
+                {
+                    break;
+                }
+                m_topOffset = next;
+                ++m_topLine;
+            }
+        }
+        else if (delta < 0 && -delta <= kMaxLinesWalked)
+        {
+            while (m_topLine > line)
+            {
+                m_topOffset = core::ByteLineIndex::previousLineStart(m_data, m_dataStart, m_topOffset);
+                --m_topLine;
+            }
+        }
+        else if (delta != 0)
+        {
+            m_topOffset = m_index.lineStart(m_data, line);
+            m_topLine = line;
+        }
+        m_rowStarts.clear();
+    }
+
+    void LargeFileViewer::setCurrentLine(qint64 line, bool centered)
+    {
+        m_currentLine = std::max<qint64>(0, line);
+        updateGeometries();
+        updateScrollRange();
+
+        const int rows = fullyVisibleRows();
+        QScrollBar* const scrollBar = verticalScrollBar();
+        if (centered)
+        {
+            scrollBar->setValue(clampToInt(m_currentLine - (rows / 2)));
+        }
+        else if (m_currentLine < m_topLine)
+        {
+            scrollBar->setValue(clampToInt(m_currentLine));
+        }
+        else if (m_currentLine >= m_topLine + rows)
+        {
+            scrollBar->setValue(clampToInt(m_currentLine - rows + 1));
+        }
+
+        viewport()->update();
+        m_lineNumberArea->update();
+        emit cursorPositionChanged();
+    }
+
+    void LargeFileViewer::moveCurrentLine(qint64 delta)
+    {
+        if (!m_open)
+        {
+            return;
+        }
+        m_match = {};
+        setCurrentLine(std::clamp<qint64>(m_currentLine + delta, 0, m_index.lineCount() - 1), false);
+    }
+
+    void LargeFileViewer::updateScrollRange()
+    {
+        const int rows = fullyVisibleRows();
+        verticalScrollBar()->setPageStep(rows);
+        verticalScrollBar()->setRange(0, clampToInt(m_index.lineCount() - rows));
+    }
+
+    void LargeFileViewer::updateGeometries()
+    {
+        const int width = lineNumberAreaWidth();
+        setViewportMargins(width, 0, 0, 0);
+        const QRect cr = contentsRect();
+        m_lineNumberArea->setGeometry(QRect(cr.left(), cr.top(), width, viewport()->height()));
+    }
+
+    void LargeFileViewer::ensureMatchVisible()
+    {
+        if (m_match.offset < 0)
+        {
+            return;
+        }
+
+        const qint64 lineStart = m_index.lineStart(m_data, m_currentLine);
+        const QByteArrayView bytes = displayedBytes(lineStart);
+        if (m_match.offset + m_match.length > lineStart + bytes.size())
+        {
+            return;
+        }
+
+        const QFontMetrics metrics(font());
+        const qint64 matchStart = m_match.offset - lineStart;
+        const int x = kTextMargin + metrics.horizontalAdvance(displayText(bytes.first(matchStart)));
+        const int right = kTextMargin + metrics.horizontalAdvance(displayText(bytes.first(matchStart + m_match.length)));
+        QScrollBar* const scrollBar = horizontalScrollBar();
+        const int visibleWidth = viewport()->width();
+        if (right + kTextMargin > scrollBar->maximum() + visibleWidth)
+        {
+            scrollBar->setMaximum(right + kTextMargin - visibleWidth);
+        }
+        if (x - kTextMargin < scrollBar->value())
+        {
+            scrollBar->setValue(x - kTextMargin);
+        }
+        else if (right + kTextMargin > scrollBar->value() + visibleWidth)
+        {
+            scrollBar->setValue(right + kTextMargin - visibleWidth);
+        }
+    }
+
+    int LargeFileViewer::lineHeight() const
+    {
+        return std::max(1, fontMetrics().lineSpacing());
+    }
+
+    int LargeFileViewer::fullyVisibleRows() const
+    {
+        return std::max(1, viewport()->height() / lineHeight());
+    }
+
+    const std::vector<qint64>& LargeFileViewer::visibleRowStarts()
+    {
+        if (!m_open || !m_rowStarts.empty())
+        {
+            return m_rowStarts;
+        }
+
+        // The mapping never changes while it is shown, so the row starts only move with scrolling and resizing.
+        const int rows = (viewport()->height() / lineHeight()) + 1;
+        qint64 position = m_topOffset;
+        while (static_cast<int>(m_rowStarts.size()) < rows && position >= 0)
+        {
+            m_rowStarts.push_back(position);
+            position = core::ByteLineIndex::nextLineStart(m_data, position);
+        }
+        return m_rowStarts;
+    }
+
+    QByteArrayView LargeFileViewer::displayedBytes(qint64 lineStart) const
+    {
+        const QByteArrayView window = m_data.first(std::min<qint64>(m_data.size(), lineStart + kMaxDisplayedLineBytes));
+        return window.sliced(lineStart, core::ByteLineIndex::lineEnd(window, lineStart) - lineStart);
+    }
+
+    QString LargeFileViewer::displayText(QByteArrayView bytes) const
+    {
+        const QString text = QString::fromUtf8(bytes);
+        if (!text.contains(QLatin1Char('\t')))
+        {
+            return text;
+        }
+
+        QString expanded;
+        expanded.reserve(text.size() + m_tabSizeSpaces);
+        for (const QChar character : text)
+        {
+            if (character == QLatin1Char('\t'))
+            {
+                expanded.append(QString(m_tabSizeSpaces - (expanded.size() % m_tabSizeSpaces), QLatin1Char(' ')));
+            }
+            else
+            {
+                expanded.append(character);
+            }
+        }
+        return expanded;
+    }
+
+} // namespace GnotePad::ui
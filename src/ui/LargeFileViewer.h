@@ -0,0 +1,204 @@
+#pragma once
+
+#include "core/ByteLineIndex.h"
+#include "core/IncrementalSearch.h"
+#include "core/LiteralSearch.h"
+#include "core/MappedFile.h"
+
+#include <QtCore/qbytearrayview.h>
+#include <QtCore/qobject.h>
+#include <QtCore/qsize.h>
+#include <QtCore/qstring.h>
+#include <QtCore/qtypes.h>
+#include <QtGui/qfont.h>
+#include <QtGui/qtextdocument.h>
+#include <QtWidgets/qabstractscrollarea.h>
+#include <QtWidgets/qwidget.h>
+
+#include <memory>
+#include <vector>
+
+class QKeyEvent;
+class QMouseEvent;
+class QPaintEvent;
+class QResizeEvent;
+class QThread;
+class QWheelEvent;
+
+namespace GnotePad::ui
+{
+
+    // Read-only view of a memory-mapped UTF-8 file that never holds more than the visible lines in memory.
+    // Opening maps the file and returns at once; a worker thread then builds a sparse line index over the
+    // mapping and the scroll range grows as it goes. Each paint decodes only the rows on screen. Find searches
+    // the mapped bytes on a worker and Go To Line lands through the index, so files far larger than a QTextDocument
+    // can hold stay browsable.
+    class LargeFileViewer : public QAbstractScrollArea
+    {
+        Q_OBJECT
+
+    public:
+        explicit LargeFileViewer(QWidget* parent = nullptr);
+        ~LargeFileViewer() override;
+
+        LargeFileViewer(const LargeFileViewer&) = delete;
+        LargeFileViewer& operator=(const LargeFileViewer&) = delete;
+        LargeFileViewer(LargeFileViewer&&) = delete;
+        LargeFileViewer& operator=(LargeFileViewer&&) = delete;
+
+        // Returns false when the file cannot be mapped, with errorString() saying why; it is never read into
+        // memory instead. Also returns false, with errorString() empty, for a UTF-16 byte order mark: lines are
+        // decoded as UTF-8 only. A failed open leaves the file shown before in place.
+        bool openFile(const QString& filePath);
+        void closeFile();
+
+        [[nodiscard]] QString errorString() const
+        {
+            return m_errorString;
+        }
+
+        [[nodiscard]] bool isOpen() const
+        {
+            return m_open;
+        }
+
+        [[nodiscard]] qint64 fileSize() const
+        {
+            return m_data.size();
+        }
+
+        [[nodiscard]] bool hasBom() const
+        {
+            return m_dataStart > 0;
+        }
+
+        [[nodiscard]] bool indexingComplete() const
+        {
+            return m_index.scannedTo() >= m_data.size();
+        }
+
+        // Lines indexed so far; final once indexingComplete() is true.
+        [[nodiscard]] qint64 lineCount() const
+        {
+            return m_index.lineCount();
+        }
+
+        [[nodiscard]] qint64 currentLine() const
+        {
+            return m_currentLine;
+        }
+
+        // Zero-based column of the current match on the current line, in characters; 0 without one.
+        [[nodiscard]] qint64 currentColumn() const;
+
+        // Moves the current line (zero-based) and scrolls it to the middle of the view.
+        void goToLine(qint64 line);
+
+        // Starts searching the file on a worker from the current match or line, wrapping around once;
+        // findFinished() reports the outcome. Each slice is decoded and matched with core::LiteralSearch, so case
+        // folding and whole words work as in the editor. Returns false, starting nothing, when there is nothing to
+        // search.
+        bool find(const QString& term, QTextDocument::FindFlags flags = {});
+
+        // Byte offset find-as-you-type starts from: the current match, or the start of the current line.
+        [[nodiscard]] qint64 findAnchor() const;
+
+        // Like find(), but forward from anchor whatever the flags say.
+        void findIncrementally(const QString& term, QTextDocument::FindFlags flags, qint64 anchor);
+
+        // Each find supersedes the one before it; this drops the last one without starting another.
+        void cancelFind();
+
+        void setDisplayFont(const QFont& font);
+        void setTabSizeSpaces(int spaces);
+        void setLineNumbersVisible(bool visible);
+
+        [[nodiscard]] int lineNumberAreaWidth() const;
+        void lineNumberAreaPaintEvent(QPaintEvent* event);
+
+    signals:
+        void cursorPositionChanged();
+        void lineCountChanged(qint64 lineCount);
+        // Ctrl+wheel; the owner applies the step to the editor zoom and hands the resulting font back.
+        void zoomRequested(int steps);
+        // A match lands once the index reaches its line, so found comes after the view has moved to it.
+        void findFinished(bool found);
+
+    protected:
+        void paintEvent(QPaintEvent* event) override;
+        void resizeEvent(QResizeEvent* event) override;
+        void keyPressEvent(QKeyEvent* event) override;
+        void mousePressEvent(QMouseEvent* event) override;
+        void wheelEvent(QWheelEvent* event) override;
+        void scrollContentsBy(int dx, int dy) override;
+
+    private:
+        class LineNumberArea;
+        struct IndexRun;
+
+        struct Match
+        {
+            qint64 offset{-1};
+            qint64 length{0};
+        };
+
+        void startIndexing();
+        void stopIndexing();
+        void deliverIndexBatch(const std::shared_ptr<IndexRun>& run, const core::ByteLineIndex::Batch& batch);
+        void moveTopLine(qint64 line);
+        void setCurrentLine(qint64 line, bool centered);
+        void moveCurrentLine(qint64 delta);
+        void updateScrollRange();
+        void updateGeometries();
+        void ensureMatchVisible();
+        void startFind(const QString& term, QTextDocument::FindFlags flags, qint64 from);
+        void showFoundMatch(qint64 offset);
+        void showPendingMatch();
+        void stopFind();
+        // Byte offset of the first match starting in [from, until), or the last one when backward; -1 without one.
+        [[nodiscard]] qint64 searchFrom(const core::LiteralSearch& search, qint64 from, qint64 until, bool backward) const;
+        [[nodiscard]] int lineHeight() const;
+        [[nodiscard]] int fullyVisibleRows() const;
+        [[nodiscard]] const std::vector<qint64>& visibleRowStarts();
+        [[nodiscard]] QByteArrayView displayedBytes(qint64 lineStart) const;
+        [[nodiscard]] QString displayText(QByteArrayView bytes) const;
+
+        LineNumberArea* const m_lineNumberArea;
+        core::IncrementalSearch* const m_search;
+        std::unique_ptr<core::MappedFile> m_file;
+        QByteArrayView m_data;
+        qint64 m_dataStart{0};
+        core::ByteLineIndex m_index;
+        std::shared_ptr<IndexRun> m_indexRun;
+        std::unique_ptr<QThread> m_indexThread;
+        bool m_open{false};
+        QString m_errorString;
+        bool m_lineNumbersVisible{true};
+        int m_tabSizeSpaces{4};
+        qint64 m_topLine{0};
+        qint64 m_topOffset{0};
+        qint64 m_currentLine{0};
+        Match m_match;
+        // A match found beyond the lines indexed so far, shown once the indexer gets there.
+        Match m_pendingMatch;
+        // UTF-16 length of the term searched for.
+        qint64 m_findUnits{0};
+        std::vector<qint64> m_rowStarts;
+        int m_contentWidth{0};
+    };
+
+    class LargeFileViewer::LineNumberArea : public QWidget
+    {
+    public:
+        explicit LineNumberArea(LargeFileViewer* viewer);
+
+        [[nodiscard]] QSize sizeHint() const override;
+
+    protected:
+        void paintEvent(QPaintEvent* event) override;
+
+    private:
+        LargeFileViewer* const m_viewer;
+    };
+
+} // namespace GnotePad::ui
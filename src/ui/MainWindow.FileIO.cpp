@@ -1,24 +1,38 @@
 #include "ui/MainWindow.h"
 
 #include "app/Application.h"
+#include "core/Compression.h"
+#include "core/DocumentLoader.h"
+#include "core/DocumentReader.h"
+#include "core/DocumentSaver.h"
+#include "core/EncodedFileWriter.h"
+#include "core/InputStreamReader.h"
+#include "core/LineIndex.h"
+#include "ui/LargeFileViewer.h"
 #include "ui/TextEditor.h"
 
 #include <spdlog/spdlog.h>
 
-#include <QtCore/qbytearray.h>
 #include <QtCore/qfile.h>
 #include <QtCore/qfileinfo.h>
-#include <QtCore/qiodevice.h>
-#include <QtCore/qsavefile.h>
+#include <QtCore/qpoint.h>
 #include <QtCore/qstring.h>
 #include <QtCore/qstringconverter.h>
 #include <QtCore/qstringliteral.h>
+#include <QtCore/qstringlist.h>
+#include <QtGui/qtextcursor.h>
+#include <QtGui/qtextdocument.h>
 #include <QtWidgets/qfiledialog.h>
 #include <QtWidgets/qinputdialog.h>
 #include <QtWidgets/qmessagebox.h>
+#include <QtWidgets/qprogressbar.h>
+#include <QtWidgets/qstackedwidget.h>
+#include <QtWidgets/qstatusbar.h>
+#include <QtWidgets/qtoolbutton.h>
 
 #include <algorithm>
 #include <array>
+#include <optional>
 
 namespace GnotePad::ui
 {
@@ -30,21 +44,39 @@ namespace GnotePad::ui
             return;
         }
 
-        const auto filePath =
-            QFileDialog::getOpenFileName(this, tr("Open"), dialogDirectory(m_lastOpenDirectory), tr("Text Files (*.txt);;All Files (*.*)"));
-        if (filePath.isEmpty())
+        const QStringList filePaths = QFileDialog::getOpenFileNames(
+            this, tr("Open"), dialogDirectory(m_lastOpenDirectory), tr("Text Files (*.txt);;Compressed Files (*.gz *.zst);;All Files (*.*)"));
+        if (filePaths.isEmpty())
         {
             return;
         }
 
-        if (loadDocumentFromPath(filePath))
+        if (filePaths.size() == 1)
         {
-            spdlog::info("Loaded file {}", filePath.toStdString());
+            if (loadDocumentFromPath(filePaths.front()) && !documentLoadInProgress())
+            {
+                spdlog::info("Loaded file {}", filePaths.front().toStdString());
+            }
+            return;
         }
+
+        // The unsaved-changes prompt has been answered, so the first file may take this window's place.
+        openFiles(filePaths, true);
     }
 
     void MainWindow::handleSaveFile()
     {
+        if (largeFileViewerActive())
+        {
+            return;
+        }
+
+        if (m_backgroundSaveEnabled && !m_currentFilePath.isEmpty())
+        {
+            startBackgroundSave(m_currentFilePath);
+            return;
+        }
+
         if (saveCurrentDocument())
         {
             spdlog::info("Saved file {}", m_currentFilePath.toStdString());
@@ -56,127 +88,668 @@ namespace GnotePad::ui
         saveCurrentDocument(true);
     }
 
+    void MainWindow::handleCancelLoad()
+    {
+        if (!documentLoadInProgress())
+        {
+            return;
+        }
+
+        // Whatever a stream delivered so far exists nowhere else; stopping keeps it.
+        if (m_documentFromStream)
+        {
+            abortBackgroundLoad();
+            finishStreamLoad(tr("Stopped reading standard input"));
+            spdlog::info("Stopped reading standard input");
+            return;
+        }
+
+        spdlog::info("Cancelled loading {}", m_currentFilePath.toStdString());
+        resetDocumentState();
+    }
+
     bool MainWindow::loadDocumentFromPath(const QString& filePath)
     {
-        QFile file(filePath);
-        if (!file.open(QIODevice::ReadOnly))
+        // The document shown now is let go only once the new file is known to open, so a failed open leaves it,
+        // its journal and its watch exactly as they were.
+        if (!QFile(filePath).open(QIODevice::ReadOnly))
         {
-            if (!GnotePad::Application::isHeadlessSmokeMode())
-            {
-                QMessageBox::warning(this, tr("Open File"), tr("Unable to open %1").arg(filePath));
-            }
-            spdlog::error("Failed to open {}", filePath.toStdString());
+            reportReadFailure(filePath, core::DocumentReader::Error::Open);
             return false;
         }
 
-        const QByteArray rawData = file.readAll();
-        int bomLength = 0;
-        const auto encoding = detectEncodingFromData(rawData, bomLength);
+        // Compressed files always stream through the loader, which decompresses on its worker; the viewer and
+        // the synchronous path only understand the raw bytes.
+        const core::Compression compression = core::detectFileCompression(filePath);
+        if (compression != core::Compression::None)
+        {
+            releaseDocument();
+            m_documentCompression = compression;
+            return startBackgroundLoad(filePath);
+        }
 
-        QStringDecoder decoder(encoding);
-        const QString text = decoder(rawData.mid(bomLength));
-        if (decoder.hasError())
+        // Files too large for the editor open in the read-only viewer; ones it cannot show (UTF-16) load normally.
+        // One it failed to map is not loaded at all: the editor would have to hold the whole file instead.
+        const qint64 fileSize = QFileInfo(filePath).size();
+        if (m_largeFileViewerThresholdBytes >= 0 && fileSize >= m_largeFileViewerThresholdBytes)
         {
-            if (!GnotePad::Application::isHeadlessSmokeMode())
+            if (openInLargeFileViewer(filePath))
             {
-                QMessageBox::warning(this, tr("Open File"), tr("Unsupported encoding in %1").arg(filePath));
+                return true;
             }
-            spdlog::error("Unsupported encoding while opening {}", filePath.toStdString());
+            if (!m_largeFileViewer->errorString().isEmpty())
+            {
+                return false;
+            }
+        }
+
+        // Large files are decoded on a worker and streamed into the editor; a negative threshold keeps every load synchronous.
+        if (m_backgroundLoadThresholdBytes >= 0 && fileSize >= m_backgroundLoadThresholdBytes)
+        {
+            releaseDocument();
+            return startBackgroundLoad(filePath);
+        }
+
+        const auto decoded = readDocumentFile(filePath);
+        if (!decoded)
+        {
             return false;
         }
+        releaseDocument();
+        showDecodedDocument(filePath, *decoded);
+        return true;
+    }
+
+    void MainWindow::releaseDocument()
+    {
+        closeLargeFileViewer();
+        releaseDocumentExceptViewer();
+    }
 
+    void MainWindow::releaseDocumentExceptViewer()
+    {
+        abortBackgroundLoad();
+        m_reloadLoader->cancel();
+        unwatchDocumentFile();
+        m_editJournal.discard();
+        m_documentFromStream = false;
+        m_documentCompression = core::Compression::None;
+        m_pendingGoToLine = 0;
+        m_incrementalSearch->cancel();
+    }
+
+    void MainWindow::showDecodedDocument(const QString& filePath, const core::DecodedDocument& decoded)
+    {
         if (m_editor)
         {
-            m_editor->setPlainText(text);
+            m_editor->loadPlainText(decoded.text, decoded.lines);
             m_editor->document()->setModified(false);
         }
 
         m_currentFilePath = filePath;
-        applyEncodingSelection(encoding, bomLength > 0);
+        m_documentDiskBytes = decoded.diskBytes;
+        applyEncodingSelection(decoded.encoding, decoded.hasBom);
+        rebaseEditJournal();
         addRecentFile(filePath);
         m_lastOpenDirectory = QFileInfo(filePath).absolutePath();
         updateWindowTitle();
         updateDocumentStats();
         updateActionStates();
+        watchDocumentFile();
+    }
+
+    std::optional<core::DecodedDocument> MainWindow::readDocumentFile(const QString& filePath)
+    {
+        core::DecodedDocument decoded;
+        const auto error = core::DocumentReader::read(filePath, m_memoryMapThresholdBytes, decoded);
+        if (error != core::DocumentReader::Error::None)
+        {
+            reportReadFailure(filePath, error);
+            return std::nullopt;
+        }
+        return decoded;
+    }
+
+    void MainWindow::reportReadFailure(const QString& filePath, core::DocumentReader::Error error)
+    {
+        QString message;
+        switch (error)
+        {
+        case core::DocumentReader::Error::Open:
+            message = tr("Unable to open %1").arg(filePath);
+            spdlog::error("Failed to open {}", filePath.toStdString());
+            break;
+        case core::DocumentReader::Error::Decompress:
+            message = tr("Unable to decompress %1").arg(filePath);
+            spdlog::error("Corrupt, truncated or unsupported compressed data in {}", filePath.toStdString());
+            break;
+        case core::DocumentReader::Error::Decode:
+        case core::DocumentReader::Error::None:
+            message = tr("Unsupported encoding in %1").arg(filePath);
+            spdlog::error("Unsupported encoding while opening {}", filePath.toStdString());
+            break;
+        }
+        if (!GnotePad::Application::isHeadlessSmokeMode())
+        {
+            QMessageBox::warning(this, tr("Open File"), message);
+        }
+    }
+
+    void MainWindow::openFiles(const QStringList& filePaths, bool replaceDocument)
+    {
+        // This window takes the first file that is ready when it was asked to, or when it holds nothing yet.
+        m_openIntoThisWindow = replaceDocument || (m_currentFilePath.isEmpty() && !m_documentFromStream && !largeFileViewerActive() &&
+                                                   !documentLoadInProgress() && m_editor && m_editor->document()->isEmpty() &&
+                                                   !m_editor->document()->isModified());
+        m_openIntoRevision = m_editor ? m_editor->document()->revision() : -1;
+
+        QStringList toRead;
+        for (const QString& filePath : filePaths)
+        {
+            // Files that stream in (large, compressed) or open in the viewer already load off the GUI thread,
+            // each on a worker of its own window; the rest are read and decoded side by side on the pool.
+            const qint64 fileSize = QFileInfo(filePath).size();
+            const bool streams = (m_backgroundLoadThresholdBytes >= 0 && fileSize >= m_backgroundLoadThresholdBytes) ||
+                                 (m_largeFileViewerThresholdBytes >= 0 && fileSize >= m_largeFileViewerThresholdBytes) ||
+                                 core::detectFileCompression(filePath) != core::Compression::None;
+            if (!streams)
+            {
+                toRead << filePath;
+                continue;
+            }
+            MainWindow* target = takeWindowForOpenedFile();
+            target->loadDocumentFromPath(filePath);
+        }
+
+        if (!toRead.isEmpty())
+        {
+            m_documentReader->start(toRead, m_memoryMapThresholdBytes);
+            spdlog::info("Reading {} files in parallel", toRead.size());
+        }
+    }
+
+    MainWindow* MainWindow::takeWindowForOpenedFile()
+    {
+        // Files arrive some time after they were asked for; text typed here in the meantime keeps this window, and
+        // the file goes to a new one instead.
+        const bool untouched = m_editor && m_editor->document()->revision() == m_openIntoRevision;
+        if (m_openIntoThisWindow && untouched && !documentLoadInProgress())
+        {
+            m_openIntoThisWindow = false;
+            return this;
+        }
+        m_openIntoThisWindow = false;
+
+        // NOLINTNEXTLINE(cppcoreguidelines-owning-memory) - the window deletes itself once closed.
+        auto* window = new MainWindow();
+        window->setAttribute(Qt::WA_DeleteOnClose);
+        window->setWindowIcon(windowIcon());
+        window->move(pos() + QPoint(CascadeOffset, CascadeOffset));
+        window->show();
+        return window;
+    }
+
+    void MainWindow::handleDocumentRead(const QString& filePath, const core::DecodedDocument& document)
+    {
+        MainWindow* target = takeWindowForOpenedFile();
+        target->releaseDocument();
+        target->showDecodedDocument(filePath, document);
+        spdlog::info("Loaded file {}", filePath.toStdString());
+    }
+
+    bool MainWindow::startBackgroundLoad(const QString& filePath)
+    {
+        if (!m_editor || !m_documentLoader)
+        {
+            return false;
+        }
+
+        // Appending chunk by chunk would otherwise record one undo step per chunk.
+        auto* document = m_editor->document();
+        document->setUndoRedoEnabled(false);
+        document->clear();
+        document->setModified(false);
+
+        // The file may still grow while it loads; the bytes it covers are counted as chunks land.
+        m_currentFilePath = filePath;
+        m_documentDiskBytes = 0;
+        m_loadShownFirstChunk = false;
+        m_documentLoader->start(filePath, m_memoryMapThresholdBytes);
+        setDocumentLoadUiActive(true);
+        updateWindowTitle();
+        updateDocumentStats();
+        spdlog::info("Loading {} in the background", filePath.toStdString());
         return true;
     }
 
-    bool MainWindow::saveDocumentToPath(const QString& filePath)
+    void MainWindow::openStandardInput()
     {
-        if (filePath.isEmpty())
+        startStreamLoad(core::InputStreamReader::standardInputHandle());
+    }
+
+    bool MainWindow::startStreamLoad(qintptr handle)
+    {
+        if (!m_editor || !m_documentLoader)
         {
-            spdlog::warn("saveDocumentToPath called without a file path; refusing to save.");
-            Q_ASSERT(!filePath.isEmpty());
             return false;
         }
 
-        QSaveFile file(filePath);
-        if (!file.open(QIODevice::WriteOnly))
+        resetDocumentState();
+        m_editor->document()->setUndoRedoEnabled(false);
+        m_documentFromStream = true;
+        m_loadShownFirstChunk = false;
+        m_documentLoader->startStream(handle);
+        setDocumentLoadUiActive(true);
+        // A stream has no known length; the bar just shows that reading goes on.
+        if (m_loadProgressBar)
+        {
+            m_loadProgressBar->setRange(0, 0);
+        }
+        if (m_statusBar)
+        {
+            m_statusBar->showMessage(tr("Reading standard input…"));
+        }
+        updateWindowTitle();
+        updateDocumentStats();
+        spdlog::info("Reading standard input");
+        return true;
+    }
+
+    void MainWindow::finishStreamLoad(const QString& message)
+    {
+        // Text read from a pipe exists nowhere else, so it counts as unsaved: closing asks first and the
+        // recovery journal covers it.
+        if (m_editor)
         {
+            m_editor->document()->setModified(!m_editor->document()->isEmpty());
+        }
+        if (m_statusBar)
+        {
+            m_statusBar->showMessage(message);
+        }
+        updateWindowTitle();
+        updateDocumentStats();
+        updateActionStates();
+    }
+
+    void MainWindow::appendLoadedChunk(const QString& text, const core::LineIndex::Span& lines)
+    {
+        if (!m_editor)
+        {
+            return;
+        }
+
+        m_editor->appendLoadedText(text, lines);
+        m_editor->document()->setModified(false);
+
+        // The editor's cursor rides along with text inserted at its position; pin it to the top once the
+        // first screen is in so the view stays there while the rest of the file streams in below.
+        if (!m_loadShownFirstChunk)
+        {
+            m_loadShownFirstChunk = true;
+            m_editor->moveCursor(QTextCursor::Start);
+        }
+    }
+
+    void MainWindow::updateLoadProgress(qint64 bytesProcessed, qint64 bytesTotal)
+    {
+        if (!m_documentFromStream)
+        {
+            m_documentDiskBytes = bytesProcessed;
+        }
+        if (m_loadProgressBar && bytesTotal > 0)
+        {
+            m_loadProgressBar->setValue(static_cast<int>(bytesProcessed * LoadProgressSteps / bytesTotal));
+        }
+    }
+
+    void MainWindow::finishBackgroundLoad(core::DocumentLoader::Status status)
+    {
+        setDocumentLoadUiActive(false);
+
+        if (m_documentFromStream)
+        {
+            if (status == core::DocumentLoader::Status::Completed)
+            {
+                finishStreamLoad(tr("End of standard input"));
+                spdlog::info("Standard input ended");
+                return;
+            }
+
+            // What arrived before the failure is kept.
+            const QString message = status == core::DocumentLoader::Status::DecodeFailed ? tr("Unsupported encoding in standard input")
+                                                                                          : tr("Unable to read standard input");
             if (!GnotePad::Application::isHeadlessSmokeMode())
             {
-                QMessageBox::warning(this, tr("Save File"), tr("Unable to save %1").arg(filePath));
+                QMessageBox::warning(this, tr("Open File"), message);
             }
-            spdlog::error("Failed to open {} for writing", filePath.toStdString());
-            return false;
+            spdlog::error("Reading standard input failed");
+            finishStreamLoad(message);
+            return;
         }
 
-        QStringEncoder encoder(m_currentEncoding);
-        const QString text = m_editor ? m_editor->toPlainText() : QString();
-        const QByteArray encoded = encoder(text);
-        if (encoder.hasError())
+        const QString filePath = m_currentFilePath;
+        if (status != core::DocumentLoader::Status::Completed)
         {
+            QString message;
+            switch (status)
+            {
+            case core::DocumentLoader::Status::OpenFailed:
+                message = tr("Unable to open %1").arg(filePath);
+                spdlog::error("Failed to open {}", filePath.toStdString());
+                break;
+            case core::DocumentLoader::Status::ReadFailed:
+                message = tr("Unable to read %1").arg(filePath);
+                spdlog::error("Read error while loading {}", filePath.toStdString());
+                break;
+            case core::DocumentLoader::Status::DecompressFailed:
+                message = tr("Unable to decompress %1").arg(filePath);
+                spdlog::error("Corrupt, truncated or unsupported compressed data in {}", filePath.toStdString());
+                break;
+            case core::DocumentLoader::Status::DecodeFailed:
+            case core::DocumentLoader::Status::Completed:
+                message = tr("Unsupported encoding in %1").arg(filePath);
+                spdlog::error("Unsupported encoding while opening {}", filePath.toStdString());
+                break;
+            }
             if (!GnotePad::Application::isHeadlessSmokeMode())
             {
-                QMessageBox::warning(this, tr("Save File"), tr("Unable to encode document using %1").arg(encodingLabel()));
+                QMessageBox::warning(this, tr("Open File"), message);
             }
-            spdlog::error("Encoding error while saving {}", filePath.toStdString());
-            return false;
+            resetDocumentState();
+            return;
         }
 
-        QByteArray payload;
-        if (m_hasBom)
+        if (m_editor)
+        {
+            m_editor->document()->setModified(false);
+        }
+        rebaseEditJournal();
+
+        addRecentFile(filePath);
+        m_lastOpenDirectory = QFileInfo(filePath).absolutePath();
+        updateWindowTitle();
+        updateDocumentStats();
+        updateActionStates();
+        watchDocumentFile();
+        spdlog::info("Loaded file {}", filePath.toStdString());
+        if (m_pendingGoToLine > 0)
         {
-            payload.append(viewBomForEncoding(m_currentEncoding));
+            goToLine(std::exchange(m_pendingGoToLine, 0));
         }
-        payload.append(encoded);
+    }
 
-        if (file.write(payload) != payload.size())
+    void MainWindow::abortBackgroundLoad()
+    {
+        if (!documentLoadInProgress())
         {
-            if (!GnotePad::Application::isHeadlessSmokeMode())
+            return;
+        }
+
+        m_documentLoader->cancel();
+        setDocumentLoadUiActive(false);
+    }
+
+    void MainWindow::setDocumentLoadUiActive(bool active)
+    {
+        if (m_editor)
+        {
+            // The filter's own read-only state would otherwise be restored over the load's.
+            m_editor->clearLineFilter();
+            m_editor->setReadOnly(active);
+            if (!active)
             {
-                QMessageBox::warning(this, tr("Save File"), tr("Failed to write data to %1").arg(filePath));
+                m_editor->document()->setUndoRedoEnabled(true);
             }
-            spdlog::error("Short write while saving {}", filePath.toStdString());
-            return false;
         }
+        if (m_loadProgressBar)
+        {
+            m_loadProgressBar->setRange(0, LoadProgressSteps);
+            m_loadProgressBar->setValue(0);
+            m_loadProgressBar->setVisible(active);
+        }
+        if (m_cancelLoadButton)
+        {
+            m_cancelLoadButton->setVisible(active);
+        }
+        updateActionStates();
+    }
+
+    bool MainWindow::documentLoadInProgress() const
+    {
+        return m_documentLoader && m_documentLoader->isRunning();
+    }
 
-        if (!file.commit())
+    bool MainWindow::openInLargeFileViewer(const QString& filePath)
+    {
+        if (!m_editor || !m_largeFileViewer)
         {
-            if (!GnotePad::Application::isHeadlessSmokeMode())
+            return false;
+        }
+        if (!m_largeFileViewer->openFile(filePath))
+        {
+            if (!m_largeFileViewer->errorString().isEmpty())
             {
-                QMessageBox::warning(this, tr("Save File"), tr("Failed to finalize %1").arg(filePath));
+                const QString message = tr("Unable to map %1 for viewing: %2").arg(filePath, m_largeFileViewer->errorString());
+                spdlog::error("Failed to map {} for the large file viewer", filePath.toStdString());
+                if (!GnotePad::Application::isHeadlessSmokeMode())
+                {
+                    QMessageBox::warning(this, tr("Open File"), message);
+                }
             }
-            spdlog::error("Failed to commit save file for {}", filePath.toStdString());
             return false;
         }
 
+        // The viewer let go of the file it showed only once this one was mapped; the rest of the old document
+        // goes now.
+        releaseDocumentExceptViewer();
+
+        // The hidden editor stays empty and read-only so edit shortcuts cannot reach it while the viewer is up.
+        m_editor->clearLineFilter();
+        m_editor->document()->clear();
+        m_editor->document()->setModified(false);
+        m_editor->setReadOnly(true);
+        syncLargeFileViewerAppearance();
+        m_editorStack->setCurrentWidget(m_largeFileViewer);
+        m_largeFileViewer->setFocus();
+
+        m_currentFilePath = filePath;
+        m_documentDiskBytes = -1;
+        applyEncodingSelection(QStringConverter::Utf8, m_largeFileViewer->hasBom());
+        addRecentFile(filePath);
+        m_lastOpenDirectory = QFileInfo(filePath).absolutePath();
+        updateWindowTitle();
+        updateDocumentStats();
+        updateActionStates();
+        handleUpdateCursorStatus();
+        spdlog::info("Opened {} in the large file viewer", filePath.toStdString());
+        return true;
+    }
+
+    void MainWindow::closeLargeFileViewer()
+    {
+        if (!largeFileViewerActive())
+        {
+            return;
+        }
+
+        m_largeFileViewer->closeFile();
+        m_editorStack->setCurrentWidget(m_editor);
+        m_editor->setReadOnly(false);
+        m_editor->setFocus();
+        updateActionStates();
+    }
+
+    bool MainWindow::largeFileViewerActive() const
+    {
+        return m_largeFileViewer && m_largeFileViewer->isOpen();
+    }
+
+    bool MainWindow::saveDocumentToPath(const QString& filePath)
+    {
+        if (filePath.isEmpty())
+        {
+            spdlog::warn("saveDocumentToPath called without a file path; refusing to save.");
+            Q_ASSERT(!filePath.isEmpty());
+            return false;
+        }
+
+        waitForBackgroundSave();
+        abandonReload();
+
+        // Stream the document piece by piece instead of materializing toPlainText(), its encoded copy and a
+        // BOM-prefixed payload; peak memory is one encoded chunk regardless of document size.
+        core::EncodedFileWriter writer(filePath, m_currentEncoding, m_hasBom, saveCompressionFor(filePath));
+        if (!writer.open() || !writeDocumentText(writer) || !writer.commit())
+        {
+            reportSaveFailure(filePath, writer.error());
+            return false;
+        }
+
+        markDocumentSaved(filePath, true);
+        return true;
+    }
+
+    void MainWindow::startBackgroundSave(const QString& filePath)
+    {
+        if (!m_editor || !m_documentSaver)
+        {
+            return;
+        }
+
+        // One save at a time; a request that arrives mid-save is folded into a single follow-up save.
+        if (m_documentSaver->isRunning())
+        {
+            m_backgroundSaveQueued = true;
+            return;
+        }
+
+        abandonReload();
+        m_backgroundSaveGeneration = m_editGeneration;
+        m_documentSaver->start(filePath, m_editor->pieceTable(), m_currentEncoding, m_hasBom, saveCompressionFor(filePath));
+        if (m_statusBar)
+        {
+            m_statusBar->showMessage(tr("Saving %1…").arg(QFileInfo(filePath).fileName()));
+        }
+    }
+
+    void MainWindow::finishBackgroundSave(const QString& filePath, core::EncodedFileWriter::Error error)
+    {
+        if (m_statusBar)
+        {
+            m_statusBar->clearMessage();
+        }
+
+        if (error != core::EncodedFileWriter::Error::None)
+        {
+            m_backgroundSaveQueued = false;
+            reportSaveFailure(filePath, error);
+            return;
+        }
+
+        // Edits typed while the snapshot was being written are not on disk, so the document stays modified.
+        markDocumentSaved(filePath, m_backgroundSaveGeneration == m_editGeneration);
+        spdlog::info("Saved file {}", filePath.toStdString());
+
+        if (m_backgroundSaveQueued)
+        {
+            m_backgroundSaveQueued = false;
+            startBackgroundSave(m_currentFilePath);
+        }
+    }
+
+    void MainWindow::waitForBackgroundSave()
+    {
+        // Whatever is saved next supersedes a queued follow-up save.
+        m_backgroundSaveQueued = false;
+        if (m_documentSaver)
+        {
+            m_documentSaver->waitForFinished();
+        }
+    }
+
+    bool MainWindow::documentSaveInProgress() const
+    {
+        return m_documentSaver && m_documentSaver->isRunning();
+    }
+
+    void MainWindow::markDocumentSaved(const QString& filePath, bool documentUnchanged)
+    {
+        m_documentCompression = saveCompressionFor(filePath);
         m_currentFilePath = filePath;
         m_lastSaveDirectory = QFileInfo(filePath).absolutePath();
         addRecentFile(filePath);
-        if (m_editor)
+        if (m_editor && documentUnchanged)
         {
             m_editor->document()->setModified(false);
         }
         updateWindowTitle();
         updateActionStates();
-        return true;
+        // Saving replaces the file on disk; watching (and following) resumes from what was written. The journal
+        // starts over from the new file, or, with edits made during a background save, from a snapshot.
+        m_documentDiskBytes = QFileInfo(filePath).size();
+        if (m_editor && documentUnchanged)
+        {
+            rebaseEditJournal();
+        }
+        else
+        {
+            m_editJournal.requestSnapshot();
+        }
+        watchDocumentFile();
+    }
+
+    core::Compression MainWindow::saveCompressionFor(const QString& filePath) const
+    {
+        // A ".gz" or ".zst" name asks for compression. Otherwise a document saved back to its own file keeps the
+        // container it came in, even under a name that does not say so, and anything else is written plain.
+        const core::Compression requested = core::compressionForFileName(filePath);
+        if (requested != core::Compression::None)
+        {
+            return requested;
+        }
+        return filePath == m_currentFilePath ? m_documentCompression : core::Compression::None;
+    }
+
+    bool MainWindow::writeDocumentText(core::EncodedFileWriter& writer) const
+    {
+        return !m_editor || core::DocumentSaver::writeText(writer, m_editor->pieceTable());
+    }
+
+    void MainWindow::reportSaveFailure(const QString& filePath, core::EncodedFileWriter::Error error)
+    {
+        QString message;
+        switch (error)
+        {
+        case core::EncodedFileWriter::Error::Open:
+            message = tr("Unable to save %1").arg(filePath);
+            spdlog::error("Failed to open {} for writing", filePath.toStdString());
+            break;
+        case core::EncodedFileWriter::Error::Encode:
+            message = tr("Unable to encode document using %1").arg(encodingLabel());
+            spdlog::error("Encoding error while saving {}", filePath.toStdString());
+            break;
+        case core::EncodedFileWriter::Error::Write:
+            message = tr("Failed to write data to %1").arg(filePath);
+            spdlog::error("Short write while saving {}", filePath.toStdString());
+            break;
+        case core::EncodedFileWriter::Error::Commit:
+        case core::EncodedFileWriter::Error::None:
+            message = tr("Failed to finalize %1").arg(filePath);
+            spdlog::error("Failed to commit save file for {}", filePath.toStdString());
+            break;
+        }
+
+        if (!GnotePad::Application::isHeadlessSmokeMode())
+        {
+            QMessageBox::warning(this, tr("Save File"), message);
+        }
     }
 
     bool MainWindow::saveDocumentAsDialog()
     {
         const QString initialPath = m_currentFilePath.isEmpty() ? dialogDirectory(m_lastSaveDirectory) : m_currentFilePath;
-        const auto target = QFileDialog::getSaveFileName(this, tr("Save As"), initialPath, tr("Text Files (*.txt);;All Files (*.*)"));
+        const auto target = QFileDialog::getSaveFileName(this, tr("Save As"), initialPath, tr("Text Files (*.txt);;Compressed Files (*.gz *.zst);;All Files (*.*)"));
         if (target.isEmpty())
         {
             return false;
@@ -201,6 +774,10 @@ namespace GnotePad::ui
 
     bool MainWindow::saveCurrentDocument(bool forceSaveAs)
     {
+        if (largeFileViewerActive())
+        {
+            return false;
+        }
         if (forceSaveAs || m_currentFilePath.isEmpty())
         {
             return saveDocumentAsDialog();
@@ -210,9 +787,13 @@ namespace GnotePad::ui
 
     void MainWindow::resetDocumentState()
     {
+        releaseDocument();
         m_currentFilePath.clear();
+        m_documentDiskBytes = -1;
         if (m_editor)
         {
+            m_editor->clearMatchHighlights();
+            m_highlightedTerm.clear();
             m_editor->document()->clear();
             m_editor->document()->setModified(false);
         }
@@ -224,6 +805,9 @@ namespace GnotePad::ui
 
     bool MainWindow::confirmReadyForDestructiveAction()
     {
+        // The modified flag is only final once an in-flight save has landed.
+        waitForBackgroundSave();
+
         if (!m_editor || !m_editor->document()->isModified())
         {
             return true;
@@ -350,41 +934,4 @@ namespace GnotePad::ui
         return label;
     }
 
-    QByteArray MainWindow::viewBomForEncoding(QStringConverter::Encoding encoding)
-    {
-        switch (encoding)
-        {
-        case QStringConverter::Utf8:
-            return QByteArray::fromHex("efbbbf");
-        case QStringConverter::Utf16LE:
-            return QByteArray::fromHex("fffe");
-        case QStringConverter::Utf16BE:
-            return QByteArray::fromHex("feff");
-        default:
-            return {};
-        }
-    }
-
-    QStringConverter::Encoding MainWindow::detectEncodingFromData(const QByteArray& data, int& bomLength)
-    {
-        bomLength = 0;
-        if (data.startsWith(QByteArray::fromHex("efbbbf")))
-        {
-            bomLength = 3;
-            return QStringConverter::Utf8;
-        }
-        if (data.startsWith(QByteArray::fromHex("fffe")))
-        {
-            bomLength = 2;
-            return QStringConverter::Utf16LE;
-        }
-        if (data.startsWith(QByteArray::fromHex("feff")))
-        {
-            bomLength = 2;
-            return QStringConverter::Utf16BE;
-        }
-
-        return QStringConverter::Utf8;
-    }
-
 } // namespace GnotePad::ui
@@ -0,0 +1,334 @@
+#include "ui/MainWindow.h"
+
+#include "app/Application.h"
+#include "core/Compression.h"
+#include "core/FileSample.h"
+#include "core/LineIndex.h"
+#include "ui/TextEditor.h"
+
+#include <spdlog/spdlog.h>
+
+#include <QtCore/qfileinfo.h>
+#include <QtCore/qfilesystemwatcher.h>
+#include <QtCore/qstring.h>
+#include <QtCore/qstringlist.h>
+#include <QtCore/qtimer.h>
+#include <QtGui/qaction.h>
+#include <QtGui/qtextcursor.h>
+#include <QtGui/qtextdocument.h>
+#include <QtWidgets/qmessagebox.h>
+#include <QtWidgets/qscrollbar.h>
+#include <QtWidgets/qstatusbar.h>
+
+#include <optional>
+#include <utility>
+
+namespace GnotePad::ui
+{
+
+    void MainWindow::handleToggleFollow(bool checked)
+    {
+        watchDocumentFile();
+        spdlog::info("Follow mode toggled: {}", checked);
+    }
+
+    void MainWindow::watchDocumentFile()
+    {
+        unwatchDocumentFile();
+        if (m_currentFilePath.isEmpty() || m_documentDiskBytes < 0 || largeFileViewerActive() || documentLoadInProgress())
+        {
+            return;
+        }
+
+        m_documentDiskModified = QFileInfo(m_currentFilePath).lastModified();
+        m_documentDiskSample = core::sampleFileHash(m_currentFilePath);
+        // The directory is watched too: a file replaced by rename (log rotation, editors that save atomically)
+        // only shows up as a directory change.
+        m_fileWatcher->addPath(m_currentFilePath);
+        m_fileWatcher->addPath(QFileInfo(m_currentFilePath).absolutePath());
+
+        // Bytes appended to a compressed file are not text; such a file is reloaded whole when it changes.
+        if (!m_followAction || !m_followAction->isChecked() || m_documentCompression != core::Compression::None)
+        {
+            return;
+        }
+        m_fileFollower.start(m_currentFilePath, m_documentDiskBytes, m_currentEncoding);
+        m_followPollTimer->start();
+        // Pick up whatever was written between the load and now.
+        pollFollowedFile();
+    }
+
+    void MainWindow::unwatchDocumentFile()
+    {
+        m_fileFollower.stop();
+        m_followPollTimer->stop();
+        const QStringList watched = m_fileWatcher->files() + m_fileWatcher->directories();
+        if (!watched.isEmpty())
+        {
+            m_fileWatcher->removePaths(watched);
+        }
+    }
+
+    void MainWindow::handleDocumentFileChanged()
+    {
+        if (m_fileFollower.isActive())
+        {
+            pollFollowedFile();
+        }
+        else
+        {
+            checkDocumentFileOnDisk();
+        }
+
+        // QFileSystemWatcher drops a file once it is renamed or removed; watch the name again when it is back.
+        if (!m_currentFilePath.isEmpty() && !m_fileWatcher->files().contains(m_currentFilePath) && QFileInfo::exists(m_currentFilePath))
+        {
+            m_fileWatcher->addPath(m_currentFilePath);
+        }
+    }
+
+    void MainWindow::checkDocumentFileOnDisk()
+    {
+        // A save in flight is the change being reported; it records the new disk state once it lands. A reload in
+        // flight checks again once it is done.
+        if (m_reloadPromptOpen || m_currentFilePath.isEmpty() || m_documentDiskBytes < 0 || documentLoadInProgress() ||
+            documentSaveInProgress() || documentReloadInProgress())
+        {
+            return;
+        }
+
+        // Timestamps can be too coarse to tell two writes apart; a file that keeps its size and time also has to
+        // keep its sampled content.
+        const QFileInfo info(m_currentFilePath);
+        if (!info.exists() || (info.size() == m_documentDiskBytes && info.lastModified() == m_documentDiskModified &&
+                               core::sampleFileHash(m_currentFilePath) == m_documentDiskSample))
+        {
+            return;
+        }
+        reloadChangedDocument();
+    }
+
+    void MainWindow::pollFollowedFile()
+    {
+        // A background save replaces the file on disk; the follower restarts once it has landed.
+        if (!m_fileFollower.isActive() || documentLoadInProgress() || documentSaveInProgress())
+        {
+            return;
+        }
+
+        QString appended;
+        switch (m_fileFollower.poll(appended))
+        {
+        case core::FileFollower::Status::Appended:
+            appendFollowedText(appended);
+            // Polls read a bounded slice; keep going until the follower has caught up.
+            QTimer::singleShot(0, this, &MainWindow::pollFollowedFile);
+            break;
+        case core::FileFollower::Status::Truncated:
+        case core::FileFollower::Status::Replaced:
+            reloadChangedDocument();
+            break;
+        case core::FileFollower::Status::Unchanged:
+        case core::FileFollower::Status::Missing:
+            break;
+        }
+    }
+
+    void MainWindow::appendFollowedText(const QString& text)
+    {
+        if (!m_editor)
+        {
+            return;
+        }
+
+        auto* document = m_editor->document();
+        const bool wasModified = document->isModified();
+        const QTextCursor cursor = m_editor->textCursor();
+        const bool followTail = cursor.atEnd() && !cursor.hasSelection();
+        QScrollBar* const scrollBar = m_editor->verticalScrollBar();
+        const int scrollPosition = scrollBar->value();
+
+        // Appended text extends the models like a background load chunk. It is the file's text, not an edit: it goes
+        // in as its own undo step that Undo steps over, so edits made before it can still be undone.
+        m_editor->appendFollowedText(text, core::LineIndex::scan(text));
+        document->setModified(wasModified);
+        m_documentDiskBytes = m_fileFollower.offset();
+
+        if (followTail)
+        {
+            m_editor->moveCursor(QTextCursor::End);
+            m_editor->ensureCursorVisible();
+        }
+        else
+        {
+            scrollBar->setValue(scrollPosition);
+        }
+    }
+
+    void MainWindow::reloadChangedDocument()
+    {
+        const QString filePath = m_currentFilePath;
+        const QString fileName = QFileInfo(filePath).fileName();
+        const bool following = m_followAction && m_followAction->isChecked();
+        if (m_editor && m_editor->document()->isModified())
+        {
+            if (following)
+            {
+                // Appending after unsaved edits is fine; splicing a rewritten file into them is not.
+                m_followAction->setChecked(false);
+            }
+
+            std::optional<QMessageBox::StandardButton> response;
+#ifdef GNOTE_TEST_HOOKS
+            if (!m_testPromptResponses.empty())
+            {
+                response = m_testPromptResponses.front();
+                m_testPromptResponses.pop_front();
+            }
+#endif
+            if (!response && !GnotePad::Application::isHeadlessSmokeMode())
+            {
+                // The prompt spins an event loop; further change notifications wait until it is answered.
+                m_reloadPromptOpen = true;
+                response = QMessageBox::question(
+                    this, tr("GnotePad"), tr("%1 has been changed by another program. Reload it and lose your changes?").arg(fileName));
+                m_reloadPromptOpen = false;
+            }
+
+            if (response.value_or(QMessageBox::No) != QMessageBox::Yes)
+            {
+                // Keep the edits, and take the file as it is now as the state to compare against from here on.
+                spdlog::warn("{} changed on disk while it had unsaved edits; kept the edits", filePath.toStdString());
+                m_documentDiskBytes = QFileInfo(filePath).size();
+                // The edits no longer apply to the file, so the recovery journal cannot start from it.
+                m_editJournal.requestSnapshot();
+                watchDocumentFile();
+                if (m_statusBar)
+                {
+                    m_statusBar->showMessage(tr("%1 changed on disk; your unsaved edits were kept").arg(fileName));
+                }
+                return;
+            }
+        }
+
+        // Files that now belong in the read-only viewer, and compressed ones, take the regular load path.
+        const qint64 fileSize = QFileInfo(filePath).size();
+        if (!m_editor || (m_largeFileViewerThresholdBytes >= 0 && fileSize >= m_largeFileViewerThresholdBytes) ||
+            core::detectFileCompression(filePath) != core::Compression::None)
+        {
+            loadDocumentFromPath(filePath);
+            return;
+        }
+
+        // The file is read back on a worker. Watching pauses meanwhile and resumes from the state of the file
+        // before reading began, so whatever changes while it is read is still seen afterwards.
+        const QFileInfo info(filePath);
+        m_pendingReload = PendingReload{};
+        m_pendingReload.diskModified = info.lastModified();
+        m_pendingReload.diskSample = core::sampleFileHash(filePath);
+        m_pendingReload.revision = m_editor->document()->revision();
+        m_pendingReload.following = following;
+        unwatchDocumentFile();
+        m_reloadLoader->start(filePath, m_memoryMapThresholdBytes);
+        spdlog::info("Reloading {} in the background", filePath.toStdString());
+    }
+
+    void MainWindow::appendReloadedChunk(const QString& text, const core::LineIndex::Span& lines)
+    {
+        PendingReload& reload = m_pendingReload;
+        const qint64 base = reload.lines.length;
+        for (const qint64 start : lines.lineStarts)
+        {
+            reload.lines.lineStarts.push_back(base + start);
+        }
+        reload.lines.length += lines.length;
+        reload.text.append(text);
+    }
+
+    void MainWindow::finishReload(core::DocumentLoader::Status status)
+    {
+        const PendingReload reload = std::exchange(m_pendingReload, PendingReload{});
+        const QString filePath = m_currentFilePath;
+        if (!m_editor)
+        {
+            return;
+        }
+
+        if (status != core::DocumentLoader::Status::Completed)
+        {
+            core::DocumentReader::Error error = core::DocumentReader::Error::Decode;
+            if (status == core::DocumentLoader::Status::OpenFailed || status == core::DocumentLoader::Status::ReadFailed)
+            {
+                error = core::DocumentReader::Error::Open;
+            }
+            else if (status == core::DocumentLoader::Status::DecompressFailed)
+            {
+                error = core::DocumentReader::Error::Decompress;
+            }
+            reportReadFailure(filePath, error);
+            return;
+        }
+
+        // Text typed while the file was read would be lost; the document keeps it, and the change on disk, still
+        // measured against the state before this reload, is offered again.
+        if (m_editor->document()->revision() != reload.revision)
+        {
+            const QDateTime diskModified = m_documentDiskModified;
+            const QByteArray diskSample = m_documentDiskSample;
+            watchDocumentFile();
+            m_documentDiskModified = diskModified;
+            m_documentDiskSample = diskSample;
+            if (!m_fileFollower.isActive())
+            {
+                checkDocumentFileOnDisk();
+            }
+            return;
+        }
+
+        // Only the lines that differ are edited, so the cursor, scroll position and undo history survive, and
+        // the reload can be undone; a file rewritten wholesale is replaced outright.
+        const bool patched = m_editor->syncPlainText(reload.text);
+        if (!patched)
+        {
+            m_editor->loadPlainText(reload.text, reload.lines);
+        }
+        m_editor->document()->setModified(false);
+        m_documentDiskBytes = reload.diskBytes;
+        applyEncodingSelection(reload.encoding, reload.hasBom);
+        rebaseEditJournal();
+        updateWindowTitle();
+        updateDocumentStats();
+        updateActionStates();
+        watchDocumentFile();
+        m_documentDiskModified = reload.diskModified;
+        m_documentDiskSample = reload.diskSample;
+
+        if (reload.following)
+        {
+            m_editor->moveCursor(QTextCursor::End);
+            m_editor->ensureCursorVisible();
+        }
+        spdlog::info("Reloaded {} after it changed on disk ({})", filePath.toStdString(), patched ? "changed lines only" : "whole file");
+        if (!m_fileFollower.isActive())
+        {
+            checkDocumentFileOnDisk();
+        }
+    }
+
+    void MainWindow::abandonReload()
+    {
+        // The document being saved is what the file will hold, so the copy read back from disk is stale.
+        if (documentReloadInProgress())
+        {
+            m_reloadLoader->cancel();
+            m_pendingReload = PendingReload{};
+            watchDocumentFile();
+        }
+    }
+
+    bool MainWindow::documentReloadInProgress() const
+    {
+        return m_reloadLoader && m_reloadLoader->isRunning();
+    }
+
+} // namespace GnotePad::ui
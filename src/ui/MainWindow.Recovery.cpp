@@ -0,0 +1,141 @@
+#include "ui/MainWindow.h"
+
+#include "app/Application.h"
+#include "core/Compression.h"
+#include "core/EditJournal.h"
+#include "core/FileSample.h"
+#include "core/LineIndex.h"
+#include "ui/TextEditor.h"
+
+#include <spdlog/spdlog.h>
+
+#include <QtCore/qfileinfo.h>
+#include <QtCore/qstring.h>
+#include <QtCore/qstringlist.h>
+#include <QtGui/qtextdocument.h>
+#include <QtWidgets/qmessagebox.h>
+
+#include <optional>
+#include <utility>
+
+namespace GnotePad::ui
+{
+
+    void MainWindow::flushEditJournal()
+    {
+        if (!m_editor || largeFileViewerActive() || documentLoadInProgress())
+        {
+            return;
+        }
+
+        // A document back at the text of its file has nothing to lose: the journal is dropped instead of written,
+        // and the file base moves along with a followed file as it grows.
+        if (!m_editor->document()->isModified())
+        {
+            if (const auto& base = m_editJournal.base())
+            {
+                core::EditJournal::FileBase grown = *base;
+                if (grown.bytes != m_documentDiskBytes)
+                {
+                    grown.bytes = m_documentDiskBytes;
+                    grown.sample = core::sampleFileHash(grown.filePath, grown.bytes);
+                }
+                m_editJournal.rebase(std::move(grown));
+            }
+            else if (m_editJournal.isOpen())
+            {
+                m_editJournal.discard();
+            }
+            return;
+        }
+
+        // A journal is only started once there is something to lose; edits made before then are in its file base
+        // or its snapshot.
+        if (!m_editJournal.isOpen())
+        {
+            if (m_editor->document()->isModified() &&
+                !m_editJournal.open(core::EditJournal::defaultDirectory(), {m_currentFilePath, m_currentEncoding, m_hasBom}, m_editor->pieceTable()))
+            {
+                spdlog::warn("Unable to start a recovery journal in {}", core::EditJournal::defaultDirectory().toStdString());
+            }
+            return;
+        }
+        m_editJournal.flush(m_editor->pieceTable());
+    }
+
+    void MainWindow::rebaseEditJournal()
+    {
+        // Only a plain file read whole can stand in for the document's text; anything else starts its journal from
+        // a snapshot once there are edits to keep.
+        if (m_currentFilePath.isEmpty() || m_documentDiskBytes < 0 || m_documentFromStream ||
+            m_documentCompression != core::Compression::None)
+        {
+            m_editJournal.discard();
+            return;
+        }
+        const QByteArray sample = core::sampleFileHash(m_currentFilePath, m_documentDiskBytes);
+        m_editJournal.rebase({m_currentFilePath, m_documentDiskBytes, m_currentEncoding, m_hasBom, sample});
+    }
+
+    void MainWindow::offerDocumentRecovery()
+    {
+        const QStringList journals = core::EditJournal::orphanedJournals(core::EditJournal::defaultDirectory());
+        if (journals.isEmpty() || !m_editor)
+        {
+            return;
+        }
+
+        // One document per window: the newest journal is offered, older ones wait for later launches.
+        const QString journalPath = journals.front();
+        const auto recovered = core::EditJournal::read(journalPath);
+        if (!recovered)
+        {
+            spdlog::warn("Discarding unreadable recovery journal {}", journalPath.toStdString());
+            core::EditJournal::remove(journalPath);
+            return;
+        }
+
+        const QString documentPath = recovered->metadata.documentPath;
+        const QString title = documentPath.isEmpty() ? tr(UntitledDocumentTitle) : QFileInfo(documentPath).fileName();
+        std::optional<QMessageBox::StandardButton> response;
+#ifdef GNOTE_TEST_HOOKS
+        if (!m_testPromptResponses.empty())
+        {
+            response = m_testPromptResponses.front();
+            m_testPromptResponses.pop_front();
+        }
+#endif
+        if (!response)
+        {
+            if (GnotePad::Application::isHeadlessSmokeMode())
+            {
+                return;
+            }
+            response = QMessageBox::question(
+                this, tr("GnotePad"), tr("GnotePad did not close properly. Recover the unsaved changes to %1?").arg(title));
+        }
+
+        core::EditJournal::remove(journalPath);
+        if (response != QMessageBox::Yes)
+        {
+            spdlog::info("Discarded recovery journal for {}", title.toStdString());
+            return;
+        }
+
+        resetDocumentState();
+        m_editor->loadPlainText(recovered->text, core::LineIndex::scan(recovered->text));
+        m_editor->document()->setModified(true);
+        m_currentFilePath = documentPath;
+        // The file on disk is what the recovered edits were made against; changes to it from here on are reported.
+        const QFileInfo diskFile(documentPath);
+        m_documentDiskBytes = !documentPath.isEmpty() && diskFile.exists() ? diskFile.size() : -1;
+        m_documentCompression = core::detectFileCompression(documentPath);
+        applyEncodingSelection(recovered->metadata.encoding, recovered->metadata.hasBom);
+        updateWindowTitle();
+        updateDocumentStats();
+        updateActionStates();
+        watchDocumentFile();
+        spdlog::info("Recovered unsaved changes to {}", title.toStdString());
+    }
+
+} // namespace GnotePad::ui
@@ -1,28 +1,63 @@
 #include "ui/MainWindow.h"
 
 #include "app/Application.h"
+#include "core/LiteralSearch.h"
+#include "core/MatchIndex.h"
+#include "core/MultiTermSearch.h"
+#include "core/PieceTable.h"
+#include "core/RegexSearch.h"
+#include "core/WatchListScan.h"
+#include "core/WordIndex.h"
+#include "ui/FindBar.h"
+#include "ui/FindInFilesPanel.h"
+#include "ui/LargeFileViewer.h"
 #include "ui/TextEditor.h"
+#include "ui/WatchListPanel.h"
 
+#include <spdlog/spdlog.h>
+
+#include <QtCore/qdir.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qfileinfo.h>
+#include <QtCore/qlocale.h>
+#include <QtCore/qlist.h>
+#include <QtCore/qregularexpression.h>
+#include <QtCore/qstringliteral.h>
+#include <QtCore/qstringview.h>
 #include <QtCore/qtimer.h>
 #include <QtGui/qtextcursor.h>
 #include <QtGui/qtextdocument.h>
-#include <QtGui/qtextobject.h>
 #include <QtWidgets/qboxlayout.h>
 #include <QtWidgets/qcheckbox.h>
 #include <QtWidgets/qdialog.h>
 #include <QtWidgets/qdialogbuttonbox.h>
+#include <QtWidgets/qdockwidget.h>
+#include <QtWidgets/qfiledialog.h>
 #include <QtWidgets/qformlayout.h>
+#include <QtWidgets/qlabel.h>
 #include <QtWidgets/qinputdialog.h>
 #include <QtWidgets/qlineedit.h>
 #include <QtWidgets/qmessagebox.h>
 #include <QtWidgets/qplaintextedit.h>
 #include <QtWidgets/qpushbutton.h>
+#include <QtWidgets/qstatusbar.h>
 
 #include <algorithm>
+#include <iterator>
+#include <limits>
+#include <numeric>
+#include <utility>
+#include <vector>
 
 namespace GnotePad::ui
 {
 
+    namespace
+    {
+        // Wall-clock limit for one regular-expression pass over the document.
+        constexpr int kRegexBudgetMs = 2000;
+    } // namespace
+
     void MainWindow::handleFind()
     {
         if (!m_editor)
@@ -44,9 +79,15 @@ namespace GnotePad::ui
         auto* const findField = new QLineEdit(m_lastSearchTerm, &dialog);
         auto* const matchCase = new QCheckBox(tr("Match case"), &dialog);
         matchCase->setChecked(m_lastCaseSensitivity == Qt::CaseSensitive);
+        auto* const wholeWords = new QCheckBox(tr("Match whole word only"), &dialog);
+        wholeWords->setChecked(m_lastWholeWords);
+        auto* const useRegex = new QCheckBox(tr("Regular expression"), &dialog);
+        useRegex->setChecked(m_lastUseRegex);
 
         form->addRow(tr("Find what:"), findField);
         form->addRow(QString(), matchCase);
+        form->addRow(QString(), wholeWords);
+        form->addRow(QString(), useRegex);
 
         auto* const buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, Qt::Horizontal, &dialog);
         form->addWidget(buttons);
@@ -91,14 +132,26 @@ namespace GnotePad::ui
 
         m_lastSearchTerm = term;
         m_lastCaseSensitivity = matchCase->isChecked() ? Qt::CaseSensitive : Qt::CaseInsensitive;
+        m_lastWholeWords = wholeWords->isChecked();
+        m_lastUseRegex = useRegex->isChecked();
 
         if (!performFind(term, buildFindFlags()))
         {
-            if (!GnotePad::Application::isHeadlessSmokeMode())
-            {
-                QMessageBox::information(this, tr("Find"), tr("Cannot find \"%1\".").arg(term));
-            }
+            reportFindMiss(tr("Find"), term);
+        }
+    }
+
+    void MainWindow::handleIncrementalFind()
+    {
+        if (!m_editor)
+        {
+            return;
         }
+
+        m_findBar->setTerm(m_lastSearchTerm);
+        m_findBar->setCaseSensitivity(m_lastCaseSensitivity);
+        m_findBar->setStatus(QString());
+        m_findBar->activate();
     }
 
     void MainWindow::handleFindNext()
@@ -111,10 +164,7 @@ namespace GnotePad::ui
 
         if (!performFind(m_lastSearchTerm, buildFindFlags()))
         {
-            if (!GnotePad::Application::isHeadlessSmokeMode())
-            {
-                QMessageBox::information(this, tr("Find"), tr("Cannot find \"%1\".").arg(m_lastSearchTerm));
-            }
+            reportFindMiss(tr("Find"), m_lastSearchTerm);
         }
     }
 
@@ -128,10 +178,7 @@ namespace GnotePad::ui
 
         if (!performFind(m_lastSearchTerm, buildFindFlags(QTextDocument::FindBackward)))
         {
-            if (!GnotePad::Application::isHeadlessSmokeMode())
-            {
-                QMessageBox::information(this, tr("Find"), tr("Cannot find \"%1\".").arg(m_lastSearchTerm));
-            }
+            reportFindMiss(tr("Find"), m_lastSearchTerm);
         }
     }
 
@@ -159,10 +206,16 @@ namespace GnotePad::ui
         auto* const replaceField = new QLineEdit(m_lastReplaceText, &dialog);
         auto* const matchCase = new QCheckBox(tr("Match case"), &dialog);
         matchCase->setChecked(m_lastCaseSensitivity == Qt::CaseSensitive);
+        auto* const wholeWords = new QCheckBox(tr("Match whole word only"), &dialog);
+        wholeWords->setChecked(m_lastWholeWords);
+        auto* const useRegex = new QCheckBox(tr("Regular expression"), &dialog);
+        useRegex->setChecked(m_lastUseRegex);
 
         formLayout->addRow(tr("Find what:"), findField);
         formLayout->addRow(tr("Replace with:"), replaceField);
         formLayout->addRow(QString(), matchCase);
+        formLayout->addRow(QString(), wholeWords);
+        formLayout->addRow(QString(), useRegex);
 
         auto* const buttonsLayout = new QHBoxLayout();
         layout->addLayout(buttonsLayout);
@@ -178,11 +231,13 @@ namespace GnotePad::ui
         buttonsLayout->addWidget(closeButton);
         // NOLINTEND(cppcoreguidelines-owning-memory)
 
-        const auto applyDialogState = [this, findField, replaceField, matchCase]()
+        const auto applyDialogState = [this, findField, replaceField, matchCase, wholeWords, useRegex]()
         {
             m_lastSearchTerm = findField->text();
             m_lastReplaceText = replaceField->text();
             m_lastCaseSensitivity = matchCase->isChecked() ? Qt::CaseSensitive : Qt::CaseInsensitive;
+            m_lastWholeWords = wholeWords->isChecked();
+            m_lastUseRegex = useRegex->isChecked();
         };
 
         connect(findNextButton,
@@ -197,10 +252,7 @@ namespace GnotePad::ui
                     }
                     if (!performFind(m_lastSearchTerm, buildFindFlags()))
                     {
-                        if (!GnotePad::Application::isHeadlessSmokeMode())
-                        {
-                            QMessageBox::information(this, tr("Replace"), tr("Cannot find \"%1\".").arg(m_lastSearchTerm));
-                        }
+                        reportFindMiss(tr("Replace"), m_lastSearchTerm);
                     }
                 });
 
@@ -216,10 +268,7 @@ namespace GnotePad::ui
                     }
                     if (!replaceNextOccurrence(m_lastSearchTerm, m_lastReplaceText, buildFindFlags()))
                     {
-                        if (!GnotePad::Application::isHeadlessSmokeMode())
-                        {
-                            QMessageBox::information(this, tr("Replace"), tr("Cannot find \"%1\".").arg(m_lastSearchTerm));
-                        }
+                        reportFindMiss(tr("Replace"), m_lastSearchTerm);
                     }
                 });
 
@@ -234,7 +283,11 @@ namespace GnotePad::ui
                         return;
                     }
                     const int count = replaceAllOccurrences(m_lastSearchTerm, m_lastReplaceText, buildFindFlags());
-                    if (!GnotePad::Application::isHeadlessSmokeMode())
+                    if (!m_searchError.isEmpty())
+                    {
+                        reportFindMiss(tr("Replace"), m_lastSearchTerm);
+                    }
+                    else if (!GnotePad::Application::isHeadlessSmokeMode())
                     {
                         QMessageBox::information(this, tr("Replace"), tr("Replaced %1 occurrence(s).").arg(count));
                     }
@@ -259,6 +312,203 @@ namespace GnotePad::ui
         dialog.exec();
     }
 
+    void MainWindow::handleFindInFiles()
+    {
+        QDialog dialog(this);
+        dialog.setWindowTitle(tr("Find in Files"));
+        dialog.setModal(true);
+
+        QString directory = m_lastFindInFilesDirectory;
+        if (directory.isEmpty())
+        {
+            directory = m_lastOpenDirectory.isEmpty() ? QDir::homePath() : m_lastOpenDirectory;
+        }
+
+        // Dialog owns its child widgets; suppress ownership warnings for stack-local helpers.
+        // NOLINTBEGIN(cppcoreguidelines-owning-memory)
+        auto* const form = new QFormLayout(&dialog);
+        auto* const findField = new QLineEdit(m_lastSearchTerm, &dialog);
+        auto* const directoryRow = new QHBoxLayout();
+        auto* const directoryField = new QLineEdit(QDir::toNativeSeparators(directory), &dialog);
+        auto* const browseButton = new QPushButton(tr("Browse…"), &dialog);
+        auto* const filtersField =
+            new QLineEdit(m_lastFindInFilesFilters.isEmpty() ? QStringLiteral("*") : m_lastFindInFilesFilters, &dialog);
+        auto* const matchCase = new QCheckBox(tr("Match case"), &dialog);
+        matchCase->setChecked(m_lastCaseSensitivity == Qt::CaseSensitive);
+
+        directoryRow->addWidget(directoryField, 1);
+        directoryRow->addWidget(browseButton);
+        form->addRow(tr("Find what:"), findField);
+        form->addRow(tr("Look in:"), directoryRow);
+        form->addRow(tr("File types:"), filtersField);
+        form->addRow(QString(), matchCase);
+
+        auto* const buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, Qt::Horizontal, &dialog);
+        form->addWidget(buttons);
+        // NOLINTEND(cppcoreguidelines-owning-memory)
+
+        connect(buttons, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+        connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+        connect(browseButton,
+                &QPushButton::clicked,
+                &dialog,
+                [&dialog, directoryField]()
+                {
+                    const QString chosen = QFileDialog::getExistingDirectory(&dialog, tr("Look in"), directoryField->text());
+                    if (!chosen.isEmpty())
+                    {
+                        directoryField->setText(QDir::toNativeSeparators(chosen));
+                    }
+                });
+
+        bool shouldAutoDismiss = false;
+#ifdef GNOTE_TEST_HOOKS
+        shouldAutoDismiss = m_testAutoDismissDialogs;
+#endif
+        if (!shouldAutoDismiss && GnotePad::Application::isHeadlessSmokeMode())
+        {
+            shouldAutoDismiss = true;
+        }
+
+        if (shouldAutoDismiss)
+        {
+#ifdef GNOTE_TEST_HOOKS
+            if (m_testAutoDismissDialogs)
+            {
+                QTimer::singleShot(0, &dialog, &QDialog::reject);
+            }
+            else
+#endif
+            {
+                QTimer::singleShot(0, &dialog, &QDialog::accept);
+            }
+        }
+
+        if (dialog.exec() != QDialog::Accepted)
+        {
+            return;
+        }
+
+        const QString term = findField->text();
+        const QString root = QDir::fromNativeSeparators(directoryField->text().trimmed());
+        if (term.isEmpty() || root.isEmpty())
+        {
+            return;
+        }
+
+        m_lastSearchTerm = term;
+        m_lastCaseSensitivity = matchCase->isChecked() ? Qt::CaseSensitive : Qt::CaseInsensitive;
+        m_lastFindInFilesDirectory = root;
+        m_lastFindInFilesFilters = filtersField->text().trimmed();
+
+        // "*.cpp; *.h" and "*.cpp *.h" both name two patterns; nothing at all means every file.
+        QStringList filters = m_lastFindInFilesFilters.split(QRegularExpression(QStringLiteral("[;\\s]+")), Qt::SkipEmptyParts);
+        if (filters.isEmpty())
+        {
+            filters << QStringLiteral("*");
+        }
+
+        ensureFindInFilesPanel()->start(root, filters, term, m_lastCaseSensitivity);
+        m_findInFilesDock->show();
+        m_findInFilesDock->raise();
+    }
+
+    void MainWindow::handleWatchList()
+    {
+        if (!m_editor || largeFileViewerActive())
+        {
+            return;
+        }
+
+        QDialog dialog(this);
+        dialog.setWindowTitle(tr("Watch List"));
+        dialog.setModal(true);
+
+        // Dialog owns its child widgets; suppress ownership warnings for stack-local helpers.
+        // NOLINTBEGIN(cppcoreguidelines-owning-memory)
+        auto* const layout = new QVBoxLayout(&dialog);
+        auto* const termsLabel = new QLabel(tr("Terms to find, one per line:"), &dialog);
+        auto* const termsField = new QPlainTextEdit(m_watchTerms.join(u'\n'), &dialog);
+        auto* const loadButton = new QPushButton(tr("Load…"), &dialog);
+        auto* const matchCase = new QCheckBox(tr("Match case"), &dialog);
+        matchCase->setChecked(m_watchSensitivity == Qt::CaseSensitive);
+        auto* const buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, Qt::Horizontal, &dialog);
+        buttons->addButton(loadButton, QDialogButtonBox::ActionRole);
+        // NOLINTEND(cppcoreguidelines-owning-memory)
+
+        termsField->setLineWrapMode(QPlainTextEdit::NoWrap);
+        termsLabel->setBuddy(termsField);
+        layout->addWidget(termsLabel);
+        layout->addWidget(termsField, 1);
+        layout->addWidget(matchCase);
+        layout->addWidget(buttons);
+
+        connect(buttons, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+        connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+        connect(loadButton,
+                &QPushButton::clicked,
+                &dialog,
+                [this, &dialog, termsField]()
+                {
+                    const QString filePath =
+                        QFileDialog::getOpenFileName(&dialog, tr("Load Watch List"), dialogDirectory(m_lastOpenDirectory));
+                    if (filePath.isEmpty())
+                    {
+                        return;
+                    }
+                    QFile file(filePath);
+                    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+                    {
+                        QMessageBox::warning(&dialog, tr("Watch List"), tr("Cannot read %1.").arg(QDir::toNativeSeparators(filePath)));
+                        return;
+                    }
+                    termsField->setPlainText(QString::fromUtf8(file.readAll()));
+                });
+
+        bool shouldAutoDismiss = false;
+#ifdef GNOTE_TEST_HOOKS
+        shouldAutoDismiss = m_testAutoDismissDialogs;
+#endif
+        if (!shouldAutoDismiss && GnotePad::Application::isHeadlessSmokeMode())
+        {
+            shouldAutoDismiss = true;
+        }
+
+        if (shouldAutoDismiss)
+        {
+#ifdef GNOTE_TEST_HOOKS
+            if (m_testAutoDismissDialogs)
+            {
+                QTimer::singleShot(0, &dialog, &QDialog::reject);
+            }
+            else
+#endif
+            {
+                QTimer::singleShot(0, &dialog, &QDialog::accept);
+            }
+        }
+
+        if (dialog.exec() != QDialog::Accepted)
+        {
+            return;
+        }
+
+        QStringList terms;
+        for (const QString& line : termsField->toPlainText().split(u'\n', Qt::SkipEmptyParts))
+        {
+            const QString term = line.trimmed();
+            if (!term.isEmpty())
+            {
+                terms << term;
+            }
+        }
+        if (terms.isEmpty())
+        {
+            return;
+        }
+        runWatchList(terms, matchCase->isChecked() ? Qt::CaseSensitive : Qt::CaseInsensitive);
+    }
+
     void MainWindow::handleGoToLine()
     {
         if (!m_editor)
@@ -266,26 +516,193 @@ namespace GnotePad::ui
             return;
         }
 
-        const auto* document = m_editor->document();
-        const int maxLine = std::max(1, document ? document->blockCount() : 1);
+        const bool viewing = largeFileViewerActive();
+        const auto& lineIndex = m_editor->lineIndex();
+        const qint64 lineCount = viewing ? m_largeFileViewer->lineCount() : lineIndex.lineCount();
+        const int maxLine = static_cast<int>(std::clamp<qint64>(lineCount, 1, std::numeric_limits<int>::max()));
         bool accepted = false;
-        const int currentLine = m_editor->textCursor().blockNumber() + 1;
+        const auto currentLine =
+            static_cast<int>((viewing ? m_largeFileViewer->currentLine() : lineIndex.lineAt(m_editor->textCursor().position())) + 1);
         const int targetLine = QInputDialog::getInt(this, tr("Go To"), tr("Line number:"), currentLine, 1, maxLine, 1, &accepted);
         if (!accepted)
         {
             return;
         }
 
-        const QTextBlock block = document->findBlockByNumber(targetLine - 1);
-        if (!block.isValid())
+        goToLine(targetLine);
+    }
+
+    void MainWindow::goToLine(qint64 lineNumber)
+    {
+        if (!m_editor)
+        {
+            return;
+        }
+
+        if (largeFileViewerActive())
+        {
+            m_largeFileViewer->goToLine(lineNumber - 1);
+            return;
+        }
+
+        // The index maps the line straight to a document position; no walk over Qt's block list.
+        const qint64 position = m_editor->lineIndex().lineStart(lineNumber - 1);
+        revealFilteredLineAt(position);
+        QTextCursor cursor(m_editor->document());
+        cursor.setPosition(static_cast<int>(position));
+        m_editor->setTextCursor(cursor);
+        m_editor->centerCursor();
+    }
+
+    void MainWindow::openFileAtLine(const QString& filePath, qint64 lineNumber)
+    {
+        if (!m_currentFilePath.isEmpty() && QFileInfo(m_currentFilePath) == QFileInfo(filePath))
+        {
+            goToLine(lineNumber);
+            return;
+        }
+
+        if (!confirmReadyForDestructiveAction() || !loadDocumentFromPath(filePath))
+        {
+            return;
+        }
+
+        // A streamed load is still filling the editor; the jump waits for it to finish.
+        if (documentLoadInProgress())
         {
+            m_pendingGoToLine = lineNumber;
             return;
         }
+        goToLine(lineNumber);
+    }
+
+    FindInFilesPanel* MainWindow::ensureFindInFilesPanel()
+    {
+        if (m_findInFilesPanel)
+        {
+            return m_findInFilesPanel;
+        }
+
+        // NOLINTBEGIN(cppcoreguidelines-owning-memory)
+        m_findInFilesDock = new QDockWidget(tr("Find Results"), this);
+        m_findInFilesPanel = new FindInFilesPanel(m_findInFilesDock);
+        // NOLINTEND(cppcoreguidelines-owning-memory)
+
+        m_findInFilesDock->setObjectName(QStringLiteral("findResultsDock"));
+        m_findInFilesDock->setWidget(m_findInFilesPanel);
+        addDockWidget(Qt::BottomDockWidgetArea, m_findInFilesDock);
+        connect(m_findInFilesPanel, &FindInFilesPanel::hitActivated, this, &MainWindow::openFileAtLine);
+        return m_findInFilesPanel;
+    }
+
+    void MainWindow::runWatchList(const QStringList& terms, Qt::CaseSensitivity sensitivity)
+    {
+        // One pass over a snapshot of the piece table finds every term, however many there are, off the GUI thread.
+        const core::MultiTermSearch search(terms, sensitivity);
+        m_watchTerms = search.terms();
+        m_watchSensitivity = sensitivity;
+        m_watchHits.clear();
+        m_watchListScan->start(search, m_editor->pieceTable());
+        ensureWatchListPanel()->showSearching();
+        m_watchListDock->show();
+        m_watchListDock->raise();
+    }
+
+    void MainWindow::showWatchListResults()
+    {
+        // Counts are exact; stepping walks the hits kept, the first few thousand of each term.
+        m_watchHits = m_watchListScan->takeHits();
+        const std::vector<qint64>& counts = m_watchListScan->counts();
+        ensureWatchListPanel()->showCounts(m_watchTerms, counts);
+        spdlog::info("Watch list of {} terms found {} hits, {} kept for stepping",
+                     m_watchTerms.size(),
+                     std::accumulate(counts.begin(), counts.end(), qint64{0}),
+                     m_watchHits.size());
+    }
+
+    bool MainWindow::jumpToWatchHit(int term, bool backward)
+    {
+        if (!m_editor || m_watchHits.empty())
+        {
+            return false;
+        }
+
+        // Hits are ordered by where they start. The next one starts at the caret, or past the start of the hit
+        // already selected; the previous one before either. A negative term takes hits of any term, and the walk
+        // wraps round once.
+        const auto& hits = m_watchHits;
+        const QTextCursor current = m_editor->textCursor();
+        const auto byPosition = [](const core::MultiTermSearch::Hit& hit) { return hit.position; };
+        const auto wanted = [term](const core::MultiTermSearch::Hit& hit) { return term < 0 || hit.term == term; };
+        const auto firstOf = [&wanted](auto first, auto last) -> const core::MultiTermSearch::Hit*
+        {
+            const auto found = std::find_if(first, last, wanted);
+            return found == last ? nullptr : &*found;
+        };
+        const core::MultiTermSearch::Hit* hit = nullptr;
+        if (backward)
+        {
+            const qint64 anchor = current.selectionStart();
+            const auto split = std::make_reverse_iterator(std::ranges::lower_bound(hits, anchor, std::less<>(), byPosition));
+            hit = firstOf(split, hits.rend());
+            hit = hit ? hit : firstOf(hits.rbegin(), split);
+        }
+        else
+        {
+            const qint64 anchor = current.hasSelection() ? current.selectionStart() + 1 : current.position();
+            const auto split = std::ranges::lower_bound(hits, anchor, std::less<>(), byPosition);
+            hit = firstOf(split, hits.end());
+            hit = hit ? hit : firstOf(hits.begin(), split);
+        }
+        if (!hit)
+        {
+            return false;
+        }
 
-        QTextCursor cursor(block);
-        cursor.movePosition(QTextCursor::StartOfLine);
+        QTextCursor cursor(m_editor->document());
+        cursor.setPosition(static_cast<int>(hit->position));
+        cursor.setPosition(static_cast<int>(hit->position + m_watchTerms.at(hit->term).size()), QTextCursor::KeepAnchor);
         m_editor->setTextCursor(cursor);
         m_editor->centerCursor();
+        return true;
+    }
+
+    void MainWindow::invalidateWatchHits()
+    {
+        if (m_watchListScan->isRunning())
+        {
+            // Whatever the scan finds would describe text that is already gone.
+            m_watchListScan->cancel();
+            m_watchListPanel->markStale();
+            return;
+        }
+        if (m_watchHits.empty())
+        {
+            return;
+        }
+        m_watchHits.clear();
+        m_watchListPanel->markStale();
+    }
+
+    WatchListPanel* MainWindow::ensureWatchListPanel()
+    {
+        if (m_watchListPanel)
+        {
+            return m_watchListPanel;
+        }
+
+        // NOLINTBEGIN(cppcoreguidelines-owning-memory)
+        m_watchListDock = new QDockWidget(tr("Watch List"), this);
+        m_watchListPanel = new WatchListPanel(m_watchListDock);
+        // NOLINTEND(cppcoreguidelines-owning-memory)
+
+        m_watchListDock->setObjectName(QStringLiteral("watchListDock"));
+        m_watchListDock->setWidget(m_watchListPanel);
+        addDockWidget(Qt::BottomDockWidgetArea, m_watchListDock);
+        connect(m_watchListPanel, &WatchListPanel::termActivated, this, [this](int term) { jumpToWatchHit(term, false); });
+        connect(m_watchListPanel, &WatchListPanel::nextHitRequested, this, [this]() { jumpToWatchHit(-1, false); });
+        connect(m_watchListPanel, &WatchListPanel::previousHitRequested, this, [this]() { jumpToWatchHit(-1, true); });
+        return m_watchListPanel;
     }
 
     QTextDocument::FindFlags MainWindow::buildFindFlags(QTextDocument::FindFlags baseFlags) const
@@ -295,49 +712,137 @@ namespace GnotePad::ui
         {
             flags |= QTextDocument::FindCaseSensitively;
         }
+        if (m_lastWholeWords)
+        {
+            flags |= QTextDocument::FindWholeWords;
+        }
         return flags;
     }
 
     bool MainWindow::performFind(const QString& term, QTextDocument::FindFlags flags)
     {
+        m_searchError.clear();
         if (!m_editor || term.isEmpty())
         {
             return false;
         }
 
-        const QTextCursor originalCursor = m_editor->textCursor();
-        if (m_editor->find(term, flags))
+        if (largeFileViewerActive())
         {
-            return true;
+            return m_largeFileViewer->find(term, flags);
         }
 
-        QTextCursor searchCursor = originalCursor;
-        if (flags.testFlag(QTextDocument::FindBackward))
+        // Searched straight in the piece table's buffers; QTextDocument::find would walk blocks and formats.
+        const core::PieceTable& text = m_editor->pieceTable();
+        const std::vector<QStringView> pieces = text.pieces();
+        const qint64 length = text.length();
+        const QTextCursor current = m_editor->textCursor();
+
+        // Like QTextDocument::find: forward starts after the selection, backward before it. On a miss the
+        // search wraps round, but only over the part the first pass did not cover.
+        const bool backward = flags.testFlag(QTextDocument::FindBackward);
+        const qint64 anchor = backward ? current.selectionStart() : current.selectionEnd();
+        using Range = std::pair<qint64, qint64>;
+        const Range firstPass = backward ? Range{0, anchor} : Range{anchor, length};
+        const Range wrapPass = backward ? Range{anchor, length} : Range{0, anchor};
+
+        qint64 match = -1;
+        qint64 matchLength = 0;
+        if (m_lastUseRegex)
+        {
+            const QRegularExpression* expression = searchExpression(term, flags);
+            if (!expression)
+            {
+                return false;
+            }
+            core::RegexSearch search(*expression, pieces, m_editor->lineIndex(), kRegexBudgetMs);
+            core::RegexSearch::Match found;
+            auto result = search.find(firstPass.first, firstPass.second, backward, found);
+            if (result == core::RegexSearch::Result::NotFound)
+            {
+                result = search.find(wrapPass.first, wrapPass.second, backward, found);
+            }
+            if (result == core::RegexSearch::Result::TimedOut)
+            {
+                m_searchError = tr("The search took too long and was stopped.");
+                return false;
+            }
+            match = found.position;
+            matchLength = found.length;
+            highlightAllMatches(term, flags);
+        }
+        else if (wordIndexAnswers(term, flags))
         {
-            searchCursor.movePosition(QTextCursor::End);
+            const Qt::CaseSensitivity sensitivity =
+                flags.testFlag(QTextDocument::FindCaseSensitively) ? Qt::CaseSensitive : Qt::CaseInsensitive;
+            match = m_wordIndex->find(term, sensitivity, text, firstPass.first, firstPass.second, backward);
+            if (match < 0)
+            {
+                match = m_wordIndex->find(term, sensitivity, text, wrapPass.first, wrapPass.second, backward);
+            }
+            matchLength = term.size();
+            highlightAllMatches(term, flags);
         }
         else
         {
-            searchCursor.movePosition(QTextCursor::Start);
+            const core::LiteralSearch search(term,
+                                             flags.testFlag(QTextDocument::FindCaseSensitively) ? Qt::CaseSensitive : Qt::CaseInsensitive,
+                                             flags.testFlag(QTextDocument::FindWholeWords));
+            match = search.find(pieces, firstPass.first, firstPass.second, backward);
+            if (match < 0)
+            {
+                match = search.find(pieces, wrapPass.first, wrapPass.second, backward);
+            }
+            matchLength = search.termLength();
+            highlightAllMatches(term, flags);
         }
-        m_editor->setTextCursor(searchCursor);
-
-        const bool foundAfterWrap = m_editor->find(term, flags);
-        if (!foundAfterWrap)
+        if (match < 0)
         {
-            m_editor->setTextCursor(originalCursor);
+            return false;
         }
-        return foundAfterWrap;
+
+        revealFilteredLineAt(match);
+        QTextCursor found(m_editor->document());
+        found.setPosition(static_cast<int>(match));
+        found.setPosition(static_cast<int>(match + matchLength), QTextCursor::KeepAnchor);
+        m_editor->setTextCursor(found);
+        m_editor->ensureCursorVisible();
+        return true;
     }
 
     bool MainWindow::replaceNextOccurrence(const QString& term, const QString& replacement, QTextDocument::FindFlags flags)
     {
+        m_searchError.clear();
         if (!m_editor || term.isEmpty())
         {
             return false;
         }
 
         QTextCursor cursor = m_editor->textCursor();
+        if (m_lastUseRegex && !largeFileViewerActive())
+        {
+            // The selection is replaced only if the pattern matches exactly it; otherwise the next match is
+            // selected first. Either way the replacement is expanded against that match's groups.
+            const QRegularExpression* expression = searchExpression(term, flags);
+            if (!expression)
+            {
+                return false;
+            }
+            const core::ReplacementTemplate replacementTemplate(replacement);
+            QString expanded;
+            if (!regexMatchesSelection(*expression, replacementTemplate, expanded))
+            {
+                if (!performFind(term, flags) || !regexMatchesSelection(*expression, replacementTemplate, expanded))
+                {
+                    return false;
+                }
+                cursor = m_editor->textCursor();
+            }
+            cursor.insertText(expanded);
+            m_editor->setTextCursor(cursor);
+            return true;
+        }
+
         const bool selectionMatches = cursor.hasSelection() && QString::compare(cursor.selectedText(), term, m_lastCaseSensitivity) == 0;
         if (!selectionMatches)
         {
@@ -355,32 +860,495 @@ namespace GnotePad::ui
 
     int MainWindow::replaceAllOccurrences(const QString& term, const QString& replacement, QTextDocument::FindFlags flags)
     {
+        m_searchError.clear();
         if (!m_editor || term.isEmpty())
         {
             return 0;
         }
 
-        const QTextCursor originalCursor = m_editor->textCursor();
-        QTextCursor searchCursor = originalCursor;
-        searchCursor.movePosition(QTextCursor::Start);
-        m_editor->setTextCursor(searchCursor);
+        // One scan over the text plans every edit; toPlainText() keeps one character per document position, so
+        // match offsets are cursor positions.
+        const QString text = m_editor->toPlainText();
+        qsizetype matches = 0;
+        QList<core::TextReplacement> edits;
+        if (m_lastUseRegex)
+        {
+            const QRegularExpression* expression = searchExpression(term, flags);
+            if (!expression)
+            {
+                return 0;
+            }
+            const std::vector<QStringView> pieces{text};
+            core::RegexSearch search(*expression, pieces, m_editor->lineIndex(), kRegexBudgetMs);
+            if (search.planReplaceAll(text, core::ReplacementTemplate(replacement), edits, matches) == core::RegexSearch::Result::TimedOut)
+            {
+                m_searchError = tr("The search took too long and was stopped.");
+                return 0;
+            }
+        }
+        else
+        {
+            const core::LiteralSearch search(term,
+                                             flags.testFlag(QTextDocument::FindCaseSensitively) ? Qt::CaseSensitive : Qt::CaseInsensitive,
+                                             flags.testFlag(QTextDocument::FindWholeWords));
+            edits = core::planReplaceAll(text, search, replacement, matches);
+        }
+        if (edits.isEmpty())
+        {
+            return 0;
+        }
+
+        applyReplacements(edits);
+        return static_cast<int>(matches);
+    }
 
-        int replacedCount = 0;
-        while (m_editor->find(term, flags))
+    void MainWindow::applyReplacements(const QList<core::TextReplacement>& edits)
+    {
+        // Applied back to front so earlier positions stay put. Inside one edit block the whole lot is a single
+        // undo step, and the document reports one contentsChange at the end: one relayout, one stats update.
+        const QTextCursor originalCursor = m_editor->textCursor();
+        QTextCursor cursor(m_editor->document());
+        cursor.beginEditBlock();
+        for (auto edit = edits.crbegin(); edit != edits.crend(); ++edit)
         {
-            QTextCursor matchCursor = m_editor->textCursor();
-            matchCursor.insertText(replacement);
-            // Move cursor to the end of the replacement to avoid re-matching just-inserted text
-            matchCursor.movePosition(QTextCursor::NextCharacter, QTextCursor::MoveAnchor, static_cast<int>(replacement.length()));
-            m_editor->setTextCursor(matchCursor);
-            ++replacedCount;
+            cursor.setPosition(static_cast<int>(edit->position));
+            cursor.setPosition(static_cast<int>(edit->position + edit->length), QTextCursor::KeepAnchor);
+            cursor.insertText(edit->text);
         }
+        cursor.endEditBlock();
 
         m_editor->setTextCursor(originalCursor);
-        return replacedCount;
+    }
+
+    void MainWindow::highlightAllMatches(const QString& term, QTextDocument::FindFlags flags)
+    {
+        // Direction makes no difference to which text matches.
+        flags &= ~QTextDocument::FindBackward;
+        if (m_editor->matchIndex().isActive() && term == m_highlightedTerm && flags == m_highlightedFlags &&
+            m_lastUseRegex == m_highlightedRegex)
+        {
+            return;
+        }
+
+        if (m_lastUseRegex)
+        {
+            const QRegularExpression* expression = searchExpression(term, flags);
+            if (!expression)
+            {
+                return;
+            }
+            m_editor->highlightMatches(core::MatchIndex::regexMatcher(*expression));
+        }
+        else
+        {
+            const Qt::CaseSensitivity sensitivity =
+                flags.testFlag(QTextDocument::FindCaseSensitively) ? Qt::CaseSensitive : Qt::CaseInsensitive;
+            const core::LiteralSearch search(term, sensitivity, flags.testFlag(QTextDocument::FindWholeWords));
+            if (wordIndexAnswers(term, flags))
+            {
+                std::vector<core::MatchIndex::Match> matches;
+                for (const qint64 position : m_wordIndex->occurrences(term, sensitivity, m_editor->pieceTable()))
+                {
+                    matches.push_back(core::MatchIndex::Match{position, search.termLength()});
+                }
+                m_editor->highlightMatches(core::MatchIndex::literalMatcher(search), std::move(matches));
+            }
+            else
+            {
+                m_editor->highlightMatches(core::MatchIndex::literalMatcher(search));
+            }
+        }
+        m_highlightedTerm = term;
+        m_highlightedFlags = flags;
+        m_highlightedRegex = m_lastUseRegex;
+    }
+
+    bool MainWindow::wordIndexAnswers(const QString& term, QTextDocument::FindFlags flags) const
+    {
+        return !m_lastUseRegex && flags.testFlag(QTextDocument::FindWholeWords) && !largeFileViewerActive() && m_wordIndex->isReady() &&
+               core::WordIndex::isWord(term);
+    }
+
+    void MainWindow::handleMarkAllOccurrences()
+    {
+        if (!m_editor || largeFileViewerActive())
+        {
+            return;
+        }
+
+        QTextCursor cursor = m_editor->textCursor();
+        if (!cursor.hasSelection())
+        {
+            cursor.select(QTextCursor::WordUnderCursor);
+        }
+        const QString term = cursor.selectedText();
+        if (term.isEmpty())
+        {
+            return;
+        }
+
+        // The plain-text editor holds a single selection, so the occurrences are marked with the search
+        // highlights instead, counted in the status bar, and become the search Find Next and Find Previous step
+        // through. A single word is matched as a whole word, which the word index can answer at once.
+        m_lastSearchTerm = term;
+        m_lastUseRegex = false;
+        m_lastWholeWords = core::WordIndex::isWord(term);
+        m_editor->setTextCursor(cursor);
+        highlightAllMatches(term, buildFindFlags());
+        updateMatchStatus();
+    }
+
+    void MainWindow::handleToggleWordIndex(bool checked)
+    {
+        rebuildWordIndex();
+        if (checked && m_wordIndex->state() == core::WordIndex::State::Building)
+        {
+            m_statusBar->showMessage(tr("Indexing words…"), StatusMessageTimeoutMs);
+        }
+    }
+
+    void MainWindow::rebuildWordIndex()
+    {
+        // Only the editor's text is indexed; the large-file viewer keeps searching its mapped bytes.
+        if (m_wordIndexAction && m_wordIndexAction->isChecked() && !largeFileViewerActive())
+        {
+            m_wordIndex->build(m_editor->pieceTable());
+        }
+        else
+        {
+            m_wordIndex->clear();
+        }
+    }
+
+    void MainWindow::reportWordIndexReady()
+    {
+        const QString size = QLocale().formattedDataSize(m_wordIndex->memoryBytes());
+        spdlog::info("Word index ready: {} distinct words, {}", m_wordIndex->wordCount(), size.toStdString());
+        m_statusBar->showMessage(tr("Word index ready: %1 distinct words in %2").arg(m_wordIndex->wordCount()).arg(size),
+                                 StatusMessageTimeoutMs);
+    }
+
+    void MainWindow::reportWordIndexDropped(core::WordIndex::DropReason reason)
+    {
+        // Searches go back to scanning the text; the index is tried again with the next document.
+        const QString why = reason == core::WordIndex::DropReason::MemoryLimit
+                                ? tr("it would need more than %1").arg(QLocale().formattedDataSize(m_wordIndex->memoryLimit()))
+                                : tr("the system is low on memory");
+        spdlog::warn("Word index dropped: {}", why.toStdString());
+        m_statusBar->showMessage(tr("Word index dropped: %1").arg(why));
+    }
+
+    void MainWindow::handleFilterLines()
+    {
+        if (!m_editor || largeFileViewerActive())
+        {
+            return;
+        }
+
+        QDialog dialog(this);
+        dialog.setWindowTitle(tr("Filter Lines"));
+        dialog.setModal(true);
+
+        // Dialog owns its child widgets; suppress ownership warnings for stack-local helpers.
+        // NOLINTBEGIN(cppcoreguidelines-owning-memory)
+        auto* const form = new QFormLayout(&dialog);
+        auto* const patternField = new QLineEdit(m_lastFilterPattern.isEmpty() ? m_lastSearchTerm : m_lastFilterPattern, &dialog);
+        auto* const matchCase = new QCheckBox(tr("Match case"), &dialog);
+        auto* const useRegex = new QCheckBox(tr("Regular expression"), &dialog);
+        auto* const invert = new QCheckBox(tr("Show lines that do not match"), &dialog);
+        matchCase->setChecked(m_lastFilterSensitivity == Qt::CaseSensitive);
+        useRegex->setChecked(m_lastFilterRegex);
+        invert->setChecked(m_lastFilterInvert);
+
+        form->addRow(tr("Show lines containing:"), patternField);
+        form->addRow(QString(), matchCase);
+        form->addRow(QString(), useRegex);
+        form->addRow(QString(), invert);
+
+        auto* const buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, Qt::Horizontal, &dialog);
+        form->addWidget(buttons);
+        // NOLINTEND(cppcoreguidelines-owning-memory)
+
+        connect(buttons, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+        connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+
+        bool shouldAutoDismiss = false;
+#ifdef GNOTE_TEST_HOOKS
+        shouldAutoDismiss = m_testAutoDismissDialogs;
+#endif
+        if (!shouldAutoDismiss && GnotePad::Application::isHeadlessSmokeMode())
+        {
+            shouldAutoDismiss = true;
+        }
+
+        if (shouldAutoDismiss)
+        {
+            QTimer::singleShot(0, &dialog, &QDialog::reject);
+        }
+
+        if (dialog.exec() != QDialog::Accepted)
+        {
+            return;
+        }
+
+        filterLines(patternField->text(),
+                    matchCase->isChecked() ? Qt::CaseSensitive : Qt::CaseInsensitive,
+                    useRegex->isChecked(),
+                    invert->isChecked());
+    }
+
+    void MainWindow::handleShowAllLines()
+    {
+        if (!m_editor || !m_editor->isLineFilterActive())
+        {
+            return;
+        }
+
+        m_editor->clearLineFilter();
+        m_statusBar->showMessage(tr("Showing all lines"), StatusMessageTimeoutMs);
+    }
+
+    bool MainWindow::filterLines(const QString& pattern, Qt::CaseSensitivity sensitivity, bool useRegex, bool invert)
+    {
+        m_searchError.clear();
+        if (!m_editor || pattern.isEmpty() || largeFileViewerActive() || documentLoadInProgress())
+        {
+            return false;
+        }
+
+        // The large-file viewer has no blocks to hide, so the filter is offered for the editor only.
+        core::LineFilter::Predicate predicate;
+        if (useRegex)
+        {
+            const QTextDocument::FindFlags flags =
+                sensitivity == Qt::CaseSensitive ? QTextDocument::FindCaseSensitively : QTextDocument::FindFlags();
+            const QRegularExpression* expression = searchExpression(pattern, flags);
+            if (!expression)
+            {
+                m_statusBar->showMessage(m_searchError, StatusMessageTimeoutMs);
+                return false;
+            }
+            predicate = core::LineFilter::regexPredicate(*expression);
+        }
+        else
+        {
+            predicate = core::LineFilter::literalPredicate(core::LiteralSearch(pattern, sensitivity));
+        }
+
+        m_lastFilterPattern = pattern;
+        m_lastFilterSensitivity = sensitivity;
+        m_lastFilterRegex = useRegex;
+        m_lastFilterInvert = invert;
+        m_editor->filterLines(std::move(predicate), invert);
+        m_statusBar->showMessage(tr("Filtering lines…"), StatusMessageTimeoutMs);
+        updateActionStates();
+        return true;
+    }
+
+    void MainWindow::reportLinesFiltered(qint64 lineCount, qint64 hiddenCount)
+    {
+        const qint64 shown = lineCount - hiddenCount;
+        spdlog::info("Line filter shows {} of {} lines", shown, lineCount);
+        // The count stays up for as long as the filter does.
+        m_statusBar->showMessage(tr("Showing %1 of %2 lines").arg(shown).arg(lineCount));
+        updateActionStates();
+    }
+
+    void MainWindow::revealFilteredLineAt(qint64 position)
+    {
+        // A search or Go To that lands on a hidden line brings the whole document back around it.
+        if (m_editor->isLineFilterActive() && !m_editor->document()->findBlock(static_cast<int>(position)).isVisible())
+        {
+            handleShowAllLines();
+        }
+    }
+
+    void MainWindow::searchIncrementally(const QString& term, Qt::CaseSensitivity sensitivity)
+    {
+        m_lastSearchTerm = term;
+        m_lastCaseSensitivity = sensitivity;
+        m_lastWholeWords = false;
+        m_lastUseRegex = false;
+        m_searchError.clear();
+        m_findBar->setStatus(QString());
+        if (term.isEmpty())
+        {
+            m_incrementalSearch->cancel();
+            m_largeFileViewer->cancelFind();
+            m_editor->clearMatchHighlights();
+            m_highlightedTerm.clear();
+            return;
+        }
+
+        // Each keystroke starts again from the current match, so typing on extends it in place; the search that
+        // was running for the previous term is dropped.
+        if (largeFileViewerActive())
+        {
+            m_largeFileViewer->findIncrementally(term, buildFindFlags(), m_largeFileViewer->findAnchor());
+            return;
+        }
+
+        // The worker searches a snapshot of the piece table, so typing never waits on it.
+        const core::LiteralSearch search(term, sensitivity);
+        const core::PieceTable text = m_editor->pieceTable();
+        const qint64 length = text.length();
+        const qint64 anchor = std::min<qint64>(m_editor->textCursor().selectionStart(), length);
+        m_incrementalLength = search.termLength();
+        m_incrementalSearch->start([search, text, pieces = text.pieces()](qint64 from, qint64 until)
+                                   { return search.find(pieces, from, until, false); },
+                                   0,
+                                   anchor,
+                                   length);
+        highlightAllMatches(term, buildFindFlags());
+    }
+
+    void MainWindow::showIncrementalMatch(qint64 position)
+    {
+        if (position < 0)
+        {
+            m_findBar->setStatus(tr("Not found"));
+            return;
+        }
+
+        QTextCursor found(m_editor->document());
+        found.setPosition(static_cast<int>(position));
+        found.setPosition(static_cast<int>(position + m_incrementalLength), QTextCursor::KeepAnchor);
+        m_editor->setTextCursor(found);
+        m_editor->ensureCursorVisible();
+    }
+
+    void MainWindow::showLargeFileFindResult(bool found)
+    {
+        // The viewer searches on a worker, so performFind() only started the search and a miss is reported here:
+        // in the find bar while it is up, otherwise the way Find reports one.
+        if (m_findBar->isVisible())
+        {
+            m_findBar->setStatus(found ? QString() : tr("Not found"));
+            return;
+        }
+        if (!found)
+        {
+            reportFindMiss(tr("Find"), m_lastSearchTerm);
+        }
+    }
+
+    void MainWindow::stepFindBar(bool backward)
+    {
+        const QString term = m_findBar->term();
+        if (term.isEmpty())
+        {
+            return;
+        }
+
+        m_incrementalSearch->cancel();
+        m_largeFileViewer->cancelFind();
+        m_lastSearchTerm = term;
+        m_lastCaseSensitivity = m_findBar->caseSensitivity();
+        m_lastWholeWords = false;
+        m_lastUseRegex = false;
+        const bool found = performFind(term, buildFindFlags(backward ? QTextDocument::FindBackward : QTextDocument::FindFlags()));
+        m_findBar->setStatus(found ? QString() : tr("Not found"));
+    }
+
+    void MainWindow::closeFindBar()
+    {
+        m_incrementalSearch->cancel();
+        m_largeFileViewer->cancelFind();
+        m_findBar->hide();
+        if (QWidget* const current = m_editorStack->currentWidget())
+        {
+            current->setFocus(Qt::ShortcutFocusReason);
+        }
+    }
+
+    void MainWindow::updateMatchStatus()
+    {
+        if (!m_editor || !m_matchCountLabel)
+        {
+            return;
+        }
+
+        const core::MatchIndex& matches = m_editor->matchIndex();
+        if (!matches.isActive() || largeFileViewerActive())
+        {
+            m_matchCountLabel->setVisible(false);
+            return;
+        }
+
+        if (matches.isScanning())
+        {
+            m_matchCountLabel->setText(tr("Counting matches..."));
+        }
+        else
+        {
+            const QTextCursor cursor = m_editor->textCursor();
+            const qsizetype current = matches.indexOf(cursor.selectionStart(), cursor.selectionEnd() - cursor.selectionStart());
+            m_matchCountLabel->setText(current >= 0 ? tr("%1 of %2").arg(current + 1).arg(matches.count())
+                                                    : tr("%1 matches").arg(matches.count()));
+        }
+        m_matchCountLabel->setVisible(true);
+    }
+
+    const QRegularExpression* MainWindow::searchExpression(const QString& pattern, QTextDocument::FindFlags flags)
+    {
+        QRegularExpression::PatternOptions options = QRegularExpression::UseUnicodePropertiesOption;
+        if (!flags.testFlag(QTextDocument::FindCaseSensitively))
+        {
+            options |= QRegularExpression::CaseInsensitiveOption;
+        }
+        const QString wrapped = flags.testFlag(QTextDocument::FindWholeWords) ? QStringLiteral("\\b(?:%1)\\b").arg(pattern) : pattern;
+        const QRegularExpression& expression = m_regexCache.get(wrapped, options);
+        if (!expression.isValid())
+        {
+            m_searchError = tr("The regular expression is not valid: %1.").arg(expression.errorString());
+            return nullptr;
+        }
+        return &expression;
+    }
+
+    bool MainWindow::regexMatchesSelection(const QRegularExpression& expression,
+                                           const core::ReplacementTemplate& replacement,
+                                           QString& expanded) const
+    {
+        const QTextCursor cursor = m_editor->textCursor();
+        if (!cursor.hasSelection())
+        {
+            return false;
+        }
+
+        const std::vector<QStringView> pieces = m_editor->pieceTable().pieces();
+        core::RegexSearch search(expression, pieces, m_editor->lineIndex(), kRegexBudgetMs);
+        core::RegexSearch::Match match;
+        const qint64 start = cursor.selectionStart();
+        if (search.find(start, start + 1, false, match, &replacement) != core::RegexSearch::Result::Found || match.position != start ||
+            match.length != cursor.selectionEnd() - start)
+        {
+            return false;
+        }
+        expanded = match.replacement;
+        return true;
+    }
+
+    void MainWindow::reportFindMiss(const QString& title, const QString& term)
+    {
+        if (GnotePad::Application::isHeadlessSmokeMode())
+        {
+            return;
+        }
+        if (!m_searchError.isEmpty())
+        {
+            QMessageBox::warning(this, title, m_searchError);
+            return;
+        }
+        QMessageBox::information(this, title, tr("Cannot find \"%1\".").arg(term));
     }
 
 #ifdef GNOTE_TEST_HOOKS
+    QString MainWindow::matchStatusForTest() const
+    {
+        return m_matchCountLabel->text();
+    }
+
     void MainWindow::setSearchStateForTest(const QString& term, Qt::CaseSensitivity sensitivity, const QString& replacement)
     {
         m_lastSearchTerm = term;
@@ -420,6 +1388,20 @@ namespace GnotePad::ui
     {
         return replaceAllOccurrences(term, replacement, buildFindFlags(extraFlags));
     }
+
+    FindInFilesPanel* MainWindow::testFindInFiles(const QString& directory, const QStringList& nameFilters, const QString& term)
+    {
+        FindInFilesPanel* const panel = ensureFindInFilesPanel();
+        panel->start(directory, nameFilters, term, m_lastCaseSensitivity);
+        m_findInFilesDock->show();
+        return panel;
+    }
+
+    WatchListPanel* MainWindow::testWatchList(const QStringList& terms, Qt::CaseSensitivity sensitivity)
+    {
+        runWatchList(terms, sensitivity);
+        return m_watchListPanel;
+    }
 #endif
 
 } // namespace GnotePad::ui
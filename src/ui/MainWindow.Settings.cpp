@@ -81,6 +81,7 @@ namespace GnotePad::ui
         loadEditorFontSettings(settings, hasExistingPreferences);
         loadEditorViewSettings(settings);
         loadEditorBehaviorSettings(settings);
+        loadFileHandlingSettings(settings);
         loadPrinterSettings(settings);
     }
 
@@ -93,6 +94,7 @@ namespace GnotePad::ui
         saveRecentFilesSettings(settings);
         saveEditorFontSettings(settings);
         saveEditorBehaviorSettings(settings);
+        saveFileHandlingSettings(settings);
         savePrinterSettings(settings);
         clearLegacySettings(settings);
     }
@@ -202,6 +204,17 @@ namespace GnotePad::ui
             m_wordWrapAction->setChecked(wrapEnabled);
         }
 
+        const bool wordIndexEnabled = settings.value("editor/wordIndex", false).toBool();
+        if (m_wordIndexAction)
+        {
+            const QSignalBlocker blocker(m_wordIndexAction);
+            m_wordIndexAction->setChecked(wordIndexEnabled);
+        }
+        if (m_editor)
+        {
+            rebuildWordIndex();
+        }
+
         const bool statusBarVisible = settings.value("editor/statusBarVisible", true).toBool();
         if (m_statusBar)
         {
@@ -247,6 +260,18 @@ namespace GnotePad::ui
         }
     }
 
+    void MainWindow::loadFileHandlingSettings(QSettings& settings)
+    {
+        // A negative threshold disables memory-mapped opens entirely.
+        m_memoryMapThresholdBytes = settings.value("files/memoryMapThresholdBytes", DefaultMemoryMapThresholdBytes).toLongLong();
+        // Files at or above this size load on a worker thread; a negative threshold keeps every load synchronous.
+        m_backgroundLoadThresholdBytes =
+            settings.value("files/backgroundLoadThresholdBytes", DefaultBackgroundLoadThresholdBytes).toLongLong();
+        m_backgroundSaveEnabled = settings.value("files/backgroundSave", true).toBool();
+        // Files at or above this size open in the read-only large file viewer; a negative threshold never uses it.
+        m_largeFileViewerThresholdBytes = settings.value("files/viewerThresholdBytes", DefaultLargeFileViewerThresholdBytes).toLongLong();
+    }
+
     void MainWindow::saveWindowGeometrySettings(QSettings& settings) const
     {
         const QRect windowRect = isMaximized() ? normalGeometry() : geometry();
@@ -277,6 +302,7 @@ namespace GnotePad::ui
             settings.setValue("editor/fontPointSize", editorFont.pointSizeF());
             settings.setValue("editor/lineNumbersVisible", m_editor->lineNumbersVisible());
             settings.setValue("editor/wordWrap", m_editor->wordWrapMode() != QTextOption::NoWrap);
+            settings.setValue("editor/wordIndex", m_wordIndexAction && m_wordIndexAction->isChecked());
             return;
         }
 
@@ -284,6 +310,7 @@ namespace GnotePad::ui
         settings.remove("editor/fontPointSize");
         settings.setValue("editor/lineNumbersVisible", true);
         settings.setValue("editor/wordWrap", false);
+        settings.setValue("editor/wordIndex", false);
     }
 
     void MainWindow::saveEditorBehaviorSettings(QSettings& settings) const
@@ -297,6 +324,14 @@ namespace GnotePad::ui
                           m_dateFormatPreference == DateFormatPreference::Long ? QStringLiteral("long") : QStringLiteral("short"));
     }
 
+    void MainWindow::saveFileHandlingSettings(QSettings& settings) const
+    {
+        settings.setValue("files/memoryMapThresholdBytes", m_memoryMapThresholdBytes);
+        settings.setValue("files/backgroundLoadThresholdBytes", m_backgroundLoadThresholdBytes);
+        settings.setValue("files/backgroundSave", m_backgroundSaveEnabled);
+        settings.setValue("files/viewerThresholdBytes", m_largeFileViewerThresholdBytes);
+    }
+
     void MainWindow::clearLegacySettings(QSettings& settings)
     {
         settings.remove("window/geometry");
@@ -1,5 +1,9 @@
 #include "ui/MainWindow.h"
 
+#include "core/DocumentLoader.h"
+#include "core/DocumentSaver.h"
+#include "ui/FindBar.h"
+#include "ui/LargeFileViewer.h"
 #include "ui/PrintSupport.h"
 #include "ui/TextEditor.h"
 
@@ -7,12 +11,14 @@
 
 #include <QtCore/qcoreapplication.h>
 #include <QtCore/qdatetime.h>
+#include <QtCore/qfilesystemwatcher.h>
 #include <QtCore/qfileinfo.h>
 #include <QtCore/qlocale.h>
 #include <QtCore/qstring.h>
 #include <QtCore/qstringconverter.h>
 #include <QtCore/qstringlist.h>
 #include <QtCore/qstringliteral.h>
+#include <QtCore/qtimer.h>
 #include <QtCore/qurl.h>
 #include <QtGui/qaction.h>
 #include <QtGui/qactiongroup.h>
@@ -38,7 +44,10 @@
 #include <QtWidgets/qmenubar.h>
 #include <QtWidgets/qmessagebox.h>
 #include <QtWidgets/qplaintextedit.h>
+#include <QtWidgets/qprogressbar.h>
+#include <QtWidgets/qstackedwidget.h>
 #include <QtWidgets/qstatusbar.h>
+#include <QtWidgets/qtoolbutton.h>
 #include <QtWidgets/qwidget.h>
 
 #include <QSignalBlocker>
@@ -69,7 +78,37 @@ namespace GnotePad::ui
         m_editor = new TextEditor(this);
         applyDefaultEditorFont();
         m_editor->setWordWrapMode(QTextOption::NoWrap);
-        setCentralWidget(m_editor);
+
+        // NOLINTBEGIN(cppcoreguidelines-owning-memory)
+        // Files too large to decode into the editor are shown by the read-only viewer in the same place.
+        m_largeFileViewer = new LargeFileViewer(this);
+        auto* const central = new QWidget(this);
+        auto* const centralLayout = new QVBoxLayout(central);
+        m_editorStack = new QStackedWidget(central);
+        m_findBar = new FindBar(central);
+        m_editorStack->addWidget(m_editor);
+        m_editorStack->addWidget(m_largeFileViewer);
+        centralLayout->setContentsMargins(0, 0, 0, 0);
+        centralLayout->setSpacing(0);
+        centralLayout->addWidget(m_editorStack, 1);
+        centralLayout->addWidget(m_findBar);
+        m_findBar->hide();
+        setCentralWidget(central);
+
+        m_documentLoader = new core::DocumentLoader(this);
+        m_reloadLoader = new core::DocumentLoader(this);
+        m_documentReader = new core::DocumentReader(this);
+        m_documentSaver = new core::DocumentSaver(this);
+        m_incrementalSearch = new core::IncrementalSearch(this);
+        m_watchListScan = new core::WatchListScan(this);
+        m_wordIndex = new core::WordIndex(this);
+        m_fileWatcher = new QFileSystemWatcher(this);
+        m_followPollTimer = new QTimer(this);
+        m_journalTimer = new QTimer(this);
+        // NOLINTEND(cppcoreguidelines-owning-memory)
+        // Change notifications can be missed (network shares, some container mounts); a slow poll backs them up.
+        m_followPollTimer->setInterval(FollowPollIntervalMs);
+        m_journalTimer->setInterval(JournalFlushIntervalMs);
     }
 
     void MainWindow::applyDefaultEditorFont()
@@ -107,6 +146,19 @@ namespace GnotePad::ui
         m_editor->setTabSizeSpaces(m_tabSizeSpaces);
     }
 
+    void MainWindow::syncLargeFileViewerAppearance()
+    {
+        if (!m_editor || !m_largeFileViewer)
+        {
+            return;
+        }
+
+        // The editor's font already carries its zoom, so the viewer follows zoom changes by taking it over.
+        m_largeFileViewer->setDisplayFont(m_editor->font());
+        m_largeFileViewer->setTabSizeSpaces(m_editor->tabSizeSpaces());
+        m_largeFileViewer->setLineNumbersVisible(m_editor->lineNumbersVisible());
+    }
+
     void MainWindow::buildMenus()
     {
         auto* bar = menuBar();
@@ -124,23 +176,36 @@ namespace GnotePad::ui
         m_saveAsAction = fileMenu->addAction(tr("Save &As…"), QKeySequence::SaveAs, this, &MainWindow::handleSaveFileAs);
         m_encodingAction = fileMenu->addAction(tr("E&ncoding…"), this, &MainWindow::handleChangeEncoding);
         m_encodingAction->setObjectName(QStringLiteral("actionEncoding"));
+        m_cancelLoadAction = fileMenu->addAction(tr("Cancel &Loading"), QKeySequence::Cancel, this, &MainWindow::handleCancelLoad);
+        m_cancelLoadAction->setObjectName(QStringLiteral("actionCancelLoad"));
+        m_cancelLoadAction->setToolTip(tr("Stop loading the current file"));
         fileMenu->addSeparator();
         fileMenu->addAction(tr("Choose P&rinter…"), this, &MainWindow::handleChoosePrinter);
         m_printAction = fileMenu->addAction(tr("&Print"), QKeySequence::Print, this, &MainWindow::handlePrint);
         fileMenu->addSeparator();
         fileMenu->addAction(tr("E&xit"), QKeySequence::Quit, this, &QWidget::close);
 
-        editMenu->addAction(tr("&Undo"), QKeySequence::Undo, m_editor, &QPlainTextEdit::undo);
+        editMenu->addAction(tr("&Undo"), QKeySequence::Undo, m_editor, &TextEditor::undoEdit);
         m_cutAction = editMenu->addAction(tr("Cu&t"), QKeySequence::Cut, m_editor, &QPlainTextEdit::cut);
         m_copyAction = editMenu->addAction(tr("&Copy"), QKeySequence::Copy, m_editor, &QPlainTextEdit::copy);
         editMenu->addAction(tr("&Paste"), QKeySequence::Paste, m_editor, &QPlainTextEdit::paste);
         m_deleteAction = editMenu->addAction(tr("De&lete"), m_editor, &QPlainTextEdit::cut);
         editMenu->addSeparator();
         m_findAction = editMenu->addAction(tr("&Find…"), QKeySequence::Find, this, &MainWindow::handleFind);
+        m_incrementalFindAction =
+            editMenu->addAction(tr("&Incremental Find"), QKeySequence(Qt::CTRL | Qt::Key_I), this, &MainWindow::handleIncrementalFind);
         m_findNextAction = editMenu->addAction(tr("Find &Next"), QKeySequence(Qt::Key_F3), this, &MainWindow::handleFindNext);
         m_findPreviousAction =
             editMenu->addAction(tr("Find &Previous"), QKeySequence(Qt::SHIFT | Qt::Key_F3), this, &MainWindow::handleFindPrevious);
         m_replaceAction = editMenu->addAction(tr("&Replace…"), QKeySequence::Replace, this, &MainWindow::handleReplace);
+        m_findInFilesAction = editMenu->addAction(
+            tr("Find in F&iles…"), QKeySequence(Qt::CTRL | Qt::SHIFT | Qt::Key_F), this, &MainWindow::handleFindInFiles);
+        m_findInFilesAction->setObjectName(QStringLiteral("actionFindInFiles"));
+        m_watchListAction = editMenu->addAction(
+            tr("&Watch List…"), QKeySequence(Qt::CTRL | Qt::SHIFT | Qt::Key_L), this, &MainWindow::handleWatchList);
+        m_markOccurrencesAction = editMenu->addAction(
+            tr("&Mark All Occurrences"), QKeySequence(Qt::ALT | Qt::Key_F3), this, &MainWindow::handleMarkAllOccurrences);
+        m_markOccurrencesAction->setObjectName(QStringLiteral("actionMarkAllOccurrences"));
         m_goToAction = editMenu->addAction(tr("&Go To…"), QKeySequence(Qt::CTRL | Qt::Key_G), this, &MainWindow::handleGoToLine);
         editMenu->addSeparator();
         editMenu->addAction(tr("Select &All"), QKeySequence::SelectAll, m_editor, &QPlainTextEdit::selectAll);
@@ -182,6 +247,23 @@ namespace GnotePad::ui
         m_lineNumberToggle->setCheckable(true);
         m_lineNumberToggle->setChecked(m_editor ? m_editor->lineNumbersVisible() : false);
 
+        m_followAction = viewMenu->addAction(tr("&Follow File"));
+        m_followAction->setObjectName(QStringLiteral("actionFollow"));
+        m_followAction->setCheckable(true);
+        m_followAction->setToolTip(tr("Show text appended to the file on disk as it arrives"));
+        connect(m_followAction, &QAction::toggled, this, &MainWindow::handleToggleFollow);
+
+        m_filterLinesAction = viewMenu->addAction(tr("F&ilter Lines…"), this, &MainWindow::handleFilterLines);
+        m_filterLinesAction->setObjectName(QStringLiteral("actionFilterLines"));
+        m_showAllLinesAction = viewMenu->addAction(tr("Show &All Lines"), this, &MainWindow::handleShowAllLines);
+        m_showAllLinesAction->setObjectName(QStringLiteral("actionShowAllLines"));
+
+        m_wordIndexAction = viewMenu->addAction(tr("Word &Index"));
+        m_wordIndexAction->setObjectName(QStringLiteral("actionWordIndex"));
+        m_wordIndexAction->setCheckable(true);
+        m_wordIndexAction->setToolTip(tr("Index the document's words so whole-word searches and counts answer at once"));
+        connect(m_wordIndexAction, &QAction::toggled, this, &MainWindow::handleToggleWordIndex);
+
         auto* zoomMenu = viewMenu->addMenu(tr("&Zoom"));
         zoomMenu->addAction(tr("Zoom &In"), QKeySequence::ZoomIn, this, &MainWindow::handleZoomIn);
         zoomMenu->addAction(tr("Zoom &Out"), QKeySequence::ZoomOut, this, &MainWindow::handleZoomOut);
@@ -201,11 +283,25 @@ namespace GnotePad::ui
         // NOLINTBEGIN(cppcoreguidelines-owning-memory)
         m_cursorLabel = new QLabel(tr("Ln 1, Col 1"), this);
         m_documentStatsLabel = new QLabel(tr("Length: 0  Lines: 1"), this);
+        m_matchCountLabel = new QLabel(this);
         m_encodingLabel = new QLabel(tr("UTF-8"), this);
         const QString defaultZoomText = tr("%1%").arg(DefaultZoomPercent);
         m_zoomLabel = new QLabel(defaultZoomText, this);
+        m_loadProgressBar = new QProgressBar(this);
+        m_cancelLoadButton = new QToolButton(this);
         // NOLINTEND(cppcoreguidelines-owning-memory)
 
+        m_loadProgressBar->setRange(0, LoadProgressSteps);
+        m_loadProgressBar->setMaximumWidth(LoadProgressBarWidth);
+        m_loadProgressBar->setVisible(false);
+        m_cancelLoadButton->setDefaultAction(m_cancelLoadAction);
+        m_cancelLoadButton->setAutoRaise(true);
+        m_cancelLoadButton->setVisible(false);
+        m_statusBar->addWidget(m_loadProgressBar);
+        m_statusBar->addWidget(m_cancelLoadButton);
+
+        m_matchCountLabel->setVisible(false);
+        m_statusBar->addPermanentWidget(m_matchCountLabel);
         m_statusBar->addPermanentWidget(m_cursorLabel);
         m_statusBar->addPermanentWidget(m_documentStatsLabel);
         m_statusBar->addPermanentWidget(m_encodingLabel);
@@ -219,12 +315,98 @@ namespace GnotePad::ui
     void MainWindow::wireSignals()
     {
         connect(m_editor, &QPlainTextEdit::cursorPositionChanged, this, &MainWindow::handleUpdateCursorStatus);
+        connect(m_editor, &QPlainTextEdit::cursorPositionChanged, this, &MainWindow::updateMatchStatus);
+        connect(&m_editor->matchIndex(), &core::MatchIndex::matchesChanged, this, &MainWindow::updateMatchStatus);
+        connect(m_findBar, &FindBar::termEdited, this, &MainWindow::searchIncrementally);
+        connect(m_findBar, &FindBar::findNextRequested, this, [this]() { stepFindBar(false); });
+        connect(m_findBar, &FindBar::findPreviousRequested, this, [this]() { stepFindBar(true); });
+        connect(m_findBar, &FindBar::closeRequested, this, &MainWindow::closeFindBar);
+        connect(m_incrementalSearch, &core::IncrementalSearch::finished, this, &MainWindow::showIncrementalMatch);
+        // Positions found in the snapshot mean nothing once the text has moved on.
+        connect(m_editor->document(), &QTextDocument::contentsChanged, m_incrementalSearch, &core::IncrementalSearch::cancel);
+        connect(m_watchListScan, &core::WatchListScan::finished, this, &MainWindow::showWatchListResults);
+        connect(m_editor->document(), &QTextDocument::contentsChanged, this, &MainWindow::invalidateWatchHits);
+        connect(m_largeFileViewer, &LargeFileViewer::findFinished, this, &MainWindow::showLargeFileFindResult);
         connect(m_editor, &QPlainTextEdit::textChanged, this, &MainWindow::updateDocumentStats);
         connect(m_editor, &QPlainTextEdit::textChanged, this, &MainWindow::updateActionStates);
         connect(m_editor, &QPlainTextEdit::selectionChanged, this, &MainWindow::updateActionStates);
         connect(m_editor, &TextEditor::zoomPercentageChanged, this, &MainWindow::updateZoomLabel);
+        // The viewer shares the editor's font and zoom; both change together with the zoom percentage.
+        connect(m_editor, &TextEditor::zoomPercentageChanged, this, &MainWindow::syncLargeFileViewerAppearance);
+        connect(m_largeFileViewer, &LargeFileViewer::cursorPositionChanged, this, &MainWindow::handleUpdateCursorStatus);
+        connect(m_largeFileViewer, &LargeFileViewer::lineCountChanged, this, &MainWindow::updateDocumentStats);
+        connect(m_largeFileViewer,
+                &LargeFileViewer::zoomRequested,
+                this,
+                [this](int steps)
+                {
+                    if (steps > 0)
+                    {
+                        handleZoomIn();
+                    }
+                    else
+                    {
+                        handleZoomOut();
+                    }
+                });
+        connect(m_documentLoader,
+                &core::DocumentLoader::encodingDetected,
+                this,
+                [this](QStringConverter::Encoding encoding, bool hasBom) { applyEncodingSelection(encoding, hasBom); });
+        connect(m_documentLoader, &core::DocumentLoader::chunkReady, this, &MainWindow::appendLoadedChunk);
+        connect(m_documentLoader, &core::DocumentLoader::progressChanged, this, &MainWindow::updateLoadProgress);
+        connect(m_documentLoader, &core::DocumentLoader::finished, this, &MainWindow::finishBackgroundLoad);
+        connect(m_reloadLoader,
+                &core::DocumentLoader::encodingDetected,
+                this,
+                [this](QStringConverter::Encoding encoding, bool hasBom)
+                {
+                    m_pendingReload.encoding = encoding;
+                    m_pendingReload.hasBom = hasBom;
+                });
+        connect(m_reloadLoader, &core::DocumentLoader::chunkReady, this, &MainWindow::appendReloadedChunk);
+        connect(m_reloadLoader,
+                &core::DocumentLoader::progressChanged,
+                this,
+                [this](qint64 bytesProcessed, qint64) { m_pendingReload.diskBytes = bytesProcessed; });
+        connect(m_reloadLoader, &core::DocumentLoader::finished, this, &MainWindow::finishReload);
+        connect(m_documentReader, &core::DocumentReader::documentReady, this, &MainWindow::handleDocumentRead);
+        connect(m_documentReader, &core::DocumentReader::documentFailed, this, &MainWindow::reportReadFailure);
+        connect(m_documentSaver, &core::DocumentSaver::finished, this, &MainWindow::finishBackgroundSave);
+        connect(m_fileWatcher, &QFileSystemWatcher::fileChanged, this, &MainWindow::handleDocumentFileChanged);
+        connect(m_fileWatcher, &QFileSystemWatcher::directoryChanged, this, &MainWindow::handleDocumentFileChanged);
+        connect(m_followPollTimer, &QTimer::timeout, this, &MainWindow::pollFollowedFile);
+        // Edits are journalled as they reach the editor's models and written out in batches on the timer.
+        connect(m_editor,
+                &TextEditor::modelEdited,
+                this,
+                [this](qint64 position, qint64 charsRemoved, const QString& inserted) { m_editJournal.recordEdit(position, charsRemoved, inserted); });
+        connect(m_editor, &TextEditor::modelRebuilt, this, [this]() { m_editJournal.requestSnapshot(); });
+        // The word index follows the same edits, and starts over when the models do.
+        connect(m_editor,
+                &TextEditor::modelEdited,
+                this,
+                [this](qint64 position, qint64 charsRemoved, const QString& inserted)
+                { m_wordIndex->applyEdit(position, charsRemoved, inserted.size(), m_editor->pieceTable()); });
+        connect(m_editor, &TextEditor::modelRebuilt, this, &MainWindow::rebuildWordIndex);
+        connect(m_wordIndex, &core::WordIndex::ready, this, &MainWindow::reportWordIndexReady);
+        connect(m_wordIndex, &core::WordIndex::dropped, this, &MainWindow::reportWordIndexDropped);
+        connect(m_editor, &TextEditor::linesFiltered, this, &MainWindow::reportLinesFiltered);
+        connect(m_editor, &TextEditor::lineFilterCleared, this, &MainWindow::updateActionStates);
+        connect(m_journalTimer, &QTimer::timeout, this, &MainWindow::flushEditJournal);
+        m_journalTimer->start();
         if (m_editor && m_editor->document())
         {
+            connect(m_editor->document(),
+                    &QTextDocument::contentsChange,
+                    this,
+                    [this](int, int charsRemoved, int charsAdded)
+                    {
+                        if (charsRemoved != 0 || charsAdded != 0)
+                        {
+                            ++m_editGeneration;
+                        }
+                    });
             connect(m_editor->document(),
                     &QTextDocument::modificationChanged,
                     this,
@@ -281,6 +463,7 @@ namespace GnotePad::ui
 
         m_tabSizeSpaces = newSize;
         m_editor->setTabSizeSpaces(newSize);
+        syncLargeFileViewerAppearance();
         spdlog::info("Tab size updated to {} spaces", newSize);
     }
 
@@ -452,6 +635,7 @@ namespace GnotePad::ui
         {
             m_editor->setLineNumbersVisible(checked);
         }
+        syncLargeFileViewerAppearance();
         spdlog::info("Line numbers toggled: {}", checked);
     }
 
@@ -486,6 +670,13 @@ namespace GnotePad::ui
             return;
         }
 
+        if (largeFileViewerActive())
+        {
+            m_cursorLabel->setText(
+                tr("Ln %1, Col %2").arg(m_largeFileViewer->currentLine() + 1).arg(m_largeFileViewer->currentColumn() + 1));
+            return;
+        }
+
         const auto cursor = m_editor->textCursor();
         const int line = cursor.blockNumber() + 1;
         const int column = cursor.columnNumber() + 1;
@@ -507,10 +698,17 @@ namespace GnotePad::ui
             return;
         }
 
-        const auto* document = m_editor->document();
-        const int lines = document ? document->blockCount() : 0;
-        const int characters = document ? std::max(0, document->characterCount() - 1) : 0;
-        m_documentStatsLabel->setText(tr("Length: %1  Lines: %2").arg(characters).arg(std::max(1, lines)));
+        if (largeFileViewerActive())
+        {
+            // Lines keep counting up while the viewer indexes the file in the background.
+            const qint64 lineCount = m_largeFileViewer->lineCount();
+            const QString lines = m_largeFileViewer->indexingComplete() ? QString::number(lineCount) : tr("%1+").arg(lineCount);
+            m_documentStatsLabel->setText(tr("Size: %1 bytes  Lines: %2  Read-only").arg(m_largeFileViewer->fileSize()).arg(lines));
+            return;
+        }
+
+        const auto& lineIndex = m_editor->lineIndex();
+        m_documentStatsLabel->setText(tr("Length: %1  Lines: %2").arg(lineIndex.length()).arg(lineIndex.lineCount()));
     }
 
     void MainWindow::updateZoomLabel(int percentage)
@@ -524,25 +722,33 @@ namespace GnotePad::ui
 
     void MainWindow::updateActionStates()
     {
-        const bool hasContent = documentHasContent();
+        // A partially loaded document must not be saved, printed or searched as if it were the whole file.
+        const bool loading = documentLoadInProgress();
+        const bool hasContent = documentHasContent() && !loading;
         const bool hasSelection = editorHasSelection();
+        // The viewer only browses and searches; nothing in it can be edited, saved or printed.
+        const bool viewing = largeFileViewerActive();
 
         if (m_saveAction)
         {
-            m_saveAction->setEnabled(hasContent);
+            m_saveAction->setEnabled(hasContent && !viewing);
         }
         if (m_saveAsAction)
         {
-            m_saveAsAction->setEnabled(hasContent);
+            m_saveAsAction->setEnabled(hasContent && !viewing);
         }
         if (m_printAction)
         {
-            m_printAction->setEnabled(hasContent);
+            m_printAction->setEnabled(hasContent && !viewing);
         }
         if (m_findAction)
         {
             m_findAction->setEnabled(hasContent);
         }
+        if (m_incrementalFindAction)
+        {
+            m_incrementalFindAction->setEnabled(hasContent);
+        }
         if (m_findNextAction)
         {
             m_findNextAction->setEnabled(hasContent);
@@ -553,7 +759,23 @@ namespace GnotePad::ui
         }
         if (m_replaceAction)
         {
-            m_replaceAction->setEnabled(hasContent);
+            m_replaceAction->setEnabled(hasContent && !viewing);
+        }
+        if (m_watchListAction)
+        {
+            m_watchListAction->setEnabled(hasContent && !viewing);
+        }
+        if (m_markOccurrencesAction)
+        {
+            m_markOccurrencesAction->setEnabled(hasContent && !viewing);
+        }
+        if (m_filterLinesAction)
+        {
+            m_filterLinesAction->setEnabled(hasContent && !viewing);
+        }
+        if (m_showAllLinesAction)
+        {
+            m_showAllLinesAction->setEnabled(m_editor && m_editor->isLineFilterActive());
         }
         if (m_goToAction)
         {
@@ -571,9 +793,25 @@ namespace GnotePad::ui
         {
             m_deleteAction->setEnabled(hasSelection);
         }
+        if (m_timeDateAction)
+        {
+            m_timeDateAction->setEnabled(!viewing);
+        }
+        if (m_encodingAction)
+        {
+            m_encodingAction->setEnabled(!viewing);
+        }
+        if (m_cancelLoadAction)
+        {
+            m_cancelLoadAction->setEnabled(loading);
+        }
+        if (m_followAction)
+        {
+            m_followAction->setEnabled(!m_currentFilePath.isEmpty() && !viewing);
+        }
         if (m_wordWrapAction)
         {
-            m_wordWrapAction->setEnabled(true);
+            m_wordWrapAction->setEnabled(!viewing);
         }
         if (m_statusBarToggle)
         {
@@ -587,6 +825,10 @@ namespace GnotePad::ui
         {
             return false;
         }
+        if (largeFileViewerActive())
+        {
+            return m_largeFileViewer->fileSize() > 0;
+        }
 
         const auto* document = m_editor->document();
         return document && !document->isEmpty();
@@ -599,7 +841,11 @@ namespace GnotePad::ui
 
     void MainWindow::updateWindowTitle()
     {
-        const auto baseName = m_currentFilePath.isEmpty() ? tr(UntitledDocumentTitle) : QFileInfo(m_currentFilePath).fileName();
+        QString baseName = m_currentFilePath.isEmpty() ? tr(UntitledDocumentTitle) : QFileInfo(m_currentFilePath).fileName();
+        if (m_currentFilePath.isEmpty() && m_documentFromStream)
+        {
+            baseName = documentLoadInProgress() ? tr("Standard Input (reading…)") : tr("Standard Input");
+        }
         QString decoratedName = baseName;
         if (m_editor && m_editor->document()->isModified())
         {
@@ -614,6 +860,8 @@ namespace GnotePad::ui
         if (confirmReadyForDestructiveAction())
         {
             saveSettings();
+            // Closing normally means whatever was not saved was meant to go.
+            m_editJournal.discard();
             event->accept();
         }
         else
@@ -1,8 +1,25 @@
 #pragma once
 
+#include "core/Compression.h"
+#include "core/DocumentLoader.h"
+#include "core/DocumentReader.h"
+#include "core/DocumentSaver.h"
+#include "core/EditJournal.h"
+#include "core/EncodedFileWriter.h"
+#include "core/FileFollower.h"
+#include "core/IncrementalSearch.h"
+#include "core/LiteralSearch.h"
+#include "core/MultiTermSearch.h"
+#include "core/RegexSearch.h"
+#include "core/WatchListScan.h"
+#include "core/WordIndex.h"
+
 #include <QtCore/qbytearray.h>
+#include <QtCore/qdatetime.h>
+#include <QtCore/qlist.h>
 #include <QtCore/qnamespace.h>
 #include <QtCore/qobject.h>
+#include <QtCore/qregularexpression.h>
 #include <QtCore/qsettings.h>
 #include <QtCore/qstring.h>
 #include <QtCore/qstringconverter.h>
@@ -15,6 +32,8 @@
 #include <QtWidgets/qwidget.h>
 
 #include <cstdint>
+#include <optional>
+#include <vector>
 #ifdef GNOTE_TEST_HOOKS
 #include <deque>
 #endif
@@ -22,14 +41,24 @@
 class QAction;
 class QLabel;
 class QCheckBox;
+class QDockWidget;
+class QFileSystemWatcher;
 class QMenu;
 class QPrinter;
+class QProgressBar;
+class QStackedWidget;
 class QStatusBar;
+class QTimer;
+class QToolButton;
 
 namespace GnotePad::ui
 {
 
+    class FindBar;
+    class FindInFilesPanel;
+    class LargeFileViewer;
     class TextEditor;
+    class WatchListPanel;
 
     class MainWindow : public QMainWindow
     {
@@ -38,6 +67,20 @@ namespace GnotePad::ui
     public:
         explicit MainWindow(QWidget* parent = nullptr);
 
+        // Offers to restore the unsaved edits a session left in its journal when it ended without closing.
+        void offerDocumentRecovery();
+
+        // Reads standard input into a new untitled document until the writer closes it.
+        void openStandardInput();
+
+        // Opens several files at once, reading and decoding them in parallel. The first file that is ready
+        // replaces this window's document when replaceDocument is set or the window is still empty; every
+        // other file opens in a window of its own as soon as it is ready.
+        void openFiles(const QStringList& filePaths, bool replaceDocument);
+
+        // Opens filePath, unless it is the current document already, and moves to the one-based lineNumber.
+        void openFileAtLine(const QString& filePath, qint64 lineNumber);
+
 #ifdef GNOTE_TEST_HOOKS
         bool testLoadDocument(const QString& path)
         {
@@ -60,6 +103,11 @@ namespace GnotePad::ui
             return m_editor;
         }
 
+        const QString& currentFilePathForTest() const
+        {
+            return m_currentFilePath;
+        }
+
         QStringConverter::Encoding currentEncodingForTest() const
         {
             return m_currentEncoding;
@@ -70,12 +118,78 @@ namespace GnotePad::ui
             return m_hasBom;
         }
 
+        void testSaveDocumentInBackground()
+        {
+            handleSaveFile();
+        }
+
+        void setBackgroundSaveForTest(bool enabled)
+        {
+            m_backgroundSaveEnabled = enabled;
+        }
+
+        bool documentSaveInProgressForTest() const
+        {
+            return documentSaveInProgress();
+        }
+
+        void testGoToLine(qint64 lineNumber)
+        {
+            goToLine(lineNumber);
+        }
+
         void setSearchStateForTest(const QString& term, Qt::CaseSensitivity sensitivity, const QString& replacement = {});
         bool testFindNext(QTextDocument::FindFlags extraFlags = {});
         bool testFindPrevious();
         bool testReplaceNext(const QString& replacementOverride = {});
         int testReplaceAll(const QString& term, const QString& replacement, QTextDocument::FindFlags extraFlags = {});
 
+        void setRegexSearchForTest(bool enabled)
+        {
+            m_lastUseRegex = enabled;
+        }
+
+        void setWholeWordSearchForTest(bool enabled)
+        {
+            m_lastWholeWords = enabled;
+        }
+
+        core::WordIndex& wordIndexForTest() const
+        {
+            return *m_wordIndex;
+        }
+
+        const QString& searchErrorForTest() const
+        {
+            return m_searchError;
+        }
+
+        QString matchStatusForTest() const;
+
+        FindInFilesPanel* testFindInFiles(const QString& directory, const QStringList& nameFilters, const QString& term);
+
+        bool incrementalSearchRunningForTest() const
+        {
+            return m_incrementalSearch->isRunning();
+        }
+
+        WatchListPanel* testWatchList(const QStringList& terms, Qt::CaseSensitivity sensitivity);
+
+        bool watchListRunningForTest() const
+        {
+            return m_watchListScan->isRunning();
+        }
+
+        bool testFilterLines(const QString& pattern, Qt::CaseSensitivity sensitivity, bool useRegex, bool invert)
+        {
+            return filterLines(pattern, sensitivity, useRegex, invert);
+        }
+
+        bool testJumpToWatchHit(int term, bool backward)
+        {
+            return jumpToWatchHit(term, backward);
+        }
+
         const QStringList& recentFilesForTest() const
         {
             return m_recentFiles;
@@ -145,6 +259,88 @@ namespace GnotePad::ui
         {
             savePrinterSettings(settings);
         }
+
+        void setMemoryMapThresholdForTest(qint64 bytes)
+        {
+            m_memoryMapThresholdBytes = bytes;
+        }
+
+        qint64 memoryMapThresholdForTest() const
+        {
+            return m_memoryMapThresholdBytes;
+        }
+
+        void setBackgroundLoadThresholdForTest(qint64 bytes)
+        {
+            m_backgroundLoadThresholdBytes = bytes;
+        }
+
+        bool documentLoadInProgressForTest() const
+        {
+            return documentLoadInProgress();
+        }
+
+        QAction* cancelLoadActionForTest() const
+        {
+            return m_cancelLoadAction;
+        }
+
+        void setLargeFileViewerThresholdForTest(qint64 bytes)
+        {
+            m_largeFileViewerThresholdBytes = bytes;
+        }
+
+        LargeFileViewer* largeFileViewerForTest() const
+        {
+            return m_largeFileViewer;
+        }
+
+        bool largeFileViewerActiveForTest() const
+        {
+            return largeFileViewerActive();
+        }
+
+        QAction* saveActionForTest() const
+        {
+            return m_saveAction;
+        }
+
+        QAction* followActionForTest() const
+        {
+            return m_followAction;
+        }
+
+        void testPollFollowedFile()
+        {
+            pollFollowedFile();
+        }
+
+        void testCheckDocumentFileOnDisk()
+        {
+            checkDocumentFileOnDisk();
+        }
+
+        bool reloadRunningForTest() const
+        {
+            return documentReloadInProgress();
+        }
+
+        bool testOpenStream(qintptr handle)
+        {
+            return startStreamLoad(handle);
+        }
+
+        // Flushes the edit journal (opening it first if the document has unsaved edits) and waits for the write.
+        void testFlushEditJournal()
+        {
+            flushEditJournal();
+            m_editJournal.waitForWriter();
+        }
+
+        const core::EditJournal& editJournalForTest() const
+        {
+            return m_editJournal;
+        }
 #endif
 
     private slots:
@@ -160,9 +356,15 @@ namespace GnotePad::ui
         void handleZoomOut();
         void handleZoomReset();
         void handleFind();
+        void handleIncrementalFind();
         void handleFindNext();
         void handleFindPrevious();
         void handleReplace();
+        void handleFindInFiles();
+        void handleWatchList();
+        void handleMarkAllOccurrences();
+        void handleFilterLines();
+        void handleShowAllLines();
         void handleGoToLine();
         void handleInsertTimeDate();
         void handleViewHelp();
@@ -173,6 +375,9 @@ namespace GnotePad::ui
         void handleChoosePrinter();
         void handleOpenRecentFile();
         void handleClearRecentFiles();
+        void handleCancelLoad();
+        void handleToggleFollow(bool checked);
+        void handleToggleWordIndex(bool checked);
 
         // NOLINTNEXTLINE(readability-redundant-access-specifiers)
     private:
@@ -195,6 +400,15 @@ namespace GnotePad::ui
         static constexpr int FontDialogHeight = 480;
         static constexpr auto UntitledDocumentTitle = "Untitled";
         static constexpr qreal InvalidFontPointSize = -1.0;
+        static constexpr qint64 DefaultMemoryMapThresholdBytes = 4LL * 1024 * 1024;
+        static constexpr qint64 DefaultBackgroundLoadThresholdBytes = 8LL * 1024 * 1024;
+        static constexpr qint64 DefaultLargeFileViewerThresholdBytes = 256LL * 1024 * 1024;
+        static constexpr int LoadProgressSteps = 1000;
+        static constexpr int LoadProgressBarWidth = 160;
+        static constexpr int FollowPollIntervalMs = 1000;
+        static constexpr int JournalFlushIntervalMs = 2000;
+        static constexpr int StatusMessageTimeoutMs = 5000;
+        static constexpr int CascadeOffset = 32;
 
         void buildMenus();
         void buildStatusBar();
@@ -203,6 +417,7 @@ namespace GnotePad::ui
         void updateEncodingDisplay(const QString& encodingLabel);
         void updateWindowTitle();
         void updateDocumentStats();
+        void updateMatchStatus();
         void updateZoomLabel(int percentage);
         void updateActionStates();
         [[nodiscard]] bool documentHasContent() const;
@@ -210,7 +425,50 @@ namespace GnotePad::ui
         void applyDefaultEditorFont();
 
         bool loadDocumentFromPath(const QString& filePath);
+        bool startBackgroundLoad(const QString& filePath);
+        bool startStreamLoad(qintptr handle);
+        void finishStreamLoad(const QString& message);
+        void appendLoadedChunk(const QString& text, const core::LineIndex::Span& lines);
+        void updateLoadProgress(qint64 bytesProcessed, qint64 bytesTotal);
+        void finishBackgroundLoad(core::DocumentLoader::Status status);
+        void abortBackgroundLoad();
+        void setDocumentLoadUiActive(bool active);
+        [[nodiscard]] bool documentLoadInProgress() const;
+        bool openInLargeFileViewer(const QString& filePath);
+        void closeLargeFileViewer();
+        void syncLargeFileViewerAppearance();
+        [[nodiscard]] bool largeFileViewerActive() const;
+        void releaseDocument();
+        // Everything releaseDocument() lets go of except the viewer's file, for a viewer that has just mapped the next.
+        void releaseDocumentExceptViewer();
+        void showDecodedDocument(const QString& filePath, const core::DecodedDocument& decoded);
+        [[nodiscard]] std::optional<core::DecodedDocument> readDocumentFile(const QString& filePath);
+        void reportReadFailure(const QString& filePath, core::DocumentReader::Error error);
+        MainWindow* takeWindowForOpenedFile();
+        void handleDocumentRead(const QString& filePath, const core::DecodedDocument& document);
+        void watchDocumentFile();
+        void unwatchDocumentFile();
+        void handleDocumentFileChanged();
+        void checkDocumentFileOnDisk();
+        void pollFollowedFile();
+        void appendFollowedText(const QString& text);
+        void reloadChangedDocument();
+        void appendReloadedChunk(const QString& text, const core::LineIndex::Span& lines);
+        void finishReload(core::DocumentLoader::Status status);
+        void abandonReload();
+        [[nodiscard]] bool documentReloadInProgress() const;
+        void flushEditJournal();
+        // Makes the file the document was just read from or written to the starting point of its recovery journal.
+        void rebaseEditJournal();
         bool saveDocumentToPath(const QString& filePath);
+        bool writeDocumentText(core::EncodedFileWriter& writer) const;
+        void reportSaveFailure(const QString& filePath, core::EncodedFileWriter::Error error);
+        void startBackgroundSave(const QString& filePath);
+        void finishBackgroundSave(const QString& filePath, core::EncodedFileWriter::Error error);
+        void waitForBackgroundSave();
+        [[nodiscard]] bool documentSaveInProgress() const;
+        void markDocumentSaved(const QString& filePath, bool documentUnchanged);
+        [[nodiscard]] core::Compression saveCompressionFor(const QString& filePath) const;
         bool saveDocumentAsDialog();
         bool saveCurrentDocument(bool forceSaveAs = false);
         bool confirmReadyForDestructiveAction();
@@ -219,8 +477,34 @@ namespace GnotePad::ui
         void resetDocumentState();
         [[nodiscard]] QTextDocument::FindFlags buildFindFlags(QTextDocument::FindFlags baseFlags = {}) const;
         bool performFind(const QString& term, QTextDocument::FindFlags flags = {});
+        void goToLine(qint64 lineNumber);
         bool replaceNextOccurrence(const QString& term, const QString& replacement, QTextDocument::FindFlags flags = {});
         int replaceAllOccurrences(const QString& term, const QString& replacement, QTextDocument::FindFlags flags = {});
+        [[nodiscard]] const QRegularExpression* searchExpression(const QString& pattern, QTextDocument::FindFlags flags);
+        [[nodiscard]] bool regexMatchesSelection(const QRegularExpression& expression,
+                                                 const core::ReplacementTemplate& replacement,
+                                                 QString& expanded) const;
+        void applyReplacements(const QList<core::TextReplacement>& edits);
+        void highlightAllMatches(const QString& term, QTextDocument::FindFlags flags);
+        [[nodiscard]] bool wordIndexAnswers(const QString& term, QTextDocument::FindFlags flags) const;
+        void rebuildWordIndex();
+        void reportWordIndexReady();
+        void reportWordIndexDropped(core::WordIndex::DropReason reason);
+        bool filterLines(const QString& pattern, Qt::CaseSensitivity sensitivity, bool useRegex, bool invert);
+        void reportLinesFiltered(qint64 lineCount, qint64 hiddenCount);
+        void revealFilteredLineAt(qint64 position);
+        void searchIncrementally(const QString& term, Qt::CaseSensitivity sensitivity);
+        void showIncrementalMatch(qint64 position);
+        void showLargeFileFindResult(bool found);
+        void stepFindBar(bool backward);
+        void closeFindBar();
+        FindInFilesPanel* ensureFindInFilesPanel();
+        void runWatchList(const QStringList& terms, Qt::CaseSensitivity sensitivity);
+        void showWatchListResults();
+        bool jumpToWatchHit(int term, bool backward);
+        void invalidateWatchHits();
+        WatchListPanel* ensureWatchListPanel();
+        void reportFindMiss(const QString& title, const QString& term);
         [[nodiscard]] QIcon brandIcon() const;
         void loadSettings();
         void saveSettings() const;
@@ -230,11 +514,13 @@ namespace GnotePad::ui
         void loadEditorFontSettings(QSettings& settings, bool hasExistingPreferences);
         void loadEditorViewSettings(QSettings& settings);
         void loadEditorBehaviorSettings(QSettings& settings);
+        void loadFileHandlingSettings(QSettings& settings);
         void saveWindowGeometrySettings(QSettings& settings) const;
         void savePathSettings(QSettings& settings) const;
         void saveRecentFilesSettings(QSettings& settings) const;
         void saveEditorFontSettings(QSettings& settings) const;
         void saveEditorBehaviorSettings(QSettings& settings) const;
+        void saveFileHandlingSettings(QSettings& settings) const;
         void loadPrinterSettings(QSettings& settings);
         void savePrinterSettings(QSettings& settings) const;
         static void clearLegacySettings(QSettings& settings);
@@ -248,18 +534,37 @@ namespace GnotePad::ui
         void closeEvent(QCloseEvent* event) override;
 
         [[nodiscard]] QString encodingLabel() const;
-        static QByteArray viewBomForEncoding(QStringConverter::Encoding encoding);
-        static QStringConverter::Encoding detectEncodingFromData(const QByteArray& data, int& bomLength);
 
+        QStackedWidget* m_editorStack{nullptr};
+        FindBar* m_findBar{nullptr};
         TextEditor* m_editor{nullptr};
+        LargeFileViewer* m_largeFileViewer{nullptr};
         QStatusBar* m_statusBar{nullptr};
         QLabel* m_cursorLabel{nullptr};
         QLabel* m_encodingLabel{nullptr};
         QLabel* m_zoomLabel{nullptr};
         QLabel* m_documentStatsLabel{nullptr};
+        QLabel* m_matchCountLabel{nullptr};
+        QProgressBar* m_loadProgressBar{nullptr};
+        QToolButton* m_cancelLoadButton{nullptr};
+        core::DocumentLoader* m_documentLoader{nullptr};
+        // Reads a file that changed on disk back in the background, apart from the loader that fills the editor.
+        core::DocumentLoader* m_reloadLoader{nullptr};
+        core::DocumentReader* m_documentReader{nullptr};
+        core::DocumentSaver* m_documentSaver{nullptr};
+        core::IncrementalSearch* m_incrementalSearch{nullptr};
+        core::WatchListScan* m_watchListScan{nullptr};
+        core::WordIndex* m_wordIndex{nullptr};
+        QFileSystemWatcher* m_fileWatcher{nullptr};
+        QTimer* m_followPollTimer{nullptr};
+        core::FileFollower m_fileFollower;
+        QTimer* m_journalTimer{nullptr};
+        core::EditJournal m_editJournal;
 
         QAction* m_statusBarToggle{nullptr};
         QAction* m_lineNumberToggle{nullptr};
+        QAction* m_followAction{nullptr};
+        QAction* m_wordIndexAction{nullptr};
         QAction* m_wordWrapAction{nullptr};
         QAction* m_saveAction{nullptr};
         QAction* m_saveAsAction{nullptr};
@@ -270,13 +575,20 @@ namespace GnotePad::ui
         QAction* m_dateFormatShortAction{nullptr};
         QAction* m_dateFormatLongAction{nullptr};
         QAction* m_findAction{nullptr};
+        QAction* m_incrementalFindAction{nullptr};
         QAction* m_findNextAction{nullptr};
         QAction* m_findPreviousAction{nullptr};
         QAction* m_replaceAction{nullptr};
+        QAction* m_findInFilesAction{nullptr};
+        QAction* m_watchListAction{nullptr};
+        QAction* m_markOccurrencesAction{nullptr};
+        QAction* m_filterLinesAction{nullptr};
+        QAction* m_showAllLinesAction{nullptr};
         QAction* m_goToAction{nullptr};
         QAction* m_timeDateAction{nullptr};
         QAction* m_tabSizeAction{nullptr};
         QAction* m_encodingAction{nullptr};
+        QAction* m_cancelLoadAction{nullptr};
         QMenu* m_recentFilesMenu{nullptr};
 
         QString m_currentFilePath;
@@ -285,12 +597,76 @@ namespace GnotePad::ui
         QString m_lastSearchTerm;
         QString m_lastReplaceText;
         Qt::CaseSensitivity m_lastCaseSensitivity{Qt::CaseInsensitive};
+        bool m_lastUseRegex{false};
+        bool m_lastWholeWords{false};
+        QString m_lastFilterPattern;
+        Qt::CaseSensitivity m_lastFilterSensitivity{Qt::CaseInsensitive};
+        bool m_lastFilterRegex{false};
+        bool m_lastFilterInvert{false};
+        core::RegexCache m_regexCache;
+        // Why the last search stopped short of an answer (bad pattern, time limit); empty for a plain miss.
+        QString m_searchError;
+        // The search whose matches the editor highlights, so repeating it does not start another scan.
+        QString m_highlightedTerm;
+        QTextDocument::FindFlags m_highlightedFlags;
+        bool m_highlightedRegex{false};
+        // Length of the term the running incremental search looks for.
+        qsizetype m_incrementalLength{0};
+        QDockWidget* m_findInFilesDock{nullptr};
+        FindInFilesPanel* m_findInFilesPanel{nullptr};
+        QString m_lastFindInFilesDirectory;
+        QString m_lastFindInFilesFilters;
+        // Line to move to once the background load of a file opened from Find in Files completes.
+        qint64 m_pendingGoToLine{0};
+        QDockWidget* m_watchListDock{nullptr};
+        WatchListPanel* m_watchListPanel{nullptr};
+        // Terms of the last watch-list search and every hit it found, by position; cleared on any edit.
+        QStringList m_watchTerms;
+        Qt::CaseSensitivity m_watchSensitivity{Qt::CaseInsensitive};
+        std::vector<core::MultiTermSearch::Hit> m_watchHits;
         QStringList m_recentFiles;
         QString m_lastOpenDirectory;
         QString m_lastSaveDirectory;
         QString m_defaultPrinterName;
         int m_tabSizeSpaces{DefaultTabSizeSpaces};
         int m_currentZoomPercent{DefaultZoomPercent};
+        qint64 m_memoryMapThresholdBytes{DefaultMemoryMapThresholdBytes};
+        qint64 m_backgroundLoadThresholdBytes{DefaultBackgroundLoadThresholdBytes};
+        qint64 m_largeFileViewerThresholdBytes{DefaultLargeFileViewerThresholdBytes};
+        // Bytes of the file on disk that the document reflects; -1 when it does not come from a file.
+        qint64 m_documentDiskBytes{-1};
+        QDateTime m_documentDiskModified;
+        QByteArray m_documentDiskSample;
+        // Container the document's file is stored in; saving back to it compresses the same way.
+        core::Compression m_documentCompression{core::Compression::None};
+        bool m_reloadPromptOpen{false};
+        // The file as a reload in flight has read it so far; it replaces the document once the whole file is in.
+        struct PendingReload
+        {
+            QString text;
+            core::LineIndex::Span lines;
+            QStringConverter::Encoding encoding{QStringConverter::Utf8};
+            bool hasBom{false};
+            qint64 diskBytes{0};
+            // The file's stamp from before reading began, so a change that lands meanwhile still shows afterwards.
+            QDateTime diskModified;
+            QByteArray diskSample;
+            // Typing while the file is read wins over the reload, which is then offered again.
+            int revision{-1};
+            bool following{false};
+        };
+        PendingReload m_pendingReload;
+        bool m_loadShownFirstChunk{false};
+        // The document is text read from standard input rather than a file.
+        bool m_documentFromStream{false};
+        // The next file opened through openFiles() may replace this window's document, if the document is still
+        // at the revision it had when the files were asked for.
+        bool m_openIntoThisWindow{false};
+        int m_openIntoRevision{-1};
+        bool m_backgroundSaveEnabled{true};
+        bool m_backgroundSaveQueued{false};
+        quint64 m_editGeneration{0};
+        quint64 m_backgroundSaveGeneration{0};
         DateFormatPreference m_dateFormatPreference{DateFormatPreference::Short};
 #ifdef GNOTE_TEST_HOOKS
         std::deque<QMessageBox::StandardButton> m_testPromptResponses;
@@ -1,22 +1,35 @@
 #include "ui/TextEditor.h"
 
+#include "core/LineDiff.h"
+
 #include <QtCore/qchar.h>
 #include <QtCore/qlist.h>
+#include <QtCore/qmath.h>
 #include <QtCore/qnamespace.h>
+#include <QtCore/qpoint.h>
+#include <QtCore/qrect.h>
 #include <QtCore/qstring.h>
 #include <QtCore/qstringliteral.h>
+#include <QtCore/qstringview.h>
+#include <QtGui/qaction.h>
 #include <QtGui/qcolor.h>
 #include <QtGui/qevent.h>
 #include <QtGui/qfontmetrics.h>
+#include <QtGui/qkeysequence.h>
 #include <QtGui/qpainter.h>
 #include <QtGui/qpalette.h>
 #include <QtGui/qtextcursor.h>
+#include <QtGui/qtextdocument.h>
 #include <QtGui/qtextformat.h>
 #include <QtGui/qtextobject.h>
+#include <QtWidgets/qmenu.h>
 #include <QtWidgets/qscrollbar.h>
 #include <QtWidgets/qtextedit.h>
 
 #include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
 
 // NOTE: Qt parent-child ownership deletes child QObjects automatically, so raw pointers
 // assigned from new within this file are intentional and safe.
@@ -29,10 +42,28 @@ namespace GnotePad::ui
         constexpr int kZoomStepPercent = 10;
         constexpr int kMinZoomPercent = 10;
         constexpr int kMaxZoomPercent = 500;
+        // Line edits the reload diff searches for before settling for one hunk spanning the whole change.
+        constexpr qint64 kMaxSyncLineEdits = 1024;
+        // Opacity of the highlight color behind search matches, so the selection itself still stands out.
+        constexpr int kMatchHighlightAlpha = 90;
+
+        // QTextCursor::insertText() turns a CRLF pair into one block separator; collapsing it up front keeps
+        // the text handed to the document and to the piece table identical, position for position.
+        QString collapseCrLf(const QString& text)
+        {
+            if (!text.contains(QLatin1Char('\r')))
+            {
+                return text;
+            }
+            QString collapsed = text;
+            collapsed.replace(QStringLiteral("\r\n"), QStringLiteral("\n"));
+            return collapsed;
+        }
     } // namespace
 
     TextEditor::LineNumberArea::LineNumberArea(TextEditor* editor) : QWidget(editor), m_editor(editor)
     {
+        setObjectName(QStringLiteral("lineNumberArea"));
         setCursor(Qt::ArrowCursor);
     }
 
@@ -53,13 +84,41 @@ namespace GnotePad::ui
         }
     }
 
-    TextEditor::TextEditor(QWidget* parent) : QPlainTextEdit(parent), m_lineNumberArea(new LineNumberArea(this)), m_defaultFont(font())
+    TextEditor::TextEditor(QWidget* parent)
+        : QPlainTextEdit(parent),
+          m_lineNumberArea(new LineNumberArea(this)),
+          m_defaultFont(font()),
+          m_matchIndex(new core::MatchIndex(this)),
+          m_lineFilter(new core::LineFilter(this))
     {
         m_lineNumberArea->setVisible(m_lineNumbersVisible);
 
         connect(this, &QPlainTextEdit::blockCountChanged, this, &TextEditor::updateLineNumberAreaWidth);
         connect(this, &QPlainTextEdit::updateRequest, this, &TextEditor::updateLineNumberArea);
         connect(this, &QPlainTextEdit::cursorPositionChanged, this, &TextEditor::highlightCurrentLine);
+        connect(document(), &QTextDocument::contentsChange, this, &TextEditor::mirrorContentsChange);
+        // Scrolling, resizing and relayouts all come through updateRequest; the match selections follow the viewport.
+        connect(this, &QPlainTextEdit::updateRequest, this, &TextEditor::updateMatchSelections);
+        connect(m_matchIndex,
+                &core::MatchIndex::matchesChanged,
+                this,
+                [this]()
+                {
+                    m_matchSelectionsFrom = -1;
+                    updateMatchSelections();
+                });
+        connect(m_lineFilter, &core::LineFilter::finished, this, &TextEditor::applyLineFilter);
+        // Loads turn undo off or clear the document, and the follow appends go with the stack.
+        connect(document(),
+                &QTextDocument::undoAvailable,
+                this,
+                [this](bool available)
+                {
+                    if (!available)
+                    {
+                        m_followedSteps.clear();
+                    }
+                });
 
         updateLineNumberAreaWidth(0);
         highlightCurrentLine();
@@ -91,14 +150,18 @@ namespace GnotePad::ui
         // Calculate the number of digits needed to display the highest line number
         // e.g., 1-9 lines = 1 digit, 10-99 = 2 digits, 100-999 = 3 digits, etc.
         int digits = 1;
-        int max = std::max(1, blockCount());
+        qint64 max = std::max<qint64>(1, m_lineIndex.lineCount());
         while (max >= 10)
         {
             max /= 10;
             ++digits;
         }
 
-        const int space = 8 + (fontMetrics().horizontalAdvance(QLatin1Char('9')) * digits);
+        // Digits are drawn in cells of whole device pixels, which at fractional ratios are a little wider than
+        // a digit's advance; the gutter makes room for them.
+        const qreal devicePixelRatio = m_lineNumberArea->devicePixelRatioF();
+        const int cellWidth = qCeil(fontMetrics().horizontalAdvance(QLatin1Char('9')) * devicePixelRatio);
+        const int space = 8 + qCeil(cellWidth * digits / devicePixelRatio);
         return space;
     }
 
@@ -111,34 +174,511 @@ namespace GnotePad::ui
 
         QPainter painter(m_lineNumberArea);
         painter.fillRect(event->rect(), palette().alternateBase());
-        painter.setRenderHint(QPainter::TextAntialiasing, true);
-        painter.setRenderHint(QPainter::Antialiasing, true);
-        painter.setRenderHint(QPainter::SmoothPixmapTransform, true);
+        // The digits are copied from the atlas one device pixel for one; nothing here may resample them.
+        painter.setRenderHint(QPainter::SmoothPixmapTransform, false);
 
         QTextBlock block = firstVisibleBlock();
-        int blockNumber = block.blockNumber();
+        qint64 lineNumber = m_lineIndex.lineAt(block.position());
         int top = static_cast<int>(blockBoundingGeometry(block).translated(contentOffset()).top());
         int bottom = top + static_cast<int>(blockBoundingRect(block).height());
 
-        const QColor inactiveColor = palette().color(QPalette::Disabled, QPalette::Text);
-        const QColor activeColor = palette().color(QPalette::Text);
-        const int currentBlockNumber = textCursor().blockNumber();
+        const qreal devicePixelRatio = m_lineNumberArea->devicePixelRatioF();
+        const GutterDigits& digits = gutterDigits(devicePixelRatio,
+                                                  palette().color(QPalette::Disabled, QPalette::Text).rgba(),
+                                                  palette().color(QPalette::Text).rgba());
+        const qint64 currentLineNumber = m_lineIndex.lineAt(textCursor().block().position());
+        // Line numbers are right-aligned with 6 logical pixels of padding to separate them from the text. Cells
+        // are placed in device pixels, so at fractional ratios too every copy lands on the grid it was drawn on.
+        const int rightPixel = qRound((m_lineNumberArea->width() - 6) * devicePixelRatio);
 
         while (block.isValid() && top <= event->rect().bottom())
         {
+            // Blocks a line filter hid take no space but still count, so every shown line keeps its own number.
             if (block.isVisible() && bottom >= event->rect().top())
             {
-                const QString number = QString::number(blockNumber + 1);
-                painter.setPen(blockNumber == currentBlockNumber ? activeColor : inactiveColor);
-                // Draw line number right-aligned with 6 logical pixels right padding for visual separation from editor content
-                painter.drawText(0, top, m_lineNumberArea->width() - 6, fontMetrics().height(), Qt::AlignRight, number);
+                const int row = lineNumber == currentLineNumber ? 1 : 0;
+                const qreal y = qRound(top * devicePixelRatio) / devicePixelRatio;
+                int pixel = rightPixel;
+                for (qint64 value = lineNumber + 1; value > 0; value /= 10)
+                {
+                    pixel -= digits.cellWidth;
+                    const auto column = static_cast<int>(value % 10);
+                    painter.drawPixmap(QPointF(pixel / devicePixelRatio, y),
+                                       digits.atlas,
+                                       QRectF(column * digits.cellWidth, row * digits.cellHeight, digits.cellWidth, digits.cellHeight));
+                }
             }
 
             block = block.next();
             top = bottom;
             bottom = top + static_cast<int>(blockBoundingRect(block).height());
-            ++blockNumber;
+            ++lineNumber;
+        }
+    }
+
+    const TextEditor::GutterDigits& TextEditor::gutterDigits(qreal devicePixelRatio, QRgb inactive, QRgb active)
+    {
+        GutterDigits& digits = m_gutterDigits;
+        if (!digits.atlas.isNull() && digits.devicePixelRatio == devicePixelRatio && digits.inactive == inactive && digits.active == active)
+        {
+            return digits;
+        }
+
+        // Cells are whole device pixels, so every copy out of the atlas lands on the pixel grid it was drawn on.
+        const QFontMetrics metrics(font());
+        digits.devicePixelRatio = devicePixelRatio;
+        digits.inactive = inactive;
+        digits.active = active;
+        digits.cellWidth = qCeil(metrics.horizontalAdvance(QLatin1Char('9')) * devicePixelRatio);
+        digits.cellHeight = qCeil(metrics.height() * devicePixelRatio);
+        digits.atlas = QPixmap(digits.cellWidth * 10, digits.cellHeight * 2);
+        digits.atlas.setDevicePixelRatio(devicePixelRatio);
+        digits.atlas.fill(Qt::transparent);
+
+        QPainter painter(&digits.atlas);
+        painter.setFont(font());
+        painter.setRenderHint(QPainter::TextAntialiasing, true);
+        for (int row = 0; row < 2; ++row)
+        {
+            painter.setPen(QColor::fromRgba(row == 0 ? inactive : active));
+            for (int digit = 0; digit < 10; ++digit)
+            {
+                const qreal left = digit * digits.cellWidth / devicePixelRatio;
+                const qreal top = row * digits.cellHeight / devicePixelRatio;
+                painter.drawText(QPointF(left, top + metrics.ascent()), QString(QChar(u'0' + digit)));
+            }
+        }
+        return digits;
+    }
+
+    void TextEditor::invalidateGutterDigits()
+    {
+        m_gutterDigits = GutterDigits();
+        m_lineNumberArea->update();
+    }
+
+    void TextEditor::loadPlainText(const QString& text, const core::LineIndex::Span& lines)
+    {
+        const QString normalized = collapseCrLf(text);
+        m_lineIndex.clear();
+        m_lineIndex.append(lines);
+        m_pieceTable = core::PieceTable(normalized);
+        m_modelPreloaded = true;
+        setPlainText(normalized);
+        m_modelPreloaded = false;
+        if (m_matchIndex->isActive())
+        {
+            m_matchIndex->rescan(m_pieceTable);
+        }
+        emit modelRebuilt();
+    }
+
+    void TextEditor::appendLoadedText(const QString& text, const core::LineIndex::Span& lines)
+    {
+        // The models are extended before the insert so slots reacting to the change already see the new text.
+        const QString normalized = collapseCrLf(text);
+        const qint64 position = m_pieceTable.length();
+        m_lineIndex.append(lines);
+        m_pieceTable.appendOriginal(normalized);
+        m_modelPreloaded = true;
+        QTextCursor cursor(document());
+        cursor.movePosition(QTextCursor::End);
+        cursor.beginEditBlock();
+        cursor.insertText(normalized);
+        cursor.endEditBlock();
+        m_modelPreloaded = false;
+        updateMatchIndex(position, 0, normalized.size());
+        emit modelEdited(position, 0, normalized);
+    }
+
+    void TextEditor::appendFollowedText(const QString& text, const core::LineIndex::Span& lines)
+    {
+        const qint64 position = m_pieceTable.length();
+        appendLoadedText(text, lines);
+        if (document()->isUndoRedoEnabled())
+        {
+            m_followedSteps.push_back({document()->availableUndoSteps(), position, m_pieceTable.length() - position, false});
+        }
+    }
+
+    void TextEditor::undoEdit()
+    {
+        // A step Qt undid some other way is no longer on the stack.
+        const int undoSteps = document()->availableUndoSteps();
+        std::erase_if(m_followedSteps, [undoSteps](const FollowedStep& step) { return step.undoSteps > undoSteps; });
+
+        // The follow appends on top of the stack, down to the first one typing merged into, which undoing takes
+        // back by itself.
+        auto first = m_followedSteps.size();
+        int steps = undoSteps;
+        bool absorbedEdit = false;
+        while (first > 0 && !absorbedEdit && m_followedSteps[first - 1].undoSteps == steps)
+        {
+            --first;
+            --steps;
+            absorbedEdit = m_followedSteps[first].absorbedEdit;
+        }
+        m_undoingEdit = true;
+        if (first == m_followedSteps.size())
+        {
+            undo();
+            m_undoingEdit = false;
+            return;
+        }
+        if (steps == 0 && !absorbedEdit)
+        {
+            // Nothing but followed text to undo.
+            m_undoingEdit = false;
+            return;
+        }
+
+        QString followed;
+        for (auto index = first; index < m_followedSteps.size(); ++index)
+        {
+            const FollowedStep& step = m_followedSteps[index];
+            QTextCursor cursor(document());
+            cursor.setPosition(static_cast<int>(step.position));
+            cursor.setPosition(static_cast<int>(step.position + step.length), QTextCursor::KeepAnchor);
+            followed += cursor.selectedText().replace(QChar::ParagraphSeparator, QLatin1Char('\n'));
+        }
+        m_followedSteps.resize(first);
+        for (int step = steps; step < undoSteps; ++step)
+        {
+            undo();
+        }
+        if (!absorbedEdit)
+        {
+            undo();
+        }
+        m_undoingEdit = false;
+
+        // Putting the text back is no edit of the user's; the document is as modified as the undo left it.
+        const bool modified = document()->isModified();
+        appendFollowedText(followed, core::LineIndex::scan(followed));
+        document()->setModified(modified);
+    }
+
+    bool TextEditor::syncPlainText(const QString& text)
+    {
+        const QString normalized = collapseCrLf(text);
+        core::LineDiff::Hasher oldHasher;
+        for (const QStringView piece : m_pieceTable.pieces())
+        {
+            oldHasher.add(piece);
+        }
+        const auto oldLines = oldHasher.finish();
+        core::LineDiff::Hasher newHasher;
+        newHasher.add(normalized);
+        const auto newLines = newHasher.finish();
+        if (static_cast<qint64>(oldLines.size()) != m_lineIndex.lineCount())
+        {
+            return false;
+        }
+
+        const auto hunks = core::LineDiff::compute(oldLines, newLines, kMaxSyncLineEdits);
+        qint64 changedLines = 0;
+        for (const auto& hunk : hunks)
+        {
+            changedLines += hunk.oldCount + hunk.newCount;
+        }
+        if (changedLines > std::max<qint64>(kMaxSyncLineEdits, static_cast<qint64>(oldLines.size() + newLines.size()) / 2))
+        {
+            return false;
+        }
+
+        const core::LineIndex::Span newSpan = core::LineIndex::scan(normalized);
+        const auto newLineCount = static_cast<qint64>(newLines.size());
+        const auto newLineStart = [&newSpan, newLineCount](qint64 line) -> qint64
+        {
+            if (line == 0)
+            {
+                return 0;
+            }
+            return line < newLineCount ? newSpan.lineStarts[static_cast<std::size_t>(line - 1)] : newSpan.length;
+        };
+        const auto oldLineStart = [this](qint64 line)
+        { return line < m_lineIndex.lineCount() ? m_lineIndex.lineStart(line) : m_lineIndex.length(); };
+
+        // Lines were matched by hash alone, and a collision would leave a line the file changed as it was. Every
+        // matched pair is compared before anything is edited; a pair that differs sends the reload to loadPlainText().
+        const QString oldText = m_pieceTable.text();
+        const auto lineText = [](QStringView text, qint64 start, qint64 end)
+        { return text.sliced(static_cast<qsizetype>(start), static_cast<qsizetype>(end - start)); };
+        qint64 oldLine = 0;
+        qint64 newLine = 0;
+        const auto matchedUntil = [&](qint64 oldEnd)
+        {
+            for (; oldLine < oldEnd; ++oldLine, ++newLine)
+            {
+                if (lineText(oldText, oldLineStart(oldLine), oldLineStart(oldLine + 1)) !=
+                    lineText(normalized, newLineStart(newLine), newLineStart(newLine + 1)))
+                {
+                    return false;
+                }
+            }
+            return true;
+        };
+        for (const auto& hunk : hunks)
+        {
+            if (!matchedUntil(hunk.oldStart))
+            {
+                return false;
+            }
+            oldLine = hunk.oldStart + hunk.oldCount;
+            newLine = hunk.newStart + hunk.newCount;
+        }
+        if (!matchedUntil(m_lineIndex.lineCount()))
+        {
+            return false;
+        }
+
+        // Hunks go in back to front so the line index still describes everything before the one being applied.
+        // Each hunk closes its own edit block, so the document reports and lays out only the lines it touched,
+        // and the later ones join the first for undo.
+        QScrollBar* const scrollBar = verticalScrollBar();
+        const int scrollPosition = scrollBar->value();
+        QTextCursor cursor(document());
+        bool firstHunk = true;
+        for (auto hunk = hunks.rbegin(); hunk != hunks.rend(); ++hunk)
+        {
+            if (firstHunk)
+            {
+                cursor.beginEditBlock();
+                firstHunk = false;
+            }
+            else
+            {
+                cursor.joinPreviousEditBlock();
+            }
+            cursor.setPosition(static_cast<int>(oldLineStart(hunk->oldStart)));
+            cursor.setPosition(static_cast<int>(oldLineStart(hunk->oldStart + hunk->oldCount)), QTextCursor::KeepAnchor);
+            const qint64 from = newLineStart(hunk->newStart);
+            const qint64 to = newLineStart(hunk->newStart + hunk->newCount);
+            if (to > from)
+            {
+                cursor.insertText(normalized.sliced(static_cast<qsizetype>(from), static_cast<qsizetype>(to - from)));
+            }
+            else
+            {
+                cursor.removeSelectedText();
+            }
+            cursor.endEditBlock();
+        }
+        scrollBar->setValue(scrollPosition);
+        return true;
+    }
+
+    void TextEditor::mirrorContentsChange(int position, int charsRemoved, int charsAdded)
+    {
+        if (m_lineFilterActive)
+        {
+            clearLineFilter();
+        }
+        if (m_modelPreloaded)
+        {
+            return;
+        }
+        // An edit that left the stack as deep as the last follow append put it in the same step.
+        if (!m_undoingEdit && !m_followedSteps.empty() && m_followedSteps.back().undoSteps == document()->availableUndoSteps())
+        {
+            m_followedSteps.back().absorbedEdit = true;
+        }
+
+        // Changes that replace the whole document count the final paragraph separator in both charsRemoved and
+        // charsAdded; that separator is not part of the text the models cover.
+        const qint64 overshoot = std::max<qint64>(0, static_cast<qint64>(position) + charsRemoved - m_lineIndex.length());
+        const qint64 removed = charsRemoved - overshoot;
+        const qint64 added = std::max<qint64>(0, charsAdded - overshoot);
+
+        // Only the blocks the change created are visited; everything after it is shifted inside the index.
+        const QTextDocument* doc = document();
+        std::vector<qint64> insertedLineStarts;
+        for (QTextBlock block = doc->findBlock(position).next(); block.isValid() && block.position() <= position + added; block = block.next())
+        {
+            insertedLineStarts.push_back(block.position());
         }
+
+        // selectedText() yields one character per position, block separators included, which is the piece
+        // table's representation.
+        m_pieceTable.remove(position, removed);
+        QString inserted;
+        if (added > 0)
+        {
+            QTextCursor cursor(document());
+            cursor.setPosition(position);
+            cursor.setPosition(static_cast<int>(position + added), QTextCursor::KeepAnchor);
+            inserted = cursor.selectedText();
+            m_pieceTable.insert(position, inserted);
+        }
+
+        // Anything the models cannot account for (an edit Qt reports unusually) falls back to a rebuild.
+        const qint64 documentLength = doc->characterCount() - 1;
+        const bool applied = m_lineIndex.applyEdit(position, removed, added, insertedLineStarts);
+        if (!applied || m_lineIndex.lineCount() != doc->blockCount() || m_lineIndex.length() != documentLength ||
+            m_pieceTable.length() != documentLength)
+        {
+            rebuildDocumentModel();
+            return;
+        }
+        updateMatchIndex(position, removed, added);
+        emit modelEdited(position, removed, inserted);
+    }
+
+    void TextEditor::rebuildDocumentModel()
+    {
+        const QTextDocument* doc = document();
+        core::LineIndex::Span span;
+        for (QTextBlock block = doc->begin().next(); block.isValid(); block = block.next())
+        {
+            span.lineStarts.push_back(block.position());
+        }
+        span.length = std::max(0, doc->characterCount() - 1);
+        m_lineIndex.clear();
+        m_lineIndex.append(span);
+
+        QTextCursor cursor(document());
+        cursor.movePosition(QTextCursor::End, QTextCursor::KeepAnchor);
+        m_pieceTable = core::PieceTable(cursor.selectedText());
+        if (m_matchIndex->isActive())
+        {
+            m_matchIndex->rescan(m_pieceTable);
+        }
+        emit modelRebuilt();
+    }
+
+    void TextEditor::updateMatchIndex(qint64 position, qint64 charsRemoved, qint64 charsAdded)
+    {
+        if (!m_matchIndex->isActive())
+        {
+            return;
+        }
+
+        // Only the lines holding the edit are read back and rescanned.
+        const qint64 firstLine = m_lineIndex.lineAt(position);
+        const qint64 lastLine = m_lineIndex.lineAt(position + charsAdded);
+        const qint64 linesStart = m_lineIndex.lineStart(firstLine);
+        const qint64 linesEnd = lastLine + 1 < m_lineIndex.lineCount() ? m_lineIndex.lineStart(lastLine + 1) - 1 : m_lineIndex.length();
+        QTextCursor cursor(document());
+        cursor.setPosition(static_cast<int>(linesStart));
+        cursor.setPosition(static_cast<int>(linesEnd), QTextCursor::KeepAnchor);
+        m_matchIndex->applyEdit(position, charsRemoved, charsAdded, linesStart, cursor.selectedText());
+    }
+
+    void TextEditor::highlightMatches(core::MatchIndex::LineMatcher matcher)
+    {
+        m_matchIndex->start(std::move(matcher), m_pieceTable);
+    }
+
+    void TextEditor::highlightMatches(core::MatchIndex::LineMatcher matcher, std::vector<core::MatchIndex::Match> matches)
+    {
+        m_matchIndex->adopt(std::move(matcher), std::move(matches));
+    }
+
+    void TextEditor::clearMatchHighlights()
+    {
+        m_matchIndex->clear();
+    }
+
+    void TextEditor::filterLines(core::LineFilter::Predicate predicate, bool invert)
+    {
+        clearLineFilter();
+        m_readOnlyBeforeFilter = isReadOnly();
+        setReadOnly(true);
+        m_lineFilterActive = true;
+        m_lineFilter->start(std::move(predicate), m_pieceTable, invert);
+    }
+
+    void TextEditor::applyLineFilter(qint64 lineCount, qint64 hiddenCount)
+    {
+        if (!m_lineFilterActive)
+        {
+            return;
+        }
+
+        QTextDocument* const doc = document();
+        m_hiddenLines = m_lineFilter->takeHiddenLines();
+        m_hiddenLinesRevision = doc->revision();
+        if (!m_hiddenLines.empty())
+        {
+            for (const qint64 line : m_hiddenLines)
+            {
+                doc->findBlockByNumber(static_cast<int>(line)).setVisible(false);
+            }
+            // Only the stretch holding hidden lines is laid out again.
+            const QTextBlock first = doc->findBlockByNumber(static_cast<int>(m_hiddenLines.front()));
+            const QTextBlock last = doc->findBlockByNumber(static_cast<int>(m_hiddenLines.back()));
+            doc->markContentsDirty(first.position(), last.position() + last.length() - first.position());
+
+            // The cursor moves off a hidden line to the next shown one, or the last shown one before it.
+            QTextBlock shown = textCursor().block();
+            while (shown.isValid() && !shown.isVisible())
+            {
+                shown = shown.next();
+            }
+            for (shown = shown.isValid() ? shown : doc->lastBlock(); shown.isValid() && !shown.isVisible();)
+            {
+                shown = shown.previous();
+            }
+            if (shown.isValid() && shown != textCursor().block())
+            {
+                QTextCursor cursor(shown);
+                setTextCursor(cursor);
+            }
+        }
+        ensureCursorVisible();
+        viewport()->update();
+        m_lineNumberArea->update();
+        emit linesFiltered(lineCount, hiddenCount);
+    }
+
+    void TextEditor::clearLineFilter()
+    {
+        if (!m_lineFilterActive)
+        {
+            return;
+        }
+        m_lineFilterActive = false;
+        m_lineFilter->cancel();
+
+        QTextDocument* const doc = document();
+        if (!m_hiddenLines.empty())
+        {
+            QTextBlock first;
+            QTextBlock last;
+            if (doc->revision() == m_hiddenLinesRevision)
+            {
+                for (const qint64 line : m_hiddenLines)
+                {
+                    doc->findBlockByNumber(static_cast<int>(line)).setVisible(true);
+                }
+                first = doc->findBlockByNumber(static_cast<int>(m_hiddenLines.front()));
+                last = doc->findBlockByNumber(static_cast<int>(m_hiddenLines.back()));
+            }
+            else
+            {
+                // An edit moved the lines around; every block still hidden is shown instead.
+                for (QTextBlock block = doc->begin(); block.isValid(); block = block.next())
+                {
+                    if (!block.isVisible())
+                    {
+                        block.setVisible(true);
+                        first = first.isValid() ? first : block;
+                        last = block;
+                    }
+                }
+            }
+            if (first.isValid())
+            {
+                doc->markContentsDirty(first.position(), last.position() + last.length() - first.position());
+            }
+            m_hiddenLines.clear();
+        }
+        m_hiddenLinesRevision = -1;
+        setReadOnly(m_readOnlyBeforeFilter);
+        ensureCursorVisible();
+        viewport()->update();
+        m_lineNumberArea->update();
+        emit lineFilterCleared();
     }
 
     void TextEditor::updateLineNumberAreaWidth([[maybe_unused]] int newBlockCount)
@@ -184,7 +724,8 @@ namespace GnotePad::ui
 
     void TextEditor::highlightCurrentLine()
     {
-        if (isReadOnly())
+        // The filter's read-only mode still moves the cursor off hidden lines, and the highlight goes with it.
+        if (isReadOnly() && (!m_lineFilterActive || m_readOnlyBeforeFilter))
         {
             return;
         }
@@ -195,9 +736,57 @@ namespace GnotePad::ui
         selection.cursor = textCursor();
         selection.cursor.clearSelection();
 
-        QList<QTextEdit::ExtraSelection> selections;
-        selections << selection;
-        setExtraSelections(selections);
+        m_currentLineSelection = {selection};
+        applyExtraSelections();
+    }
+
+    void TextEditor::updateMatchSelections()
+    {
+        if (!m_matchIndex->isActive())
+        {
+            if (!m_matchSelections.isEmpty())
+            {
+                m_matchSelections.clear();
+                m_matchSelectionsFrom = -1;
+                applyExtraSelections();
+            }
+            return;
+        }
+
+        // From the start of the top visual line to the end of the bottom one; a long wrapped paragraph is only
+        // covered as far as it shows.
+        QTextCursor top = cursorForPosition(QPoint(0, 0));
+        top.movePosition(QTextCursor::StartOfLine);
+        QTextCursor bottom = cursorForPosition(QPoint(viewport()->width(), viewport()->height()));
+        bottom.movePosition(QTextCursor::EndOfLine);
+        const qint64 from = top.position();
+        const qint64 until = bottom.position() + 1;
+        if (from == m_matchSelectionsFrom && until == m_matchSelectionsUntil)
+        {
+            return;
+        }
+        m_matchSelectionsFrom = from;
+        m_matchSelectionsUntil = until;
+
+        QColor background = palette().color(QPalette::Highlight);
+        background.setAlpha(kMatchHighlightAlpha);
+        m_matchSelections.clear();
+        for (const core::MatchIndex::Match& match : m_matchIndex->matchesIn(from, until))
+        {
+            QTextEdit::ExtraSelection selection;
+            selection.format.setBackground(background);
+            selection.cursor = QTextCursor(document());
+            selection.cursor.setPosition(static_cast<int>(match.position));
+            selection.cursor.setPosition(static_cast<int>(match.position + match.length), QTextCursor::KeepAnchor);
+            m_matchSelections << selection;
+        }
+        applyExtraSelections();
+    }
+
+    void TextEditor::applyExtraSelections()
+    {
+        // The current line goes first so the match highlights are drawn over it.
+        setExtraSelections(m_currentLineSelection + m_matchSelections);
     }
 
     void TextEditor::increaseZoom(int range)
@@ -212,6 +801,7 @@ namespace GnotePad::ui
         QPlainTextEdit::zoomIn(range);
         updateZoomPercentageEstimate(range);
         updateTabStopDistance();
+        invalidateGutterDigits();
     }
 
     void TextEditor::decreaseZoom(int range)
@@ -226,6 +816,7 @@ namespace GnotePad::ui
         QPlainTextEdit::zoomOut(range);
         updateZoomPercentageEstimate(-range);
         updateTabStopDistance();
+        invalidateGutterDigits();
     }
 
     void TextEditor::wheelEvent(QWheelEvent* event)
@@ -247,6 +838,30 @@ namespace GnotePad::ui
         QPlainTextEdit::wheelEvent(event);
     }
 
+    void TextEditor::keyPressEvent(QKeyEvent* event)
+    {
+        if (!isReadOnly() && event->matches(QKeySequence::Undo))
+        {
+            event->accept();
+            undoEdit();
+            return;
+        }
+
+        QPlainTextEdit::keyPressEvent(event);
+    }
+
+    void TextEditor::contextMenuEvent(QContextMenuEvent* event)
+    {
+        // The standard menu's Undo goes to the document directly; it takes the same path as the shortcut.
+        const std::unique_ptr<QMenu> menu(createStandardContextMenu(event->pos()));
+        if (auto* undoAction = menu->findChild<QAction*>(QStringLiteral("edit-undo")))
+        {
+            disconnect(undoAction, &QAction::triggered, nullptr, nullptr);
+            connect(undoAction, &QAction::triggered, this, &TextEditor::undoEdit);
+        }
+        menu->exec(event->globalPos());
+    }
+
     void TextEditor::resetZoom()
     {
         QPlainTextEdit::setFont(m_defaultFont);
@@ -254,6 +869,7 @@ namespace GnotePad::ui
         emit zoomPercentageChanged(m_zoomPercentage);
         updateLineNumberAreaWidth(0);
         updateTabStopDistance();
+        invalidateGutterDigits();
     }
 
     void TextEditor::applyEditorFont(const QFont& font)
@@ -264,6 +880,7 @@ namespace GnotePad::ui
         emit zoomPercentageChanged(m_zoomPercentage);
         updateLineNumberAreaWidth(0);
         updateTabStopDistance();
+        invalidateGutterDigits();
     }
 
     void TextEditor::setZoomPercentage(int percent)
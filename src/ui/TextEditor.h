@@ -1,12 +1,26 @@
 #pragma once
 
+#include "core/LineFilter.h"
+#include "core/LineIndex.h"
+#include "core/MatchIndex.h"
+#include "core/PieceTable.h"
+
+#include <QtCore/qlist.h>
 #include <QtCore/qobject.h>
+#include <QtCore/qstring.h>
 #include <QtCore/qrect.h>
 #include <QtCore/qsize.h>
 #include <QtGui/qfont.h>
+#include <QtGui/qpixmap.h>
+#include <QtGui/qrgb.h>
 #include <QtWidgets/qplaintextedit.h>
+#include <QtWidgets/qtextedit.h>
 #include <QtWidgets/qwidget.h>
 
+#include <vector>
+
+class QContextMenuEvent;
+class QKeyEvent;
 class QPaintEvent;
 class QResizeEvent;
 class QWheelEvent;
@@ -45,32 +59,153 @@ namespace GnotePad::ui
             return m_zoomPercentage;
         }
 
+        // Line starts of the document, kept current from contentsChange. Line numbers shown in the gutter,
+        // Go To Line and the status bar come from here instead of walking Qt's block structure.
+        [[nodiscard]] const core::LineIndex& lineIndex() const
+        {
+            return m_lineIndex;
+        }
+
+        // Piece-table copy of the document, kept current from contentsChange. It is an extra index beside
+        // QTextDocument, which still owns the text, edits and undo: the text is held twice, and every change is
+        // read back from the document once more to be mirrored here. What it buys is O(1) snapshots that saves,
+        // searches and indexes read on worker threads instead of the document's blocks.
+        [[nodiscard]] const core::PieceTable& pieceTable() const
+        {
+            return m_pieceTable;
+        }
+
+        // Replace or extend the document with text whose line starts were already scanned while decoding, so
+        // the index takes the precomputed span instead of walking the new blocks, and the decoded text becomes
+        // an original buffer of the piece table.
+        void loadPlainText(const QString& text, const core::LineIndex::Span& lines);
+        void appendLoadedText(const QString& text, const core::LineIndex::Span& lines);
+        // Appends text that arrived in the file while following it, as its own undo step. undoEdit() steps over
+        // it, so edits made before it stay undoable and the followed text stays put.
+        void appendFollowedText(const QString& text, const core::LineIndex::Span& lines);
+
+        // Undo for the Edit menu, the shortcut and the context menu. When followed text sits on top of the undo
+        // stack, the edit beneath it is undone instead and the followed text goes back in as one new step.
+        void undoEdit();
+
+        // Bring the document to text by editing only the lines that differ, as one undo step, so the cursor,
+        // scroll position and undo history survive. Returns false without touching the document when most of
+        // it changed and loadPlainText() is the cheaper way there, or when two lines the diff matched by hash
+        // turn out to differ.
+        bool syncPlainText(const QString& text);
+
+        // Highlights every match of matcher in the visible part of the document, alongside the current line. The
+        // matches are indexed in the background and kept current as the document changes.
+        void highlightMatches(core::MatchIndex::LineMatcher matcher);
+        // The same with the matches already known, so no scan runs.
+        void highlightMatches(core::MatchIndex::LineMatcher matcher, std::vector<core::MatchIndex::Match> matches);
+        void clearMatchHighlights();
+
+        [[nodiscard]] const core::MatchIndex& matchIndex() const
+        {
+            return *m_matchIndex;
+        }
+
+        // Hides the lines predicate rejects, or the ones it accepts when invert is set, once the background test
+        // is done. Hidden lines keep their numbers, and the editor is read-only until the filter is cleared; any
+        // edit that reaches the document anyway clears it first.
+        void filterLines(core::LineFilter::Predicate predicate, bool invert);
+        // Shows exactly the lines the filter hid; nothing is tested again.
+        void clearLineFilter();
+
+        [[nodiscard]] bool isLineFilterActive() const
+        {
+            return m_lineFilterActive;
+        }
+
         [[nodiscard]] int lineNumberAreaWidth() const;
         void lineNumberAreaPaintEvent(QPaintEvent* event);
 
     signals:
         void zoomPercentageChanged(int percentage);
+        // The models took a change in piece-table coordinates, after they were updated.
+        void modelEdited(qint64 position, qint64 charsRemoved, const QString& inserted);
+        // The models were rebuilt from scratch, for a new document or an edit they could not follow.
+        void modelRebuilt();
+        // A line filter took effect; hiddenCount of lineCount lines are hidden.
+        void linesFiltered(qint64 lineCount, qint64 hiddenCount);
+        // Every line is shown again, on request or because an edit reached the document.
+        void lineFilterCleared();
 
     protected:
         void resizeEvent(QResizeEvent* event) override;
         void wheelEvent(QWheelEvent* event) override;
+        void keyPressEvent(QKeyEvent* event) override;
+        void contextMenuEvent(QContextMenuEvent* event) override;
 
     private slots:
         void updateLineNumberAreaWidth([[maybe_unused]] int newBlockCount = 0);
         void updateLineNumberArea(const QRect& rect, int dy);
         void highlightCurrentLine();
+        void updateMatchSelections();
+        void mirrorContentsChange(int position, int charsRemoved, int charsAdded);
 
     private: // NOLINT(readability-redundant-access-specifiers)
         class LineNumberArea;
 
         void updateZoomPercentageEstimate(int deltaSteps);
         void updateTabStopDistance();
+        void rebuildDocumentModel();
+        void updateMatchIndex(qint64 position, qint64 charsRemoved, qint64 charsAdded);
+        void applyExtraSelections();
+        void applyLineFilter(qint64 lineCount, qint64 hiddenCount);
+
+        // The gutter's digits rendered once for the current font (zoom included), device pixel ratio and pen
+        // colors. Row 0 of the atlas holds 0-9 in the inactive color and row 1 in the current line's, one cell
+        // each, so painting a line number copies cells instead of laying out text.
+        struct GutterDigits
+        {
+            QPixmap atlas;
+            qreal devicePixelRatio{0};
+            QRgb inactive{0};
+            QRgb active{0};
+            // A cell's size in device pixels; digits follow each other one cell apart.
+            int cellWidth{0};
+            int cellHeight{0};
+        };
+
+        // An undo step that appended followed text. absorbedEdit is set once typing right after the text merged
+        // into the step, which Qt does for an insertion that continues the one before it.
+        struct FollowedStep
+        {
+            int undoSteps{0};
+            qint64 position{0};
+            qint64 length{0};
+            bool absorbedEdit{false};
+        };
+
+        const GutterDigits& gutterDigits(qreal devicePixelRatio, QRgb inactive, QRgb active);
+        void invalidateGutterDigits();
 
         LineNumberArea* const m_lineNumberArea;
         bool m_lineNumbersVisible{true};
         QFont m_defaultFont;
         int m_zoomPercentage{100};
         int m_tabSizeSpaces{4};
+        core::LineIndex m_lineIndex;
+        core::PieceTable m_pieceTable;
+        bool m_modelPreloaded{false};
+        core::MatchIndex* const m_matchIndex;
+        QList<QTextEdit::ExtraSelection> m_currentLineSelection;
+        QList<QTextEdit::ExtraSelection> m_matchSelections;
+        // The span the match selections were built for; matches outside it are not selections at all.
+        qint64 m_matchSelectionsFrom{-1};
+        qint64 m_matchSelectionsUntil{-1};
+        core::LineFilter* const m_lineFilter;
+        bool m_lineFilterActive{false};
+        bool m_readOnlyBeforeFilter{false};
+        // Lines the filter hid, and the document revision they were hidden at.
+        std::vector<qint64> m_hiddenLines;
+        int m_hiddenLinesRevision{-1};
+        GutterDigits m_gutterDigits;
+        // Follow appends still on the undo stack, oldest first, and whether undoEdit() is moving through it.
+        std::vector<FollowedStep> m_followedSteps;
+        bool m_undoingEdit{false};
     };
 
     class TextEditor::LineNumberArea : public QWidget
@@ -0,0 +1,107 @@
+#include "ui/WatchListPanel.h"
+
+#include <QtCore/qvariant.h>
+#include <QtWidgets/qboxlayout.h>
+#include <QtWidgets/qheaderview.h>
+#include <QtWidgets/qlabel.h>
+#include <QtWidgets/qtoolbutton.h>
+#include <QtWidgets/qtreewidget.h>
+
+#include <algorithm>
+#include <numeric>
+
+// NOTE: Qt parent-child ownership deletes child QObjects automatically, so raw pointers
+// assigned from new within this file are intentional and safe.
+
+namespace GnotePad::ui
+{
+
+    namespace
+    {
+        constexpr int kTermRole = Qt::UserRole;
+        constexpr int kTermColumn = 0;
+        constexpr int kCountColumn = 1;
+    } // namespace
+
+    WatchListPanel::WatchListPanel(QWidget* parent) : QWidget(parent)
+    {
+        // NOLINTBEGIN(cppcoreguidelines-owning-memory)
+        auto* const layout = new QVBoxLayout(this);
+        auto* const header = new QHBoxLayout();
+        m_status = new QLabel(this);
+        m_previousButton = new QToolButton(this);
+        m_nextButton = new QToolButton(this);
+        m_results = new QTreeWidget(this);
+        // NOLINTEND(cppcoreguidelines-owning-memory)
+
+        layout->setContentsMargins(0, 0, 0, 0);
+        layout->addLayout(header);
+        layout->addWidget(m_results);
+        header->addWidget(m_status, 1);
+        header->addWidget(m_previousButton);
+        header->addWidget(m_nextButton);
+
+        m_previousButton->setText(tr("Previous Hit"));
+        m_nextButton->setText(tr("Next Hit"));
+        setSteppingEnabled(false);
+        m_results->setColumnCount(2);
+        m_results->setHeaderLabels({tr("Term"), tr("Hits")});
+        m_results->setRootIsDecorated(false);
+        m_results->setUniformRowHeights(true);
+        m_results->header()->setStretchLastSection(false);
+        m_results->header()->setSectionResizeMode(kTermColumn, QHeaderView::Stretch);
+        m_results->header()->setSectionResizeMode(kCountColumn, QHeaderView::ResizeToContents);
+
+        connect(m_previousButton, &QToolButton::clicked, this, &WatchListPanel::previousHitRequested);
+        connect(m_nextButton, &QToolButton::clicked, this, &WatchListPanel::nextHitRequested);
+        connect(m_results, &QTreeWidget::itemActivated, this, [this](QTreeWidgetItem* item, int) { activateItem(item); });
+    }
+
+    void WatchListPanel::showSearching()
+    {
+        m_results->clear();
+        m_status->setText(tr("Searching..."));
+        setSteppingEnabled(false);
+    }
+
+    void WatchListPanel::showCounts(const QStringList& terms, const std::vector<qint64>& counts)
+    {
+        m_results->clear();
+        // NOLINTBEGIN(cppcoreguidelines-owning-memory)
+        for (qsizetype term = 0; term < terms.size(); ++term)
+        {
+            auto* const item = new QTreeWidgetItem(m_results);
+            item->setText(kTermColumn, terms.at(term));
+            item->setText(kCountColumn, QString::number(counts[static_cast<std::size_t>(term)]));
+            item->setTextAlignment(kCountColumn, Qt::AlignRight | Qt::AlignVCenter);
+            item->setData(kTermColumn, kTermRole, static_cast<int>(term));
+        }
+        // NOLINTEND(cppcoreguidelines-owning-memory)
+
+        const qint64 total = std::accumulate(counts.begin(), counts.end(), qint64{0});
+        const auto found = std::ranges::count_if(counts, [](qint64 count) { return count > 0; });
+        m_status->setText(tr("%1 hit(s) for %2 of %3 term(s)").arg(total).arg(found).arg(terms.size()));
+        setSteppingEnabled(total > 0);
+    }
+
+    void WatchListPanel::markStale()
+    {
+        m_status->setText(tr("The document has changed; run the watch list again to refresh."));
+        setSteppingEnabled(false);
+    }
+
+    void WatchListPanel::activateItem(QTreeWidgetItem* item)
+    {
+        if (item && m_nextButton->isEnabled())
+        {
+            emit termActivated(item->data(kTermColumn, kTermRole).toInt());
+        }
+    }
+
+    void WatchListPanel::setSteppingEnabled(bool enabled)
+    {
+        m_previousButton->setEnabled(enabled);
+        m_nextButton->setEnabled(enabled);
+    }
+
+} // namespace GnotePad::ui
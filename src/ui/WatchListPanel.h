@@ -0,0 +1,56 @@
+#pragma once
+
+#include <QtCore/qobject.h>
+#include <QtCore/qstring.h>
+#include <QtCore/qstringlist.h>
+#include <QtCore/qtypes.h>
+#include <QtWidgets/qwidget.h>
+
+#include <vector>
+
+class QLabel;
+class QToolButton;
+class QTreeWidget;
+class QTreeWidgetItem;
+
+namespace GnotePad::ui
+{
+
+    // Results of a watch-list search: every term with the number of times it occurs, and buttons that step
+    // through the hits of all terms in document order. Activating a term jumps to its next hit.
+    class WatchListPanel : public QWidget
+    {
+        Q_OBJECT
+
+    public:
+        explicit WatchListPanel(QWidget* parent = nullptr);
+
+        // Clears the results while a search runs; stepping is off until showCounts().
+        void showSearching();
+        void showCounts(const QStringList& terms, const std::vector<qint64>& counts);
+
+        // The counts no longer describe the document; stepping is off until the next search.
+        void markStale();
+
+        [[nodiscard]] QTreeWidget* results() const
+        {
+            return m_results;
+        }
+
+    signals:
+        // term indexes the list given to showCounts().
+        void termActivated(int term);
+        void nextHitRequested();
+        void previousHitRequested();
+
+    private:
+        void activateItem(QTreeWidgetItem* item);
+        void setSteppingEnabled(bool enabled);
+
+        QLabel* m_status{nullptr};
+        QToolButton* m_previousButton{nullptr};
+        QToolButton* m_nextButton{nullptr};
+        QTreeWidget* m_results{nullptr};
+    };
+
+} // namespace GnotePad::ui
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <QObject>
+#include <QString>
+#include <QTemporaryDir>
+
+class LoadBenchmarks : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit LoadBenchmarks(QObject* parent = nullptr);
+
+private slots:
+    void initTestCase();
+
+    void benchmarkBufferedOpen();
+    void benchmarkMappedOpen();
+
+private:
+    void runOpenBenchmark(qint64 mapThreshold);
+    static qint64 peakResidentBytes();
+
+    QTemporaryDir m_tempDir;
+    QString m_largeFilePath;
+};
@@ -0,0 +1,101 @@
+#include "LoadBenchmarks.h"
+#include "ui/MainWindow.h"
+#include "ui/TextEditor.h"
+
+#include <QtCore/QByteArray>
+#include <QtCore/QFile>
+#include <QtCore/QStandardPaths>
+#include <QtTest/QTest>
+#include <QtWidgets/QApplication>
+
+namespace
+{
+    // Large enough that the raw-byte copy dominates allocator noise when comparing peak RSS.
+    constexpr qint64 kLargeFileBytes = 64LL * 1024 * 1024;
+} // namespace
+
+using namespace GnotePad::ui;
+
+LoadBenchmarks::LoadBenchmarks(QObject* parent) : QObject(parent)
+{
+}
+
+void LoadBenchmarks::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+    QVERIFY(m_tempDir.isValid());
+
+    m_largeFilePath = m_tempDir.filePath(QStringLiteral("large.log"));
+    QFile file(m_largeFilePath);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+
+    const QByteArray line = QByteArrayLiteral("2024-01-01T00:00:00Z INFO service[1234]: request handled in 12ms path=/api/v1/items\n");
+    qint64 written = 0;
+    while (written < kLargeFileBytes)
+    {
+        const qint64 chunk = file.write(line);
+        QVERIFY(chunk > 0);
+        written += chunk;
+    }
+    file.close();
+}
+
+qint64 LoadBenchmarks::peakResidentBytes()
+{
+#ifdef Q_OS_LINUX
+    QFile status(QStringLiteral("/proc/self/status"));
+    if (!status.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        return -1;
+    }
+    while (!status.atEnd())
+    {
+        const QByteArray line = status.readLine();
+        if (line.startsWith("VmHWM:"))
+        {
+            const QByteArray kilobytes = line.mid(6).trimmed().split(' ').value(0);
+            return kilobytes.toLongLong() * 1024;
+        }
+    }
+#endif
+    return -1;
+}
+
+void LoadBenchmarks::runOpenBenchmark(qint64 mapThreshold)
+{
+    MainWindow window;
+    window.setMemoryMapThresholdForTest(mapThreshold);
+    // Measure the read and decode itself; the background path would return before the document is populated.
+    window.setBackgroundLoadThresholdForTest(-1);
+
+    QBENCHMARK_ONCE
+    {
+        QVERIFY(window.testLoadDocument(m_largeFilePath));
+    }
+
+    QVERIFY(!window.editorForTest()->document()->isEmpty());
+
+    // ctest runs each benchmark in its own process, so the high-water mark is attributable to this open.
+    const qint64 peak = peakResidentBytes();
+    if (peak > 0)
+    {
+        qInfo("Peak RSS after opening %lld-byte file: %lld MiB", kLargeFileBytes, peak / (1024 * 1024));
+    }
+}
+
+void LoadBenchmarks::benchmarkBufferedOpen()
+{
+    runOpenBenchmark(-1);
+}
+
+void LoadBenchmarks::benchmarkMappedOpen()
+{
+    runOpenBenchmark(0);
+}
+
+int main(int argc, char** argv)
+{
+    QApplication app(argc, argv);
+    LoadBenchmarks tc;
+    return QTest::qExec(&tc, argc, argv);
+}
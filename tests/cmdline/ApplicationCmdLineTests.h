@@ -19,6 +19,8 @@ private slots:
     void testHelpOption();
     void testVersionOption();
     void testInvalidOption();
+    void testStdinParsing();
+    void testPositionalFilesParsing();
 
 private:
     void setupParser(QCommandLineParser& parser);
@@ -18,7 +18,12 @@ void ApplicationCmdLineTests::setupParser(QCommandLineParser& parser)
     QCommandLineOption quitAfterInitOption({QStringLiteral("quit-after-init"), QStringLiteral("headless-smoke")},
                                            QStringLiteral("Quit shortly after startup (useful for headless smoke tests)."));
 
+    QCommandLineOption stdinOption(QStringLiteral("stdin"), QStringLiteral("Read the document from standard input."));
+
     parser.addOption(quitAfterInitOption);
+    parser.addOption(stdinOption);
+    parser.addPositionalArgument(
+        QStringLiteral("files"), QStringLiteral("Files to open; \"-\" reads standard input."), QStringLiteral("[files...]"));
 }
 
 void ApplicationCmdLineTests::testQuitAfterInitParsing()
@@ -143,6 +148,43 @@ void ApplicationCmdLineTests::testInvalidOption()
     QVERIFY(!parser.errorText().isEmpty());
 }
 
+void ApplicationCmdLineTests::testStdinParsing()
+{
+    // Test that both --stdin and a lone dash ask for standard input
+    QCommandLineParser parser;
+    setupParser(parser);
+
+    QStringList args;
+    args << QStringLiteral("GnotePad") << QStringLiteral("--stdin");
+
+    QVERIFY(parser.parse(args));
+    QVERIFY(parser.isSet(QStringLiteral("stdin")));
+
+    QCommandLineParser parser2;
+    setupParser(parser2);
+
+    QStringList args2;
+    args2 << QStringLiteral("GnotePad") << QStringLiteral("-");
+
+    QVERIFY(parser2.parse(args2));
+    QVERIFY(!parser2.isSet(QStringLiteral("stdin")));
+    QCOMPARE(parser2.positionalArguments(), QStringList{QStringLiteral("-")});
+}
+
+void ApplicationCmdLineTests::testPositionalFilesParsing()
+{
+    // Test that every positional argument is kept, in order, alongside options
+    QCommandLineParser parser;
+    setupParser(parser);
+
+    QStringList args;
+    args << QStringLiteral("GnotePad") << QStringLiteral("first.log") << QStringLiteral("--quit-after-init") << QStringLiteral("second.log");
+
+    QVERIFY(parser.parse(args));
+    QVERIFY(parser.isSet(QStringLiteral("quit-after-init")));
+    QCOMPARE(parser.positionalArguments(), (QStringList{QStringLiteral("first.log"), QStringLiteral("second.log")}));
+}
+
 int main(int argc, char** argv)
 {
     ApplicationCmdLineTests tc;
@@ -30,6 +30,11 @@ private slots:
     void testMultipleBomMarkers();
     void testEncodingConversionErrors();
     void testUnsupportedEncoding();
+    void testMemoryMappedLoadMatchesBuffered();
+    void testUtf8DecoderMatchesQStringDecoder();
+    void testUtf8DecoderChunkedMatchesQStringDecoder();
+    void testStreamingSaveMatchesPlainText();
+    void testBatchReplaceKeepsEncoding();
 
 private:
     QString resolveTestFile(const QString& name) const;
@@ -1,4 +1,6 @@
 #include "EncodingEdgeCasesTests.h"
+#include "core/BatchReplace.h"
+#include "core/Utf8Decoder.h"
 #include "ui/MainWindow.h"
 #include "ui/TextEditor.h"
 
@@ -6,12 +8,14 @@
 #include <QtCore/QDir>
 #include <QtCore/QFile>
 #include <QtCore/QFileInfo>
+#include <QtCore/QList>
 #include <QtCore/QStandardPaths>
 #include <QtCore/QTemporaryDir>
 #include <QtTest/QTest>
 #include <QtWidgets/QApplication>
 
 #include <QStringConverter>
+#include <algorithm>
 
 using namespace GnotePad::ui;
 
@@ -331,6 +335,249 @@ void EncodingEdgeCasesTests::testUnsupportedEncoding()
     QCOMPARE(editor->toPlainText(), QStringLiteral("Simple ASCII text"));
 }
 
+void EncodingEdgeCasesTests::testMemoryMappedLoadMatchesBuffered()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+
+    // Cover every BOM flavour so the mapped path exercises the same detection and BOM stripping.
+    const QString content = QStringLiteral("Mapped line \u00e9\u4f60\U0001F600\r\nSecond line\n");
+    const struct
+    {
+        QString name;
+        QStringConverter::Encoding encoding;
+        QByteArray bom;
+    } variants[] = {
+        {QStringLiteral("plain.txt"), QStringConverter::Utf8, QByteArray()},
+        {QStringLiteral("utf8bom.txt"), QStringConverter::Utf8, QByteArray::fromHex("efbbbf")},
+        {QStringLiteral("utf16le.txt"), QStringConverter::Utf16LE, QByteArray::fromHex("fffe")},
+        {QStringLiteral("utf16be.txt"), QStringConverter::Utf16BE, QByteArray::fromHex("feff")},
+    };
+
+    for (const auto& variant : variants)
+    {
+        const QString path = tempDir.filePath(variant.name);
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        QStringEncoder encoder(variant.encoding);
+        file.write(variant.bom);
+        file.write(encoder(content));
+        file.close();
+
+        MainWindow bufferedWindow;
+        bufferedWindow.setMemoryMapThresholdForTest(-1);
+        QVERIFY(bufferedWindow.testLoadDocument(path));
+
+        MainWindow mappedWindow;
+        mappedWindow.setMemoryMapThresholdForTest(0);
+        QVERIFY(mappedWindow.testLoadDocument(path));
+
+        QCOMPARE(mappedWindow.editorForTest()->toPlainText(), bufferedWindow.editorForTest()->toPlainText());
+        QCOMPARE(mappedWindow.currentEncodingForTest(), variant.encoding);
+        QCOMPARE(mappedWindow.currentBomForTest(), !variant.bom.isEmpty());
+    }
+}
+
+void EncodingEdgeCasesTests::testUtf8DecoderMatchesQStringDecoder()
+{
+    // Long ASCII runs reach the vector kernels; the rest covers every sequence length, the boundary code
+    // points, a leading BOM, and malformed input where the replacement characters must match as well.
+    QByteArray asciiRun;
+    for (int index = 0; index < 1000; ++index)
+    {
+        asciiRun.append(static_cast<char>('!' + (index % 90)));
+    }
+
+    QList<QByteArray> samples{
+        QByteArray(),
+        asciiRun,
+        asciiRun + "\xC3\xA9" + asciiRun,
+        QByteArray("\xEF\xBB\xBF") + asciiRun,
+        QByteArray("\xEF\xBB\xBF\xEF\xBB\xBF") + "twice",
+        QByteArray("\xC2\x80\xDF\xBF\xE0\xA0\x80\xEF\xBF\xBF\xF0\x90\x80\x80\xF4\x8F\xBF\xBF"),
+        QStringLiteral("Grüße, 你好世界, emoji \U0001F600 and é\r\n").toUtf8().repeated(200),
+        asciiRun + "\xC0\xAF" + asciiRun,
+        asciiRun + "\xE0\x80\x80" + asciiRun,
+        asciiRun + "\xED\xA0\x80" + asciiRun,
+        asciiRun + "\xF4\x90\x80\x80" + asciiRun,
+        asciiRun + "\xF8\x88\x80\x80\x80" + asciiRun,
+        asciiRun + "\x80\xBF" + asciiRun,
+        asciiRun + "\xE2\x82" + asciiRun,
+        asciiRun + "\xE2\x82",
+        QByteArray("\xFF\xFE") + asciiRun,
+    };
+
+    const QString corpusPath = resolveTestFile(QStringLiteral("utf8-tests"));
+    QVERIFY2(!corpusPath.isEmpty(), "utf8-tests not found in testfiles directory");
+    const QDir corpus(corpusPath);
+    for (const auto& entry : corpus.entryInfoList(QDir::Files))
+    {
+        QFile file(entry.absoluteFilePath());
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        samples.append(file.readAll());
+    }
+
+    for (const auto& sample : samples)
+    {
+        QStringDecoder reference(QStringConverter::Utf8);
+        const QString expected = reference(sample);
+
+        GnotePad::core::Utf8Decoder decoder;
+        QCOMPARE(decoder.decode(sample), expected);
+        QCOMPARE(decoder.hasError(), reference.hasError());
+    }
+}
+
+void EncodingEdgeCasesTests::testUtf8DecoderChunkedMatchesQStringDecoder()
+{
+    const QByteArray sample = QByteArray("\xEF\xBB\xBF") +
+                              QStringLiteral("ASCII run long enough for a vector block, then Grüße 你好 \U0001F600\r\n").toUtf8().repeated(8);
+
+    QStringDecoder reference(QStringConverter::Utf8);
+    const QString expected = reference(sample);
+    QVERIFY(!reference.hasError());
+
+    // Split at every chunk size so each multi-byte sequence (and the BOM) is cut at every possible offset.
+    for (qsizetype chunkSize = 1; chunkSize <= 40; ++chunkSize)
+    {
+        GnotePad::core::Utf8Decoder decoder;
+        QString actual;
+        for (qsizetype offset = 0; offset < sample.size(); offset += chunkSize)
+        {
+            actual.append(decoder.decode(QByteArrayView(sample).sliced(offset, std::min(chunkSize, sample.size() - offset))));
+        }
+        QCOMPARE(actual, expected);
+        QVERIFY(!decoder.hasError());
+    }
+}
+
+void EncodingEdgeCasesTests::testStreamingSaveMatchesPlainText()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+
+    MainWindow window;
+    auto* editor = window.editorForTest();
+    QVERIFY(editor);
+
+    // Several encoder chunks' worth of text, with the characters toPlainText() rewrites (non-breaking spaces,
+    // line separators) and a surrogate pair on every line so chunk boundaries land inside pairs too.
+    const QString line = QStringLiteral("Line with\u00a0nbsp, a soft\u2028break and \U0001F600 emoji: 你好\n");
+    editor->setPlainText(line.repeated(5000) + QStringLiteral("last line without newline"));
+    const QString expectedText = editor->toPlainText();
+
+    const struct
+    {
+        QString name;
+        QStringConverter::Encoding encoding;
+        bool bom;
+    } variants[] = {
+        {QStringLiteral("utf8.txt"), QStringConverter::Utf8, false},
+        {QStringLiteral("utf8bom.txt"), QStringConverter::Utf8, true},
+        {QStringLiteral("utf16le.txt"), QStringConverter::Utf16LE, true},
+        {QStringLiteral("utf16be.txt"), QStringConverter::Utf16BE, true},
+    };
+
+    for (const auto& variant : variants)
+    {
+        const QString path = tempDir.filePath(variant.name);
+        QVERIFY(window.testSaveDocumentWithEncoding(path, variant.encoding, variant.bom));
+
+        QStringEncoder encoder(variant.encoding);
+        QByteArray expected;
+        if (variant.bom)
+        {
+            expected.append(encoder.encode(QStringView(u"\uFEFF")));
+        }
+        expected.append(encoder.encode(expectedText));
+
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        QCOMPARE(file.readAll(), expected);
+        QVERIFY(!editor->document()->isModified());
+    }
+}
+
+void EncodingEdgeCasesTests::testBatchReplaceKeepsEncoding()
+{
+    using GnotePad::core::BatchReplace;
+
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+
+    const QString original = QStringLiteral("Host=old.example\r\nBackup=OLD.example\r\nnote: 😀 ölder\r\n");
+    const QString replaced = QStringLiteral("Host=new.example\r\nBackup=new.example\r\nnote: 😀 ölder\r\n");
+
+    const struct
+    {
+        QString name;
+        QStringConverter::Encoding encoding;
+        bool bom;
+    } variants[] = {
+        {QStringLiteral("utf8.conf"), QStringConverter::Utf8, false},
+        {QStringLiteral("utf8bom.conf"), QStringConverter::Utf8, true},
+        {QStringLiteral("utf16le.conf"), QStringConverter::Utf16LE, true},
+        {QStringLiteral("utf16be.conf"), QStringConverter::Utf16BE, true},
+    };
+
+    const auto encoded = [](const QString& text, QStringConverter::Encoding encoding, bool bom)
+    {
+        QStringEncoder encoder(encoding);
+        QByteArray bytes;
+        if (bom)
+        {
+            bytes.append(encoder.encode(QStringView(u"\uFEFF")));
+        }
+        bytes.append(encoder.encode(text));
+        return bytes;
+    };
+
+    QStringList paths;
+    for (const auto& variant : variants)
+    {
+        const QString path = tempDir.filePath(variant.name);
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write(encoded(original, variant.encoding, variant.bom));
+        paths << path;
+    }
+    const QString untouched = tempDir.filePath(QStringLiteral("untouched.conf"));
+    {
+        QFile file(untouched);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write("nothing to see\n");
+    }
+    paths << untouched << tempDir.filePath(QStringLiteral("missing.conf"));
+
+    const BatchReplace replace(QStringLiteral("old.example"), QStringLiteral("new.example"), Qt::CaseInsensitive);
+    QList<BatchReplace::FileResult> results;
+    replace.run(paths, 2, [&results](const BatchReplace::FileResult& result) { results.append(result); });
+    QCOMPARE(results.size(), paths.size());
+
+    for (const BatchReplace::FileResult& result : results)
+    {
+        const QString name = QFileInfo(result.filePath).fileName();
+        if (name == QStringLiteral("missing.conf"))
+        {
+            QCOMPARE(result.error, BatchReplace::Error::Open);
+            continue;
+        }
+        QCOMPARE(result.error, BatchReplace::Error::None);
+        QCOMPARE(result.replacements, qsizetype{name == QStringLiteral("untouched.conf") ? 0 : 2});
+    }
+
+    for (const auto& variant : variants)
+    {
+        QFile file(tempDir.filePath(variant.name));
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        QCOMPARE(file.readAll(), encoded(replaced, variant.encoding, variant.bom));
+    }
+
+    // Matching is case-sensitive on request.
+    const BatchReplace exact(QStringLiteral("NEW.example"), QStringLiteral("x"), Qt::CaseSensitive);
+    QCOMPARE(exact.replaceInFile(paths.front()).replacements, qsizetype{0});
+}
+
 int main(int argc, char** argv)
 {
     QApplication app(argc, argv);
@@ -30,6 +30,16 @@ private slots:
     void testEncodingRoundTripVariants();
     void testFindNavigation();
     void testReplaceOperations();
+    void testReplaceAllSingleUndoStep();
+    void testFindAcrossEditedText();
+    void testRegexFindReplace();
+    void testHighlightAllMatches();
+    void testFindInFiles();
+    void testIncrementalFind();
+    void testWatchList();
+    void testWordIndex();
+    void testFilterLines();
+    void testLineNumberGutter();
     void testRecentFilesMenu();
     void testDestructivePrompts();
     void testShortcutCommands();
@@ -67,6 +77,19 @@ private slots:
     void testActionStateManagement();
     void testTooltipPresence();
     void testRecentFilesMenuActions();
+    void testBackgroundLoadMatchesSynchronous();
+    void testCancelBackgroundLoad();
+    void testBackgroundSaveKeepsLaterEdits();
+    void testLineIndexTracksEdits();
+    void testPieceTableMirrorsEdits();
+    void testLargeFileViewerBrowsesMappedFile();
+    void testFailedOpenKeepsLargeFileViewer();
+    void testFollowAppendsGrowth();
+    void testExternalChangeReloadsChangedLines();
+    void testEditJournalRecoversUnsavedEdits();
+    void testCompressedLogStreamsIn();
+    void testStandardInputStreamsIn();
+    void testOpenFilesInParallel();
 
 private: // NOLINT(readability-redundant-access-specifiers)
     QString resolveTestFile(const QString& name) const;
@@ -1,11 +1,25 @@
 #include "MainWindowSmokeTests.h"
+#include "core/Compression.h"
+#include "core/EditJournal.h"
+#include "core/FileSearch.h"
+#include "core/LiteralSearch.h"
+#include "core/MultiTermSearch.h"
+#include "core/PieceTable.h"
+#include "core/RegexSearch.h"
+#include "core/WordIndex.h"
+#include "ui/FindBar.h"
+#include "ui/FindInFilesPanel.h"
+#include "ui/LargeFileViewer.h"
 #include "ui/MainWindow.h"
 #include "ui/TextEditor.h"
+#include "ui/WatchListPanel.h"
 
 #include <QtCore/QByteArray>
+#include <QtCore/QDateTime>
 #include <QtCore/QDir>
 #include <QtCore/QFile>
 #include <QtCore/QFileInfo>
+#include <QtCore/QHash>
 #include <QtCore/QPoint>
 #include <QtCore/QProcessEnvironment>
 #include <QtCore/QSettings>
@@ -15,22 +29,70 @@
 #include <QtCore/QTemporaryDir>
 #include <QtGui/QAction>
 #include <QtGui/QFont>
+#include <QtGui/QImage>
+#include <QtGui/QPixmap>
+#include <QtGui/QTextBlock>
 #include <QtGui/QTextCursor>
+#include <QtGui/QTextDocument>
+#include <QtGui/QTextFormat>
 #include <QtGui/QTextOption>
 #include <QtPrintSupport/QPrinterInfo>
+#include <QtTest/QSignalSpy>
 #include <QtTest/QTest>
 #include <QtWidgets/QApplication>
 #include <QtWidgets/QLabel>
+#include <QtWidgets/QLineEdit>
 #include <QtWidgets/QMenu>
 #include <QtWidgets/QMenuBar>
 #include <QtWidgets/QMessageBox>
 #include <QtWidgets/QScrollBar>
 #include <QtWidgets/QStatusBar>
+#include <QtWidgets/QTextEdit>
+#include <QtWidgets/QTreeWidget>
+#include <QtWidgets/QWidget>
 
 #include <QStringConverter>
 
+#ifdef Q_OS_UNIX
+#include <unistd.h>
+#endif
+
+#include <array>
+#include <atomic>
+#include <vector>
+
 using namespace GnotePad::ui;
 
+namespace
+{
+    // The editor's line index must agree with Qt's block structure after every change.
+    bool lineIndexMatchesDocument(const TextEditor* editor)
+    {
+        const auto& lineIndex = editor->lineIndex();
+        const QTextDocument* document = editor->document();
+        if (lineIndex.lineCount() != document->blockCount() || lineIndex.length() != document->characterCount() - 1)
+        {
+            return false;
+        }
+        for (QTextBlock block = document->begin(); block.isValid(); block = block.next())
+        {
+            if (lineIndex.lineStart(block.blockNumber()) != block.position() || lineIndex.lineAt(block.position()) != block.blockNumber())
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // The piece table holds the document one character per position, block separators included.
+    QString documentPositions(const TextEditor* editor)
+    {
+        QTextCursor cursor(editor->document());
+        cursor.movePosition(QTextCursor::End, QTextCursor::KeepAnchor);
+        return cursor.selectedText();
+    }
+} // namespace
+
 MainWindowSmokeTests::MainWindowSmokeTests(QObject* parent) : QObject(parent)
 {
 }
@@ -420,6 +482,584 @@ void MainWindowSmokeTests::testReplaceOperations()
     QVERIFY(!afterAll.contains(QStringLiteral("cat")));
 }
 
+void MainWindowSmokeTests::testReplaceAllSingleUndoStep()
+{
+    MainWindow window;
+    auto* editor = window.editorForTest();
+    QVERIFY(editor);
+
+    // Dense runs of matches (folded into shared edits) separated by long stretches without any.
+    QString original;
+    QString expected;
+    for (int section = 0; section < 20; ++section)
+    {
+        for (int line = 0; line < 500; ++line)
+        {
+            original += QStringLiteral("cat Cat catcat %1\n").arg(line);
+            expected += QStringLiteral("lynx lynx lynxlynx %1\n").arg(line);
+        }
+        const QString filler = QStringLiteral("%1\n").arg(QString(5000, QLatin1Char('x')));
+        original += filler;
+        expected += filler;
+    }
+    editor->setPlainText(original);
+    editor->document()->clearUndoRedoStacks();
+    editor->moveCursor(QTextCursor::Start);
+
+    QCOMPARE(window.testReplaceAll(QStringLiteral("cat"), QStringLiteral("lynx")), 20 * 500 * 4);
+    QCOMPARE(editor->toPlainText(), expected);
+    QVERIFY(lineIndexMatchesDocument(editor));
+    QCOMPARE(editor->textCursor().position(), 0);
+    QCOMPARE(editor->document()->availableUndoSteps(), 1);
+
+    editor->undo();
+    QCOMPARE(editor->toPlainText(), original);
+    QVERIFY(lineIndexMatchesDocument(editor));
+
+    // Whole words and case are honoured the way Find honours them.
+    const QTextDocument::FindFlags wholeWordCase = QTextDocument::FindWholeWords | QTextDocument::FindCaseSensitively;
+    QCOMPARE(window.testReplaceAll(QStringLiteral("cat"), QStringLiteral("dog"), wholeWordCase), 20 * 500);
+    QVERIFY(editor->toPlainText().startsWith(QStringLiteral("dog Cat catcat 0\n")));
+}
+
+void MainWindowSmokeTests::testFindAcrossEditedText()
+{
+    MainWindow window;
+    auto* editor = window.editorForTest();
+    QVERIFY(editor);
+
+    editor->setPlainText(QStringLiteral("alpha beta\ngamma beta\n\u212Aelvin scale\n"));
+    // Typing into the middle of a word leaves it split over two pieces of the piece table.
+    QTextCursor cursor(editor->document());
+    cursor.setPosition(13);
+    cursor.insertText(QStringLiteral("XX"));
+    QCOMPARE(editor->toPlainText(), QStringLiteral("alpha beta\ngaXXmma beta\n\u212Aelvin scale\n"));
+
+    editor->moveCursor(QTextCursor::Start);
+    window.setSearchStateForTest(QStringLiteral("aXXm"), Qt::CaseSensitive);
+    QVERIFY(window.testFindNext());
+    QCOMPARE(editor->textCursor().selectionStart(), 12);
+    QCOMPARE(editor->textCursor().selectedText(), QStringLiteral("aXXm"));
+
+    // Forward wraps round to the top, backward to the bottom.
+    window.setSearchStateForTest(QStringLiteral("alpha"), Qt::CaseSensitive);
+    QVERIFY(window.testFindNext());
+    QCOMPARE(editor->textCursor().selectionStart(), 0);
+    window.setSearchStateForTest(QStringLiteral("BETA"), Qt::CaseInsensitive);
+    QVERIFY(window.testFindPrevious());
+    QCOMPARE(editor->textCursor().selectionStart(), 19);
+    QVERIFY(window.testFindPrevious());
+    QCOMPARE(editor->textCursor().selectionStart(), 6);
+
+    // Ignoring case matches every character that folds the same way, the Kelvin sign included.
+    window.setSearchStateForTest(QStringLiteral("kelvin"), Qt::CaseInsensitive);
+    QVERIFY(window.testFindNext());
+    QCOMPARE(editor->textCursor().selectedText(), QStringLiteral("\u212Aelvin"));
+    window.setSearchStateForTest(QStringLiteral("kelvin"), Qt::CaseSensitive);
+    QVERIFY(!window.testFindNext());
+    QCOMPARE(editor->textCursor().selectedText(), QStringLiteral("\u212Aelvin"));
+
+    window.setSearchStateForTest(QStringLiteral("scale"), Qt::CaseSensitive);
+    QVERIFY(window.testFindNext(QTextDocument::FindWholeWords));
+    window.setSearchStateForTest(QStringLiteral("scal"), Qt::CaseSensitive);
+    QVERIFY(!window.testFindNext(QTextDocument::FindWholeWords));
+}
+
+void MainWindowSmokeTests::testRegexFindReplace()
+{
+    MainWindow window;
+    auto* editor = window.editorForTest();
+    QVERIFY(editor);
+
+    editor->setPlainText(QStringLiteral("id=12 name=ab\nid=7 name=cd\n"));
+    editor->document()->clearUndoRedoStacks();
+    editor->moveCursor(QTextCursor::Start);
+    window.setRegexSearchForTest(true);
+
+    window.setSearchStateForTest(QStringLiteral("ID=(\\d+)"), Qt::CaseInsensitive, QStringLiteral("n\\1"));
+    QVERIFY(window.testFindNext());
+    QCOMPARE(editor->textCursor().selectedText(), QStringLiteral("id=12"));
+    QVERIFY(window.testFindNext());
+    QCOMPARE(editor->textCursor().selectionStart(), 14);
+
+    // The selection is a match, so it is replaced with the groups filled in.
+    QVERIFY(window.testReplaceNext());
+    QCOMPARE(editor->toPlainText(), QStringLiteral("id=12 name=ab\nn7 name=cd\n"));
+
+    QCOMPARE(window.testReplaceAll(QStringLiteral("(\\w+)=(\\w+)"), QStringLiteral("$2:\\1")), 3);
+    QCOMPARE(editor->toPlainText(), QStringLiteral("12:id ab:name\nn7 cd:name\n"));
+    QCOMPARE(editor->document()->availableUndoSteps(), 2);
+    editor->undo();
+    QCOMPARE(editor->toPlainText(), QStringLiteral("id=12 name=ab\nn7 name=cd\n"));
+    editor->redo();
+
+    // Anchors apply per line, the way QTextDocument::find treats them.
+    QCOMPARE(window.testReplaceAll(QStringLiteral("^(\\w+)"), QStringLiteral("[\\1]")), 2);
+    QCOMPARE(editor->toPlainText(), QStringLiteral("[12]:id ab:name\n[n7] cd:name\n"));
+    QVERIFY(lineIndexMatchesDocument(editor));
+
+    editor->moveCursor(QTextCursor::End);
+    window.setSearchStateForTest(QStringLiteral("\\d+"), Qt::CaseSensitive);
+    QVERIFY(window.testFindPrevious());
+    QCOMPARE(editor->textCursor().selectionStart(), 18);
+    QVERIFY(window.testFindPrevious());
+    QCOMPARE(editor->textCursor().selectedText(), QStringLiteral("12"));
+
+    // Empty matches are not stops for Find; a broken pattern is reported and changes nothing.
+    window.setSearchStateForTest(QStringLiteral("z*"), Qt::CaseSensitive);
+    QVERIFY(!window.testFindNext());
+    window.setSearchStateForTest(QStringLiteral("(unclosed"), Qt::CaseSensitive);
+    QVERIFY(!window.testFindNext());
+    QVERIFY(!window.searchErrorForTest().isEmpty());
+    QCOMPARE(window.testReplaceAll(QStringLiteral("(unclosed"), QStringLiteral("x")), 0);
+    QCOMPARE(editor->toPlainText(), QStringLiteral("[12]:id ab:name\n[n7] cd:name\n"));
+
+    // A line longer than a window is searched a window at a time, with the same matches as in one go: one far
+    // past the first window, and one that runs across every window edge.
+    const qsizetype longLine = 3 * GnotePad::core::RegexSearch::WindowChars;
+    editor->setPlainText(QString(longLine, u'x') + QStringLiteral("id=99y"));
+    editor->moveCursor(QTextCursor::Start);
+    window.setSearchStateForTest(QStringLiteral("id=(\\d+)"), Qt::CaseSensitive);
+    QVERIFY(window.testFindNext());
+    QCOMPARE(editor->textCursor().selectionStart(), longLine);
+    QCOMPARE(window.testReplaceAll(QStringLiteral("x+id=(\\d+)y"), QStringLiteral("<\\1>")), 1);
+    QCOMPARE(editor->toPlainText(), QStringLiteral("<99>"));
+}
+
+void MainWindowSmokeTests::testHighlightAllMatches()
+{
+    MainWindow window;
+    window.show();
+    QTRY_VERIFY(window.isVisible());
+    auto* editor = window.editorForTest();
+    QVERIFY(editor);
+
+    QString text;
+    for (int line = 0; line < 2000; ++line)
+    {
+        text += QStringLiteral("line %1 needle\n").arg(line);
+    }
+    editor->setPlainText(text);
+    editor->moveCursor(QTextCursor::Start);
+
+    window.setSearchStateForTest(QStringLiteral("needle"), Qt::CaseSensitive);
+    QVERIFY(window.testFindNext());
+    const auto& matches = editor->matchIndex();
+    QTRY_VERIFY(!matches.isScanning());
+    QCOMPARE(matches.count(), 2000);
+    QCOMPARE(window.matchStatusForTest(), QStringLiteral("1 of 2000"));
+    QVERIFY(window.testFindNext());
+    QCOMPARE(window.matchStatusForTest(), QStringLiteral("2 of 2000"));
+
+    // Only what the viewport shows becomes a selection, next to the current line's.
+    const qsizetype selections = editor->extraSelections().size();
+    QVERIFY(selections > 1);
+    QVERIFY(selections < 2000);
+
+    // Edits are folded in right away by rescanning just the lines they touch.
+    QTextCursor cursor(editor->document());
+    cursor.movePosition(QTextCursor::End);
+    cursor.insertText(QStringLiteral("needle needle\n"));
+    QVERIFY(!matches.isScanning());
+    QCOMPARE(matches.count(), 2002);
+    cursor.setPosition(21);
+    cursor.setPosition(27, QTextCursor::KeepAnchor);
+    cursor.removeSelectedText();
+    cursor.setPosition(13);
+    cursor.deleteChar();
+    QCOMPARE(matches.count(), 2001);
+    const QString edited = editor->toPlainText();
+    for (const auto& match : matches.matchesIn(0, edited.size()))
+    {
+        QCOMPARE(edited.mid(match.position, match.length), QStringLiteral("needle"));
+    }
+
+    window.setSearchStateForTest(QStringLiteral("NEEDLE"), Qt::CaseSensitive);
+    QVERIFY(!window.testFindNext());
+    QTRY_VERIFY(!matches.isScanning());
+    QCOMPARE(matches.count(), 0);
+    QCOMPARE(window.matchStatusForTest(), QStringLiteral("0 matches"));
+}
+
+void MainWindowSmokeTests::testFindInFiles()
+{
+    QTemporaryDir root;
+    QVERIFY(root.isValid());
+    const auto writeFile = [&root](const QString& name, const QByteArray& bytes)
+    {
+        QFile file(root.filePath(name));
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        QCOMPARE(file.write(bytes), bytes.size());
+    };
+    QVERIFY(QDir(root.path()).mkpath(QStringLiteral("sub")));
+    writeFile(QStringLiteral("a.txt"), QByteArrayLiteral("one\ntwo\nthe needle is here\nfour\n"));
+    auto encoder = QStringEncoder(QStringConverter::Utf16LE, QStringConverter::Flag::WriteBom);
+    writeFile(QStringLiteral("b.log"), encoder.encode(QStringLiteral("utf-16 needle\nnone\nneedle again\n")));
+    writeFile(QStringLiteral("c.bin"), QByteArray("needle\0\0\0binary", 16));
+    writeFile(QStringLiteral("sub/d.txt"), QByteArrayLiteral("nested needle\n"));
+    writeFile(QStringLiteral("sub/e.txt"), QByteArrayLiteral("nothing to see\n"));
+
+    MainWindow window;
+    window.show();
+    QTRY_VERIFY(window.isVisible());
+    window.setSearchStateForTest(QStringLiteral("needle"), Qt::CaseSensitive);
+
+    auto* panel = window.testFindInFiles(root.path(), {QStringLiteral("*")}, QStringLiteral("needle"));
+    QVERIFY(panel);
+    QTRY_VERIFY(!panel->isSearching());
+
+    // One entry per text file with a hit; the binary file is skipped and the UTF-16 one decoded.
+    auto* results = panel->results();
+    QCOMPARE(results->topLevelItemCount(), 3);
+    QHash<QString, QTreeWidgetItem*> byName;
+    for (int index = 0; index < results->topLevelItemCount(); ++index)
+    {
+        auto* item = results->topLevelItem(index);
+        byName.insert(QFileInfo(item->data(0, Qt::UserRole).toString()).fileName(), item);
+    }
+    QVERIFY(byName.contains(QStringLiteral("a.txt")));
+    QVERIFY(byName.contains(QStringLiteral("d.txt")));
+    QVERIFY(!byName.contains(QStringLiteral("c.bin")));
+    QCOMPARE(byName.value(QStringLiteral("b.log"))->childCount(), 2);
+    QCOMPARE(byName.value(QStringLiteral("b.log"))->child(1)->text(0), QStringLiteral("Ln 3: needle again"));
+
+    // Activating a hit opens its file with the cursor on that line.
+    auto* hit = byName.value(QStringLiteral("a.txt"))->child(0);
+    QCOMPARE(hit->text(0), QStringLiteral("Ln 3: the needle is here"));
+    emit results->itemActivated(hit, 0);
+    QCOMPARE(QFileInfo(window.currentFilePathForTest()), QFileInfo(root.filePath(QStringLiteral("a.txt"))));
+    QCOMPARE(window.editorForTest()->textCursor().blockNumber(), 2);
+
+    // Name filters narrow the walk, and a cancelled search stops at once.
+    panel = window.testFindInFiles(root.path(), {QStringLiteral("*.txt")}, QStringLiteral("needle"));
+    QTRY_VERIFY(!panel->isSearching());
+    QCOMPARE(results->topLevelItemCount(), 2);
+    panel = window.testFindInFiles(root.path(), {QStringLiteral("*")}, QStringLiteral("needle"));
+    panel->cancel();
+    QVERIFY(!panel->isSearching());
+
+    // Lines break where the editor breaks them, a CRLF pair counting once.
+    const GnotePad::core::LiteralSearch needle(QStringLiteral("needle"), Qt::CaseSensitive);
+    const std::atomic_bool notCancelled{false};
+    writeFile(QStringLiteral("breaks.txt"), QByteArrayLiteral("one\r\ntwo\rthree\nfour needle\r\nfive needle"));
+    const auto breakHits = GnotePad::core::FileSearch::searchFile(root.filePath(QStringLiteral("breaks.txt")), needle, notCancelled);
+    QCOMPARE(breakHits.size(), qsizetype{2});
+    QCOMPARE(breakHits.at(0).line, qint64{3});
+    QCOMPARE(breakHits.at(0).text, QStringLiteral("four needle"));
+    QCOMPARE(breakHits.at(1).line, qint64{4});
+
+    // A file that is one endless line is searched as it streams in, with the column counted from its start.
+    QByteArray endless(9 * 1024 * 1024, 'x');
+    const qsizetype needleAt = endless.size() - 100;
+    endless.replace(needleAt, 6, "needle");
+    writeFile(QStringLiteral("endless.txt"), endless);
+    const auto endlessHits = GnotePad::core::FileSearch::searchFile(root.filePath(QStringLiteral("endless.txt")), needle, notCancelled);
+    QCOMPARE(endlessHits.size(), qsizetype{1});
+    QCOMPARE(endlessHits.at(0).line, qint64{0});
+    QCOMPARE(endlessHits.at(0).column, needleAt);
+}
+
+void MainWindowSmokeTests::testIncrementalFind()
+{
+    MainWindow window;
+    window.show();
+    QTRY_VERIFY(window.isVisible());
+    auto* editor = window.editorForTest();
+    QVERIFY(editor);
+
+    QString text;
+    for (int line = 0; line < 20000; ++line)
+    {
+        text += QStringLiteral("line %1 filler\n").arg(line);
+    }
+    text += QStringLiteral("needle in the haystack\n");
+    editor->setPlainText(text);
+    editor->moveCursor(QTextCursor::Start);
+
+    QMetaObject::invokeMethod(&window, "handleIncrementalFind");
+    auto* bar = window.findChild<FindBar*>();
+    QVERIFY(bar);
+    QVERIFY(bar->isVisible());
+    auto* field = bar->findChild<QLineEdit*>();
+    QVERIFY(field);
+
+    // Each keystroke supersedes the search before it; only the last one lands, through the event loop.
+    QTest::keyClicks(field, QStringLiteral("need"));
+    QVERIFY(window.incrementalSearchRunningForTest());
+    QTRY_VERIFY(!window.incrementalSearchRunningForTest());
+    QCOMPARE(editor->textCursor().selectedText(), QStringLiteral("need"));
+    const int found = editor->textCursor().selectionStart();
+
+    // Typing on extends the match in place; a miss keeps it.
+    QTest::keyClicks(field, QStringLiteral("le"));
+    QTRY_VERIFY(!window.incrementalSearchRunningForTest());
+    QCOMPARE(editor->textCursor().selectionStart(), found);
+    QCOMPARE(editor->textCursor().selectedText(), QStringLiteral("needle"));
+    QTest::keyClicks(field, QStringLiteral("x"));
+    QTRY_VERIFY(!window.incrementalSearchRunningForTest());
+    QCOMPARE(editor->textCursor().selectedText(), QStringLiteral("needle"));
+
+    // An edit to the document drops a search still in flight.
+    QTest::keyClick(field, Qt::Key_Backspace);
+    QVERIFY(window.incrementalSearchRunningForTest());
+    QTextCursor(editor->document()).insertText(QStringLiteral("x"));
+    QVERIFY(!window.incrementalSearchRunningForTest());
+
+    // Escape closes the bar even while Cancel Loading, which shares the key, is armed by a running load.
+    QAction* cancelLoad = window.cancelLoadActionForTest();
+    QVERIFY(cancelLoad);
+    cancelLoad->setEnabled(true);
+    const QSignalSpy cancelled(cancelLoad, &QAction::triggered);
+    QTest::keyClick(field, Qt::Key_Escape);
+    QVERIFY(!bar->isVisible());
+    QCOMPARE(cancelled.count(), 0);
+    cancelLoad->setEnabled(false);
+}
+
+void MainWindowSmokeTests::testWatchList()
+{
+    // Overlapping terms all count, found in one pass even where a term straddles two pieces.
+    const QStringList terms{QStringLiteral("he"), QStringLiteral("she"), QStringLiteral("his"), QStringLiteral("hers")};
+    const GnotePad::core::MultiTermSearch search(terms, Qt::CaseSensitive);
+    const QString ushers = QStringLiteral("ushers");
+    const auto hits = search.findAll(std::vector<QStringView>{QStringView(ushers).first(2), QStringView(ushers).sliced(2)});
+    QCOMPARE(hits.size(), std::size_t{3});
+    QCOMPARE(hits[0].position, 1);
+    QCOMPARE(search.terms().at(hits[0].term), QStringLiteral("she"));
+    QCOMPARE(search.terms().at(hits[1].term), QStringLiteral("he"));
+    QCOMPARE(search.terms().at(hits[2].term), QStringLiteral("hers"));
+
+    // Only the first hits of each term are kept past the cap, but every occurrence is counted.
+    std::vector<qint64> counts;
+    const std::atomic_bool notCancelled{false};
+    const QString repeated = QStringLiteral("she ").repeated(50);
+    const auto capped = search.findAll(std::vector<QStringView>{repeated}, 5, counts, notCancelled);
+    QCOMPARE(capped.size(), std::size_t{10});
+    QVERIFY(counts == (std::vector<qint64>{50, 50, 0, 0}));
+    QCOMPARE(capped.back().position, qint64{17});
+
+    MainWindow window;
+    window.show();
+    QTRY_VERIFY(window.isVisible());
+    auto* editor = window.editorForTest();
+    QVERIFY(editor);
+    editor->setPlainText(QStringLiteral("OOM killed\nok\nconnection reset\nok\noom killed again\nTimeout\n"));
+    editor->moveCursor(QTextCursor::Start);
+
+    // Terms that differ only in case are one term when case is ignored.
+    auto* panel = window.testWatchList({QStringLiteral("oom killed"),
+                                        QStringLiteral("connection reset"),
+                                        QStringLiteral("timeout"),
+                                        QStringLiteral("disk full"),
+                                        QStringLiteral("OOM KILLED")},
+                                       Qt::CaseInsensitive);
+    QVERIFY(panel);
+    QTRY_VERIFY(!window.watchListRunningForTest());
+    auto* results = panel->results();
+    QCOMPARE(results->topLevelItemCount(), 4);
+    QCOMPARE(results->topLevelItem(0)->text(1), QStringLiteral("2"));
+    QCOMPARE(results->topLevelItem(1)->text(1), QStringLiteral("1"));
+    QCOMPARE(results->topLevelItem(2)->text(1), QStringLiteral("1"));
+    QCOMPARE(results->topLevelItem(3)->text(1), QStringLiteral("0"));
+
+    // Stepping visits every hit in document order and wraps; a term's own hits can be stepped alone.
+    QVERIFY(window.testJumpToWatchHit(-1, false));
+    QCOMPARE(editor->textCursor().selectedText(), QStringLiteral("OOM killed"));
+    QVERIFY(window.testJumpToWatchHit(-1, false));
+    QCOMPARE(editor->textCursor().selectedText(), QStringLiteral("connection reset"));
+    QVERIFY(window.testJumpToWatchHit(0, false));
+    QCOMPARE(editor->textCursor().selectedText(), QStringLiteral("oom killed"));
+    QVERIFY(window.testJumpToWatchHit(-1, false));
+    QCOMPARE(editor->textCursor().selectedText(), QStringLiteral("Timeout"));
+    QVERIFY(window.testJumpToWatchHit(-1, false));
+    QCOMPARE(editor->textCursor().selectionStart(), 0);
+    QVERIFY(window.testJumpToWatchHit(-1, true));
+    QCOMPARE(editor->textCursor().selectedText(), QStringLiteral("Timeout"));
+    QVERIFY(!window.testJumpToWatchHit(3, false));
+
+    // Any edit makes the hits stale until the list is run again, and drops a scan still running.
+    editor->insertPlainText(QStringLiteral("x"));
+    QVERIFY(!window.testJumpToWatchHit(-1, false));
+    window.testWatchList({QStringLiteral("timeout")}, Qt::CaseInsensitive);
+    editor->insertPlainText(QStringLiteral("x"));
+    QVERIFY(!window.watchListRunningForTest());
+    QVERIFY(!window.testJumpToWatchHit(-1, false));
+}
+
+void MainWindowSmokeTests::testWordIndex()
+{
+    MainWindow window;
+    window.show();
+    QTRY_VERIFY(window.isVisible());
+    auto* editor = window.editorForTest();
+    QVERIFY(editor);
+    auto* indexAction = window.findChild<QAction*>(QStringLiteral("actionWordIndex"));
+    QVERIFY(indexAction);
+    auto& index = window.wordIndexForTest();
+
+    // Words are runs of letters and digits, as whole-word search takes them, and are counted ignoring case.
+    editor->setPlainText(QStringLiteral("cat concat Cat\ncat_dog cats CAT\n"));
+    indexAction->setChecked(true);
+    QTRY_VERIFY(index.isReady());
+    QVERIFY(index.memoryBytes() > 0);
+    QCOMPARE(index.count(u"cat"), qsizetype{4});
+    QCOMPARE(index.count(u"dog"), qsizetype{1});
+    QCOMPARE(index.count(u"ca"), qsizetype{0});
+
+    // Whole-word Find Next answers from the index and honours case.
+    editor->moveCursor(QTextCursor::Start);
+    window.setSearchStateForTest(QStringLiteral("cat"), Qt::CaseSensitive);
+    window.setWholeWordSearchForTest(true);
+    QVERIFY(window.testFindNext());
+    QCOMPARE(editor->textCursor().selectionStart(), 0);
+    QVERIFY(window.testFindNext());
+    QCOMPARE(editor->textCursor().selectionStart(), 15);
+    QTRY_COMPARE(window.matchStatusForTest(), QStringLiteral("2 of 2"));
+
+    // Edits keep the index current in place.
+    QTextCursor cursor(editor->document());
+    cursor.movePosition(QTextCursor::End);
+    cursor.insertText(QStringLiteral("cat"));
+    QVERIFY(index.isReady());
+    QCOMPARE(index.count(u"cat"), qsizetype{5});
+    cursor.setPosition(3);
+    cursor.deleteChar();
+    QCOMPARE(index.count(u"cat"), qsizetype{4});
+    QCOMPARE(index.count(u"catconcat"), qsizetype{1});
+
+    // Marking the word under the caret marks and counts every occurrence of it.
+    QTextCursor caret(editor->document());
+    caret.setPosition(15);
+    editor->setTextCursor(caret);
+    QVERIFY(QMetaObject::invokeMethod(&window, "handleMarkAllOccurrences"));
+    QCOMPARE(editor->textCursor().selectedText(), QStringLiteral("cat"));
+    QTRY_COMPARE(window.matchStatusForTest(), QStringLiteral("1 of 2"));
+
+    // An index over its memory limit is dropped, and searches scan the text again.
+    index.setMemoryLimit(1);
+    QCOMPARE(index.state(), GnotePad::core::WordIndex::State::Off);
+    QVERIFY(window.testFindNext());
+    QCOMPARE(editor->textCursor().selectionStart(), 31);
+    indexAction->setChecked(false);
+}
+
+void MainWindowSmokeTests::testFilterLines()
+{
+    MainWindow window;
+    window.show();
+    QTRY_VERIFY(window.isVisible());
+    auto* editor = window.editorForTest();
+    QVERIFY(editor);
+    auto* showAllAction = window.findChild<QAction*>(QStringLiteral("actionShowAllLines"));
+    QVERIFY(showAllAction);
+    const QTextDocument* doc = editor->document();
+    const auto shownLines = [doc]()
+    {
+        QList<int> lines;
+        for (QTextBlock block = doc->begin(); block.isValid(); block = block.next())
+        {
+            if (block.isVisible())
+            {
+                lines << block.blockNumber();
+            }
+        }
+        return lines;
+    };
+
+    // Only the matching lines stay, and the editor is read-only while they do.
+    editor->setPlainText(QStringLiteral("alpha\nbeta\nAlphabet\ngamma\n"));
+    QVERIFY(window.testFilterLines(QStringLiteral("alpha"), Qt::CaseInsensitive, false, false));
+    QTRY_COMPARE(shownLines(), QList<int>({0, 2}));
+    QVERIFY(editor->isLineFilterActive());
+    QVERIFY(editor->isReadOnly());
+    QVERIFY(showAllAction->isEnabled());
+
+    // Showing all lines again needs no new pass over the text.
+    showAllAction->trigger();
+    QCOMPARE(shownLines(), QList<int>({0, 1, 2, 3, 4}));
+    QVERIFY(!editor->isLineFilterActive());
+    QVERIFY(!editor->isReadOnly());
+    QVERIFY(!showAllAction->isEnabled());
+
+    // An inverted regular expression keeps the lines that do not match.
+    QVERIFY(window.testFilterLines(QStringLiteral("^a"), Qt::CaseSensitive, true, true));
+    QTRY_COMPARE(shownLines(), QList<int>({1, 2, 3, 4}));
+    QVERIFY(!window.testFilterLines(QStringLiteral("("), Qt::CaseSensitive, true, false));
+
+    // Going to a hidden line brings the whole document back.
+    window.testGoToLine(1);
+    QVERIFY(!editor->isLineFilterActive());
+    QCOMPARE(shownLines().size(), 5);
+    QCOMPARE(editor->textCursor().blockNumber(), 0);
+
+    // So does any edit that reaches the document.
+    QVERIFY(window.testFilterLines(QStringLiteral("gamma"), Qt::CaseInsensitive, false, false));
+    QTRY_COMPARE(shownLines(), QList<int>({3}));
+    QCOMPARE(editor->textCursor().blockNumber(), 3);
+    const auto highlightedLine = [editor]()
+    {
+        for (const QTextEdit::ExtraSelection& selection : editor->extraSelections())
+        {
+            if (selection.format.boolProperty(QTextFormat::FullWidthSelection))
+            {
+                return selection.cursor.blockNumber();
+            }
+        }
+        return -1;
+    };
+    // The current line highlight moves off the hidden line along with the cursor.
+    QCOMPARE(highlightedLine(), 3);
+    QTextCursor cursor(editor->document());
+    cursor.movePosition(QTextCursor::End);
+    cursor.insertText(QStringLiteral("delta"));
+    QVERIFY(!editor->isLineFilterActive());
+    QVERIFY(!editor->isReadOnly());
+    QCOMPARE(shownLines().size(), 5);
+}
+
+void MainWindowSmokeTests::testLineNumberGutter()
+{
+    MainWindow window;
+    window.show();
+    QTRY_VERIFY(window.isVisible());
+    auto* editor = window.editorForTest();
+    QVERIFY(editor);
+    auto* gutter = editor->findChild<QWidget*>(QStringLiteral("lineNumberArea"));
+    QVERIFY(gutter);
+
+    // Numbers are drawn right-aligned; the gutter's left edge stays background.
+    const auto inkedPixels = [](const QImage& image)
+    {
+        int inked = 0;
+        for (int y = 0; y < image.height(); ++y)
+        {
+            for (int x = 0; x < image.width(); ++x)
+            {
+                inked += image.pixel(x, y) != image.pixel(0, 0) ? 1 : 0;
+            }
+        }
+        return inked;
+    };
+
+    editor->setPlainText(QStringLiteral("1\n2\n3\n4\n5\n6\n7\n8\n9\n10\n11\n12"));
+    editor->resetZoom();
+    const QImage original = gutter->grab().toImage();
+    QVERIFY(inkedPixels(original) > 0);
+
+    // The cached digits follow the zoom and the font.
+    editor->increaseZoom(5);
+    const QImage zoomed = gutter->grab().toImage();
+    QVERIFY(inkedPixels(zoomed) > inkedPixels(original));
+
+    editor->resetZoom();
+    QCOMPARE(gutter->grab().toImage(), original);
+
+    QFont larger = editor->font();
+    larger.setPointSizeF(larger.pointSizeF() * 2);
+    editor->applyEditorFont(larger);
+    QVERIFY(inkedPixels(gutter->grab().toImage()) > inkedPixels(original));
+}
+
 void MainWindowSmokeTests::testRecentFilesMenu()
 {
     const QString firstPath = resolveTestFile(QStringLiteral("sample68.htm"));
@@ -1691,6 +2331,860 @@ void MainWindowSmokeTests::testRecentFilesMenuActions()
     QTRY_VERIFY(window.recentFilesForTest().isEmpty());
 }
 
+void MainWindowSmokeTests::testBackgroundLoadMatchesSynchronous()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+
+    // CRLF line endings and multi-byte characters make it likely that chunk boundaries split both a CRLF pair
+    // and a UTF-8 sequence, which the streamed load must reassemble exactly like a single-shot decode.
+    const QString path = tempDir.filePath(QStringLiteral("background.txt"));
+    {
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write(QByteArray::fromHex("efbbbf"));
+        const QByteArray line = QStringLiteral("Zeile mit Umlauten äöü, 日本語のテキスト, emoji 🙂\r\n").toUtf8();
+        constexpr int LINE_COUNT = 40000;
+        for (int index = 0; index < LINE_COUNT; ++index)
+        {
+            QVERIFY(file.write(line) == line.size());
+        }
+    }
+
+    MainWindow synchronousWindow;
+    synchronousWindow.setBackgroundLoadThresholdForTest(-1);
+    QVERIFY(synchronousWindow.testLoadDocument(path));
+    QVERIFY(!synchronousWindow.documentLoadInProgressForTest());
+
+    MainWindow backgroundWindow;
+    backgroundWindow.setBackgroundLoadThresholdForTest(0);
+    QVERIFY(backgroundWindow.testLoadDocument(path));
+    QVERIFY(backgroundWindow.documentLoadInProgressForTest());
+    QVERIFY(backgroundWindow.cancelLoadActionForTest()->isEnabled());
+    QTRY_VERIFY_WITH_TIMEOUT(!backgroundWindow.documentLoadInProgressForTest(), 30000);
+
+    auto* expected = synchronousWindow.editorForTest();
+    auto* actual = backgroundWindow.editorForTest();
+    QCOMPARE(actual->toPlainText(), expected->toPlainText());
+    QCOMPARE(actual->document()->blockCount(), expected->document()->blockCount());
+    QVERIFY(lineIndexMatchesDocument(expected));
+    QVERIFY(lineIndexMatchesDocument(actual));
+    QCOMPARE(backgroundWindow.currentEncodingForTest(), QStringConverter::Utf8);
+    QVERIFY(backgroundWindow.currentBomForTest());
+    QVERIFY(!actual->document()->isModified());
+    QVERIFY(!actual->isReadOnly());
+    QVERIFY(!actual->document()->isUndoAvailable());
+    QCOMPARE(actual->textCursor().position(), 0);
+    QVERIFY(!backgroundWindow.cancelLoadActionForTest()->isEnabled());
+    QVERIFY(backgroundWindow.windowTitle().contains(QStringLiteral("background.txt")));
+    QCOMPARE(backgroundWindow.recentFilesForTest().value(0), path);
+}
+
+void MainWindowSmokeTests::testCancelBackgroundLoad()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+
+    const QString path = tempDir.filePath(QStringLiteral("cancelled.log"));
+    {
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        const QByteArray line = QByteArrayLiteral("2024-01-01T00:00:00Z INFO request handled\n");
+        constexpr int LINE_COUNT = 200000;
+        for (int index = 0; index < LINE_COUNT; ++index)
+        {
+            QVERIFY(file.write(line) == line.size());
+        }
+    }
+
+    MainWindow window;
+    window.setBackgroundLoadThresholdForTest(0);
+    QVERIFY(window.testLoadDocument(path));
+    QVERIFY(window.documentLoadInProgressForTest());
+
+    auto* cancelAction = window.cancelLoadActionForTest();
+    QVERIFY(cancelAction);
+    cancelAction->trigger();
+
+    QVERIFY(!window.documentLoadInProgressForTest());
+    QVERIFY(!cancelAction->isEnabled());
+
+    // Chunks that were already queued when the load was cancelled must not reach the editor.
+    QTest::qWait(100);
+    auto* editor = window.editorForTest();
+    QVERIFY(editor->document()->isEmpty());
+    QVERIFY(!editor->isReadOnly());
+    QVERIFY(window.windowTitle().contains(QStringLiteral("Untitled")));
+    QVERIFY(!window.recentFilesForTest().contains(path));
+}
+
+void MainWindowSmokeTests::testBackgroundSaveKeepsLaterEdits()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    const QString path = tempDir.filePath(QStringLiteral("background_save.txt"));
+    {
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write("original\n");
+    }
+
+    MainWindow window;
+    window.setBackgroundSaveForTest(true);
+    QVERIFY(window.testLoadDocument(path));
+
+    const auto readFile = [&path]()
+    {
+        QFile file(path);
+        return file.open(QIODevice::ReadOnly) ? QString::fromUtf8(file.readAll()) : QString();
+    };
+
+    auto* editor = window.editorForTest();
+    editor->moveCursor(QTextCursor::End);
+    editor->insertPlainText(QStringLiteral("saved edit\n"));
+    window.testSaveDocumentInBackground();
+    QVERIFY(window.documentSaveInProgressForTest());
+
+    // Typed after the snapshot was taken: must not reach the file, and must keep the document modified.
+    editor->insertPlainText(QStringLiteral("later edit\n"));
+    QTRY_VERIFY(!window.documentSaveInProgressForTest());
+    QCOMPARE(readFile(), QStringLiteral("original\nsaved edit\n"));
+    QVERIFY(editor->document()->isModified());
+    QVERIFY(window.windowTitle().startsWith(QLatin1Char('*')));
+
+    // A follow-up save with no concurrent edits clears the modified flag.
+    window.testSaveDocumentInBackground();
+    QTRY_VERIFY(!window.documentSaveInProgressForTest());
+    QCOMPARE(readFile(), QStringLiteral("original\nsaved edit\nlater edit\n"));
+    QVERIFY(!editor->document()->isModified());
+    QCOMPARE(window.recentFilesForTest().value(0), path);
+}
+
+void MainWindowSmokeTests::testLineIndexTracksEdits()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    const QString path = tempDir.filePath(QStringLiteral("line_index.txt"));
+    {
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        // Every kind of break QTextDocument turns into a block: CRLF, lone CR, LF and the paragraph separator.
+        file.write(QStringLiteral("one\r\ntwo\rthree\nfour\u2029five\u2028still five\r\n\r\nlast").toUtf8());
+    }
+
+    MainWindow window;
+    QVERIFY(window.testLoadDocument(path));
+    auto* editor = window.editorForTest();
+    QCOMPARE(editor->lineIndex().lineCount(), qint64{7});
+    QVERIFY(lineIndexMatchesDocument(editor));
+
+    QTextCursor cursor(editor->document());
+    cursor.setPosition(5);
+    cursor.insertText(QStringLiteral("x\ny\r\nz\r"));
+    QVERIFY(lineIndexMatchesDocument(editor));
+
+    cursor.setPosition(2);
+    cursor.setPosition(20, QTextCursor::KeepAnchor);
+    cursor.removeSelectedText();
+    QVERIFY(lineIndexMatchesDocument(editor));
+
+    cursor.insertBlock();
+    cursor.deletePreviousChar();
+    cursor.movePosition(QTextCursor::End);
+    cursor.insertText(QStringLiteral("\ntrailing\n"));
+    QVERIFY(lineIndexMatchesDocument(editor));
+
+    editor->undo();
+    QVERIFY(lineIndexMatchesDocument(editor));
+    editor->redo();
+    QVERIFY(lineIndexMatchesDocument(editor));
+
+    editor->selectAll();
+    editor->insertPlainText(QStringLiteral("a\nb\nc"));
+    QVERIFY(lineIndexMatchesDocument(editor));
+    QCOMPARE(editor->lineIndex().lineCount(), qint64{3});
+
+    window.testGoToLine(3);
+    QCOMPARE(editor->textCursor().blockNumber(), 2);
+    QCOMPARE(editor->textCursor().positionInBlock(), 0);
+    window.testGoToLine(99);
+    QCOMPARE(editor->textCursor().blockNumber(), 2);
+
+    editor->clear();
+    QVERIFY(lineIndexMatchesDocument(editor));
+    QCOMPARE(editor->lineIndex().lineCount(), qint64{1});
+}
+
+void MainWindowSmokeTests::testPieceTableMirrorsEdits()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+    const QString path = tempDir.filePath(QStringLiteral("pieces.txt"));
+    {
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write(QStringLiteral("first\r\nsecond\u00a0line\rthird\nfourth").toUtf8());
+    }
+
+    MainWindow window;
+    QVERIFY(window.testLoadDocument(path));
+    auto* editor = window.editorForTest();
+    QCOMPARE(editor->pieceTable().text(), documentPositions(editor));
+    QCOMPARE(editor->pieceTable().lineCount(), qint64{4});
+
+    QTextCursor cursor(editor->document());
+    cursor.setPosition(3);
+    cursor.insertText(QStringLiteral("typed"));
+    cursor.insertText(QStringLiteral(" more\nlines"));
+    QCOMPARE(editor->pieceTable().text(), documentPositions(editor));
+
+    // A copy is a snapshot: later edits and undo must not show through it.
+    const GnotePad::core::PieceTable snapshot = editor->pieceTable();
+    const QString snapshotText = snapshot.text();
+    cursor.setPosition(1);
+    cursor.setPosition(12, QTextCursor::KeepAnchor);
+    cursor.removeSelectedText();
+    QCOMPARE(editor->pieceTable().text(), documentPositions(editor));
+    editor->undo();
+    editor->undo();
+    QCOMPARE(editor->pieceTable().text(), documentPositions(editor));
+    editor->redo();
+    QCOMPARE(editor->pieceTable().text(), documentPositions(editor));
+    QCOMPARE(snapshot.text(), snapshotText);
+    QCOMPARE(editor->pieceTable().lineStart(2), qint64{editor->document()->findBlockByNumber(2).position()});
+
+    // Saving from the pieces writes what toPlainText() would.
+    const QString savedPath = tempDir.filePath(QStringLiteral("pieces_saved.txt"));
+    QVERIFY(window.testSaveDocument(savedPath));
+    QFile saved(savedPath);
+    QVERIFY(saved.open(QIODevice::ReadOnly));
+    QCOMPARE(QString::fromUtf8(saved.readAll()), editor->toPlainText());
+}
+
+void MainWindowSmokeTests::testLargeFileViewerBrowsesMappedFile()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+
+    // Mixed LF and CRLF endings and a trailing newline, so the viewer's line count has an empty last line.
+    const QString path = tempDir.filePath(QStringLiteral("huge.log"));
+    constexpr int LINE_COUNT = 5000;
+    {
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        for (int index = 0; index < LINE_COUNT; ++index)
+        {
+            QByteArray line = QByteArrayLiteral("entry ") + QByteArray::number(index);
+            if (index == 3209)
+            {
+                line += QByteArrayLiteral(" needle");
+            }
+            if (index == 4100)
+            {
+                line += QByteArrayLiteral("\tNEEDLE");
+            }
+            if (index == 4500)
+            {
+                line += QStringLiteral(" \u00abK\u00c4SE\u00bb k\u00e4sebrot").toUtf8();
+            }
+            line += (index % 3 == 0) ? QByteArrayLiteral("\r\n") : QByteArrayLiteral("\n");
+            QVERIFY(file.write(line) == line.size());
+        }
+    }
+
+    MainWindow window;
+    window.setLargeFileViewerThresholdForTest(1);
+    QVERIFY(window.testLoadDocument(path));
+    QVERIFY(window.largeFileViewerActiveForTest());
+    auto* viewer = window.largeFileViewerForTest();
+    QTRY_VERIFY_WITH_TIMEOUT(viewer->indexingComplete(), 10000);
+    QCOMPARE(viewer->lineCount(), qint64{LINE_COUNT + 1});
+    QCOMPARE(window.recentFilesForTest().value(0), path);
+
+    // Browsing only: the hidden editor is empty and read-only, and nothing offers to write the file.
+    QVERIFY(window.editorForTest()->isReadOnly());
+    QVERIFY(window.editorForTest()->document()->isEmpty());
+    QVERIFY(!window.saveActionForTest()->isEnabled());
+    QVERIFY(!window.replaceActionForTest()->isEnabled());
+    QVERIFY(window.findActionForTest()->isEnabled());
+
+    window.testGoToLine(2500);
+    QCOMPARE(viewer->currentLine(), qint64{2499});
+
+    // Find only starts a search on the viewer's worker; the outcome arrives later through findFinished().
+    QSignalSpy findFinished(viewer, &LargeFileViewer::findFinished);
+    const auto findOutcome = [&findFinished]() { return findFinished.wait(10000) && findFinished.takeFirst().value(0).toBool(); };
+
+    window.setSearchStateForTest(QStringLiteral("needle"), Qt::CaseInsensitive);
+    QVERIFY(window.testFindNext());
+    QVERIFY(findOutcome());
+    QCOMPARE(viewer->currentLine(), qint64{3209});
+    QCOMPARE(viewer->currentColumn(), qint64{QStringLiteral("entry 3209 ").size()});
+    QVERIFY(window.testFindNext());
+    QVERIFY(findOutcome());
+    QCOMPARE(viewer->currentLine(), qint64{4100});
+    // Wraps around to the first match, and back again going backwards.
+    QVERIFY(window.testFindNext());
+    QVERIFY(findOutcome());
+    QCOMPARE(viewer->currentLine(), qint64{3209});
+    QVERIFY(window.testFindPrevious());
+    QVERIFY(findOutcome());
+    QCOMPARE(viewer->currentLine(), qint64{4100});
+    QVERIFY(window.testFindPrevious());
+    QVERIFY(findOutcome());
+    QCOMPARE(viewer->currentLine(), qint64{3209});
+
+    window.setSearchStateForTest(QStringLiteral("NEEDLE"), Qt::CaseSensitive);
+    window.testGoToLine(1);
+    QVERIFY(window.testFindNext());
+    QVERIFY(findOutcome());
+    QCOMPARE(viewer->currentLine(), qint64{4100});
+    window.setSearchStateForTest(QStringLiteral("missing"), Qt::CaseSensitive);
+    QVERIFY(window.testFindNext());
+    QVERIFY(!findOutcome());
+    QCOMPARE(viewer->currentLine(), qint64{4100});
+
+    // Case folding and whole words follow the editor's rules beyond ASCII: the guillemets end a word, the
+    // letters of "k\u00e4sebrot" do not.
+    window.setSearchStateForTest(QStringLiteral("k\u00e4se"), Qt::CaseInsensitive);
+    window.setWholeWordSearchForTest(true);
+    QVERIFY(window.testFindNext());
+    QVERIFY(findOutcome());
+    QCOMPARE(viewer->currentLine(), qint64{4500});
+    QCOMPARE(viewer->currentColumn(), qint64{QStringLiteral("entry 4500 \u00ab").size()});
+    QVERIFY(window.testFindNext());
+    QVERIFY(findOutcome());
+    QCOMPARE(viewer->currentColumn(), qint64{QStringLiteral("entry 4500 \u00ab").size()});
+    window.setWholeWordSearchForTest(false);
+    QVERIFY(window.testFindNext());
+    QVERIFY(findOutcome());
+    QCOMPARE(viewer->currentColumn(), qint64{QStringLiteral("entry 4500 \u00abK\u00c4SE\u00bb ").size()});
+
+    // A UTF-16 file cannot be shown by the viewer and loads into the editor instead.
+    const QString utf16Path = tempDir.filePath(QStringLiteral("wide.txt"));
+    {
+        QFile file(utf16Path);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        QStringEncoder encoder(QStringConverter::Utf16LE, QStringEncoder::Flag::WriteBom);
+        file.write(encoder.encode(QStringLiteral("wide text\n")));
+    }
+    QVERIFY(window.testLoadDocument(utf16Path));
+    QVERIFY(!window.largeFileViewerActiveForTest());
+    QVERIFY(!viewer->isOpen());
+    QVERIFY(!window.editorForTest()->isReadOnly());
+    QCOMPARE(window.editorForTest()->toPlainText(), QStringLiteral("wide text\n"));
+    QVERIFY(window.saveActionForTest()->isEnabled());
+}
+
+void MainWindowSmokeTests::testFailedOpenKeepsLargeFileViewer()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+
+    const QString path = tempDir.filePath(QStringLiteral("huge.log"));
+    {
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        QVERIFY(file.write(QByteArrayLiteral("first\nsecond\nthird\n")) > 0);
+    }
+
+    MainWindow window;
+    window.setLargeFileViewerThresholdForTest(1);
+    QVERIFY(window.testLoadDocument(path));
+    auto* viewer = window.largeFileViewerForTest();
+    QTRY_VERIFY_WITH_TIMEOUT(viewer->indexingComplete(), 10000);
+
+    // The file shown is only let go once the next one opens; a failed open must not leave a writable editor
+    // behind that a save would write over the viewed file.
+    QVERIFY(!window.testLoadDocument(tempDir.filePath(QStringLiteral("missing.log"))));
+    QCOMPARE(window.currentFilePathForTest(), path);
+    QVERIFY(window.largeFileViewerActiveForTest());
+    QVERIFY(viewer->isOpen());
+    QCOMPARE(viewer->lineCount(), qint64{4});
+    QVERIFY(window.editorForTest()->isReadOnly());
+    QVERIFY(window.editorForTest()->document()->isEmpty());
+    QVERIFY(!window.saveActionForTest()->isEnabled());
+}
+
+void MainWindowSmokeTests::testFollowAppendsGrowth()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+
+    const QString path = tempDir.filePath(QStringLiteral("follow.log"));
+    const auto appendBytes = [&path](const QByteArray& bytes)
+    {
+        QFile file(path);
+        return file.open(QIODevice::Append) && file.write(bytes) == bytes.size();
+    };
+    const auto writeBytes = [](const QString& filePath, const QByteArray& bytes)
+    {
+        QFile file(filePath);
+        return file.open(QIODevice::WriteOnly | QIODevice::Truncate) && file.write(bytes) == bytes.size();
+    };
+    QVERIFY(writeBytes(path, QByteArrayLiteral("first\n")));
+
+    MainWindow window;
+    QVERIFY(window.testLoadDocument(path));
+    auto* editor = window.editorForTest();
+    QVERIFY(window.followActionForTest()->isEnabled());
+    window.followActionForTest()->setChecked(true);
+    editor->moveCursor(QTextCursor::End);
+
+    // A CRLF split across two writes is held back until its LF arrives.
+    QVERIFY(appendBytes(QByteArrayLiteral("second\r")));
+    window.testPollFollowedFile();
+    QCOMPARE(editor->toPlainText(), QStringLiteral("first\nsecond"));
+    QVERIFY(appendBytes(QByteArrayLiteral("\nthird\n")));
+    window.testPollFollowedFile();
+    QCOMPARE(editor->toPlainText(), QStringLiteral("first\nsecond\nthird\n"));
+    QVERIFY(!editor->document()->isModified());
+    QVERIFY(editor->textCursor().atEnd());
+    QVERIFY(lineIndexMatchesDocument(editor));
+    // Followed text is the file's, not an edit: undo takes back what was typed before it and leaves it in place.
+    editor->moveCursor(QTextCursor::Start);
+    editor->insertPlainText(QStringLiteral("note "));
+    QVERIFY(appendBytes(QByteArrayLiteral("fourth\n")));
+    window.testPollFollowedFile();
+    QCOMPARE(editor->toPlainText(), QStringLiteral("note first\nsecond\nthird\nfourth\n"));
+    QTest::keySequence(editor, QKeySequence::Undo);
+    QCOMPARE(editor->toPlainText(), QStringLiteral("first\nsecond\nthird\nfourth\n"));
+    QVERIFY(!editor->document()->isModified());
+    QVERIFY(lineIndexMatchesDocument(editor));
+    editor->moveCursor(QTextCursor::End);
+
+    // Half a character is not counted as shown, so following can stop and pick up again in the middle of it.
+    const QByteArray umlaut = QStringLiteral("\u00e4\n").toUtf8();
+    QVERIFY(appendBytes(umlaut.first(1)));
+    window.testPollFollowedFile();
+    window.followActionForTest()->setChecked(false);
+    window.followActionForTest()->setChecked(true);
+    QVERIFY(appendBytes(umlaut.sliced(1)));
+    window.testPollFollowedFile();
+    QCOMPARE(editor->toPlainText(), QStringLiteral("first\nsecond\nthird\nfourth\n\u00e4\n"));
+
+    // Truncation in place reloads the file, in the background.
+    QVERIFY(writeBytes(path, QByteArrayLiteral("new\n")));
+    window.testPollFollowedFile();
+    QTRY_COMPARE(editor->toPlainText(), QStringLiteral("new\n"));
+    QVERIFY(window.followActionForTest()->isChecked());
+
+    // So does rotation: the old file moves away and a fresh one takes its name.
+    QVERIFY(QFile::rename(path, tempDir.filePath(QStringLiteral("follow.log.1"))));
+    QVERIFY(writeBytes(path, QByteArrayLiteral("rotated\n")));
+    window.testPollFollowedFile();
+    QTRY_COMPARE(editor->toPlainText(), QStringLiteral("rotated\n"));
+    QVERIFY(appendBytes(QByteArrayLiteral("more\n")));
+    window.testPollFollowedFile();
+    QCOMPARE(editor->toPlainText(), QStringLiteral("rotated\nmore\n"));
+
+    // With unsaved edits a truncation stops following instead of discarding them.
+    editor->moveCursor(QTextCursor::Start);
+    editor->insertPlainText(QStringLiteral("edit "));
+    QVERIFY(writeBytes(path, QByteArrayLiteral("x\n")));
+    window.enqueueDestructivePromptResponseForTest(QMessageBox::No);
+    window.testPollFollowedFile();
+    QVERIFY(!window.followActionForTest()->isChecked());
+    QCOMPARE(editor->toPlainText(), QStringLiteral("edit rotated\nmore\n"));
+}
+
+void MainWindowSmokeTests::testExternalChangeReloadsChangedLines()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+
+    const QString path = tempDir.filePath(QStringLiteral("external.txt"));
+    const auto writeText = [&path](const QString& text)
+    {
+        QFile file(path);
+        return file.open(QIODevice::WriteOnly | QIODevice::Truncate) && file.write(text.toUtf8()) >= 0;
+    };
+    QStringList lines;
+    for (int index = 0; index < 2000; ++index)
+    {
+        lines << QStringLiteral("line %1").arg(index);
+    }
+    const QString original = lines.join(QLatin1Char('\n')) + QLatin1Char('\n');
+    QVERIFY(writeText(original));
+
+    MainWindow window;
+    QVERIFY(window.testLoadDocument(path));
+    auto* editor = window.editorForTest();
+    QTextCursor cursor(editor->document()->findBlockByNumber(1500));
+    cursor.movePosition(QTextCursor::Right, QTextCursor::MoveAnchor, 3);
+    editor->setTextCursor(cursor);
+
+    // Another program edits a few lines, one of them above the cursor, and appends one more.
+    lines[10] = QStringLiteral("changed near the top");
+    lines.removeAt(500);
+    lines[1800] = QStringLiteral("changed below the cursor");
+    lines << QStringLiteral("appended");
+    const QString changed = lines.join(QLatin1Char('\n')) + QLatin1Char('\n');
+    QVERIFY(writeText(changed));
+    window.testCheckDocumentFileOnDisk();
+    // The file is read back off the GUI thread; the document only changes once all of it is in.
+    QVERIFY(window.reloadRunningForTest());
+    QCOMPARE(editor->toPlainText(), original);
+    QTRY_VERIFY(!window.reloadRunningForTest());
+
+    QCOMPARE(editor->toPlainText(), changed);
+    QVERIFY(!editor->document()->isModified());
+    QVERIFY(lineIndexMatchesDocument(editor));
+    QCOMPARE(editor->pieceTable().text(), documentPositions(editor));
+    // The cursor stays on its text even though a line above it went away.
+    QCOMPARE(editor->textCursor().blockNumber(), 1499);
+    QCOMPARE(editor->textCursor().positionInBlock(), 3);
+
+    // The reload is a single undo step on top of the existing history.
+    QVERIFY(editor->document()->isUndoAvailable());
+    editor->undo();
+    QCOMPARE(editor->toPlainText(), original);
+    editor->redo();
+    QCOMPARE(editor->toPlainText(), changed);
+
+    // Unchanged files are left alone, and unsaved edits are only replaced when the prompt says so.
+    window.testCheckDocumentFileOnDisk();
+    QVERIFY(!window.reloadRunningForTest());
+    QCOMPARE(editor->toPlainText(), changed);
+
+    // A rewrite that keeps the size and the modification time is caught by the sampled content.
+    const QDateTime modified = QFileInfo(path).lastModified();
+    QString sameSize = changed;
+    sameSize.replace(QStringLiteral("line 1000\n"), QStringLiteral("LINE 1000\n"));
+    QVERIFY(writeText(sameSize));
+    {
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::Append));
+        QVERIFY(file.setFileTime(modified, QFileDevice::FileModificationTime));
+    }
+    window.testCheckDocumentFileOnDisk();
+    QTRY_COMPARE(editor->toPlainText(), sameSize);
+    QVERIFY(writeText(changed));
+    window.testCheckDocumentFileOnDisk();
+    QTRY_COMPARE(editor->toPlainText(), changed);
+
+    // Typing while the file is read back keeps the typed text; the reload is offered again and declined.
+    QVERIFY(writeText(original));
+    window.testCheckDocumentFileOnDisk();
+    editor->moveCursor(QTextCursor::End);
+    editor->insertPlainText(QStringLiteral("typed"));
+    window.enqueueDestructivePromptResponseForTest(QMessageBox::No);
+    QTRY_VERIFY(!window.reloadRunningForTest());
+    QCOMPARE(editor->toPlainText(), changed + QStringLiteral("typed"));
+    QVERIFY(editor->document()->isModified());
+    editor->undo();
+    editor->document()->setModified(false);
+    QVERIFY(writeText(changed));
+    window.testCheckDocumentFileOnDisk();
+    QTRY_VERIFY(!window.reloadRunningForTest());
+    QCOMPARE(editor->toPlainText(), changed);
+
+    editor->moveCursor(QTextCursor::Start);
+    editor->insertPlainText(QStringLiteral("local "));
+    QVERIFY(writeText(original));
+    window.enqueueDestructivePromptResponseForTest(QMessageBox::No);
+    window.testCheckDocumentFileOnDisk();
+    QVERIFY(editor->document()->isModified());
+    QVERIFY(editor->toPlainText().startsWith(QStringLiteral("local line 0\n")));
+    QVERIFY(writeText(changed));
+    window.enqueueDestructivePromptResponseForTest(QMessageBox::Yes);
+    window.testCheckDocumentFileOnDisk();
+    QTRY_VERIFY(!window.reloadRunningForTest());
+    QVERIFY(!editor->document()->isModified());
+    QCOMPARE(editor->toPlainText(), changed);
+}
+
+void MainWindowSmokeTests::testEditJournalRecoversUnsavedEdits()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+
+    // Journals from earlier runs would be offered first.
+    const QString journalDirectory = GnotePad::core::EditJournal::defaultDirectory();
+    for (const QString& stale : GnotePad::core::EditJournal::orphanedJournals(journalDirectory))
+    {
+        GnotePad::core::EditJournal::remove(stale);
+    }
+
+    const QString path = tempDir.filePath(QStringLiteral("journal.txt"));
+    qint64 fileBytes = 0;
+    {
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write("alpha\r\nbeta\r\ngamma\r\n");
+        for (int index = 0; index < 20000; ++index)
+        {
+            file.write(QByteArray("filler line ") + QByteArray::number(index) + "\r\n");
+        }
+        fileBytes = file.size();
+    }
+
+    QString expected;
+    {
+        MainWindow crashed;
+        QVERIFY(crashed.testLoadDocument(path));
+        auto* editor = crashed.editorForTest();
+        editor->moveCursor(QTextCursor::End);
+        editor->insertPlainText(QStringLiteral("delta\n"));
+        crashed.testFlushEditJournal();
+        QVERIFY(crashed.editJournalForTest().isOpen());
+        const QString journalPath = crashed.editJournalForTest().filePath();
+        QVERIFY(QFileInfo::exists(journalPath));
+        // The file the document was read from stands in for a snapshot of its text.
+        QVERIFY(crashed.editJournalForTest().base().has_value());
+        QVERIFY(QFileInfo(journalPath).size() < fileBytes / 16);
+
+        // Undoing back to the file's text leaves nothing to recover.
+        editor->undo();
+        QVERIFY(!editor->document()->isModified());
+        crashed.testFlushEditJournal();
+        QVERIFY(!crashed.editJournalForTest().isOpen());
+        QVERIFY(!QFileInfo::exists(journalPath));
+        editor->redo();
+        crashed.testFlushEditJournal();
+        QVERIFY(crashed.editJournalForTest().isOpen());
+
+        // Later edits land as records behind the file base.
+        QTextCursor cursor(editor->document()->findBlockByNumber(1));
+        cursor.movePosition(QTextCursor::EndOfBlock, QTextCursor::KeepAnchor);
+        cursor.insertText(QStringLiteral("BETA\nbeta two"));
+        editor->moveCursor(QTextCursor::Start);
+        editor->insertPlainText(QStringLiteral("# "));
+        crashed.testFlushEditJournal();
+        expected = editor->toPlainText();
+        // Leaving without closeEvent() is what a crash looks like to the next session.
+    }
+    QCOMPARE(GnotePad::core::EditJournal::orphanedJournals(journalDirectory).size(), qsizetype{1});
+
+    MainWindow window;
+    window.enqueueDestructivePromptResponseForTest(QMessageBox::Yes);
+    window.offerDocumentRecovery();
+    auto* editor = window.editorForTest();
+    QCOMPARE(editor->toPlainText(), expected);
+    QVERIFY(editor->document()->isModified());
+    QCOMPARE(window.currentFilePathForTest(), path);
+    QVERIFY(GnotePad::core::EditJournal::orphanedJournals(journalDirectory).isEmpty());
+
+    // Saving makes the journal redundant.
+    window.testFlushEditJournal();
+    const QString journalPath = window.editJournalForTest().filePath();
+    QVERIFY(QFileInfo::exists(journalPath));
+    QVERIFY(window.testSaveDocument(path));
+    QVERIFY(!window.editJournalForTest().isOpen());
+    QVERIFY(!QFileInfo::exists(journalPath));
+}
+
+void MainWindowSmokeTests::testCompressedLogStreamsIn()
+{
+    using GnotePad::core::Compression;
+    if (!GnotePad::core::compressionSupported(Compression::Gzip))
+    {
+        QSKIP("Built without zlib");
+    }
+
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+
+    // Two gzip members, the way rotated logs are often concatenated; they must read as one document.
+    const QString path = tempDir.filePath(QStringLiteral("rotated.log.gz"));
+    QString expected;
+    {
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        constexpr int MEMBER_COUNT = 2;
+        constexpr int LINE_COUNT = 30000;
+        for (int member = 0; member < MEMBER_COUNT; ++member)
+        {
+            GnotePad::core::StreamCompressor compressor(Compression::Gzip);
+            QByteArray compressed;
+            for (int index = 0; index < LINE_COUNT; ++index)
+            {
+                const QString line = QStringLiteral("2024-01-0%1T00:00:00Z INFO request %2 handled äöü\n").arg(member + 1).arg(index);
+                expected += line;
+                QVERIFY(compressor.compress(line.toUtf8(), compressed));
+            }
+            QVERIFY(compressor.finish(compressed));
+            QVERIFY(file.write(compressed) == compressed.size());
+        }
+    }
+
+    // Compressed files stream through the loader even when every other load would be synchronous.
+    MainWindow window;
+    window.setBackgroundLoadThresholdForTest(-1);
+    QVERIFY(window.testLoadDocument(path));
+    QVERIFY(window.documentLoadInProgressForTest());
+    QTRY_VERIFY_WITH_TIMEOUT(!window.documentLoadInProgressForTest(), 30000);
+
+    auto* editor = window.editorForTest();
+    QCOMPARE(editor->toPlainText(), expected);
+    QVERIFY(lineIndexMatchesDocument(editor));
+    QVERIFY(!editor->document()->isModified());
+    QCOMPARE(window.currentFilePathForTest(), path);
+
+    // Saving back to the file compresses it again.
+    editor->moveCursor(QTextCursor::End);
+    editor->insertPlainText(QStringLiteral("appended\n"));
+    QVERIFY(window.testSaveDocument(path));
+    QFile saved(path);
+    QVERIFY(saved.open(QIODevice::ReadOnly));
+    const QByteArray compressed = saved.readAll();
+    QCOMPARE(GnotePad::core::detectCompression(compressed), Compression::Gzip);
+
+    GnotePad::core::StreamDecompressor decompressor(Compression::Gzip);
+    QByteArrayView remaining(compressed);
+    QByteArray chunk;
+    QByteArray decompressed;
+    do
+    {
+        QVERIFY(decompressor.decompress(remaining, chunk, 64 * 1024));
+        decompressed += chunk;
+    } while (!chunk.isEmpty());
+    QVERIFY(decompressor.atEnd());
+    QCOMPARE(QString::fromUtf8(decompressed), expected + QStringLiteral("appended\n"));
+
+    // Zero padding after the last member is skipped, as gzip -d skips it.
+    GnotePad::core::StreamDecompressor paddedDecompressor(Compression::Gzip);
+    const QByteArray padded = compressed + QByteArray(512, '\0');
+    QByteArrayView paddedRemaining(padded);
+    QByteArray paddedOutput;
+    do
+    {
+        QVERIFY(paddedDecompressor.decompress(paddedRemaining, chunk, 64 * 1024));
+        paddedOutput += chunk;
+    } while (!chunk.isEmpty());
+    QVERIFY(paddedDecompressor.atEnd());
+    QVERIFY(paddedRemaining.isEmpty());
+    QCOMPARE(paddedOutput, decompressed);
+
+    // A plain name saves plain text.
+    const QString plainPath = tempDir.filePath(QStringLiteral("rotated.log"));
+    QVERIFY(window.testSaveDocument(plainPath));
+    QFile plain(plainPath);
+    QVERIFY(plain.open(QIODevice::ReadOnly));
+    QCOMPARE(GnotePad::core::detectCompression(plain.read(4)), Compression::None);
+}
+
+void MainWindowSmokeTests::testStandardInputStreamsIn()
+{
+#ifdef Q_OS_UNIX
+    std::array<int, 2> pipeEnds{};
+    QCOMPARE(::pipe(pipeEnds.data()), 0);
+    const auto writeAll = [&pipeEnds](const QByteArray& bytes)
+    { return ::write(pipeEnds[1], bytes.constData(), static_cast<std::size_t>(bytes.size())) == bytes.size(); };
+
+    MainWindow window;
+    QVERIFY(window.testOpenStream(pipeEnds[0]));
+    QVERIFY(window.documentLoadInProgressForTest());
+    QVERIFY(window.windowTitle().contains(QStringLiteral("Standard Input")));
+
+    // Text shows up while the writer is still going.
+    auto* editor = window.editorForTest();
+    QVERIFY(writeAll(QByteArrayLiteral("first line äöü\nsecond ")));
+    QTRY_COMPARE(editor->toPlainText(), QStringLiteral("first line äöü\nsecond "));
+    QVERIFY(window.documentLoadInProgressForTest());
+
+    QVERIFY(writeAll(QByteArrayLiteral("line\nthird line\n")));
+    ::close(pipeEnds[1]);
+    QTRY_VERIFY(!window.documentLoadInProgressForTest());
+    ::close(pipeEnds[0]);
+
+    QCOMPARE(editor->toPlainText(), QStringLiteral("first line äöü\nsecond line\nthird line\n"));
+    QVERIFY(lineIndexMatchesDocument(editor));
+    QVERIFY(!editor->isReadOnly());
+    // Piped text exists nowhere else, so it is unsaved.
+    QVERIFY(editor->document()->isModified());
+    QVERIFY(window.currentFilePathForTest().isEmpty());
+    QVERIFY(!window.windowTitle().contains(QStringLiteral("reading")));
+#else
+    QSKIP("Needs POSIX pipes");
+#endif
+}
+
+void MainWindowSmokeTests::testOpenFilesInParallel()
+{
+    QTemporaryDir tempDir;
+    QVERIFY(tempDir.isValid());
+
+    QStringList paths;
+    QHash<QString, QString> expected;
+    for (int index = 0; index < 3; ++index)
+    {
+        const QString path = tempDir.filePath(QStringLiteral("part%1.txt").arg(index));
+        QString text;
+        for (int line = 0; line < 500; ++line)
+        {
+            text += QStringLiteral("file %1 line %2 äöü\n").arg(index).arg(line);
+        }
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write(text.toUtf8());
+        file.close();
+        paths << path;
+        expected.insert(path, text);
+    }
+
+    MainWindow window;
+    window.openFiles(paths, false);
+
+    // The empty window takes whichever file is ready first; every other file gets a window of its own.
+    const auto openedWindows = [&window]()
+    {
+        QHash<QString, MainWindow*> opened;
+        for (QWidget* widget : QApplication::topLevelWidgets())
+        {
+            auto* candidate = qobject_cast<MainWindow*>(widget);
+            if (candidate != nullptr && (candidate == &window || candidate->testAttribute(Qt::WA_DeleteOnClose)) &&
+                !candidate->currentFilePathForTest().isEmpty())
+            {
+                opened.insert(candidate->currentFilePathForTest(), candidate);
+            }
+        }
+        return opened;
+    };
+    QTRY_COMPARE(openedWindows().size(), paths.size());
+
+    const auto opened = openedWindows();
+    QVERIFY(paths.contains(window.currentFilePathForTest()));
+    for (const QString& path : paths)
+    {
+        MainWindow* owner = opened.value(path);
+        QVERIFY(owner != nullptr);
+        QCOMPARE(owner->editorForTest()->toPlainText(), expected.value(path));
+        QVERIFY(lineIndexMatchesDocument(owner->editorForTest()));
+        QVERIFY(!owner->editorForTest()->document()->isModified());
+    }
+
+    for (MainWindow* owner : opened)
+    {
+        if (owner != &window)
+        {
+            delete owner;
+        }
+    }
+
+    // Text typed while the files are still being read keeps its window; every file then opens in a new one.
+    MainWindow typedInto;
+    typedInto.openFiles(paths, false);
+    typedInto.editorForTest()->insertPlainText(QStringLiteral("typed meanwhile"));
+    const auto newWindows = []()
+    {
+        QList<MainWindow*> windows;
+        for (QWidget* widget : QApplication::topLevelWidgets())
+        {
+            auto* candidate = qobject_cast<MainWindow*>(widget);
+            if (candidate != nullptr && candidate->testAttribute(Qt::WA_DeleteOnClose) && !candidate->currentFilePathForTest().isEmpty())
+            {
+                windows << candidate;
+            }
+        }
+        return windows;
+    };
+    QTRY_COMPARE(newWindows().size(), paths.size());
+    QVERIFY(typedInto.currentFilePathForTest().isEmpty());
+    QCOMPARE(typedInto.editorForTest()->toPlainText(), QStringLiteral("typed meanwhile"));
+    qDeleteAll(newWindows());
+}
+
 int main(int argc, char** argv)
 {
     if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM"))
@@ -72,7 +72,7 @@ IncludeOrderTests::IncludeCategory IncludeOrderTests::categorizeInclude(const QS
 
     // 2. Project headers (src/, include/, tests/)
     if (includePath.startsWith("src/") || includePath.startsWith("include/") || includePath.startsWith("tests/") ||
-        (includePath.startsWith("ui/") || includePath.startsWith("app/")))
+        (includePath.startsWith("core/") || includePath.startsWith("ui/") || includePath.startsWith("app/")))
     {
         return ProjectHeaders;
     }